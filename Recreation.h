@@ -1,7 +1,15 @@
 #ifndef RECREATION_H
 #define RECREATION_H
 
+#include "src/algorithms.hpp"
+#include "src/hash.hpp"
+#include "src/hash_map.hpp"
 #include "src/memory.hpp"
+#include "src/os.hpp"
+#include "src/queue.hpp"
+#include "src/small_vector.hpp"
+#include "src/span.hpp"
+#include "src/string.hpp"
 #include "src/utilities.h"
 #include "src/utilities/types.h"
 #include "src/vector.hpp"
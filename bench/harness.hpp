@@ -0,0 +1,358 @@
+// @file harness.hpp
+
+#pragma once
+
+#include <cstdio>  // For printf
+
+#include "../src/os/clock.hpp"
+#include "../src/utilities/types.h"
+
+// @brief Minimal benchmark harness: every benchmark is warmed up, then timed
+// over a number of samples; each sample runs the body for a fixed operation
+// count and the per-operation times are summarized (min, median, p99, mean).
+// Results are printed as CSV or JSON lines so runs can be diffed by scripts.
+namespace bench {
+
+// @brief The output format of the results.
+enum class Format : uint8 { CSV, JSON };
+
+// @brief Run-wide settings, parsed from the command line.
+struct Options {
+  // @brief Untimed samples run before measuring.
+  uint32 warmup = 3;
+
+  // @brief Timed samples per benchmark (capped at MAX_SAMPLES).
+  uint32 repetitions = 31;
+
+  // @brief The output format.
+  Format format = Format::CSV;
+
+  // @brief Only benchmarks whose name contains this text run (nullptr: all).
+  const char* filter = nullptr;
+};
+
+// @brief The maximum number of timed samples per benchmark.
+inline constexpr uint32 MAX_SAMPLES = 1024;
+
+// @brief The number of results printed so far (JSON needs separators).
+inline uint64 reported = 0;
+
+// @brief The summary of one benchmark, with times per operation.
+struct Result {
+  const char* name;
+  uint64 param;
+  uint64 ops;
+  float64 min_ns;
+  float64 median_ns;
+  float64 p99_ns;
+  float64 mean_ns;
+  float64 median_cycles;
+
+  // @brief Bytes processed per second at the median (0 if not applicable).
+  float64 bytes_per_second;
+};
+
+// @brief Returns a monotonic timestamp.
+// @return Nanoseconds since an arbitrary epoch.
+uint64 now_ns();
+
+// @brief Returns the CPU timestamp counter (TSC on x86, CNTVCT on ARM64),
+// or the monotonic clock where no counter is available.
+// @return The counter value.
+uint64 cycles();
+
+// @brief Keeps the compiler from discarding a value it can prove unused.
+// @param value The value to keep alive.
+template <typename T>
+void keep(const T& value);
+
+// @brief Forces pending writes to memory to be considered observable.
+void clobber();
+
+// @brief Parses --warmup N, --repetitions N, --format csv|json and
+// --filter TEXT.
+// @param argc The argument count passed to main.
+// @param argv The arguments passed to main.
+// @param options Receives the parsed settings.
+// @return false (after printing usage) on an unknown or malformed argument.
+bool parse(int argc, char** argv, Options& options);
+
+// @brief Prints the header line of the chosen format.
+// @param options The run settings.
+void begin(const Options& options);
+
+// @brief Prints the closing line of the chosen format.
+// @param options The run settings.
+void end(const Options& options);
+
+// @brief Runs one benchmark and prints its result.
+// @param options The run settings.
+// @param name The benchmark name.
+// @param param A free-form parameter reported with the result (size, count).
+// @param ops The number of operations performed by one call of body.
+// @param bytes The number of bytes processed per operation (0 if none).
+// @param body Callable performing ops operations; called once per sample.
+// @return The summary (zeroed if the benchmark was filtered out).
+template <typename Body>
+Result run(const Options& options, const char* name, const uint64 param,
+           const uint64 ops, const uint64 bytes, Body&& body);
+
+// @brief Prints one result in the chosen format.
+// @param options The run settings.
+// @param result The result to print.
+void report(const Options& options, const Result& result);
+
+// @brief Returns whether name passes the filter.
+// @param options The run settings.
+// @param name The benchmark name.
+// @return true if the benchmark should run.
+bool selected(const Options& options, const char* name);
+
+// @brief Sorts samples in place (ascending).
+// @param samples The samples.
+// @param count The number of samples.
+void sort(float64* samples, const uint32 count);
+
+// === Benchmark suites (defined in the other bench/*.cpp files) ===
+
+// @brief memory::copy, set, compare and find over several block sizes.
+void memory_suite(const Options& options);
+
+// @brief Vector push, insert, remove and get across element sizes, plus
+// growth policies.
+void vector_suite(const Options& options);
+
+// @brief Integer and float conversions to and from text, against the C
+// library.
+void numbers_suite(const Options& options);
+
+// @brief HashMap insert and find (hits and misses), against
+// std::unordered_map.
+void hash_map_suite(const Options& options);
+
+// @brief hash::bytes over several sizes, streaming, and batches of integer
+// keys.
+void hash_suite(const Options& options);
+
+// @brief String assignment inline and on the heap, appends, and StringView
+// find and split over a 64 KiB buffer.
+void string_suite(const Options& options);
+
+// @brief SPSCQueue and MPMCQueue round trips, single and batched, against a
+// mutex-guarded Vector, and a producer thread handing items to a consumer.
+void queue_suite(const Options& options);
+
+// @brief Loop timer scheduling and a loopback echo round trip through a
+// Server.
+void network_suite(const Options& options);
+
+// @brief send_file against the user-space copy fallback over a 1 MiB file,
+// and one write_vector against a write per buffer.
+void transfer_suite(const Options& options);
+
+// @brief Clock and cycle counter reads, and trace zones while stopped and
+// while recording.
+void trace_suite(const Options& options);
+
+// @brief Child::spawn against fork+exec from a small and a 256 MiB parent,
+// and capture() into a reused vector.
+void process_suite(const Options& options);
+
+}  // namespace bench
+
+// === Implementation of bench ===
+
+inline uint64 bench::now_ns() { return os::system::clock::now(); }
+
+inline uint64 bench::cycles() { return os::system::clock::ticks(); }
+
+template <typename T>
+inline void bench::keep(const T& value) {
+  __asm__ volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void bench::clobber() { __asm__ volatile("" : : : "memory"); }
+
+inline bool bench::parse(int argc, char** argv, Options& options) {
+  // Compares two NUL-terminated strings
+  auto equal = [](const char* a, const char* b) {
+    while (*a != '\0' && *a == *b) {
+      a++;
+      b++;
+    }
+    return *a == *b;
+  };
+
+  // Parses a decimal number no larger than MAX_SAMPLES
+  auto number = [](const char* text, uint32& out) {
+    const char* start = text;
+    uint64 value = 0;
+    for (; *text >= '0' && *text <= '9' && value <= MAX_SAMPLES; text++) {
+      value = value * 10 + static_cast<uint64>(*text - '0');
+    }
+    out = static_cast<uint32>(value);
+    return *text == '\0' && text != start && value <= MAX_SAMPLES;
+  };
+
+  // Walk the flag/value pairs
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = i + 1 < argc;
+    bool ok = has_value;
+    if (has_value && equal(argv[i], "--warmup")) {
+      ok = number(argv[++i], options.warmup);
+    } else if (has_value && equal(argv[i], "--repetitions")) {
+      ok = number(argv[++i], options.repetitions) && options.repetitions > 0;
+    } else if (has_value && equal(argv[i], "--format")) {
+      i++;
+      if (equal(argv[i], "csv")) {
+        options.format = Format::CSV;
+      } else if (equal(argv[i], "json")) {
+        options.format = Format::JSON;
+      } else {
+        ok = false;
+      }
+    } else if (has_value && equal(argv[i], "--filter")) {
+      options.filter = argv[++i];
+    } else {
+      ok = false;
+    }
+
+    if (!ok) {
+      fprintf(stderr,
+              "usage: %s [--warmup N] [--repetitions N] [--format csv|json] "
+              "[--filter TEXT]\n",
+              argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+inline void bench::begin(const Options& options) {
+  if (options.format == Format::CSV) {
+    printf(
+        "name,param,ops,min_ns,median_ns,p99_ns,mean_ns,median_cycles,"
+        "bytes_per_second\n");
+  } else {
+    printf("[\n");
+  }
+}
+
+inline void bench::end(const Options& options) {
+  if (options.format == Format::JSON) {
+    printf("\n]\n");
+  }
+}
+
+inline bool bench::selected(const Options& options, const char* name) {
+  if (options.filter == nullptr) {
+    return true;
+  }
+
+  // Naive substring search; names are short
+  for (const char* start = name; *start != '\0'; start++) {
+    const char* a = start;
+    const char* b = options.filter;
+    while (*b != '\0' && *a == *b) {
+      a++;
+      b++;
+    }
+    if (*b == '\0') {
+      return true;
+    }
+  }
+  return options.filter[0] == '\0';
+}
+
+inline void bench::sort(float64* samples, const uint32 count) {
+  // Insertion sort: sample counts are small
+  for (uint32 i = 1; i < count; i++) {
+    const float64 value = samples[i];
+    uint32 j = i;
+    while (j > 0 && samples[j - 1] > value) {
+      samples[j] = samples[j - 1];
+      j--;
+    }
+    samples[j] = value;
+  }
+}
+
+template <typename Body>
+bench::Result bench::run(const Options& options, const char* name,
+                         const uint64 param, const uint64 ops,
+                         const uint64 bytes, Body&& body) {
+  Result result = {};
+  if (!selected(options, name)) {
+    return result;
+  }
+
+  // Warm caches, branch predictors and the allocator
+  for (uint32 i = 0; i < options.warmup; i++) {
+    body();
+  }
+
+  // Time every sample, both in nanoseconds and in counter ticks
+  const uint32 count =
+      options.repetitions < MAX_SAMPLES ? options.repetitions : MAX_SAMPLES;
+  if (count == 0) {
+    return result;
+  }
+  float64 times[MAX_SAMPLES];
+  float64 ticks[MAX_SAMPLES];
+  const float64 per_op = 1.0 / static_cast<float64>(ops);
+  for (uint32 i = 0; i < count; i++) {
+    const uint64 start_cycles = cycles();
+    const uint64 start = now_ns();
+    body();
+    const uint64 stop = now_ns();
+    const uint64 stop_cycles = cycles();
+    times[i] = static_cast<float64>(stop - start) * per_op;
+    ticks[i] = static_cast<float64>(stop_cycles - start_cycles) * per_op;
+  }
+
+  // Summarize
+  sort(times, count);
+  sort(ticks, count);
+  float64 sum = 0;
+  for (uint32 i = 0; i < count; i++) {
+    sum += times[i];
+  }
+  result.name = name;
+  result.param = param;
+  result.ops = ops;
+  result.min_ns = times[0];
+  result.median_ns = times[count / 2];
+  result.p99_ns = times[(count * 99) / 100 < count ? (count * 99) / 100
+                                                    : count - 1];
+  result.mean_ns = sum / static_cast<float64>(count);
+  result.median_cycles = ticks[count / 2];
+  result.bytes_per_second =
+      result.median_ns > 0
+          ? static_cast<float64>(bytes) * 1e9 / result.median_ns
+          : 0;
+
+  report(options, result);
+  return result;
+}
+
+inline void bench::report(const Options& options, const Result& result) {
+  if (options.format == Format::CSV) {
+    printf("%s,%llu,%llu,%.3f,%.3f,%.3f,%.3f,%.1f,%.0f\n", result.name,
+           static_cast<unsigned long long>(result.param),
+           static_cast<unsigned long long>(result.ops), result.min_ns,
+           result.median_ns, result.p99_ns, result.mean_ns,
+           result.median_cycles, result.bytes_per_second);
+  } else {
+    printf(
+        "%s{\"name\":\"%s\",\"param\":%llu,\"ops\":%llu,\"min_ns\":%.3f,"
+        "\"median_ns\":%.3f,\"p99_ns\":%.3f,\"mean_ns\":%.3f,"
+        "\"median_cycles\":%.1f,\"bytes_per_second\":%.0f}",
+        reported == 0 ? "" : ",\n", result.name,
+        static_cast<unsigned long long>(result.param),
+        static_cast<unsigned long long>(result.ops), result.min_ns,
+        result.median_ns, result.p99_ns, result.mean_ns, result.median_cycles,
+        result.bytes_per_second);
+  }
+  reported++;
+  fflush(stdout);
+}
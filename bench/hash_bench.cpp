@@ -0,0 +1,56 @@
+// @file hash_bench.cpp
+
+#include "../src/hash.hpp"
+#include "harness.hpp"
+
+void bench::hash_suite(const Options& options) {
+  // Input sizes from a short key up to past the L2 cache
+  const uint64 sizes[] = {8, 32, 256, 4 * 1024, 256 * 1024};
+  const uint64 largest = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+  byte* input = static_cast<byte*>(memory::allocate(largest));
+  if (input == nullptr) {
+    return;
+  }
+  uint64 state = 0x9E3779B97F4A7C15;
+  for (uint64 i = 0; i < largest; i++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    input[i] = static_cast<byte>(state);
+  }
+
+  for (const uint64 size : sizes) {
+    // Keep the byte count per sample roughly constant
+    const uint64 ops = size >= 64 * 1024 ? 4 : (256 * 1024) / size;
+    run(options, "hash::bytes", size, ops, size, [&] {
+      for (uint64 i = 0; i < ops; i++) {
+        keep(hash::bytes(input, size, i));
+      }
+    });
+  }
+
+  // The same bytes arriving in 4 KiB chunks
+  run(options, "hash::Stream", largest, 1, largest, [&] {
+    hash::Stream stream;
+    for (uint64 offset = 0; offset < largest; offset += 4096) {
+      stream.update(input + offset, 4096);
+    }
+    keep(stream.finish());
+  });
+
+  // Batches of integer keys
+  constexpr uint64 KEYS = 4096;
+  static uint64 hashes[KEYS];
+  const uint64* wide = reinterpret_cast<const uint64*>(input);
+  const uint32* narrow = reinterpret_cast<const uint32*>(input);
+  run(options, "hash::batch(uint64)", KEYS, KEYS, sizeof(uint64), [&] {
+    hash::batch(wide, hashes, KEYS);
+    clobber();
+  });
+  run(options, "hash::batch(uint32)", KEYS, KEYS, sizeof(uint32), [&] {
+    hash::batch(narrow, hashes, KEYS);
+    clobber();
+  });
+
+  memory::deallocate(input);
+}
@@ -0,0 +1,73 @@
+// @file hash_map_bench.cpp
+
+#include <unordered_map>  // The node-based baseline
+
+#include "../src/hash_map.hpp"
+#include "harness.hpp"
+
+void bench::hash_map_suite(const Options& options) {
+  // Pseudo-random keys; lookups hit every key once, misses none
+  constexpr uint64 COUNT = 16384;
+  static uint64 keys[COUNT];
+  static uint64 missing[COUNT];
+  uint64 state = 0x9E3779B97F4A7C15;
+  for (uint64 i = 0; i < COUNT; i++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    keys[i] = state;
+    missing[i] = state ^ 0x5555555555555555;
+  }
+
+  // Building a map from empty, against std::unordered_map
+  run(options, "HashMap::insert", COUNT, COUNT, 0, [&] {
+    HashMap<uint64, uint64> map;
+    for (uint64 i = 0; i < COUNT; i++) {
+      map.insert(keys[i], i);
+    }
+    keep(map.getSize());
+  });
+  run(options, "HashMap::insert(reserved)", COUNT, COUNT, 0, [&] {
+    HashMap<uint64, uint64> map;
+    map.reserve(COUNT);
+    for (uint64 i = 0; i < COUNT; i++) {
+      map.insert(keys[i], i);
+    }
+    keep(map.getSize());
+  });
+  run(options, "std::unordered_map::insert", COUNT, COUNT, 0, [&] {
+    std::unordered_map<uint64, uint64> map;
+    for (uint64 i = 0; i < COUNT; i++) {
+      map.insert({keys[i], i});
+    }
+    keep(map.size());
+  });
+
+  // Lookups in warm maps, hits and misses
+  HashMap<uint64, uint64> map;
+  std::unordered_map<uint64, uint64> baseline;
+  for (uint64 i = 0; i < COUNT; i++) {
+    map.insert(keys[i], i);
+    baseline.insert({keys[i], i});
+  }
+  run(options, "HashMap::find(hit)", COUNT, COUNT, 0, [&] {
+    for (uint64 i = 0; i < COUNT; i++) {
+      keep(map.find(keys[i]));
+    }
+  });
+  run(options, "std::unordered_map::find(hit)", COUNT, COUNT, 0, [&] {
+    for (uint64 i = 0; i < COUNT; i++) {
+      keep(baseline.find(keys[i]) != baseline.end());
+    }
+  });
+  run(options, "HashMap::find(miss)", COUNT, COUNT, 0, [&] {
+    for (uint64 i = 0; i < COUNT; i++) {
+      keep(map.find(missing[i]));
+    }
+  });
+  run(options, "std::unordered_map::find(miss)", COUNT, COUNT, 0, [&] {
+    for (uint64 i = 0; i < COUNT; i++) {
+      keep(baseline.find(missing[i]) != baseline.end());
+    }
+  });
+}
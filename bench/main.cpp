@@ -0,0 +1,27 @@
+// @file main.cpp
+
+#include "harness.hpp"
+
+int main(int argc, char** argv) {
+  // Parse the command line
+  bench::Options options;
+  if (!bench::parse(argc, argv, options)) {
+    return 1;
+  }
+
+  // Run every suite; --filter narrows them down by benchmark name
+  bench::begin(options);
+  bench::memory_suite(options);
+  bench::vector_suite(options);
+  bench::numbers_suite(options);
+  bench::hash_map_suite(options);
+  bench::hash_suite(options);
+  bench::string_suite(options);
+  bench::queue_suite(options);
+  bench::network_suite(options);
+  bench::transfer_suite(options);
+  bench::trace_suite(options);
+  bench::process_suite(options);
+  bench::end(options);
+  return 0;
+}
@@ -0,0 +1,84 @@
+// @file memory_bench.cpp
+
+#include "../src/memory.hpp"
+#include "harness.hpp"
+
+void bench::memory_suite(const Options& options) {
+  // Block sizes from a cache line up to past the last-level cache
+  const uint64 sizes[] = {64, 1024, 16 * 1024, 256 * 1024, 4 * 1024 * 1024};
+  const uint64 largest = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+
+  // Two buffers, so copies read and write different lines
+  byte* source = static_cast<byte*>(memory::allocate(largest));
+  byte* target = static_cast<byte*>(memory::allocate(largest));
+  if (source == nullptr || target == nullptr) {
+    memory::deallocate(source);
+    memory::deallocate(target);
+    return;
+  }
+  const byte fill = 0x5A;
+  memory::set(source, &fill, largest);
+  memory::set(target, &fill, largest);
+
+  for (const uint64 size : sizes) {
+    // Keep the byte count per sample roughly constant
+    const uint64 ops = size >= 1024 * 1024 ? 4 : (4 * 1024 * 1024) / size;
+
+    run(options, "memory::copy", size, ops, size, [&] {
+      for (uint64 i = 0; i < ops; i++) {
+        memory::copy(target, source, size);
+        clobber();
+      }
+    });
+
+    run(options, "memory::move", size, ops, size, [&] {
+      for (uint64 i = 0; i < ops; i++) {
+        memory::move(target + 1, target, size - 1);
+        clobber();
+      }
+    });
+
+    run(options, "memory::set", size, ops, size, [&] {
+      for (uint64 i = 0; i < ops; i++) {
+        memory::set(target, &fill, size);
+        clobber();
+      }
+    });
+
+    // Equal blocks: the whole range has to be scanned
+    memory::copy(target, source, size);
+    run(options, "memory::compare", size, ops, size, [&] {
+      for (uint64 i = 0; i < ops; i++) {
+        keep(memory::compare(target, source, size));
+      }
+    });
+
+    // A needle sitting at the very end of the haystack
+    const byte needle[4] = {1, 2, 3, 4};
+    memory::copy(target + size - sizeof(needle), needle, sizeof(needle));
+    run(options, "memory::find", size, ops, size, [&] {
+      for (uint64 i = 0; i < ops; i++) {
+        keep(memory::find(target, size, needle, sizeof(needle)));
+      }
+    });
+    memory::set(target, &fill, size);
+  }
+
+  // Allocation round trips through the active backend
+  const uint64 allocation_sizes[] = {16, 256, 4096, 65536};
+  for (const uint64 size : allocation_sizes) {
+    void* blocks[256];
+    run(options, "memory::allocate+deallocate", size, 256, 0, [&] {
+      for (uint64 i = 0; i < 256; i++) {
+        blocks[i] = memory::allocate(size);
+        keep(blocks[i]);
+      }
+      for (uint64 i = 0; i < 256; i++) {
+        memory::deallocate(blocks[i]);
+      }
+    });
+  }
+
+  memory::deallocate(source);
+  memory::deallocate(target);
+}
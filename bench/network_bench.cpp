@@ -0,0 +1,69 @@
+// @file network_bench.cpp
+
+#include "../src/os/network.hpp"
+#include "harness.hpp"
+
+namespace {
+
+// @brief Sends every byte received straight back.
+void echo(void* context, os::network::Connection& connection) {
+  (void)context;
+  const Span<byte> input = connection.getInput();
+  connection.consume(connection.write(input.getData(), input.getSize()));
+}
+
+}  // namespace
+
+void bench::network_suite(const Options& options) {
+  using namespace os::network;
+  Loop loop;
+  if (loop.open() != NetworkStatus::OK) {
+    return;
+  }
+
+  // Timers: scheduling and cancelling keeps the heap at one entry
+  constexpr uint64 TIMERS = 1024;
+  run(options, "Loop::add_timer+cancel_timer", TIMERS, TIMERS, 0, [&] {
+    for (uint64 i = 0; i < TIMERS; i++) {
+      uint64 id;
+      loop.add_timer(1000 + i, [](void*) {}, nullptr, id);
+      keep(loop.cancel_timer(id));
+    }
+  });
+
+  // A loopback echo round trip driven from this thread: the client writes,
+  // one iteration echoes, the client reads the reply back
+  Server::Handlers handlers{nullptr, &echo, nullptr, nullptr, nullptr};
+  Server server(loop, handlers);
+  Address address;
+  Socket client;
+  if (server.listen(loopback(0), false) != NetworkStatus::OK ||
+      server.getLocalAddress(address) != NetworkStatus::OK ||
+      client.connect(address) != NetworkStatus::OK) {
+    return;
+  }
+  client.set_no_delay(true);
+  while (server.getConnectionCount() == 0) {
+    loop.run_once(10);
+  }
+  constexpr uint64 MESSAGE = 64;
+  constexpr uint64 ROUND_TRIPS = 256;
+  byte message[MESSAGE] = {};
+  byte reply[MESSAGE];
+  run(options, "Server::echo(loopback)", MESSAGE, ROUND_TRIPS, MESSAGE, [&] {
+    for (uint64 i = 0; i < ROUND_TRIPS; i++) {
+      uint64 written;
+      client.write(message, MESSAGE, written);
+      uint64 received = 0;
+      while (received < MESSAGE) {
+        loop.run_once(0);
+        uint64 read_count;
+        if (client.read(reply + received, MESSAGE - received, read_count) ==
+            NetworkStatus::OK) {
+          received += read_count;
+        }
+      }
+    }
+    keep(reply[0]);
+  });
+}
@@ -0,0 +1,108 @@
+// @file numbers_bench.cpp
+
+#include <stdio.h>   // snprintf, the formatting baseline
+#include <stdlib.h>  // strtoull, strtod, the parsing baselines
+
+#include "../src/numbers.hpp"
+#include "harness.hpp"
+
+void bench::numbers_suite(const Options& options) {
+  // Pseudo-random inputs of mixed magnitude, and their text forms
+  constexpr uint64 COUNT = 1024;
+  static uint64 integers[COUNT];
+  static float64 floats[COUNT];
+  static char integer_text[COUNT][numbers::MAX_CHARS];
+  static char float_text[COUNT][numbers::MAX_CHARS];
+  static uint32 integer_length[COUNT];
+  static uint32 float_length[COUNT];
+  uint64 state = 0x9E3779B97F4A7C15;
+  for (uint64 i = 0; i < COUNT; i++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    integers[i] = state >> (state % 64);
+    floats[i] = static_cast<float64>(state >> 11) /
+                static_cast<float64>(1ULL << (state % 40));
+    integer_length[i] = numbers::to_string(integers[i], integer_text[i]);
+    integer_text[i][integer_length[i]] = '\0';
+    float_length[i] = numbers::to_string(floats[i], float_text[i]);
+    float_text[i][float_length[i]] = '\0';
+  }
+
+  // Formatting, against snprintf
+  char out[numbers::MAX_CHARS];
+  run(options, "numbers::to_string(uint64)", COUNT, COUNT, 0, [&] {
+    for (uint64 i = 0; i < COUNT; i++) {
+      keep(numbers::to_string(integers[i], out));
+      clobber();
+    }
+  });
+  run(options, "snprintf(uint64)", COUNT, COUNT, 0, [&] {
+    for (uint64 i = 0; i < COUNT; i++) {
+      keep(snprintf(out, sizeof(out), "%llu", integers[i]));
+      clobber();
+    }
+  });
+  run(options, "numbers::to_string(float64)", COUNT, COUNT, 0, [&] {
+    for (uint64 i = 0; i < COUNT; i++) {
+      keep(numbers::to_string(floats[i], out));
+      clobber();
+    }
+  });
+  run(options, "snprintf(float64)", COUNT, COUNT, 0, [&] {
+    for (uint64 i = 0; i < COUNT; i++) {
+      keep(snprintf(out, sizeof(out), "%.17g", floats[i]));
+      clobber();
+    }
+  });
+
+  // Parsing, against the C library
+  run(options, "numbers::from_string(uint64)", COUNT, COUNT, 0, [&] {
+    uint64 value = 0;
+    for (uint64 i = 0; i < COUNT; i++) {
+      numbers::from_string(integer_text[i], integer_length[i], value);
+      keep(value);
+    }
+  });
+  run(options, "strtoull", COUNT, COUNT, 0, [&] {
+    for (uint64 i = 0; i < COUNT; i++) {
+      keep(strtoull(integer_text[i], nullptr, 10));
+    }
+  });
+  run(options, "numbers::from_string(float64)", COUNT, COUNT, 0, [&] {
+    float64 value = 0;
+    for (uint64 i = 0; i < COUNT; i++) {
+      numbers::from_string(float_text[i], float_length[i], value);
+      keep(value);
+    }
+  });
+  run(options, "strtod", COUNT, COUNT, 0, [&] {
+    for (uint64 i = 0; i < COUNT; i++) {
+      keep(strtod(float_text[i], nullptr));
+    }
+  });
+
+  // Saturating accumulation: the branchless range form against a loop that
+  // branches on every checked add
+  static int16 counters[COUNT];
+  static int16 deltas[COUNT];
+  for (uint64 i = 0; i < COUNT; i++) {
+    deltas[i] = static_cast<int16>(integers[i]);
+  }
+  run(options, "numbers::saturating_add(int16*)", COUNT, COUNT, sizeof(int16),
+      [&] {
+        numbers::saturating_add(counters, deltas, COUNT);
+        clobber();
+      });
+  run(options, "checked_add branch(int16)", COUNT, COUNT, sizeof(int16),
+      [&] {
+        for (uint64 i = 0; i < COUNT; i++) {
+          int16 sum;
+          if (!numbers::checked_add(counters[i], deltas[i], sum)) {
+            sum = deltas[i] < 0 ? limits<int16>::min : limits<int16>::max;
+          }
+          counters[i] = sum;
+        }
+        clobber();
+      });
+}
@@ -0,0 +1,56 @@
+// @file process_bench.cpp
+
+#include <sys/wait.h>  // waitpid
+#include <unistd.h>    // fork, execv, _exit
+
+#include "../src/os/process.hpp"
+#include "../src/vector.hpp"
+#include "harness.hpp"
+
+namespace {
+
+// @brief The launch being replaced: fork copies the page tables of the
+// whole parent before exec throws them away.
+int fork_exec(char* const* arguments) {
+  const pid_t child = fork();
+  if (child == 0) {
+    execv(arguments[0], arguments);
+    _exit(127);
+  }
+  int raw = 0;
+  waitpid(child, &raw, 0);
+  return raw;
+}
+
+}  // namespace
+
+void bench::process_suite(const Options& options) {
+  using namespace os::process;
+  const char* arguments[] = {"/bin/true", nullptr};
+  const char* echo[] = {"/bin/echo", "captured", nullptr};
+
+  // Launch and reap from this process, then again with 256 MiB resident,
+  // where fork has page tables to copy and posix_spawn does not
+  constexpr uint64 LARGE = 256ULL << 20;
+  for (uint64 resident = 0; resident <= LARGE; resident += LARGE) {
+    Vector<byte> ballast(16);
+    ballast.resize(resident, static_cast<byte>(1));
+    run(options, "Child::spawn+wait", resident >> 20, 1, 0, [&] {
+      Child child;
+      child.spawn(arguments);
+      child.wait();
+      keep(child.getExitCode());
+    });
+    run(options, "fork+exec+wait", resident >> 20, 1, 0, [&] {
+      keep(fork_exec(const_cast<char* const*>(arguments)));
+    });
+  }
+
+  // Capturing into one reused vector
+  Vector<byte> output(64);
+  run(options, "capture(echo)", 9, 1, 0, [&] {
+    int exit_code;
+    capture(echo, output, exit_code);
+    keep(output.getSize());
+  });
+}
@@ -0,0 +1,131 @@
+// @file queue_bench.cpp
+
+#include "../src/os/thread.hpp"
+#include "../src/queue.hpp"
+#include "../src/vector.hpp"
+#include "harness.hpp"
+
+namespace {
+
+// @brief The handoff being replaced: a Vector guarded by a mutex.
+struct LockedVector {
+  Vector<uint64> items{64};
+  pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+};
+
+// @brief Shared with the producer thread of a handoff benchmark.
+template <typename Q>
+struct Handoff {
+  Q* queue;
+  uint64 count;
+};
+
+// @brief Pushes 0..count-1 in batches of 32, yielding while the queue is
+// full so the benchmark also makes progress on a single CPU.
+template <typename Q>
+void produce(void* argument) {
+  Handoff<Q>* handoff = static_cast<Handoff<Q>*>(argument);
+  uint64 batch[32];
+  uint64 next = 0;
+  while (next < handoff->count) {
+    uint64 size = 0;
+    while (size < 32 && next + size < handoff->count) {
+      batch[size] = next + size;
+      size++;
+    }
+    const uint64 pushed = handoff->queue->push_batch(batch, size);
+    if (pushed == 0) {
+      os::thread::yield();
+    }
+    next += pushed;
+  }
+}
+
+// @brief Starts a producer and pops everything it pushes.
+// @return The sum of the popped values.
+template <typename Q>
+uint64 consume(Q& queue, const uint64 count) {
+  Handoff<Q> handoff{&queue, count};
+  os::thread::Thread producer;
+  producer.start(&produce<Q>, &handoff);
+  uint64 batch[32];
+  uint64 received = 0;
+  uint64 sum = 0;
+  while (received < count) {
+    const uint64 popped = queue.pop_batch(batch, 32);
+    if (popped == 0) {
+      os::thread::yield();
+    }
+    for (uint64 i = 0; i < popped; i++) {
+      sum += batch[i];
+    }
+    received += popped;
+  }
+  producer.join();
+  return sum;
+}
+
+}  // namespace
+
+void bench::queue_suite(const Options& options) {
+  // One thread pushing and popping: the cost of a handoff without contention
+  constexpr uint64 ITEMS = 4096;
+  SPSCQueue<uint64> spsc(1024);
+  MPMCQueue<uint64> mpmc(1024);
+  LockedVector locked;
+  run(options, "SPSCQueue::push+pop", ITEMS, ITEMS, 0, [&] {
+    uint64 value = 0;
+    for (uint64 i = 0; i < ITEMS; i++) {
+      spsc.push(i);
+      spsc.pop(value);
+    }
+    keep(value);
+  });
+  run(options, "MPMCQueue::push+pop", ITEMS, ITEMS, 0, [&] {
+    uint64 value = 0;
+    for (uint64 i = 0; i < ITEMS; i++) {
+      mpmc.push(i);
+      mpmc.pop(value);
+    }
+    keep(value);
+  });
+  run(options, "mutex+Vector::push+pop", ITEMS, ITEMS, 0, [&] {
+    uint64 value = 0;
+    for (uint64 i = 0; i < ITEMS; i++) {
+      pthread_mutex_lock(&locked.mutex);
+      locked.items.push(i);
+      pthread_mutex_unlock(&locked.mutex);
+      pthread_mutex_lock(&locked.mutex);
+      locked.items.pop(value);
+      pthread_mutex_unlock(&locked.mutex);
+    }
+    keep(value);
+  });
+
+  // Batches of 64 publish and release with one store or compare-and-swap
+  constexpr uint64 BATCH = 64;
+  uint64 batch[BATCH];
+  for (uint64 i = 0; i < BATCH; i++) {
+    batch[i] = i;
+  }
+  run(options, "SPSCQueue::push_batch+pop_batch", BATCH, ITEMS, 0, [&] {
+    for (uint64 i = 0; i < ITEMS; i += BATCH) {
+      spsc.push_batch(batch, BATCH);
+      keep(spsc.pop_batch(batch, BATCH));
+    }
+  });
+  run(options, "MPMCQueue::push_batch+pop_batch", BATCH, ITEMS, 0, [&] {
+    for (uint64 i = 0; i < ITEMS; i += BATCH) {
+      mpmc.push_batch(batch, BATCH);
+      keep(mpmc.pop_batch(batch, BATCH));
+    }
+  });
+
+  // A producer thread handing items to this one
+  constexpr uint64 HANDOFF = 1 << 18;
+  run(options, "SPSCQueue::handoff", HANDOFF, HANDOFF, 0,
+      [&] { keep(consume(spsc, HANDOFF)); });
+  run(options, "MPMCQueue::handoff", HANDOFF, HANDOFF, 0,
+      [&] { keep(consume(mpmc, HANDOFF)); });
+  pthread_mutex_destroy(&locked.mutex);
+}
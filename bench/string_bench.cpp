@@ -0,0 +1,49 @@
+// @file string_bench.cpp
+
+#include "../src/string.hpp"
+#include "harness.hpp"
+
+void bench::string_suite(const Options& options) {
+  // Short keys stay inline; long ones go to the heap
+  constexpr uint64 KEYS = 1024;
+  const StringView short_key("user:4815162342");
+  const StringView long_key("session:4815162342:0123456789abcdef");
+  run(options, "String::assign(inline)", short_key.getSize(), KEYS, 0, [&] {
+    for (uint64 i = 0; i < KEYS; i++) {
+      String key;
+      key.assign(short_key);
+      keep(key.getSize());
+    }
+  });
+  run(options, "String::assign(heap)", long_key.getSize(), KEYS, 0, [&] {
+    for (uint64 i = 0; i < KEYS; i++) {
+      String key;
+      key.assign(long_key);
+      keep(key.getSize());
+    }
+  });
+  run(options, "String::append(char)", KEYS, KEYS, 0, [&] {
+    String text;
+    for (uint64 i = 0; i < KEYS; i++) {
+      text.append('x');
+    }
+    keep(text.getSize());
+  });
+
+  // Searching and splitting a comma-separated 64 KiB buffer
+  constexpr uint64 SIZE = 64 * 1024;
+  String text;
+  text.reserve(SIZE);
+  while (text.getSize() + 18 <= SIZE) {
+    text.append("field,value,");
+    text.append("12345,");
+  }
+  const StringView view = text.getView();
+  run(options, "StringView::find(missing)", view.getSize(), 1, view.getSize(),
+      [&] { keep(view.find("needle")); });
+  run(options, "StringView::split", view.getSize(), 1, view.getSize(), [&] {
+    uint64 fields = 0;
+    view.split(",", [&](const StringView piece) { fields += piece.getSize(); });
+    keep(fields);
+  });
+}
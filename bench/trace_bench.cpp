@@ -0,0 +1,43 @@
+// @file trace_bench.cpp
+
+#include "../src/os/clock.hpp"
+#include "../src/os/trace.hpp"
+#include "harness.hpp"
+
+void bench::trace_suite(const Options& options) {
+  using namespace os::system;
+  constexpr uint64 READS = 1024;
+  run(options, "clock::now", READS, READS, 0, [&] {
+    uint64 sum = 0;
+    for (uint64 i = 0; i < READS; i++) {
+      sum += clock::now();
+    }
+    keep(sum);
+  });
+  run(options, "clock::ticks", READS, READS, 0, [&] {
+    uint64 sum = 0;
+    for (uint64 i = 0; i < READS; i++) {
+      sum += clock::ticks();
+    }
+    keep(sum);
+  });
+
+  // A zone costs a load while stopped; recording adds two counter reads and
+  // a ring append (both are empty without RECREATIONS_TRACE)
+  constexpr uint64 ZONES = 1024;
+  run(options, "trace::Zone(stopped)", ZONES, ZONES, 0, [&] {
+    for (uint64 i = 0; i < ZONES; i++) {
+      trace::Zone zone("bench");
+      clobber();
+    }
+  });
+  trace::start();
+  run(options, "trace::Zone(recording)", ZONES, ZONES, 0, [&] {
+    for (uint64 i = 0; i < ZONES; i++) {
+      trace::Zone zone("bench");
+      clobber();
+    }
+  });
+  trace::stop();
+  trace::clear();
+}
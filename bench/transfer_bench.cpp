@@ -0,0 +1,58 @@
+// @file transfer_bench.cpp
+
+#include <unistd.h>  // unlink
+
+#include "../src/os/file.hpp"
+#include "../src/os/transfer.hpp"
+#include "../src/vector.hpp"
+#include "harness.hpp"
+
+void bench::transfer_suite(const Options& options) {
+  using namespace os::file;
+  constexpr uint64 SIZE = 1 << 20;
+  const char* path = "/tmp/recreations_transfer_bench";
+  Vector<byte> contents(SIZE);
+  contents.resize(SIZE, static_cast<byte>('x'));
+  File source;
+  File sink;
+  if (write_all(path, Span<const byte>(contents)) != FileStatus::OK ||
+      source.open(path, Mode::READ) != FileStatus::OK ||
+      sink.open("/dev/null", Mode::WRITE) != FileStatus::OK) {
+    unlink(path);
+    return;
+  }
+
+  // Serving a cached file: in the kernel, or staged through user space
+  run(options, "send_file(1MiB)", SIZE, 1, SIZE, [&] {
+    uint64 transferred;
+    os::io::send_file(sink.getDescriptor(), source.getDescriptor(), 0, SIZE,
+                      transferred);
+    keep(transferred);
+  });
+  run(options, "copy(1MiB)", SIZE, 1, SIZE, [&] {
+    const uint64 offset = 0;
+    uint64 transferred;
+    os::io::copy(sink.getDescriptor(), source.getDescriptor(), &offset, SIZE,
+                 transferred);
+    keep(transferred);
+  });
+
+  // Sixteen 4 KiB buffers: one writev against one write each
+  constexpr uint64 BUFFERS = 16;
+  constexpr uint64 BUFFER = 4096;
+  Span<const byte> buffers[BUFFERS];
+  for (uint64 i = 0; i < BUFFERS; i++) {
+    buffers[i] = Span<const byte>(contents.getData() + i * BUFFER, BUFFER);
+  }
+  run(options, "write_vector(16x4KiB)", BUFFERS, 1, BUFFERS * BUFFER, [&] {
+    uint64 written;
+    os::io::write_vector(sink.getDescriptor(), buffers, BUFFERS, written);
+    keep(written);
+  });
+  run(options, "File::write(16x4KiB)", BUFFERS, 1, BUFFERS * BUFFER, [&] {
+    for (uint64 i = 0; i < BUFFERS; i++) {
+      keep(sink.write(buffers[i].getData(), BUFFER));
+    }
+  });
+  unlink(path);
+}
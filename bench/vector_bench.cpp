@@ -0,0 +1,100 @@
+// @file vector_bench.cpp
+
+#include "../src/vector.hpp"
+#include "harness.hpp"
+
+// @brief A trivially copyable element of Size bytes.
+// @param Size The size of the element in bytes.
+template <uint64 Size>
+struct Element {
+  byte data[Size];
+};
+
+// @brief Runs the per-operation Vector benchmarks for one element size.
+// @param Size The size of the element in bytes.
+// @param options The run settings.
+template <uint64 Size>
+static void element_benchmarks(const bench::Options& options) {
+  using E = Element<Size>;
+  const E value = {};
+
+  // Appending, with and without the storage reserved up front
+  constexpr uint64 PUSHES = 4096;
+  bench::run(options, "Vector::push", Size, PUSHES, Size, [&] {
+    Vector<E> vector(1);
+    for (uint64 i = 0; i < PUSHES; i++) {
+      vector.push(value);
+    }
+    bench::keep(vector.getSize());
+  });
+  bench::run(options, "Vector::push(reserved)", Size, PUSHES, Size, [&] {
+    Vector<E> vector(PUSHES);
+    for (uint64 i = 0; i < PUSHES; i++) {
+      vector.push(value);
+    }
+    bench::keep(vector.getSize());
+  });
+
+  // Insertions and removals at the front shift every element
+  constexpr uint64 SHIFTS = 1024;
+  bench::run(options, "Vector::insert(front)", Size, SHIFTS, 0, [&] {
+    Vector<E> vector(SHIFTS);
+    for (uint64 i = 0; i < SHIFTS; i++) {
+      vector.insert(0, value);
+    }
+    bench::keep(vector.getSize());
+  });
+
+  Vector<E> full(SHIFTS);
+  bench::run(options, "Vector::remove(front)", Size, SHIFTS, 0, [&] {
+    full.resize(SHIFTS, value);
+    E out;
+    for (uint64 i = 0; i < SHIFTS; i++) {
+      full.remove(0, out);
+    }
+    bench::keep(out);
+  });
+
+  // Checked element access over a warm vector
+  full.resize(PUSHES, value);
+  bench::run(options, "Vector::get", Size, PUSHES, Size, [&] {
+    uint64 sum = 0;
+    for (uint64 i = 0; i < PUSHES; i++) {
+      const E* element = full.get(i);
+      sum += element != nullptr ? element->data[0] : 0;
+    }
+    bench::keep(sum);
+  });
+}
+
+// @brief Pushes count integers into a vector starting at capacity 1.
+// @param options The run settings.
+// @param name The benchmark name.
+// @param count The number of pushes.
+template <GrowthPolicy G>
+static void growth_benchmark(const bench::Options& options, const char* name,
+                             const uint64 count) {
+  bench::run(options, name, count, count, sizeof(uint32), [&] {
+    Vector<uint32, memory::HeapAllocator, G> vector(1);
+    for (uint64 i = 0; i < count; i++) {
+      vector.push(static_cast<uint32>(i));
+    }
+    bench::keep(vector.getCapacity());
+  });
+}
+
+void bench::vector_suite(const Options& options) {
+  element_benchmarks<4>(options);
+  element_benchmarks<16>(options);
+  element_benchmarks<64>(options);
+  element_benchmarks<256>(options);
+
+  // Growth policies, from a few pages to far past the huge-block threshold
+  const uint64 counts[] = {1024, 65536, 1048576};
+  for (const uint64 count : counts) {
+    growth_benchmark<growth::Double>(options, "growth::Double", count);
+    growth_benchmark<growth::OneAndHalf>(options, "growth::OneAndHalf", count);
+    growth_benchmark<growth::PageGranular<>>(options, "growth::PageGranular",
+                                             count);
+  }
+}
@@ -1,13 +1,15 @@
-#include <cstdio>
-
 #include "Recreation.h"
 
 int64 test2() { return INT64_MAX; }
 
-int32 test() { return INT32_MAX + test2(); }
+int32 test() {
+  return numbers::saturating_cast<int32>(
+      numbers::saturating_add<int64>(INT32_MAX, test2()));
+}
 
 int32 main(void) {
-  int8 x = INT8_MAX + test();
-  printf("%d", x);
+  int8 x = numbers::saturating_cast<int8>(
+      numbers::saturating_add<int32>(INT8_MAX, test()));
+  os::io::output().write(x);
   return 0;
 }
@@ -0,0 +1,792 @@
+// @file algorithms.hpp
+
+#pragma once
+
+#include "memory.hpp"
+#include "numbers.hpp"
+#include "os/thread.hpp"
+#include "utilities/types.h"
+#include "vector.hpp"
+
+// @brief Data-parallel algorithms over contiguous ranges, with overloads for
+// Vector. Large ranges are cut into blocks that run on os::thread::pool();
+// short ranges run on the calling thread. Inner loops are plain indexed loops
+// over raw pointers so the compiler can vectorize them. Callables passed in
+// must be safe to invoke concurrently, and combining operations must be
+// associative.
+namespace algorithms {
+
+// @brief Ranges shorter than this many elements run sequentially.
+inline constexpr uint64 PARALLEL_THRESHOLD = 1 << 15;
+
+// @brief The smallest block handed to a worker.
+inline constexpr uint64 MIN_BLOCK = 4096;
+
+// === Range algorithms (Declaration) ===
+
+// @brief Calls function(item) on every element.
+// @param items The first element.
+// @param count The number of elements.
+// @param function Callable taking T&.
+template <typename T, typename F>
+void for_each(T* items, const uint64 count, const F& function);
+
+// @brief Stores function(input[i]) into output[i] for every element. input
+// and output may be the same range.
+// @param input The source elements.
+// @param output The destination (at least count constructed elements).
+// @param count The number of elements.
+// @param function Callable taking const T& and returning something
+// assignable to U.
+template <typename T, typename U, typename F>
+void transform(const T* input, U* output, const uint64 count,
+               const F& function);
+
+// @brief Folds every element with an associative operation.
+// @param items The first element.
+// @param count The number of elements.
+// @param identity The neutral element of combine (returned for empty ranges).
+// @param combine Callable taking (const T&, const T&) and returning T.
+// @return The combined value.
+template <typename T, typename Op>
+T reduce(const T* items, const uint64 count, const T& identity,
+         const Op& combine);
+
+// @brief Stores the running fold of input[0..i] into output[i]. input and
+// output may be the same range.
+// @param input The source elements.
+// @param output The destination (at least count constructed elements).
+// @param count The number of elements.
+// @param combine Associative callable taking (const T&, const T&).
+template <typename T, typename Op>
+void inclusive_scan(const T* input, T* output, const uint64 count,
+                    const Op& combine);
+
+// @brief Stores initial combined with input[0..i-1] into output[i]. input and
+// output may be the same range.
+// @param input The source elements.
+// @param output The destination (at least count constructed elements).
+// @param count The number of elements.
+// @param initial The value stored in output[0].
+// @param combine Associative callable taking (const T&, const T&).
+template <typename T, typename Op>
+void exclusive_scan(const T* input, T* output, const uint64 count,
+                    const T& initial, const Op& combine);
+
+// @brief Finds the first element satisfying a predicate.
+// @param items The first element.
+// @param count The number of elements.
+// @param predicate Callable taking const T& and returning bool.
+// @return The index of the first match, or count if there is none.
+template <typename T, typename P>
+uint64 find_if(const T* items, const uint64 count, const P& predicate);
+
+// @brief Finds the first element equal to value.
+// @param items The first element.
+// @param count The number of elements.
+// @param value The value to look for (compared with ==).
+// @return The index of the first match, or count if there is none.
+template <typename T>
+uint64 find(const T* items, const uint64 count, const T& value);
+
+// @brief Sorts numbers in ascending order with a stable LSD radix sort
+// (8-bit digits; passes where every key shares the digit are skipped).
+// Negative zero sorts before zero and NaNs sort to the ends by sign. Falls
+// back to an in-place sort if the scratch buffer cannot be allocated.
+// @param items The first element.
+// @param count The number of elements.
+template <typename T>
+  requires Integer<T> || FloatingPoint<T>
+void sort(T* items, const uint64 count);
+
+// @brief Sorts elements so that less(b, a) is false for every a before b.
+// Trivially relocatable types are sorted in parallel (blocks sorted
+// independently, then merged pairwise); other types, or when the merge buffer
+// cannot be allocated, are sorted in place on the calling thread. Not stable.
+// @param items The first element.
+// @param count The number of elements.
+// @param less Strict weak ordering taking (const T&, const T&).
+template <typename T, typename Less>
+void sort(T* items, const uint64 count, const Less& less);
+
+// === Vector overloads (Declaration) ===
+
+// @brief for_each over every element of a vector.
+template <typename T, memory::Allocator A, GrowthPolicy G, typename F>
+void for_each(Vector<T, A, G>& vector, const F& function);
+
+// @brief transform from one vector into another, resized to match.
+// @return VectorStatus::OK, or the error returned by resizing output.
+template <typename T, typename U, memory::Allocator A, memory::Allocator B,
+          GrowthPolicy G, GrowthPolicy H, typename F>
+VectorStatus transform(const Vector<T, A, G>& input, Vector<U, B, H>& output,
+                       const F& function);
+
+// @brief reduce over every element of a vector.
+template <typename T, memory::Allocator A, GrowthPolicy G, typename Op>
+T reduce(const Vector<T, A, G>& vector, const T& identity, const Op& combine);
+
+// @brief inclusive_scan of a vector, in place.
+template <typename T, memory::Allocator A, GrowthPolicy G, typename Op>
+void inclusive_scan(Vector<T, A, G>& vector, const Op& combine);
+
+// @brief exclusive_scan of a vector, in place.
+template <typename T, memory::Allocator A, GrowthPolicy G, typename Op>
+void exclusive_scan(Vector<T, A, G>& vector, const T& initial,
+                    const Op& combine);
+
+// @brief find in a vector.
+// @return The index of the first match, or getSize() if there is none.
+template <typename T, memory::Allocator A, GrowthPolicy G>
+uint64 find(const Vector<T, A, G>& vector, const T& value);
+
+// @brief Radix sort of a vector of numbers.
+template <typename T, memory::Allocator A, GrowthPolicy G>
+  requires Integer<T> || FloatingPoint<T>
+void sort(Vector<T, A, G>& vector);
+
+// @brief Comparison sort of a vector.
+template <typename T, memory::Allocator A, GrowthPolicy G, typename Less>
+void sort(Vector<T, A, G>& vector, const Less& less);
+
+// === Building blocks (Declaration) ===
+
+// @brief Returns how many blocks a parallel pass over count elements uses:
+// about four per thread, none smaller than MIN_BLOCK, or 1 below
+// PARALLEL_THRESHOLD.
+// @param count The number of elements.
+// @return The block count (at least 1).
+uint64 block_count(const uint64 count);
+
+// @brief Calls body(block, first, last) for blocks equal partitions of
+// [0, count), in parallel when there is more than one block.
+// @param count The number of elements.
+// @param blocks The number of blocks.
+// @param body Callable taking (uint64 block, uint64 first, uint64 last).
+template <typename F>
+void for_blocks(const uint64 count, const uint64 blocks, const F& body);
+
+// @brief Swaps two elements through moves.
+template <typename T>
+void swap(T& a, T& b);
+
+// @brief In-place insertion sort; fastest for a few dozen elements.
+template <typename T, typename Less>
+void insertion_sort(T* items, const uint64 count, const Less& less);
+
+// @brief In-place heap sort; the introsort fallback on adversarial input.
+template <typename T, typename Less>
+void heap_sort(T* items, const uint64 count, const Less& less);
+
+// @brief In-place introsort: median-of-three quicksort that switches to heap
+// sort past the depth limit and to insertion sort on short ranges.
+template <typename T, typename Less>
+void introsort(T* items, uint64 count, const Less& less, uint32 depth);
+
+// @brief Unsigned integer of a given width, used as radix sort key.
+template <uint64 Size>
+struct UnsignedOf;
+
+template <>
+struct UnsignedOf<1> {
+  using Type = uint8;
+};
+
+template <>
+struct UnsignedOf<2> {
+  using Type = uint16;
+};
+
+template <>
+struct UnsignedOf<4> {
+  using Type = uint32;
+};
+
+template <>
+struct UnsignedOf<8> {
+  using Type = uint64;
+};
+
+// @brief Maps a number to an unsigned key with the same ordering.
+// @param value The number.
+// @return The key.
+template <typename T>
+typename UnsignedOf<sizeof(T)>::Type radix_key(const T value);
+
+}  // namespace algorithms
+
+// === Implementation of algorithms building blocks ===
+
+inline uint64 algorithms::block_count(const uint64 count) {
+  if (count < PARALLEL_THRESHOLD) {
+    return 1;
+  }
+  const uint64 threads = os::thread::pool().getWorkerCount() + 1;
+  if (threads == 1) {
+    return 1;
+  }
+  const uint64 by_size = count / MIN_BLOCK;
+  const uint64 by_threads = threads * 4;
+  return by_size < by_threads ? (by_size > 0 ? by_size : 1) : by_threads;
+}
+
+template <typename F>
+inline void algorithms::for_blocks(const uint64 count, const uint64 blocks,
+                                   const F& body) {
+  // Equal partitions, so every pass over the same count sees the same blocks
+  auto run = [&](const uint64 first_block, const uint64 last_block) {
+    for (uint64 block = first_block; block < last_block; block++) {
+      body(block, count * block / blocks, count * (block + 1) / blocks);
+    }
+  };
+  if (blocks <= 1) {
+    run(0, 1);
+    return;
+  }
+  os::thread::parallel_for(0, blocks, 1, run);
+}
+
+template <typename T>
+inline void algorithms::swap(T& a, T& b) {
+  T temporary = memory::pass_ownership(a);
+  a = memory::pass_ownership(b);
+  b = memory::pass_ownership(temporary);
+}
+
+template <typename T, typename Less>
+inline void algorithms::insertion_sort(T* items, const uint64 count,
+                                       const Less& less) {
+  for (uint64 i = 1; i < count; i++) {
+    // Shift larger elements right until the hole reaches the insertion point
+    T value = memory::pass_ownership(items[i]);
+    uint64 j = i;
+    while (j > 0 && less(value, items[j - 1])) {
+      items[j] = memory::pass_ownership(items[j - 1]);
+      j--;
+    }
+    items[j] = memory::pass_ownership(value);
+  }
+}
+
+template <typename T, typename Less>
+inline void algorithms::heap_sort(T* items, const uint64 count,
+                                  const Less& less) {
+  // Restores the max-heap property below root within the first size elements
+  auto sift_down = [&](uint64 root, const uint64 size) {
+    while (2 * root + 1 < size) {
+      uint64 child = 2 * root + 1;
+      if (child + 1 < size && less(items[child], items[child + 1])) {
+        child++;
+      }
+      if (!less(items[root], items[child])) {
+        return;
+      }
+      swap(items[root], items[child]);
+      root = child;
+    }
+  };
+
+  // Build the heap, then repeatedly move the maximum to the end
+  for (uint64 i = count / 2; i > 0; i--) {
+    sift_down(i - 1, count);
+  }
+  for (uint64 end = count; end > 1; end--) {
+    swap(items[0], items[end - 1]);
+    sift_down(0, end - 1);
+  }
+}
+
+template <typename T, typename Less>
+inline void algorithms::introsort(T* items, uint64 count, const Less& less,
+                                  uint32 depth) {
+  while (count > 16) {
+    // Degenerate partitions: guarantee O(n log n)
+    if (depth == 0) {
+      heap_sort(items, count, less);
+      return;
+    }
+    depth--;
+
+    // Median of three; the outer two then act as sentinels for the scans
+    const uint64 middle = count / 2;
+    if (less(items[middle], items[0])) {
+      swap(items[middle], items[0]);
+    }
+    if (less(items[count - 1], items[middle])) {
+      swap(items[count - 1], items[middle]);
+      if (less(items[middle], items[0])) {
+        swap(items[middle], items[0]);
+      }
+    }
+    swap(items[middle], items[count - 2]);
+
+    // Hoare-style partition around the pivot parked at count - 2
+    const T& pivot = items[count - 2];
+    uint64 i = 0;
+    uint64 j = count - 2;
+    while (true) {
+      while (less(items[++i], pivot)) {
+      }
+      while (less(pivot, items[--j])) {
+      }
+      if (i >= j) {
+        break;
+      }
+      swap(items[i], items[j]);
+    }
+    swap(items[i], items[count - 2]);
+
+    // Recurse into the smaller side, loop on the larger one
+    if (i < count - i - 1) {
+      introsort(items, i, less, depth);
+      items += i + 1;
+      count -= i + 1;
+    } else {
+      introsort(items + i + 1, count - i - 1, less, depth);
+      count = i;
+    }
+  }
+  insertion_sort(items, count, less);
+}
+
+template <typename T>
+inline typename algorithms::UnsignedOf<sizeof(T)>::Type algorithms::radix_key(
+    const T value) {
+  using K = typename UnsignedOf<sizeof(T)>::Type;
+  constexpr K SIGN = static_cast<K>(K(1) << (sizeof(T) * 8 - 1));
+  const K bits = __builtin_bit_cast(K, value);
+  if constexpr (FloatingPoint<T>) {
+    // Negative floats: flip everything (larger magnitude sorts first);
+    // positive floats: flip the sign so they sort after the negatives
+    return static_cast<K>(bits ^ ((bits & SIGN) != 0 ? static_cast<K>(~K(0))
+                                                      : SIGN));
+  } else if constexpr (isSigned<T>::value) {
+    return static_cast<K>(bits ^ SIGN);
+  } else {
+    return bits;
+  }
+}
+
+// === Implementation of algorithms range algorithms ===
+
+template <typename T, typename F>
+inline void algorithms::for_each(T* items, const uint64 count,
+                                 const F& function) {
+  for_blocks(count, block_count(count),
+             [&](uint64, const uint64 first, const uint64 last) {
+               for (uint64 i = first; i < last; i++) {
+                 function(items[i]);
+               }
+             });
+}
+
+template <typename T, typename U, typename F>
+inline void algorithms::transform(const T* input, U* output,
+                                  const uint64 count, const F& function) {
+  for_blocks(count, block_count(count),
+             [&](uint64, const uint64 first, const uint64 last) {
+               for (uint64 i = first; i < last; i++) {
+                 output[i] = function(input[i]);
+               }
+             });
+}
+
+template <typename T, typename Op>
+inline T algorithms::reduce(const T* items, const uint64 count,
+                            const T& identity, const Op& combine) {
+  // Folds one block on the calling thread
+  auto fold = [&](const uint64 first, const uint64 last) {
+    T result = identity;
+    for (uint64 i = first; i < last; i++) {
+      result = combine(result, items[i]);
+    }
+    return result;
+  };
+
+  // One partial result per block, combined in block order at the end
+  const uint64 blocks = block_count(count);
+  T* partials =
+      blocks > 1 ? static_cast<T*>(memory::allocate(blocks * sizeof(T)))
+                 : nullptr;
+  if (partials == nullptr) {
+    return fold(0, count);
+  }
+  for_blocks(count, blocks,
+             [&](const uint64 block, const uint64 first, const uint64 last) {
+               memory::construct(&partials[block], fold(first, last));
+             });
+
+  T result = identity;
+  for (uint64 block = 0; block < blocks; block++) {
+    result = combine(result, partials[block]);
+    memory::destroy(&partials[block]);
+  }
+  memory::deallocate(partials);
+  return result;
+}
+
+template <typename T, typename Op>
+inline void algorithms::inclusive_scan(const T* input, T* output,
+                                       const uint64 count, const Op& combine) {
+  if (count == 0) {
+    return;
+  }
+
+  // Scans [first, last) with an optional carried-in prefix
+  auto scan = [&](const uint64 first, const uint64 last, const T* prefix) {
+    T running = prefix != nullptr ? combine(*prefix, input[first])
+                                  : input[first];
+    output[first] = running;
+    for (uint64 i = first + 1; i < last; i++) {
+      running = combine(running, input[i]);
+      output[i] = running;
+    }
+  };
+
+  // Pass 1: total of every block but the last
+  const uint64 blocks = block_count(count);
+  T* totals = blocks > 1
+                  ? static_cast<T*>(memory::allocate(blocks * sizeof(T)))
+                  : nullptr;
+  if (totals == nullptr) {
+    scan(0, count, nullptr);
+    return;
+  }
+  for_blocks(count, blocks,
+             [&](const uint64 block, const uint64 first, const uint64 last) {
+               if (block + 1 == blocks) {
+                 return;
+               }
+               T total = input[first];
+               for (uint64 i = first + 1; i < last; i++) {
+                 total = combine(total, input[i]);
+               }
+               memory::construct(&totals[block], memory::pass_ownership(total));
+             });
+
+  // Turn the totals into the prefix carried into each following block
+  for (uint64 block = 1; block + 1 < blocks; block++) {
+    totals[block] = combine(totals[block - 1], totals[block]);
+  }
+
+  // Pass 2: scan every block from its prefix
+  for_blocks(count, blocks,
+             [&](const uint64 block, const uint64 first, const uint64 last) {
+               scan(first, last, block > 0 ? &totals[block - 1] : nullptr);
+             });
+
+  for (uint64 block = 0; block + 1 < blocks; block++) {
+    memory::destroy(&totals[block]);
+  }
+  memory::deallocate(totals);
+}
+
+template <typename T, typename Op>
+inline void algorithms::exclusive_scan(const T* input, T* output,
+                                       const uint64 count, const T& initial,
+                                       const Op& combine) {
+  // Scans [first, last) starting from prefix; reads before writing so input
+  // and output may alias
+  auto scan = [&](const uint64 first, const uint64 last, const T& prefix) {
+    T running = prefix;
+    for (uint64 i = first; i < last; i++) {
+      T value = input[i];
+      output[i] = running;
+      running = combine(running, value);
+    }
+  };
+
+  // Pass 1: total of every block but the last
+  const uint64 blocks = block_count(count);
+  T* prefixes = blocks > 1
+                    ? static_cast<T*>(memory::allocate(blocks * sizeof(T)))
+                    : nullptr;
+  if (prefixes == nullptr) {
+    scan(0, count, initial);
+    return;
+  }
+  memory::construct(&prefixes[0], initial);
+  for_blocks(count, blocks,
+             [&](const uint64 block, const uint64 first, const uint64 last) {
+               if (block + 1 == blocks) {
+                 return;
+               }
+               T total = input[first];
+               for (uint64 i = first + 1; i < last; i++) {
+                 total = combine(total, input[i]);
+               }
+               memory::construct(&prefixes[block + 1],
+                                 memory::pass_ownership(total));
+             });
+
+  // Turn the totals into the prefix carried into each block
+  for (uint64 block = 1; block < blocks; block++) {
+    prefixes[block] = combine(prefixes[block - 1], prefixes[block]);
+  }
+
+  // Pass 2: scan every block from its prefix
+  for_blocks(count, blocks,
+             [&](const uint64 block, const uint64 first, const uint64 last) {
+               scan(first, last, prefixes[block]);
+             });
+
+  for (uint64 block = 0; block < blocks; block++) {
+    memory::destroy(&prefixes[block]);
+  }
+  memory::deallocate(prefixes);
+}
+
+template <typename T, typename P>
+inline uint64 algorithms::find_if(const T* items, const uint64 count,
+                                  const P& predicate) {
+  // Blocks scan in strides and give up once an earlier block has a match
+  constexpr uint64 STRIDE = 1024;
+  uint64 found = count;
+  for_blocks(
+      count, block_count(count),
+      [&](const uint64, const uint64 first, const uint64 last) {
+        for (uint64 stride = first; stride < last; stride += STRIDE) {
+          if (__atomic_load_n(&found, __ATOMIC_RELAXED) < stride) {
+            return;
+          }
+          const uint64 end = stride + STRIDE < last ? stride + STRIDE : last;
+          for (uint64 i = stride; i < end; i++) {
+            if (!predicate(items[i])) {
+              continue;
+            }
+
+            // Keep the smallest index
+            uint64 current = __atomic_load_n(&found, __ATOMIC_RELAXED);
+            while (i < current &&
+                   !__atomic_compare_exchange_n(&found, &current, i, true,
+                                                __ATOMIC_RELAXED,
+                                                __ATOMIC_RELAXED)) {
+            }
+            return;
+          }
+        }
+      });
+  return found;
+}
+
+template <typename T>
+inline uint64 algorithms::find(const T* items, const uint64 count,
+                               const T& value) {
+  return find_if(items, count,
+                 [&value](const T& item) { return item == value; });
+}
+
+template <typename T>
+  requires Integer<T> || FloatingPoint<T>
+inline void algorithms::sort(T* items, const uint64 count) {
+  using K = typename UnsignedOf<sizeof(T)>::Type;
+  auto less = [](const T& a, const T& b) {
+    return radix_key(a) < radix_key(b);
+  };
+
+  // Short ranges: radix passes cost more than they save
+  if (count <= 64) {
+    insertion_sort(items, count, less);
+    return;
+  }
+
+  // Scratch space: the ping-pong buffer and one histogram per block
+  const uint64 blocks = block_count(count);
+  T* buffer = static_cast<T*>(memory::allocate(count * sizeof(T)));
+  uint64* histograms =
+      static_cast<uint64*>(memory::allocate(blocks * 256 * sizeof(uint64)));
+  if (buffer == nullptr || histograms == nullptr) {
+    memory::deallocate(buffer);
+    memory::deallocate(histograms);
+    introsort(items, count, less, 128);
+    return;
+  }
+
+  T* source = items;
+  T* target = buffer;
+  for (uint32 shift = 0; shift < sizeof(T) * 8; shift += 8) {
+    auto digit = [shift](const T value) {
+      return static_cast<uint32>((radix_key(value) >> shift) & K(0xFF));
+    };
+
+    // Count the digits of every block
+    for_blocks(count, blocks,
+               [&](const uint64 block, const uint64 first, const uint64 last) {
+                 uint64* histogram = histograms + block * 256;
+                 for (uint32 d = 0; d < 256; d++) {
+                   histogram[d] = 0;
+                 }
+                 for (uint64 i = first; i < last; i++) {
+                   histogram[digit(source[i])]++;
+                 }
+               });
+
+    // Skip the pass when every key has the same digit; otherwise turn the
+    // counts into write offsets (digit-major, then block order: stable)
+    uint64 offset = 0;
+    bool trivial = false;
+    for (uint32 d = 0; d < 256 && !trivial; d++) {
+      const uint64 start = offset;
+      for (uint64 block = 0; block < blocks; block++) {
+        uint64& slot = histograms[block * 256 + d];
+        const uint64 amount = slot;
+        slot = offset;
+        offset += amount;
+      }
+      trivial = offset - start == count;
+    }
+    if (trivial) {
+      continue;
+    }
+
+    // Scatter every block to its offsets
+    for_blocks(count, blocks,
+               [&](const uint64 block, const uint64 first, const uint64 last) {
+                 uint64* histogram = histograms + block * 256;
+                 for (uint64 i = first; i < last; i++) {
+                   target[histogram[digit(source[i])]++] = source[i];
+                 }
+               });
+    T* swapped = source;
+    source = target;
+    target = swapped;
+  }
+
+  // An odd number of passes leaves the result in the buffer
+  if (source != items) {
+    for_blocks(count, blocks,
+               [&](const uint64, const uint64 first, const uint64 last) {
+                 memory::copy(items + first, source + first,
+                              (last - first) * sizeof(T));
+               });
+  }
+  memory::deallocate(histograms);
+  memory::deallocate(buffer);
+}
+
+template <typename T, typename Less>
+inline void algorithms::sort(T* items, const uint64 count, const Less& less) {
+  // Depth limit of introsort: twice the binary logarithm
+  uint32 depth = 0;
+  for (uint64 n = count; n > 1; n >>= 1) {
+    depth += 2;
+  }
+
+  // The parallel merge relocates elements bitwise through a raw buffer
+  const uint64 blocks = block_count(count);
+  T* buffer = nullptr;
+  if constexpr (isTriviallyRelocatable<T>::value) {
+    if (blocks > 1) {
+      buffer = static_cast<T*>(memory::allocate(count * sizeof(T)));
+    }
+  }
+  if (buffer == nullptr) {
+    introsort(items, count, less, depth);
+    return;
+  }
+
+  // Sort every block independently
+  for_blocks(count, blocks,
+             [&](uint64, const uint64 first, const uint64 last) {
+               introsort(items + first, last - first, less, depth);
+             });
+
+  // Merge runs pairwise, doubling their width every round
+  auto bound = [&](const uint64 run) {
+    return run >= blocks ? count : count * run / blocks;
+  };
+  T* source = items;
+  T* target = buffer;
+  for (uint64 width = 1; width < blocks; width *= 2) {
+    const uint64 pairs = (blocks + 2 * width - 1) / (2 * width);
+    os::thread::parallel_for(
+        0, pairs, 1, [&](const uint64 first_pair, const uint64 last_pair) {
+          for (uint64 pair = first_pair; pair < last_pair; pair++) {
+            const uint64 left = bound(pair * 2 * width);
+            const uint64 middle = bound(pair * 2 * width + width);
+            const uint64 right = bound(pair * 2 * width + 2 * width);
+            uint64 i = left;
+            uint64 j = middle;
+            uint64 k = left;
+            while (i < middle && j < right) {
+              const uint64 next = less(source[j], source[i]) ? j++ : i++;
+              __builtin_memcpy(static_cast<void*>(&target[k++]),
+                               &source[next], sizeof(T));
+            }
+            memory::copy(&target[k], &source[i], (middle - i) * sizeof(T));
+            k += middle - i;
+            memory::copy(&target[k], &source[j], (right - j) * sizeof(T));
+          }
+        });
+    T* swapped = source;
+    source = target;
+    target = swapped;
+  }
+
+  // An odd number of rounds leaves the result in the buffer
+  if (source != items) {
+    for_blocks(count, blocks,
+               [&](uint64, const uint64 first, const uint64 last) {
+                 memory::copy(items + first, source + first,
+                              (last - first) * sizeof(T));
+               });
+  }
+  memory::deallocate(buffer);
+}
+
+// === Implementation of algorithms Vector overloads ===
+
+template <typename T, memory::Allocator A, GrowthPolicy G, typename F>
+inline void algorithms::for_each(Vector<T, A, G>& vector, const F& function) {
+  for_each(vector.getData(), vector.getSize(), function);
+}
+
+template <typename T, typename U, memory::Allocator A, memory::Allocator B,
+          GrowthPolicy G, GrowthPolicy H, typename F>
+inline VectorStatus algorithms::transform(const Vector<T, A, G>& input,
+                                          Vector<U, B, H>& output,
+                                          const F& function) {
+  // Size the output first; a failed resize leaves it untouched
+  const VectorStatus status = output.resize(input.getSize());
+  if (status != VectorStatus::OK) {
+    return status;
+  }
+  transform(input.getData(), output.getData(), input.getSize(), function);
+  return VectorStatus::OK;
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G, typename Op>
+inline T algorithms::reduce(const Vector<T, A, G>& vector, const T& identity,
+                            const Op& combine) {
+  return reduce(vector.getData(), vector.getSize(), identity, combine);
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G, typename Op>
+inline void algorithms::inclusive_scan(Vector<T, A, G>& vector,
+                                       const Op& combine) {
+  inclusive_scan(vector.getData(), vector.getData(), vector.getSize(),
+                 combine);
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G, typename Op>
+inline void algorithms::exclusive_scan(Vector<T, A, G>& vector,
+                                       const T& initial, const Op& combine) {
+  exclusive_scan(vector.getData(), vector.getData(), vector.getSize(),
+                 initial, combine);
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+inline uint64 algorithms::find(const Vector<T, A, G>& vector, const T& value) {
+  return find(vector.getData(), vector.getSize(), value);
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+  requires Integer<T> || FloatingPoint<T>
+inline void algorithms::sort(Vector<T, A, G>& vector) {
+  sort(vector.getData(), vector.getSize());
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G, typename Less>
+inline void algorithms::sort(Vector<T, A, G>& vector, const Less& less) {
+  sort(vector.getData(), vector.getSize(), less);
+}
@@ -0,0 +1,680 @@
+// @file hash.hpp
+
+#pragma once
+
+#include "memory.hpp"
+#include "numbers.hpp"
+#include "utilities/architecture.h"
+#include "utilities/compiler.h"
+#include "utilities/types.h"
+#include "vector.hpp"
+
+// Inputs longer than a few hundred bytes are folded into eight accumulators,
+// one 64-byte stripe at a time. The stripe kernel has SSE2/AVX2 versions on
+// x86 (AVX2 picked at run time) and a NEON version on ARM64.
+#if defined(ARCHITECTURE_X64) || \
+    (defined(ARCHITECTURE_X86) && defined(__SSE2__))
+#define HASH_SSE2
+#define HASH_AVX2
+#elif defined(ARCHITECTURE_ARM64)
+#define HASH_NEON
+#endif
+
+// 64-bit targets multiply into 128 bits in one or two instructions; 32-bit
+// ones would need four multiplies, so they mix with 64-bit products only.
+#if defined(ARCHITECTURE_X64) || defined(ARCHITECTURE_ARM64)
+#define HASH_WIDE_MULTIPLY
+#endif
+
+// @brief Fast non-cryptographic hashing for containers, deduplication and
+// partitioning. Results are 64 bits with every bit depending on every input
+// bit, so callers may slice them freely. They are stable within a build but
+// are not meant to be stored or sent over the network.
+namespace hash {
+
+// === Hash functions (Declaration) ===
+
+// @brief Scrambles a 64-bit value: two folded 64x64->128 multiplies
+// (wyhash64), or the murmur3 finalizer without a wide multiply.
+// @param value The value.
+// @return The hash.
+uint64 mix(const uint64 value);
+
+// @brief Hashes an integer. Types of up to 32 bits take two 64-bit
+// multiplies, wider ones the full mix.
+// @param value The integer.
+// @param seed Varies the result.
+// @return The hash.
+template <Integer T>
+uint64 integer(const T value, const uint64 seed = 0);
+
+// @brief Hashes bytes. Up to SHORT_MAX bytes go through wyhash; longer
+// inputs through the striped xxh3-style loop, which runs at memory speed.
+// @param data The bytes.
+// @param size The number of bytes.
+// @param seed Varies the result.
+// @return The hash.
+uint64 bytes(const void* data, const uint64 size, const uint64 seed = 0);
+
+// @brief Hashes count integer keys; independent multiplies overlap, so
+// this is faster than calling integer() key by key through a function
+// pointer or across a loop-carried dependency.
+// @param keys The keys.
+// @param hashes Receives the hash of each key.
+// @param count The number of keys.
+// @param seed Varies the results.
+template <Integer T>
+void batch(const T* keys, uint64* hashes, const uint64 count,
+           const uint64 seed = 0);
+
+// @brief Hashes every key of a vector.
+// @param keys The keys.
+// @param hashes Resized to hold the hash of each key.
+// @param seed Varies the results.
+// @return OK, or ALLOCATION_ERROR if hashes could not be resized.
+template <Integer T, memory::Allocator A, GrowthPolicy G, memory::Allocator B,
+          GrowthPolicy H>
+VectorStatus batch(const Vector<T, A, G>& keys, Vector<uint64, B, H>& hashes,
+                   const uint64 seed = 0);
+
+// === Streaming (Declaration) ===
+
+// @brief The largest input hashed by the short (wyhash) path.
+inline constexpr uint64 SHORT_MAX = 256;
+
+// @brief The bytes consumed by one stripe of the long path.
+inline constexpr uint64 STRIPE = 64;
+
+// @brief The size of the key material the long path mixes in.
+inline constexpr uint64 SECRET_SIZE = 192;
+
+// @brief The bytes between two scrambles of the accumulators.
+inline constexpr uint64 BLOCK = (SECRET_SIZE - STRIPE) / 8 * STRIPE;
+
+// @brief Hashes data that arrives in chunks. The result equals
+// hash::bytes over the concatenated chunks, whatever their sizes.
+class Stream {
+ public:
+  // @brief Creates an empty stream.
+  // @param stream_seed Varies the result, like the seed of hash::bytes.
+  Stream(const uint64 stream_seed = 0);
+
+  // @brief Appends bytes. Whole blocks are folded in straight from data;
+  // only a partial block is copied.
+  // @param data The bytes.
+  // @param size The number of bytes.
+  void update(const void* data, uint64 size);
+
+  // @brief Returns the hash of everything appended so far. The stream can
+  // keep going afterwards.
+  // @return The hash.
+  uint64 finish() const;
+
+  // @brief Forgets everything appended, keeping the seed.
+  void reset();
+
+  // @brief Returns the number of bytes appended.
+  // @return The total size.
+  uint64 getSize() const;
+
+ private:
+  // @brief The accumulators of the long path.
+  alignas(32) uint64 accumulators[8];
+
+  // @brief The last, possibly partial, block.
+  byte buffer[BLOCK];
+  uint64 buffered = 0;
+
+  // @brief The last stripe of the previous block, needed when the final
+  // block is shorter than a stripe.
+  byte tail[STRIPE];
+
+  // @brief The number of bytes appended.
+  uint64 total = 0;
+
+  uint64 seed;
+};
+
+// === Building blocks (Declaration) ===
+
+// @brief Key material of the long path, generated at compile time.
+struct Secret {
+  byte data[SECRET_SIZE];
+};
+
+// @brief Builds the key material with splitmix64.
+// @return The secret.
+constexpr Secret make_secret();
+
+// @brief Reads 4 bytes in native order.
+// @param source The bytes.
+// @return The value.
+uint64 read32(const byte* source);
+
+// @brief Multiplies two values into 128 bits and folds the halves.
+// @param a The first factor.
+// @param b The second factor.
+// @return The low half xor the high half.
+uint64 fold(const uint64 a, const uint64 b);
+
+// @brief wyhash (final version 4.2) over at most SHORT_MAX bytes.
+// @param data The bytes.
+// @param size The number of bytes.
+// @param seed Varies the result.
+// @return The hash.
+uint64 short_hash(const byte* data, const uint64 size, const uint64 seed);
+
+// @brief Sets the accumulators of the long path to their starting values.
+// @param accumulators The accumulators.
+void initialize(uint64* accumulators);
+
+// @brief Scrambles the accumulators between blocks.
+// @param accumulators The accumulators.
+// @param seed The seed of the hash.
+void scramble(uint64* accumulators, const uint64 seed);
+
+// @brief Folds the last block into the accumulators and finishes the hash.
+// @param accumulators The accumulators (changed).
+// @param last The last block.
+// @param last_size Its size (1 to BLOCK bytes).
+// @param last_stripe The last STRIPE bytes of the input.
+// @param size The size of the whole input.
+// @param seed The seed of the hash.
+// @return The hash.
+uint64 finish_long(uint64* accumulators, const byte* last,
+                   const uint64 last_size, const byte* last_stripe,
+                   const uint64 size, const uint64 seed);
+
+// @brief Folds stripes into the accumulators. Stripe n of the call uses the
+// secret from secret + 8 * n.
+// @param accumulators The eight accumulators.
+// @param input The first stripe.
+// @param secret The key material for the first stripe.
+// @param stripes The number of stripes.
+// @param seed The seed of the hash, mixed into the key material.
+using Accumulate = void (*)(uint64* accumulators, const byte* input,
+                            const byte* secret, const uint64 stripes,
+                            const uint64 seed);
+
+namespace simd {
+
+namespace scalar {
+void accumulate(uint64* accumulators, const byte* input, const byte* secret,
+                const uint64 stripes, const uint64 seed);
+}  // namespace scalar
+
+#if defined(HASH_SSE2)
+namespace sse2 {
+void accumulate(uint64* accumulators, const byte* input, const byte* secret,
+                const uint64 stripes, const uint64 seed);
+}  // namespace sse2
+
+namespace avx2 {
+void accumulate(uint64* accumulators, const byte* input, const byte* secret,
+                const uint64 stripes, const uint64 seed);
+}  // namespace avx2
+#elif defined(HASH_NEON)
+namespace neon {
+void accumulate(uint64* accumulators, const byte* input, const byte* secret,
+                const uint64 stripes, const uint64 seed);
+}  // namespace neon
+#endif
+
+// @brief Picks the widest stripe kernel supported by the running CPU.
+// @return The kernel.
+Accumulate resolve();
+
+// @brief Returns the stripe kernel for the running CPU, resolved on first
+// use.
+// @return The kernel.
+Accumulate active();
+
+}  // namespace simd
+
+}  // namespace hash
+
+// === Hash trait ===
+
+// @brief The default hasher of a key type, used by HashMap. Specialize it
+// for custom keys; operator() may be overloaded for other types that compare
+// equal to the key (heterogeneous lookup), as long as equal values hash the
+// same.
+template <typename T>
+struct Hash;
+
+template <Integer T>
+struct Hash<T> {
+  uint64 operator()(const T key) const;
+};
+
+template <typename T>
+struct Hash<T*> {
+  uint64 operator()(const T* key) const;
+};
+
+// === Implementation of hash::SECRET ===
+
+constexpr hash::Secret hash::make_secret() {
+  Secret secret{};
+  uint64 state = 0x243F6A8885A308D3;
+  for (uint64 i = 0; i < SECRET_SIZE; i += 8) {
+    state += 0x9E3779B97F4A7C15;
+    uint64 word = state;
+    word = (word ^ (word >> 30)) * 0xBF58476D1CE4E5B9;
+    word = (word ^ (word >> 27)) * 0x94D049BB133111EB;
+    word ^= word >> 31;
+    for (uint64 j = 0; j < 8; j++) {
+      secret.data[i + j] = static_cast<byte>(word >> (j * 8));
+    }
+  }
+  return secret;
+}
+
+namespace hash {
+
+// @brief The key material of the long path.
+inline constexpr Secret SECRET = make_secret();
+
+}  // namespace hash
+
+// === Implementation of hash ===
+
+inline uint64 hash::mix(const uint64 value) {
+#ifdef HASH_WIDE_MULTIPLY
+  // wyhash64: the constants are wyhash's first two secrets
+  uint64 high;
+  const uint64 low = numbers::multiply(value ^ 0x2D358DCCAA6C78A5,
+                                       value ^ 0x8BB84B93962EACC9, high);
+  return fold(low ^ 0x2D358DCCAA6C78A5, high ^ 0x8BB84B93962EACC9);
+#else
+  uint64 result = value;
+  result = (result ^ (result >> 33)) * 0xFF51AFD7ED558CCD;
+  result = (result ^ (result >> 33)) * 0xC4CEB9FE1A85EC53;
+  return result ^ (result >> 33);
+#endif
+}
+
+template <Integer T>
+inline uint64 hash::integer(const T value, const uint64 seed) {
+  using U = typename numbers::makeUnsigned<T>::type;
+  if constexpr (sizeof(T) <= sizeof(uint32)) {
+    // Multiply-fold twice: the first round spreads the 32 input bits over
+    // the high half, the second brings them back down to every bit
+    uint64 result =
+        (static_cast<uint64>(static_cast<U>(value)) ^ seed) *
+        0x9E3779B97F4A7C15;
+    result = (result ^ (result >> 32)) * 0xD6E8FEB86659FD93;
+    return result ^ (result >> 32);
+  } else {
+    return mix(static_cast<uint64>(value) ^ seed);
+  }
+}
+
+inline uint64 hash::bytes(const void* data, const uint64 size,
+                          const uint64 seed) {
+  const byte* input = static_cast<const byte*>(data);
+  if (size <= SHORT_MAX) {
+    return short_hash(input, size, seed);
+  }
+
+  // Every block but the last is folded in and scrambled here
+  alignas(32) uint64 accumulators[8];
+  initialize(accumulators);
+  const Accumulate accumulate = simd::active();
+  const uint64 blocks = (size - 1) / BLOCK;
+  for (uint64 i = 0; i < blocks; i++) {
+    accumulate(accumulators, input + i * BLOCK, SECRET.data, BLOCK / STRIPE,
+               seed);
+    scramble(accumulators, seed);
+  }
+  return finish_long(accumulators, input + blocks * BLOCK,
+                     size - blocks * BLOCK, input + size - STRIPE, size, seed);
+}
+
+template <Integer T>
+inline void hash::batch(const T* keys, uint64* hashes, const uint64 count,
+                        const uint64 seed) {
+  for (uint64 i = 0; i < count; i++) {
+    hashes[i] = integer(keys[i], seed);
+  }
+}
+
+template <Integer T, memory::Allocator A, GrowthPolicy G, memory::Allocator B,
+          GrowthPolicy H>
+inline VectorStatus hash::batch(const Vector<T, A, G>& keys,
+                                Vector<uint64, B, H>& hashes,
+                                const uint64 seed) {
+  // Size the output first; a failed resize leaves it untouched
+  const VectorStatus status = hashes.resize(keys.getSize());
+  if (status != VectorStatus::OK) {
+    return status;
+  }
+  batch(keys.getData(), hashes.getData(), keys.getSize(), seed);
+  return VectorStatus::OK;
+}
+
+// === Implementation of hash::Stream ===
+
+inline hash::Stream::Stream(const uint64 stream_seed) : seed(stream_seed) {
+  initialize(this->accumulators);
+}
+
+inline void hash::Stream::update(const void* data, uint64 size) {
+  const byte* input = static_cast<const byte*>(data);
+  this->total += size;
+  const Accumulate accumulate = simd::active();
+  while (size > 0) {
+    // A full buffer followed by more bytes is not the last block
+    if (this->buffered == BLOCK) {
+      accumulate(this->accumulators, this->buffer, SECRET.data,
+                 BLOCK / STRIPE, this->seed);
+      scramble(this->accumulators, this->seed);
+      ::memory::copy(this->tail, this->buffer + BLOCK - STRIPE, STRIPE);
+      this->buffered = 0;
+    }
+
+    // Fold whole blocks in place while at least one more byte follows them
+    if (this->buffered == 0 && size > BLOCK) {
+      while (size > BLOCK) {
+        accumulate(this->accumulators, input, SECRET.data, BLOCK / STRIPE,
+                   this->seed);
+        scramble(this->accumulators, this->seed);
+        input += BLOCK;
+        size -= BLOCK;
+      }
+      ::memory::copy(this->tail, input - STRIPE, STRIPE);
+    }
+
+    const uint64 room = BLOCK - this->buffered;
+    const uint64 taken = size < room ? size : room;
+    ::memory::copy(this->buffer + this->buffered, input, taken);
+    this->buffered += taken;
+    input += taken;
+    size -= taken;
+  }
+}
+
+inline uint64 hash::Stream::finish() const {
+  // Short inputs never left the buffer
+  if (this->total <= SHORT_MAX) {
+    return short_hash(this->buffer, this->total, this->seed);
+  }
+
+  // The last stripe may reach back into the previous block
+  byte last_stripe[STRIPE];
+  if (this->buffered >= STRIPE) {
+    ::memory::copy(last_stripe, this->buffer + this->buffered - STRIPE,
+                   STRIPE);
+  } else {
+    const uint64 reach = STRIPE - this->buffered;
+    ::memory::copy(last_stripe, this->tail + STRIPE - reach, reach);
+    ::memory::copy(last_stripe + reach, this->buffer, this->buffered);
+  }
+  alignas(32) uint64 copy[8];
+  ::memory::copy(copy, this->accumulators, sizeof(copy));
+  return finish_long(copy, this->buffer, this->buffered, last_stripe,
+                     this->total, this->seed);
+}
+
+inline void hash::Stream::reset() {
+  initialize(this->accumulators);
+  this->buffered = 0;
+  this->total = 0;
+}
+
+inline uint64 hash::Stream::getSize() const { return this->total; }
+
+// === Implementation of building blocks ===
+
+inline uint64 hash::read32(const byte* source) {
+  uint32 word;
+  __builtin_memcpy(&word, source, sizeof(word));
+  return word;
+}
+
+inline uint64 hash::fold(const uint64 a, const uint64 b) {
+  uint64 high;
+  const uint64 low = numbers::multiply(a, b, high);
+  return low ^ high;
+}
+
+inline uint64 hash::short_hash(const byte* data, const uint64 size,
+                               uint64 seed) {
+  constexpr uint64 S0 = 0x2D358DCCAA6C78A5;
+  constexpr uint64 S1 = 0x8BB84B93962EACC9;
+  constexpr uint64 S2 = 0x4B33A62ED433D4A3;
+  constexpr uint64 S3 = 0x4D5A2DA51DE1AA47;
+  using memory::simd::load64;
+
+  seed ^= fold(seed ^ S0, S1);
+  uint64 a;
+  uint64 b;
+  if (size <= 16) {
+    // Overlapping reads cover 4 to 16 bytes without a loop
+    if (size >= 4) {
+      const uint64 middle = (size >> 3) << 2;
+      a = (read32(data) << 32) | read32(data + middle);
+      b = (read32(data + size - 4) << 32) | read32(data + size - 4 - middle);
+    } else if (size > 0) {
+      a = (static_cast<uint64>(data[0]) << 16) |
+          (static_cast<uint64>(data[size >> 1]) << 8) | data[size - 1];
+      b = 0;
+    } else {
+      a = 0;
+      b = 0;
+    }
+  } else {
+    // Three independent lanes of 16 bytes, then 16 bytes at a time
+    const byte* p = data;
+    uint64 left = size;
+    if (left > 48) {
+      uint64 lane1 = seed;
+      uint64 lane2 = seed;
+      do {
+        seed = fold(load64(p) ^ S1, load64(p + 8) ^ seed);
+        lane1 = fold(load64(p + 16) ^ S2, load64(p + 24) ^ lane1);
+        lane2 = fold(load64(p + 32) ^ S3, load64(p + 40) ^ lane2);
+        p += 48;
+        left -= 48;
+      } while (left > 48);
+      seed ^= lane1 ^ lane2;
+    }
+    while (left > 16) {
+      seed = fold(load64(p) ^ S1, load64(p + 8) ^ seed);
+      p += 16;
+      left -= 16;
+    }
+    a = load64(p + left - 16);
+    b = load64(p + left - 8);
+  }
+
+  a ^= S1;
+  b ^= seed;
+  uint64 high;
+  a = numbers::multiply(a, b, high);
+  return fold(a ^ S0 ^ size, high ^ S1);
+}
+
+inline void hash::initialize(uint64* accumulators) {
+  // The starting values of xxh3
+  accumulators[0] = 0xC2B2AE3D;
+  accumulators[1] = 0x9E3779B185EBCA87;
+  accumulators[2] = 0xC2B2AE3D27D4EB4F;
+  accumulators[3] = 0x165667B19E3779F9;
+  accumulators[4] = 0x85EBCA77C2B2AE63;
+  accumulators[5] = 0x85EBCA77;
+  accumulators[6] = 0x27D4EB2F165667C5;
+  accumulators[7] = 0x9E3779B1;
+}
+
+inline void hash::scramble(uint64* accumulators, const uint64 seed) {
+  const byte* secret = SECRET.data + SECRET_SIZE - STRIPE;
+  for (uint64 i = 0; i < 8; i++) {
+    uint64 value = accumulators[i];
+    value ^= value >> 47;
+    value ^= memory::simd::load64(secret + i * 8) ^ seed;
+    accumulators[i] = value * 0x9E3779B1;
+  }
+}
+
+inline uint64 hash::finish_long(uint64* accumulators, const byte* last,
+                                const uint64 last_size,
+                                const byte* last_stripe, const uint64 size,
+                                const uint64 seed) {
+  // The whole stripes of the last block, then the last 64 bytes of the input
+  // (overlapping them) with their own key material
+  const Accumulate accumulate = simd::active();
+  accumulate(accumulators, last, SECRET.data, (last_size - 1) / STRIPE, seed);
+  accumulate(accumulators, last_stripe, SECRET.data + SECRET_SIZE - STRIPE - 7,
+             1, seed);
+
+  // Merge the accumulators pairwise, then avalanche
+  uint64 result = size * 0x9E3779B185EBCA87 + seed;
+  for (uint64 i = 0; i < 4; i++) {
+    const byte* key = SECRET.data + 11 + i * 16;
+    result += fold(accumulators[2 * i] ^ memory::simd::load64(key),
+                   accumulators[2 * i + 1] ^ memory::simd::load64(key + 8));
+  }
+  result ^= result >> 37;
+  result *= 0x165667919E3779F9;
+  return result ^ (result >> 32);
+}
+
+// === Implementation of hash::simd ===
+
+// Each stripe adds, per 64-bit lane, the neighbouring input word and the
+// product of the two 32-bit halves of the input xor the key (xxh3's
+// accumulate step). The vector kernels compute exactly the same sums.
+
+inline void hash::simd::scalar::accumulate(uint64* accumulators,
+                                           const byte* input,
+                                           const byte* secret,
+                                           const uint64 stripes,
+                                           const uint64 seed) {
+  for (uint64 n = 0; n < stripes; n++) {
+    const byte* stripe = input + n * STRIPE;
+    const byte* key = secret + n * 8;
+    for (uint64 i = 0; i < 8; i++) {
+      const uint64 data = memory::simd::load64(stripe + i * 8);
+      const uint64 mixed = data ^ memory::simd::load64(key + i * 8) ^ seed;
+      accumulators[i ^ 1] += data;
+      accumulators[i] += (mixed & 0xFFFFFFFF) * (mixed >> 32);
+    }
+  }
+}
+
+#if defined(HASH_SSE2)
+
+COMPILER_TARGET("sse2")
+inline void hash::simd::sse2::accumulate(uint64* accumulators,
+                                         const byte* input, const byte* secret,
+                                         const uint64 stripes,
+                                         const uint64 seed) {
+  __m128i* lanes = reinterpret_cast<__m128i*>(accumulators);
+  const __m128i salt = _mm_set1_epi64x(static_cast<int64>(seed));
+  for (uint64 n = 0; n < stripes; n++) {
+    const byte* stripe = input + n * STRIPE;
+    const byte* key = secret + n * 8;
+    for (uint64 i = 0; i < 4; i++) {
+      const __m128i data =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(stripe + i * 16));
+      const __m128i mixed = _mm_xor_si128(
+          data, _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                                  key + i * 16)),
+                              salt));
+      const __m128i product = _mm_mul_epu32(
+          mixed, _mm_shuffle_epi32(mixed, _MM_SHUFFLE(0, 3, 0, 1)));
+      const __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+      lanes[i] = _mm_add_epi64(lanes[i], _mm_add_epi64(product, swapped));
+    }
+  }
+}
+
+COMPILER_TARGET("avx2")
+inline void hash::simd::avx2::accumulate(uint64* accumulators,
+                                         const byte* input, const byte* secret,
+                                         const uint64 stripes,
+                                         const uint64 seed) {
+  __m256i* lanes = reinterpret_cast<__m256i*>(accumulators);
+  const __m256i salt = _mm256_set1_epi64x(static_cast<int64>(seed));
+  for (uint64 n = 0; n < stripes; n++) {
+    const byte* stripe = input + n * STRIPE;
+    const byte* key = secret + n * 8;
+    for (uint64 i = 0; i < 2; i++) {
+      const __m256i data = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(stripe + i * 32));
+      const __m256i mixed = _mm256_xor_si256(
+          data,
+          _mm256_xor_si256(_mm256_loadu_si256(
+                               reinterpret_cast<const __m256i*>(key + i * 32)),
+                           salt));
+      const __m256i product = _mm256_mul_epu32(
+          mixed, _mm256_shuffle_epi32(mixed, _MM_SHUFFLE(0, 3, 0, 1)));
+      const __m256i swapped =
+          _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+      lanes[i] =
+          _mm256_add_epi64(lanes[i], _mm256_add_epi64(product, swapped));
+    }
+  }
+}
+
+#elif defined(HASH_NEON)
+
+inline void hash::simd::neon::accumulate(uint64* accumulators,
+                                         const byte* input, const byte* secret,
+                                         const uint64 stripes,
+                                         const uint64 seed) {
+  const uint64x2_t salt = vdupq_n_u64(seed);
+  for (uint64 n = 0; n < stripes; n++) {
+    const byte* stripe = input + n * STRIPE;
+    const byte* key = secret + n * 8;
+    for (uint64 i = 0; i < 4; i++) {
+      const uint64x2_t data = vreinterpretq_u64_u8(vld1q_u8(stripe + i * 16));
+      const uint64x2_t mixed = veorq_u64(
+          data,
+          veorq_u64(vreinterpretq_u64_u8(vld1q_u8(key + i * 16)), salt));
+      const uint64x2_t product =
+          vmull_u32(vmovn_u64(mixed), vshrn_n_u64(mixed, 32));
+      const uint64x2_t swapped = vextq_u64(data, data, 1);
+      uint64x2_t lane = vld1q_u64(accumulators + i * 2);
+      lane = vaddq_u64(lane, vaddq_u64(product, swapped));
+      vst1q_u64(accumulators + i * 2, lane);
+    }
+  }
+}
+
+#endif
+
+inline hash::Accumulate hash::simd::resolve() {
+#if defined(HASH_AVX2)
+  // Prefer AVX2 when both the CPU and the OS support it
+  if (os::system::cpu::features().avx2) {
+    return avx2::accumulate;
+  }
+#endif
+#if defined(HASH_SSE2)
+  return sse2::accumulate;
+#elif defined(HASH_NEON)
+  return neon::accumulate;
+#else
+  return scalar::accumulate;
+#endif
+}
+
+inline hash::Accumulate hash::simd::active() {
+  // Resolve once; later calls only read the cached pointer
+  static const Accumulate kernel = resolve();
+  return kernel;
+}
+
+// === Implementation of Hash<T> ===
+
+template <Integer T>
+inline uint64 Hash<T>::operator()(const T key) const {
+  return hash::integer(key);
+}
+
+template <typename T>
+inline uint64 Hash<T*>::operator()(const T* key) const {
+  return hash::mix(reinterpret_cast<uint64>(key));
+}
@@ -0,0 +1,630 @@
+// @file hash_map.hpp
+
+#pragma once
+
+#include "hash.hpp"
+#include "memory.hpp"
+#include "numbers.hpp"
+#include "utilities/types.h"
+
+// Control bytes are matched 16 at a time: with one SSE2 compare and movemask
+// on x86, one NEON compare on ARM64, and a byte loop elsewhere.
+#if defined(MEMORY_SIMD_SSE2)
+#define HASH_MAP_SSE2
+#elif defined(MEMORY_SIMD_NEON)
+#define HASH_MAP_NEON
+#endif
+
+// @brief The status codes for operations within the HashMap class.
+enum class HashMapStatus : int8 {
+  OK = 1,
+  ALLOCATION_ERROR = 0,
+  NOT_FOUND_ERROR = -1,
+};
+
+// @brief An unordered key-value map with open addressing (Swiss-table
+// style). Entries live in one flat block next to a byte of metadata each;
+// lookups compare the metadata of 16 slots at once and only touch the entries
+// whose 7-bit hash fragment matches. Nothing is allocated per entry.
+// @param K The key type (compared with ==).
+// @param V The value type.
+// @param H The hasher; see Hash<T>.
+// @param A The allocator the table is obtained from.
+template <typename K, typename V, typename H = Hash<K>,
+          memory::Allocator A = memory::HeapAllocator>
+class HashMap {
+ public:
+  // @brief A key and its value, as stored in the table.
+  struct Entry {
+    K key;
+    V value;
+  };
+
+  // === Constructor & Deconstructor ===
+
+  // @brief Default constructor. Creates an empty map; nothing is allocated
+  // until the first insertion.
+  HashMap() = default;
+
+  // @brief Creates an empty map whose table comes from a specific allocator.
+  // @param storage_allocator The allocator used for every table.
+  HashMap(A storage_allocator);
+
+  // @brief Creates an empty map with a specific hasher and allocator.
+  // @param key_hasher The hasher.
+  // @param storage_allocator The allocator used for every table.
+  HashMap(H key_hasher, A storage_allocator);
+
+  // @brief Destructor. Destroys the entries and frees the table.
+  ~HashMap();
+
+  // === Disable copy semantics ===
+
+  // @brief Deleted copy constructor. HashMap objects are non-copyable.
+  HashMap(const HashMap&) = delete;
+
+  // @brief Deleted copy assignment operator. HashMap objects are
+  // non-copyable.
+  HashMap& operator=(const HashMap&) = delete;
+
+  // === Enable move semantics ===
+
+  // @brief Move constructor. Takes over the table of another HashMap.
+  // @param other The HashMap to move resources from.
+  HashMap(HashMap&& other) noexcept;
+
+  // @brief Move assignment operator. Releases the current table, then takes
+  // over the table of another HashMap.
+  // @param other The HashMap to move resources from.
+  // @return A reference to the current HashMap object.
+  HashMap& operator=(HashMap&& other) noexcept;
+
+  // === Public Methods ===
+
+  // @brief Maps a key to a copy of a value, replacing any previous value.
+  // @param key The key.
+  // @param value The value.
+  // @return OK, or ALLOCATION_ERROR if the table could not grow.
+  HashMapStatus insert(const K& key, const V& value);
+
+  // @brief Maps a key to a value by moving both in, replacing any previous
+  // value.
+  // @param key The key.
+  // @param value The value.
+  // @return OK, or ALLOCATION_ERROR if the table could not grow.
+  HashMapStatus insert(K&& key, V&& value);
+
+  // @brief Finds the value of a key, inserting a value-initialized one first
+  // if the key is absent. Counting and grouping take a single probe this way.
+  // @param key The key.
+  // @return A pointer to the value, or nullptr if the table could not grow.
+  // Invalidated by the next insertion.
+  V* find_or_insert(const K& key);
+
+  // @brief Finds the value of a key.
+  // @param key The key, or any value that compares equal to keys with == and
+  // that H hashes like the equal key (e.g. a view of a string key).
+  // @return A pointer to the value, or nullptr if the key is absent.
+  // Invalidated by the next insertion.
+  template <typename Q>
+  V* find(const Q& key) const;
+
+  // @brief Checks whether a key is present.
+  // @param key The key (see find).
+  // @return true if the key is present.
+  template <typename Q>
+  bool contains(const Q& key) const;
+
+  // @brief Removes a key and destroys its value.
+  // @param key The key (see find).
+  // @return OK, or NOT_FOUND_ERROR if the key is absent.
+  template <typename Q>
+  HashMapStatus remove(const Q& key);
+
+  // @brief Grows the table so that count entries fit without rehashing.
+  // @param count The number of entries to make room for.
+  // @return OK, or ALLOCATION_ERROR (the map is left untouched).
+  HashMapStatus reserve(const uint64 count);
+
+  // @brief Destroys every entry, keeping the table.
+  void clear();
+
+  // @brief Calls a function on every entry, in no particular order. The map
+  // must not be modified meanwhile.
+  // @param function Called as function(const K& key, V& value).
+  template <typename F>
+  void for_each(const F& function) const;
+
+  // === Getters ===
+
+  // @brief Returns the number of entries.
+  // @return The size of the map.
+  uint64 getSize() const;
+
+  // @brief Returns the number of slots in the table. At most 7/8 of them are
+  // used before the table grows.
+  // @return The capacity of the map.
+  uint64 getCapacity() const;
+
+  // @brief Checks whether the map has no entries.
+  // @return true if the size is zero.
+  bool isEmpty() const;
+
+ private:
+  static_assert(alignof(Entry) <= 16, "HashMap entries are 16-byte aligned");
+
+  // @brief The number of slots whose metadata is matched at once.
+  static constexpr uint64 GROUP = 16;
+
+  // @brief Metadata of a never used slot. Full slots hold the low 7 bits of
+  // the hash of their key, so only free slots have the top bit set.
+  static constexpr byte EMPTY = 0x80;
+
+  // @brief Metadata of a slot whose entry was removed. Lookups probe past it
+  // where they would stop at an EMPTY slot.
+  static constexpr byte DELETED = 0xFE;
+
+  // @brief Returned by locate when the key is absent.
+  static constexpr uint64 NOT_FOUND = ~0ULL;
+
+  // @brief The entries, followed by the metadata in the same block.
+  Entry* slots = nullptr;
+  byte* control = nullptr;
+
+  // @brief The number of slots (a power of two, at least GROUP, or 0).
+  uint64 capacity = 0;
+
+  // @brief The number of entries.
+  uint64 size = 0;
+
+  // @brief The number of DELETED slots.
+  uint64 deleted = 0;
+
+  H hasher{};
+  A allocator{};
+
+  // @brief Finds the slot holding a key.
+  // @param key The key.
+  // @param hash The hash of key.
+  // @return The slot index, or NOT_FOUND.
+  template <typename Q>
+  uint64 locate(const Q& key, const uint64 hash) const;
+
+  // @brief Finds the first free slot along the probe sequence of a hash.
+  // @param hash The hash.
+  // @return The slot index. The table must have at least one free slot.
+  uint64 free_slot(const uint64 hash) const;
+
+  // @brief Finds the slot of a key, or claims a free slot for it, growing
+  // the table first if needed. A claimed slot is left unconstructed.
+  // @param key The key.
+  // @param found Set to whether the key was already present.
+  // @return The slot index, or NOT_FOUND if the table could not grow.
+  uint64 prepare(const K& key, bool& found);
+
+  // @brief Moves every entry into a fresh table, dropping DELETED slots.
+  // @param new_capacity The number of slots of the new table.
+  // @return OK, or ALLOCATION_ERROR (the map is left untouched).
+  HashMapStatus rehash(const uint64 new_capacity);
+
+  // @brief Destroys the entries and frees the table.
+  void release();
+
+  // @brief Returns the largest number of used (full or DELETED) slots of a
+  // table before it must grow.
+  // @param slot_count The number of slots.
+  // @return 7/8 of slot_count.
+  static uint64 max_load(const uint64 slot_count);
+
+  // @brief Returns the offset of the metadata inside a table block.
+  // @param slot_count The number of slots.
+  // @return The size of the entries, rounded up to 16 bytes.
+  static uint64 control_offset(const uint64 slot_count);
+
+  // @brief Returns the slots of a group whose metadata equals a byte.
+  // @param group The first metadata byte of the group.
+  // @param value The byte.
+  // @return A mask with one bit per matching slot; see slot_of.
+  static uint64 match(const byte* group, const byte value);
+
+  // @brief Returns the free (EMPTY or DELETED) slots of a group.
+  // @param group The first metadata byte of the group.
+  // @return A mask with one bit per free slot; see slot_of.
+  static uint64 match_free(const byte* group);
+
+  // @brief Returns the position in its group of the lowest slot of a mask.
+  // @param mask A non-zero match mask.
+  // @return The position (0 to GROUP - 1).
+  static uint64 slot_of(const uint64 mask);
+};
+
+// === Implementation of HashMap<K, V> ===
+
+template <typename K, typename V, typename H, memory::Allocator A>
+HashMap<K, V, H, A>::HashMap(A storage_allocator)
+    : allocator(storage_allocator) {}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+HashMap<K, V, H, A>::HashMap(H key_hasher, A storage_allocator)
+    : hasher(key_hasher), allocator(storage_allocator) {}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+HashMap<K, V, H, A>::~HashMap() {
+  this->release();
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+HashMap<K, V, H, A>::HashMap(HashMap&& other) noexcept
+    : slots(other.slots),
+      control(other.control),
+      capacity(other.capacity),
+      size(other.size),
+      deleted(other.deleted),
+      hasher(other.hasher),
+      allocator(other.allocator) {
+  // Leave 'other' empty so its destructor frees nothing
+  other.slots = nullptr;
+  other.control = nullptr;
+  other.capacity = 0;
+  other.size = 0;
+  other.deleted = 0;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+HashMap<K, V, H, A>& HashMap<K, V, H, A>::operator=(HashMap&& other) noexcept {
+  if (this != &other) {
+    // Free the current table before taking over the other one
+    this->release();
+    this->slots = other.slots;
+    this->control = other.control;
+    this->capacity = other.capacity;
+    this->size = other.size;
+    this->deleted = other.deleted;
+    this->hasher = other.hasher;
+    this->allocator = other.allocator;
+
+    other.slots = nullptr;
+    other.control = nullptr;
+    other.capacity = 0;
+    other.size = 0;
+    other.deleted = 0;
+  }
+  return *this;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+HashMapStatus HashMap<K, V, H, A>::insert(const K& key, const V& value) {
+  bool found;
+  const uint64 index = this->prepare(key, found);
+  if (index == NOT_FOUND) {
+    return HashMapStatus::ALLOCATION_ERROR;
+  }
+  if (found) {
+    this->slots[index].value = value;
+  } else {
+    memory::construct(&this->slots[index], Entry{key, value});
+  }
+  return HashMapStatus::OK;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+HashMapStatus HashMap<K, V, H, A>::insert(K&& key, V&& value) {
+  bool found;
+  const uint64 index = this->prepare(key, found);
+  if (index == NOT_FOUND) {
+    return HashMapStatus::ALLOCATION_ERROR;
+  }
+  if (found) {
+    this->slots[index].value = memory::pass_ownership(value);
+  } else {
+    memory::construct(&this->slots[index],
+                      Entry{memory::pass_ownership(key),
+                            memory::pass_ownership(value)});
+  }
+  return HashMapStatus::OK;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+V* HashMap<K, V, H, A>::find_or_insert(const K& key) {
+  bool found;
+  const uint64 index = this->prepare(key, found);
+  if (index == NOT_FOUND) {
+    return nullptr;
+  }
+  if (!found) {
+    memory::construct(&this->slots[index], Entry{key, V()});
+  }
+  return &this->slots[index].value;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+template <typename Q>
+V* HashMap<K, V, H, A>::find(const Q& key) const {
+  const uint64 index = this->locate(key, this->hasher(key));
+  return index == NOT_FOUND ? nullptr : &this->slots[index].value;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+template <typename Q>
+bool HashMap<K, V, H, A>::contains(const Q& key) const {
+  return this->locate(key, this->hasher(key)) != NOT_FOUND;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+template <typename Q>
+HashMapStatus HashMap<K, V, H, A>::remove(const Q& key) {
+  const uint64 index = this->locate(key, this->hasher(key));
+  if (index == NOT_FOUND) {
+    return HashMapStatus::NOT_FOUND_ERROR;
+  }
+  memory::destroy(&this->slots[index]);
+  this->size--;
+
+  // Lookups never probe past a group that still has an EMPTY slot, so the
+  // slot can become EMPTY again; otherwise it must keep them probing
+  const byte* group = this->control + (index & ~(GROUP - 1));
+  if (match(group, EMPTY) != 0) {
+    this->control[index] = EMPTY;
+  } else {
+    this->control[index] = DELETED;
+    this->deleted++;
+  }
+  return HashMapStatus::OK;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+HashMapStatus HashMap<K, V, H, A>::reserve(const uint64 count) {
+  uint64 new_capacity = this->capacity == 0 ? GROUP : this->capacity;
+  while (max_load(new_capacity) < count) {
+    // No power of two holds count once doubling would wrap
+    if (new_capacity > UINT64_MAX / 2) {
+      return HashMapStatus::ALLOCATION_ERROR;
+    }
+    new_capacity *= 2;
+  }
+  if (new_capacity == this->capacity) {
+    return HashMapStatus::OK;
+  }
+  return this->rehash(new_capacity);
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+void HashMap<K, V, H, A>::clear() {
+  for (uint64 i = 0; i < this->capacity; i++) {
+    if (this->control[i] < EMPTY) {
+      memory::destroy(&this->slots[i]);
+    }
+    this->control[i] = EMPTY;
+  }
+  this->size = 0;
+  this->deleted = 0;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+template <typename F>
+void HashMap<K, V, H, A>::for_each(const F& function) const {
+  for (uint64 i = 0; i < this->capacity; i++) {
+    if (this->control[i] < EMPTY) {
+      function(static_cast<const K&>(this->slots[i].key),
+               this->slots[i].value);
+    }
+  }
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+uint64 HashMap<K, V, H, A>::getSize() const {
+  return this->size;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+uint64 HashMap<K, V, H, A>::getCapacity() const {
+  return this->capacity;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+bool HashMap<K, V, H, A>::isEmpty() const {
+  return this->size == 0;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+template <typename Q>
+uint64 HashMap<K, V, H, A>::locate(const Q& key, const uint64 hash) const {
+  if (this->capacity == 0) {
+    return NOT_FOUND;
+  }
+
+  // The low 7 bits are kept in the metadata, the rest pick the first group.
+  // Groups are then visited in triangular steps, which reach every group of
+  // a power-of-two table
+  const byte fragment = static_cast<byte>(hash & 0x7F);
+  const uint64 groups = this->capacity / GROUP - 1;
+  uint64 group = (hash >> 7) & groups;
+  for (uint64 step = 1;; step++) {
+    const byte* metadata = this->control + group * GROUP;
+    for (uint64 mask = match(metadata, fragment); mask != 0;
+         mask &= mask - 1) {
+      const uint64 index = group * GROUP + slot_of(mask);
+      if (this->slots[index].key == key) {
+        return index;
+      }
+    }
+
+    // An EMPTY slot means the key was never pushed further along
+    if (match(metadata, EMPTY) != 0) {
+      return NOT_FOUND;
+    }
+    group = (group + step) & groups;
+  }
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+uint64 HashMap<K, V, H, A>::free_slot(const uint64 hash) const {
+  const uint64 groups = this->capacity / GROUP - 1;
+  uint64 group = (hash >> 7) & groups;
+  for (uint64 step = 1;; step++) {
+    const uint64 mask = match_free(this->control + group * GROUP);
+    if (mask != 0) {
+      return group * GROUP + slot_of(mask);
+    }
+    group = (group + step) & groups;
+  }
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+uint64 HashMap<K, V, H, A>::prepare(const K& key, bool& found) {
+  const uint64 hash = this->hasher(key);
+  const uint64 existing = this->locate(key, hash);
+  if (existing != NOT_FOUND) {
+    found = true;
+    return existing;
+  }
+  found = false;
+
+  // Grow when used slots would pass 7/8; when DELETED slots make up much of
+  // that, rehashing at the same capacity is enough to reclaim them
+  if (this->size + this->deleted + 1 > max_load(this->capacity)) {
+    uint64 new_capacity = this->capacity;
+    if (new_capacity == 0) {
+      new_capacity = GROUP;
+    } else if (this->size + 1 > max_load(new_capacity) / 2) {
+      new_capacity *= 2;
+    }
+    if (this->rehash(new_capacity) != HashMapStatus::OK) {
+      return NOT_FOUND;
+    }
+  }
+
+  const uint64 index = this->free_slot(hash);
+  if (this->control[index] == DELETED) {
+    this->deleted--;
+  }
+  this->control[index] = static_cast<byte>(hash & 0x7F);
+  this->size++;
+  return index;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+HashMapStatus HashMap<K, V, H, A>::rehash(const uint64 new_capacity) {
+  // Refuse tables whose block size overflows; the map is untouched
+  if (new_capacity > (UINT64_MAX - 15) / (sizeof(Entry) + 1)) {
+    return HashMapStatus::ALLOCATION_ERROR;
+  }
+
+  // One block: the entries, then the metadata
+  const uint64 offset = control_offset(new_capacity);
+  byte* block =
+      static_cast<byte*>(this->allocator.allocate(offset + new_capacity));
+  if (block == nullptr) {
+    return HashMapStatus::ALLOCATION_ERROR;
+  }
+  Entry* old_slots = this->slots;
+  byte* old_control = this->control;
+  const uint64 old_capacity = this->capacity;
+
+  this->slots = reinterpret_cast<Entry*>(block);
+  this->control = block + offset;
+  this->capacity = new_capacity;
+  this->deleted = 0;
+  for (uint64 i = 0; i < new_capacity; i++) {
+    this->control[i] = EMPTY;
+  }
+
+  // Move every entry to its slot in the new table
+  for (uint64 i = 0; i < old_capacity; i++) {
+    if (old_control[i] < EMPTY) {
+      const uint64 hash = this->hasher(old_slots[i].key);
+      const uint64 index = this->free_slot(hash);
+      this->control[index] = static_cast<byte>(hash & 0x7F);
+      memory::construct(&this->slots[index],
+                        memory::pass_ownership(old_slots[i]));
+      memory::destroy(&old_slots[i]);
+    }
+  }
+  if (old_slots != nullptr) {
+    this->allocator.deallocate(old_slots,
+                               control_offset(old_capacity) + old_capacity);
+  }
+  return HashMapStatus::OK;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+void HashMap<K, V, H, A>::release() {
+  if (this->slots == nullptr) {
+    return;
+  }
+  this->clear();
+  this->allocator.deallocate(this->slots, control_offset(this->capacity) +
+                                              this->capacity);
+  this->slots = nullptr;
+  this->control = nullptr;
+  this->capacity = 0;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+uint64 HashMap<K, V, H, A>::max_load(const uint64 slot_count) {
+  return slot_count - slot_count / 8;
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+uint64 HashMap<K, V, H, A>::control_offset(const uint64 slot_count) {
+  return memory::align_up(slot_count * sizeof(Entry), 16);
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+uint64 HashMap<K, V, H, A>::match(const byte* group, const byte value) {
+#if defined(HASH_MAP_SSE2)
+  const __m128i metadata =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  const __m128i matches =
+      _mm_cmpeq_epi8(metadata, _mm_set1_epi8(static_cast<char>(value)));
+  return static_cast<uint32>(_mm_movemask_epi8(matches));
+#elif defined(HASH_MAP_NEON)
+  // One nibble per slot; keep its top bit so mask &= mask - 1 steps slots
+  const uint8x16_t matches = vceqq_u8(vld1q_u8(group), vdupq_n_u8(value));
+  return memory::simd::neon::mask(matches) & 0x8888888888888888;
+#else
+  uint64 mask = 0;
+  for (uint64 i = 0; i < GROUP; i++) {
+    mask |= static_cast<uint64>(group[i] == value) << i;
+  }
+  return mask;
+#endif
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+uint64 HashMap<K, V, H, A>::match_free(const byte* group) {
+#if defined(HASH_MAP_SSE2)
+  // Free slots are exactly those with the top bit set
+  const __m128i metadata =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  return static_cast<uint32>(_mm_movemask_epi8(metadata));
+#elif defined(HASH_MAP_NEON)
+  const uint8x16_t free = vcgeq_u8(vld1q_u8(group), vdupq_n_u8(EMPTY));
+  return memory::simd::neon::mask(free) & 0x8888888888888888;
+#else
+  uint64 mask = 0;
+  for (uint64 i = 0; i < GROUP; i++) {
+    mask |= static_cast<uint64>(group[i] >= EMPTY) << i;
+  }
+  return mask;
+#endif
+}
+
+template <typename K, typename V, typename H, memory::Allocator A>
+uint64 HashMap<K, V, H, A>::slot_of(const uint64 mask) {
+#if defined(HASH_MAP_NEON)
+  return static_cast<uint64>(__builtin_ctzll(mask)) >> 2;
+#else
+  return static_cast<uint64>(__builtin_ctzll(mask));
+#endif
+}
+
+// === Trait specializations ===
+
+// @brief A HashMap only holds a pointer to its table and counters, so it can
+// be relocated bitwise when nested inside another container.
+template <typename K, typename V, typename H, memory::Allocator A>
+struct isTriviallyRelocatable<HashMap<K, V, H, A>> {
+  static constexpr bool value = isTriviallyRelocatable<H>::value &&
+                                isTriviallyRelocatable<A>::value;
+};
@@ -2,8 +2,20 @@
 
 #pragma once
 
+#include <new>  // For placement new (freestanding)
+
+#include "memory/heap.hpp"
+#include "memory/simd.hpp"
+#include "memory/stats.hpp"
+#include "os/trace.hpp"
 #include "utilities/types.h"
 
+// Freestanding builds always allocate through memory::heap; hosted builds opt
+// in with RECREATIONS_ALLOCATOR and otherwise use malloc.
+#if defined(RECREATIONS_ONLY) && !defined(RECREATIONS_ALLOCATOR)
+#define RECREATIONS_ALLOCATOR
+#endif
+
 // The standard library functions are only included if not in RECREATIONS_ONLY
 // mode.
 #ifndef RECREATIONS_ONLY
@@ -41,6 +53,15 @@ void* cleaned_allocate(const uint64 count, const uint64 size);
 // @param ptr Pointer to the memory block to be freed.
 void deallocate(void* ptr);
 
+// @brief The raw allocation functions memory::allocate, reallocate and
+// deallocate forward to: memory::heap when RECREATIONS_ALLOCATOR is defined,
+// the C library otherwise. Blocks obtained here bypass memory::stats.
+namespace backend {
+void* allocate(const uint64 size);
+void* reallocate(void* ptr, const uint64 size);
+void deallocate(void* ptr);
+}  // namespace backend
+
 // === Memory Manipulation (Declaration) ===
 
 // @brief Copies a block of memory from a source to a destination.
@@ -75,12 +96,16 @@ void* set(void* dest, const void* src, const uint64 size);
 // otherwise.
 bool compare(const void* s1, const void* s2, const uint64 size);
 
-// @brief Checks if two blocks of memory are identical (alias for compare).
-// @param s Pointer to the first block of memory.
-// @param c Pointer to the second block of memory.
-// @param size The number of bytes to compare.
-// @return true if the blocks are identical, false otherwise.
-bool find(const void* s, const void* c, const uint64 size);
+// @brief Searches a block of memory for the first occurrence of a byte
+// pattern (memmem-style), using the vectorized kernels in memory::simd.
+// @param haystack Pointer to the block of memory to search.
+// @param haystack_size The number of bytes to search.
+// @param needle Pointer to the pattern to look for.
+// @param needle_size The length of the pattern in bytes.
+// @return A pointer to the first match inside haystack, haystack itself for an
+// empty pattern, or nullptr if the pattern does not occur.
+const void* find(const void* haystack, const uint64 haystack_size,
+                 const void* needle, const uint64 needle_size);
 
 // === Ownership Transfer (Declaration) ===
 
@@ -90,6 +115,248 @@ bool find(const void* s, const void* c, const uint64 size);
 // @return An rvalue reference to the object.
 template <typename T>
 T&& pass_ownership(T& t) noexcept;
+
+// @brief Constructs an object in place inside uninitialized storage.
+// @param where Pointer to suitably aligned, uninitialized storage for a T.
+// @param args The arguments forwarded to the constructor of T.
+// @return A pointer to the constructed object.
+template <typename T, typename... Args>
+T* construct(T* where, Args&&... args);
+
+// @brief Runs the destructor of an object without releasing its storage.
+// @param ptr Pointer to the object to destroy.
+template <typename T>
+void destroy(T* ptr) noexcept;
+
+// @brief Rounds a size up to the next multiple of a power-of-two alignment.
+// @param size The size in bytes to round.
+// @param alignment The alignment in bytes (must be a power of two).
+// @return The smallest multiple of alignment that is >= size.
+constexpr uint64 align_up(const uint64 size, const uint64 alignment);
+
+// === Allocators (Declaration) ===
+
+// @brief Requirements for an allocator usable by the containers. Sizes are
+// passed back on reallocate/deallocate so that backends which do not store
+// per-block headers (arena, pool) can still release or grow blocks.
+// @param A The allocator type to check.
+template <typename A>
+concept Allocator = requires(A a, void* ptr, uint64 size) {
+  static_cast<void*>(a.allocate(size));
+  static_cast<void*>(a.reallocate(ptr, size, size));
+  a.deallocate(ptr, size);
+};
+
+// @brief Stateless allocator forwarding to memory::allocate, reallocate and
+// deallocate. This is the default allocator of every container.
+struct HeapAllocator {
+  // @brief Allocates a block through memory::allocate.
+  // @param size The number of bytes to allocate.
+  // @return A pointer to the block, or nullptr on failure.
+  void* allocate(const uint64 size);
+
+  // @brief Resizes a block through memory::reallocate.
+  // @param ptr The block to resize (may be nullptr).
+  // @param old_size The current size of the block in bytes (unused).
+  // @param new_size The requested size of the block in bytes.
+  // @return A pointer to the resized block, or nullptr on failure.
+  void* reallocate(void* ptr, const uint64 old_size, const uint64 new_size);
+
+  // @brief Frees a block through memory::deallocate.
+  // @param ptr The block to free.
+  // @param size The size of the block in bytes (unused).
+  void deallocate(void* ptr, const uint64 size);
+};
+
+// @brief Bump allocator carving allocations out of large blocks. Individual
+// deallocations are no-ops (except for the most recent allocation, which is
+// rolled back); all memory is reclaimed at once with reset() or release().
+class Arena {
+ public:
+  // @brief Creates an arena whose blocks hold at least block_size bytes.
+  // @param default_block_size The default size in bytes of each block
+  // requested from memory::allocate.
+  Arena(const uint64 default_block_size = 64 * 1024);
+
+  // @brief Destructor. Returns every block to memory::deallocate.
+  ~Arena();
+
+  // @brief Deleted copy constructor. Arenas own their blocks.
+  Arena(const Arena&) = delete;
+
+  // @brief Deleted copy assignment operator. Arenas own their blocks.
+  Arena& operator=(const Arena&) = delete;
+
+  // @brief Bumps a new allocation out of the current block, chaining a new
+  // block when the current one is exhausted.
+  // @param size The number of bytes to allocate.
+  // @return A pointer aligned to 16 bytes, or nullptr on failure.
+  void* allocate(const uint64 size);
+
+  // @brief Grows or shrinks an allocation. The most recent allocation is
+  // resized in place when it fits; otherwise a new region is bumped and the
+  // contents copied.
+  // @param ptr The allocation to resize (may be nullptr).
+  // @param old_size The current size of the allocation in bytes.
+  // @param new_size The requested size in bytes.
+  // @return A pointer to the resized allocation, or nullptr on failure.
+  void* reallocate(void* ptr, const uint64 old_size, const uint64 new_size);
+
+  // @brief Rolls back the allocation if it was the most recent one, otherwise
+  // does nothing.
+  // @param ptr The allocation to release.
+  // @param size The size of the allocation in bytes.
+  void deallocate(void* ptr, const uint64 size);
+
+  // @brief Discards every allocation at once. The largest block is kept so the
+  // next cycle does not have to go back to memory::allocate.
+  void reset();
+
+  // @brief Returns every block to memory::deallocate.
+  void release();
+
+  // @brief Returns the number of bytes handed out since the last reset.
+  // @return The used byte count.
+  uint64 getUsed() const;
+
+ private:
+  // @brief Header placed at the start of every block.
+  struct Block {
+    Block* next;
+    uint64 capacity;
+    uint64 used;
+  };
+
+  // @brief The block currently being bumped (head of the chain).
+  Block* head = nullptr;
+
+  // @brief The minimum size in bytes of a newly chained block.
+  uint64 block_size;
+
+  // @brief Bytes handed out since the last reset.
+  uint64 used = 0;
+
+  // @brief Chains a new block able to hold at least size bytes.
+  // @param size The size of the allocation that triggered the growth.
+  // @return true on success, false if memory::allocate failed.
+  bool grow(const uint64 size);
+};
+
+// @brief Fixed-size block allocator backed by an intrusive free list.
+// Requests larger than the block size fail; every other request is served in
+// O(1) without touching memory::allocate once a chunk has been carved.
+class Pool {
+ public:
+  // @brief Creates a pool serving blocks of block_size bytes, carving
+  // blocks_per_chunk blocks out of every chunk it requests.
+  // @param size The size in bytes of every block.
+  // @param count The number of blocks obtained per chunk.
+  Pool(const uint64 size, const uint64 count = 64);
+
+  // @brief Destructor. Returns every chunk to memory::deallocate.
+  ~Pool();
+
+  // @brief Deleted copy constructor. Pools own their chunks.
+  Pool(const Pool&) = delete;
+
+  // @brief Deleted copy assignment operator. Pools own their chunks.
+  Pool& operator=(const Pool&) = delete;
+
+  // @brief Pops a block off the free list, carving a new chunk if needed.
+  // @param size The number of bytes requested (must be <= the block size).
+  // @return A pointer to the block, or nullptr on failure.
+  void* allocate(const uint64 size);
+
+  // @brief Keeps the block if new_size still fits, otherwise fails.
+  // @param ptr The block to resize (may be nullptr).
+  // @param old_size The current size in bytes (unused).
+  // @param new_size The requested size in bytes.
+  // @return ptr (or a fresh block if ptr was nullptr), or nullptr if new_size
+  // exceeds the block size.
+  void* reallocate(void* ptr, const uint64 old_size, const uint64 new_size);
+
+  // @brief Pushes the block back onto the free list.
+  // @param ptr The block to release.
+  // @param size The size in bytes (unused).
+  void deallocate(void* ptr, const uint64 size);
+
+  // @brief Returns every block of every chunk to the free list at once.
+  void reset();
+
+  // @brief Returns the size in bytes of the blocks served by the pool.
+  // @return The block size.
+  uint64 getBlockSize() const;
+
+ private:
+  // @brief Intrusive free-list node stored inside free blocks.
+  struct Node {
+    Node* next;
+  };
+
+  // @brief Header placed at the start of every chunk.
+  struct Chunk {
+    Chunk* next;
+  };
+
+  // @brief Head of the free list.
+  Node* free_list = nullptr;
+
+  // @brief Head of the chunk chain.
+  Chunk* chunks = nullptr;
+
+  // @brief The size in bytes of every block (rounded up to 16).
+  uint64 block_size;
+
+  // @brief The number of blocks carved out of each chunk.
+  uint64 blocks_per_chunk;
+
+  // @brief Carves a new chunk and threads its blocks onto the free list.
+  // @return true on success, false if memory::allocate failed.
+  bool grow();
+
+  // @brief Threads the blocks of a chunk onto the free list.
+  // @param chunk The chunk whose blocks are released.
+  void thread_chunk(Chunk* chunk);
+};
+
+// @brief Non-owning allocator handle forwarding to a stateful backend, so that
+// containers can store their allocator by value.
+// @param Backend The backend type (Arena or Pool).
+template <typename Backend>
+class BackendAllocator {
+ public:
+  // @brief Creates a handle referring to backend. The backend must outlive
+  // every container using the handle.
+  // @param target The backend to forward to.
+  BackendAllocator(Backend& target);
+
+  // @brief Forwards to Backend::allocate.
+  // @param size The number of bytes to allocate.
+  // @return A pointer to the block, or nullptr on failure.
+  void* allocate(const uint64 size);
+
+  // @brief Forwards to Backend::reallocate.
+  // @param ptr The block to resize.
+  // @param old_size The current size in bytes.
+  // @param new_size The requested size in bytes.
+  // @return A pointer to the resized block, or nullptr on failure.
+  void* reallocate(void* ptr, const uint64 old_size, const uint64 new_size);
+
+  // @brief Forwards to Backend::deallocate.
+  // @param ptr The block to release.
+  // @param size The size in bytes.
+  void deallocate(void* ptr, const uint64 size);
+
+ private:
+  // @brief The backend every call is forwarded to.
+  Backend* backend;
+};
+
+// @brief Allocator handle for containers living in an Arena.
+using ArenaAllocator = BackendAllocator<Arena>;
+
+// @brief Allocator handle for containers living in a Pool.
+using PoolAllocator = BackendAllocator<Pool>;
 }  // namespace memory
 
 // === Implementation of Namespace memory ===
@@ -97,42 +364,96 @@ T&& pass_ownership(T& t) noexcept;
 // Note: Since all functions are declared inline, their definitions must be
 // provided here in the header file.
 
-inline void* memory::allocate(const uint64 size) {
-#ifndef RECREATIONS_ONLY
+inline void* memory::backend::allocate(const uint64 size) {
+#ifdef RECREATIONS_ALLOCATOR
+  // Serve the request from the size-class thread-caching allocator.
+  return heap::allocate(size);
+#else
   // Allocate the requested number of bytes using the standard library.
   return malloc(size);
-#else
-  // In recreation mode, always return null.
-  return nullptr;
 #endif
 }
 
-inline void* memory::reallocate(void* ptr, const uint64 size) {
-#ifndef RECREATIONS_ONLY
+inline void* memory::backend::reallocate(void* ptr, const uint64 size) {
+#ifdef RECREATIONS_ALLOCATOR
+  // Resize in place within the size class, or move to a new block.
+  return heap::reallocate(ptr, size);
+#else
   // Reallocate the memory block to the new size.
   return realloc(ptr, size);
+#endif
+}
+
+inline void memory::backend::deallocate(void* ptr) {
+#ifdef RECREATIONS_ALLOCATOR
+  // Return the block to the thread cache (or the OS for large blocks).
+  heap::deallocate(ptr);
 #else
-  // In recreation mode, always return null.
-  return nullptr;
+  // Free the previously allocated memory block.
+  free(ptr);
+#endif
+}
+
+inline void* memory::allocate(const uint64 size) {
+  os::system::trace::Zone zone("memory::allocate");
+#ifdef RECREATIONS_MEMORY_STATS
+  // Reserve room for the size/tag header in front of the block.
+  if (size > UINT64_MAX - stats::HEADER) {
+    return nullptr;
+  }
+  return stats::track(backend::allocate(size + stats::HEADER), size);
+#else
+  return backend::allocate(size);
+#endif
+}
+
+inline void* memory::reallocate(void* ptr, const uint64 size) {
+  os::system::trace::Zone zone("memory::reallocate");
+#ifdef RECREATIONS_MEMORY_STATS
+  // Behave like allocate for nullptr, then resize the block with its header.
+  if (ptr == nullptr) {
+    return allocate(size);
+  }
+  if (size > UINT64_MAX - stats::HEADER) {
+    return nullptr;
+  }
+  void* raw = backend::reallocate(stats::header_of(ptr), size + stats::HEADER);
+  return raw != nullptr ? stats::retrack(raw, size) : nullptr;
+#else
+  return backend::reallocate(ptr, size);
 #endif
 }
 
 inline void* memory::cleaned_allocate(const uint64 count, const uint64 size) {
-#ifndef RECREATIONS_ONLY
+#if defined(RECREATIONS_ALLOCATOR) || defined(RECREATIONS_MEMORY_STATS)
+  // Reject products that overflow, then allocate and zero the block.
+  if (size != 0 && count > UINT64_MAX / size) {
+    return nullptr;
+  }
+  void* ptr = allocate(count * size);
+  if (ptr != nullptr) {
+    simd::active().set(static_cast<byte*>(ptr), 0, count * size);
+  }
+  return ptr;
+#else
   // Allocate memory for count elements, each of size, and initialize to zero.
   return calloc(count, size);
-#else
-  // In recreation mode, always return null.
-  return nullptr;
 #endif
 }
 
 inline void memory::deallocate(void* ptr) {
-#ifndef RECREATIONS_ONLY
-  // Free the previously allocated memory block.
-  free(ptr);
+  os::system::trace::Zone zone("memory::deallocate");
+#ifdef RECREATIONS_MEMORY_STATS
+  // Account the block before handing it (header included) back.
+  if (ptr == nullptr) {
+    return;
+  }
+  void* raw = stats::header_of(ptr);
+  stats::untrack(raw);
+  backend::deallocate(raw);
+#else
+  backend::deallocate(ptr);
 #endif
-  // No operation in recreation mode.
 }
 
 inline void* memory::copy(void* dest, const void* src, const uint64 size) {
@@ -141,8 +462,10 @@ inline void* memory::copy(void* dest, const void* src, const uint64 size) {
   // overlap.
   return memcpy(dest, src, size);
 #else
-  // In recreation mode, return null.
-  return nullptr;
+  // In recreation mode, use the vectorized kernel for the running CPU.
+  simd::active().copy(static_cast<byte*>(dest), static_cast<const byte*>(src),
+                     size);
+  return dest;
 #endif
 }
 
@@ -152,8 +475,10 @@ inline void* memory::move(void* dest, const void* src, const uint64 size) {
   // blocks.
   return memmove(dest, src, size);
 #else
-  // In recreation mode, return null.
-  return nullptr;
+  // In recreation mode, use the vectorized kernel for the running CPU.
+  simd::active().move(static_cast<byte*>(dest), static_cast<const byte*>(src),
+                     size);
+  return dest;
 #endif
 }
 
@@ -162,8 +487,10 @@ inline void* memory::set(void* dest, const void* src, const uint64 size) {
   // Fill the memory block with the byte value extracted from src.
   return memset(dest, *(static_cast<const unsigned char*>(src)), size);
 #else
-  // In recreation mode, return null.
-  return nullptr;
+  // In recreation mode, use the vectorized kernel for the running CPU.
+  simd::active().set(static_cast<byte*>(dest), *static_cast<const byte*>(src),
+                     size);
+  return dest;
 #endif
 }
 
@@ -173,19 +500,19 @@ inline bool memory::compare(const void* s1, const void* s2, const uint64 size) {
   // (result is zero).
   return memcmp(s1, s2, size) == 0;
 #else
-  // In recreation mode, return false.
-  return false;
+  // In recreation mode, use the vectorized kernel for the running CPU.
+  return simd::active().compare(static_cast<const byte*>(s1),
+                                static_cast<const byte*>(s2), size);
 #endif
 }
 
-inline bool memory::find(const void* s, const void* c, const uint64 size) {
-#ifndef RECREATIONS_ONLY
-  // Compare the specified number of bytes (alias for memcmp == 0).
-  return memcmp(s, c, size) == 0;
-#else
-  // In recreation mode, return false.
-  return false;
-#endif
+inline const void* memory::find(const void* haystack,
+                                const uint64 haystack_size, const void* needle,
+                                const uint64 needle_size) {
+  // The C library has no portable memmem, so both modes use the vectorized
+  // first/last-byte filter kernel for the running CPU.
+  return simd::active().find(static_cast<const byte*>(haystack), haystack_size,
+                             static_cast<const byte*>(needle), needle_size);
 }
 
 template <typename T>
@@ -193,4 +520,309 @@ inline T&& memory::pass_ownership(T& t) noexcept {
   // Cast an lvalue reference to an rvalue reference to enable moving the
   // object's resources.
   return static_cast<T&&>(t);
-}
\ No newline at end of file
+}
+
+template <typename T, typename... Args>
+inline T* memory::construct(T* where, Args&&... args) {
+  // Placement-new the object, forwarding the arguments with their value
+  // category preserved
+  return ::new (static_cast<void*>(where)) T(static_cast<Args&&>(args)...);
+}
+
+template <typename T>
+inline void memory::destroy(T* ptr) noexcept {
+  // Invoke the destructor only; the storage is owned by the caller
+  ptr->~T();
+}
+
+constexpr uint64 memory::align_up(const uint64 size, const uint64 alignment) {
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+
+// === Implementation of memory::HeapAllocator ===
+
+inline void* memory::HeapAllocator::allocate(const uint64 size) {
+  return memory::allocate(size);
+}
+
+inline void* memory::HeapAllocator::reallocate(void* ptr, const uint64 old_size,
+                                               const uint64 new_size) {
+  (void)old_size;
+  return memory::reallocate(ptr, new_size);
+}
+
+inline void memory::HeapAllocator::deallocate(void* ptr, const uint64 size) {
+  (void)size;
+  memory::deallocate(ptr);
+}
+
+// === Implementation of memory::Arena ===
+
+inline memory::Arena::Arena(const uint64 default_block_size)
+    : block_size(default_block_size) {}
+
+inline memory::Arena::~Arena() { this->release(); }
+
+inline bool memory::Arena::grow(const uint64 size) {
+  // Size the new block so it holds at least the triggering allocation
+  const uint64 header = memory::align_up(sizeof(Block), 16);
+  uint64 capacity = this->block_size;
+  if (capacity < size) {
+    capacity = size;
+  }
+  if (capacity > UINT64_MAX - header) {
+    return false;
+  }
+
+  // Request the block and push it at the head of the chain
+  Block* block = static_cast<Block*>(memory::allocate(header + capacity));
+  if (block == nullptr) {
+    return false;
+  }
+  block->next = this->head;
+  block->capacity = capacity;
+  block->used = 0;
+  this->head = block;
+  return true;
+}
+
+inline void* memory::Arena::allocate(const uint64 size) {
+  // Round the request up to keep every allocation 16-byte aligned, refusing
+  // sizes the rounding would wrap
+  if (size > UINT64_MAX - 15) {
+    return nullptr;
+  }
+  const uint64 rounded = memory::align_up(size, 16);
+  const uint64 header = memory::align_up(sizeof(Block), 16);
+
+  // Chain a new block if the current one cannot hold the request
+  if (this->head == nullptr ||
+      this->head->capacity - this->head->used < rounded) {
+    if (!this->grow(rounded)) {
+      return nullptr;
+    }
+  }
+
+  // Bump the block cursor
+  byte* base = reinterpret_cast<byte*>(this->head) + header;
+  void* ptr = base + this->head->used;
+  this->head->used += rounded;
+  this->used += rounded;
+  return ptr;
+}
+
+inline void* memory::Arena::reallocate(void* ptr, const uint64 old_size,
+                                       const uint64 new_size) {
+  if (ptr == nullptr) {
+    return this->allocate(new_size);
+  }
+
+  if (new_size > UINT64_MAX - 15) {
+    return nullptr;
+  }
+  const uint64 old_rounded = memory::align_up(old_size, 16);
+  const uint64 new_rounded = memory::align_up(new_size, 16);
+  const uint64 header = memory::align_up(sizeof(Block), 16);
+
+  // Resize in place when ptr is the most recent allocation of the head block
+  if (this->head != nullptr) {
+    byte* base = reinterpret_cast<byte*>(this->head) + header;
+    const bool is_last = static_cast<byte*>(ptr) + old_rounded ==
+                         base + this->head->used;
+    // Compare against the space left below ptr, so nothing can wrap
+    if (is_last && new_rounded <= this->head->capacity -
+                                       (this->head->used - old_rounded)) {
+      this->head->used = this->head->used - old_rounded + new_rounded;
+      this->used = this->used - old_rounded + new_rounded;
+      return ptr;
+    }
+  }
+
+  // Otherwise bump a fresh region and copy the surviving bytes
+  void* new_ptr = this->allocate(new_size);
+  if (new_ptr == nullptr) {
+    return nullptr;
+  }
+  memory::copy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+  return new_ptr;
+}
+
+inline void memory::Arena::deallocate(void* ptr, const uint64 size) {
+  if (ptr == nullptr || this->head == nullptr) {
+    return;
+  }
+
+  // Roll the cursor back only if ptr is the most recent allocation
+  const uint64 rounded = memory::align_up(size, 16);
+  const uint64 header = memory::align_up(sizeof(Block), 16);
+  byte* base = reinterpret_cast<byte*>(this->head) + header;
+  if (static_cast<byte*>(ptr) + rounded == base + this->head->used) {
+    this->head->used -= rounded;
+    this->used -= rounded;
+  }
+}
+
+inline void memory::Arena::reset() {
+  if (this->head == nullptr) {
+    return;
+  }
+
+  // Keep only the largest block and free the rest of the chain
+  Block* largest = this->head;
+  for (Block* block = this->head->next; block != nullptr; block = block->next) {
+    if (block->capacity > largest->capacity) {
+      largest = block;
+    }
+  }
+  Block* block = this->head;
+  while (block != nullptr) {
+    Block* next = block->next;
+    if (block != largest) {
+      memory::deallocate(block);
+    }
+    block = next;
+  }
+
+  // Rewind the surviving block
+  largest->next = nullptr;
+  largest->used = 0;
+  this->head = largest;
+  this->used = 0;
+}
+
+inline void memory::Arena::release() {
+  // Walk the chain and free every block
+  Block* block = this->head;
+  while (block != nullptr) {
+    Block* next = block->next;
+    memory::deallocate(block);
+    block = next;
+  }
+  this->head = nullptr;
+  this->used = 0;
+}
+
+inline uint64 memory::Arena::getUsed() const { return this->used; }
+
+// === Implementation of memory::Pool ===
+
+inline memory::Pool::Pool(const uint64 size, const uint64 count)
+    : block_size(size > UINT64_MAX - 15
+                     ? UINT64_MAX & ~15ULL
+                     : memory::align_up(
+                           size < sizeof(Node) ? sizeof(Node) : size, 16)),
+      blocks_per_chunk(count > 0 ? count : 1) {}
+
+inline memory::Pool::~Pool() {
+  // Free every chunk in the chain
+  Chunk* chunk = this->chunks;
+  while (chunk != nullptr) {
+    Chunk* next = chunk->next;
+    memory::deallocate(chunk);
+    chunk = next;
+  }
+}
+
+inline void memory::Pool::thread_chunk(Chunk* chunk) {
+  // Push every block of the chunk onto the free list
+  const uint64 header = memory::align_up(sizeof(Chunk), 16);
+  byte* base = reinterpret_cast<byte*>(chunk) + header;
+  for (uint64 i = this->blocks_per_chunk; i > 0; i--) {
+    Node* node = reinterpret_cast<Node*>(base + (i - 1) * this->block_size);
+    node->next = this->free_list;
+    this->free_list = node;
+  }
+}
+
+inline bool memory::Pool::grow() {
+  // Request a chunk large enough for the header and every block, failing
+  // when that size wraps
+  const uint64 header = memory::align_up(sizeof(Chunk), 16);
+  if (this->blocks_per_chunk > (UINT64_MAX - header) / this->block_size) {
+    return false;
+  }
+  Chunk* chunk = static_cast<Chunk*>(
+      memory::allocate(header + this->block_size * this->blocks_per_chunk));
+  if (chunk == nullptr) {
+    return false;
+  }
+
+  // Link the chunk and release its blocks
+  chunk->next = this->chunks;
+  this->chunks = chunk;
+  this->thread_chunk(chunk);
+  return true;
+}
+
+inline void* memory::Pool::allocate(const uint64 size) {
+  // Reject requests that do not fit in a block
+  if (size > this->block_size) {
+    return nullptr;
+  }
+
+  // Refill the free list if it ran dry
+  if (this->free_list == nullptr && !this->grow()) {
+    return nullptr;
+  }
+
+  // Pop the head of the free list
+  Node* node = this->free_list;
+  this->free_list = node->next;
+  return node;
+}
+
+inline void* memory::Pool::reallocate(void* ptr, const uint64 old_size,
+                                      const uint64 new_size) {
+  (void)old_size;
+  if (new_size > this->block_size) {
+    return nullptr;
+  }
+  return ptr != nullptr ? ptr : this->allocate(new_size);
+}
+
+inline void memory::Pool::deallocate(void* ptr, const uint64 size) {
+  (void)size;
+  if (ptr == nullptr) {
+    return;
+  }
+
+  // Push the block back onto the free list
+  Node* node = static_cast<Node*>(ptr);
+  node->next = this->free_list;
+  this->free_list = node;
+}
+
+inline void memory::Pool::reset() {
+  // Rebuild the free list from every chunk
+  this->free_list = nullptr;
+  for (Chunk* chunk = this->chunks; chunk != nullptr; chunk = chunk->next) {
+    this->thread_chunk(chunk);
+  }
+}
+
+inline uint64 memory::Pool::getBlockSize() const { return this->block_size; }
+
+// === Implementation of memory::BackendAllocator<Backend> ===
+
+template <typename Backend>
+memory::BackendAllocator<Backend>::BackendAllocator(Backend& target)
+    : backend(&target) {}
+
+template <typename Backend>
+void* memory::BackendAllocator<Backend>::allocate(const uint64 size) {
+  return this->backend->allocate(size);
+}
+
+template <typename Backend>
+void* memory::BackendAllocator<Backend>::reallocate(void* ptr,
+                                                    const uint64 old_size,
+                                                    const uint64 new_size) {
+  return this->backend->reallocate(ptr, old_size, new_size);
+}
+
+template <typename Backend>
+void memory::BackendAllocator<Backend>::deallocate(void* ptr,
+                                                   const uint64 size) {
+  this->backend->deallocate(ptr, size);
+}
@@ -0,0 +1,562 @@
+// @file heap.hpp
+
+#pragma once
+
+#include "../utilities/architecture.h"
+#include "../utilities/types.h"
+#include "simd.hpp"
+
+// Hosted builds map pages through the C library; freestanding Linux builds
+// issue the system calls directly.
+#if !defined(RECREATIONS_ONLY) && \
+    (defined(__linux__) || defined(__APPLE__) || defined(__unix__))
+#define HEAP_PAGES_POSIX
+#define HEAP_THREAD_KEY
+#include <pthread.h>   // pthread_key_create, pthread_setspecific
+#include <sys/mman.h>  // mmap, munmap
+#elif defined(RECREATIONS_ONLY) && defined(__linux__) && \
+    (defined(ARCHITECTURE_X64) || defined(ARCHITECTURE_ARM64))
+#define HEAP_PAGES_SYSCALL
+#endif
+
+// @brief Raw page mapping straight from the operating system.
+namespace memory::pages {
+
+// @brief The granularity of page mappings in bytes.
+inline constexpr uint64 SIZE = 4096;
+
+// @brief Maps zero-filled, readable and writable pages.
+// @param size The number of bytes to map (rounded up to whole pages).
+// @return A pointer to the mapping, or nullptr on failure (including sizes
+// too large to round up).
+void* map(const uint64 size);
+
+// @brief Maps pages whose start address is a multiple of alignment, by
+// over-mapping and trimming the excess.
+// @param size The number of bytes to map (rounded up to whole pages).
+// @param alignment The required alignment (power of two, multiple of SIZE).
+// @return A pointer to the aligned mapping, or nullptr on failure.
+void* map_aligned(const uint64 size, const uint64 alignment);
+
+// @brief Returns pages to the operating system.
+// @param ptr The start of the range, as returned by map.
+// @param size The size of the range in bytes.
+void unmap(void* ptr, const uint64 size);
+
+#if defined(HEAP_PAGES_SYSCALL)
+// @brief Issues a raw six-argument Linux system call.
+// @param number The system call number.
+// @param a..f The system call arguments.
+// @return The raw result (negative errno on failure).
+int64 syscall6(int64 number, int64 a, int64 b, int64 c, int64 d, int64 e,
+               int64 f);
+#endif
+
+}  // namespace memory::pages
+
+// @brief General-purpose allocator: sizes up to MAX_SMALL are rounded to one
+// of CLASS_COUNT size classes and served from per-thread free lists, refilled
+// in batches from a central list that carves SPAN-sized slabs out of fresh
+// pages. Larger sizes are mapped and unmapped directly. Every slab and large
+// mapping starts on a SPAN boundary with a header, so deallocate finds the
+// size of any pointer by masking its address.
+namespace memory::heap {
+
+// @brief The size and alignment in bytes of a slab.
+inline constexpr uint64 SPAN = 256 * 1024;
+
+// @brief The largest request served from size classes.
+inline constexpr uint64 MAX_SMALL = 32 * 1024;
+
+// @brief The number of size classes (16-byte steps up to 128, then four
+// classes per power of two up to MAX_SMALL).
+inline constexpr uint32 CLASS_COUNT = 40;
+
+// @brief Allocates a block of at least size bytes, aligned to 16 bytes.
+// @param size The number of bytes to allocate.
+// @return A pointer to the block, or nullptr on failure.
+void* allocate(const uint64 size);
+
+// @brief Resizes a block, keeping it in place while the new size still fits
+// its size class.
+// @param ptr The block to resize (may be nullptr).
+// @param size The new size in bytes.
+// @return A pointer to the resized block, or nullptr on failure (ptr is then
+// left untouched).
+void* reallocate(void* ptr, const uint64 size);
+
+// @brief Returns a block to the calling thread's cache (or to the OS for
+// large blocks).
+// @param ptr The block to free (may be nullptr).
+void deallocate(void* ptr);
+
+// @brief Returns every block cached by the calling thread to the central
+// list. Runs automatically when a thread exits on POSIX systems; call it by
+// hand before a thread exits in freestanding builds.
+void flush_thread();
+
+// @brief Returns the number of bytes actually usable in a block.
+// @param ptr A block returned by allocate or reallocate.
+// @return The usable size in bytes.
+uint64 usable_size(const void* ptr);
+
+// @brief Maps a request size to its size class.
+// @param size The request size in bytes (<= MAX_SMALL).
+// @return The size class index.
+constexpr uint32 size_class(const uint64 size);
+
+// @brief Returns the block size of a size class.
+// @param index The size class index.
+// @return The block size in bytes.
+constexpr uint64 class_size(const uint32 index);
+
+// @brief Returns the number of blocks moved between a thread cache and the
+// central list at once for a size class.
+// @param index The size class index.
+// @return The batch size.
+constexpr uint32 batch_size(const uint32 index);
+
+// @brief Header at the start of every slab and large mapping.
+struct SpanHeader {
+  // @brief The size class of the slab, or LARGE for direct mappings.
+  uint32 size_class;
+
+  // @brief The length of the mapping in bytes.
+  uint64 mapped;
+};
+
+// @brief Size class marker of direct (large) mappings.
+inline constexpr uint32 LARGE = 0xFFFFFFFFU;
+
+// @brief Offset of the first block inside a slab or large mapping.
+inline constexpr uint64 HEADER = 64;
+
+// @brief Intrusive free-list node stored inside free blocks.
+struct Node {
+  Node* next;
+};
+
+// @brief Per-thread free lists. Blocks beyond twice the batch size are
+// flushed back to the central list; everything left is flushed by
+// flush_thread(). The cache is trivially destructible, so frees made by
+// later thread-exit or static destructors still find it intact.
+struct ThreadCache {
+  // @brief Free list heads, one per size class.
+  Node* lists[CLASS_COUNT];
+
+  // @brief Free list lengths, one per size class.
+  uint32 counts[CLASS_COUNT];
+
+  // @brief Whether the thread-exit flush is registered for this thread.
+  bool attached;
+};
+
+// @brief Lists shared by every thread, guarded by a spin lock.
+struct Central {
+  // @brief Spin lock guarding the lists (0 = free, 1 = held).
+  uint8 lock = 0;
+
+  // @brief Free list heads, one per size class.
+  Node* lists[CLASS_COUNT] = {};
+};
+
+// @brief The central free lists.
+inline Central central;
+
+// @brief The calling thread's cache (zero-initialized, no destructor).
+inline thread_local ThreadCache thread_cache;
+
+#if defined(HEAP_THREAD_KEY)
+// @brief The key whose destructor flushes a thread's cache on exit.
+inline pthread_key_t exit_key;
+
+// @brief Guards the creation of exit_key.
+inline pthread_once_t exit_key_once = PTHREAD_ONCE_INIT;
+#endif
+
+// @brief Registers the thread-exit flush of the calling thread, once.
+// @param cache The calling thread's cache.
+void attach(ThreadCache& cache);
+
+// @brief Moves up to one batch of blocks of a size class from the central
+// list (carving a new slab if it is empty) into the thread cache.
+// @param index The size class index.
+// @return true if at least one block is now cached, false if out of memory.
+bool refill(const uint32 index);
+
+// @brief Moves count blocks of a size class from a thread cache to the
+// central list.
+// @param cache The thread cache to drain.
+// @param index The size class index.
+// @param count The number of blocks to move.
+void flush(ThreadCache& cache, const uint32 index, uint32 count);
+
+// @brief Maps a new slab for a size class and threads its blocks onto the
+// central list. The central lock must be held.
+// @param index The size class index.
+// @return true on success, false if the mapping failed.
+bool carve(const uint32 index);
+
+// @brief Acquires the central spin lock.
+void lock();
+
+// @brief Releases the central spin lock.
+void unlock();
+
+}  // namespace memory::heap
+
+// === Implementation of memory::pages ===
+
+#if defined(HEAP_PAGES_SYSCALL)
+inline int64 memory::pages::syscall6(int64 number, int64 a, int64 b, int64 c,
+                                     int64 d, int64 e, int64 f) {
+#if defined(ARCHITECTURE_X64)
+  int64 result;
+  register int64 r10 __asm__("r10") = d;
+  register int64 r8 __asm__("r8") = e;
+  register int64 r9 __asm__("r9") = f;
+  __asm__ volatile("syscall"
+                   : "=a"(result)
+                   : "a"(number), "D"(a), "S"(b), "d"(c), "r"(r10), "r"(r8),
+                     "r"(r9)
+                   : "rcx", "r11", "memory");
+  return result;
+#else
+  register int64 x8 __asm__("x8") = number;
+  register int64 x0 __asm__("x0") = a;
+  register int64 x1 __asm__("x1") = b;
+  register int64 x2 __asm__("x2") = c;
+  register int64 x3 __asm__("x3") = d;
+  register int64 x4 __asm__("x4") = e;
+  register int64 x5 __asm__("x5") = f;
+  __asm__ volatile("svc 0"
+                   : "+r"(x0)
+                   : "r"(x8), "r"(x1), "r"(x2), "r"(x3), "r"(x4), "r"(x5)
+                   : "memory");
+  return x0;
+#endif
+}
+#endif
+
+inline void* memory::pages::map(const uint64 size) {
+  // Sizes within a page of the top of the address space cannot be rounded
+  if (size > UINT64_MAX - (SIZE - 1)) {
+    return nullptr;
+  }
+  const uint64 length = (size + SIZE - 1) & ~(SIZE - 1);
+
+#if defined(HEAP_PAGES_POSIX)
+  // Anonymous private mapping through the C library
+  void* ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  return ptr == MAP_FAILED ? nullptr : ptr;
+#elif defined(HEAP_PAGES_SYSCALL)
+  // mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS)
+#if defined(ARCHITECTURE_X64)
+  const int64 number = 9;
+#else
+  const int64 number = 222;
+#endif
+  const int64 result =
+      syscall6(number, 0, static_cast<int64>(length), 0x3, 0x22, -1, 0);
+  if (result < 0 && result > -4096) {
+    return nullptr;
+  }
+  return reinterpret_cast<void*>(result);
+#else
+  // No page source on this platform
+  (void)length;
+  return nullptr;
+#endif
+}
+
+inline void memory::pages::unmap(void* ptr, const uint64 size) {
+  const uint64 length = (size + SIZE - 1) & ~(SIZE - 1);
+  if (ptr == nullptr || length == 0) {
+    return;
+  }
+
+#if defined(HEAP_PAGES_POSIX)
+  munmap(ptr, length);
+#elif defined(HEAP_PAGES_SYSCALL)
+#if defined(ARCHITECTURE_X64)
+  const int64 number = 11;
+#else
+  const int64 number = 215;
+#endif
+  syscall6(number, reinterpret_cast<int64>(ptr), static_cast<int64>(length),
+           0, 0, 0, 0);
+#endif
+}
+
+inline void* memory::pages::map_aligned(const uint64 size,
+                                        const uint64 alignment) {
+  // Over-map by one alignment unit so an aligned start always exists
+  if (size > UINT64_MAX - (SIZE - 1)) {
+    return nullptr;
+  }
+  const uint64 length = (size + SIZE - 1) & ~(SIZE - 1);
+  if (length > UINT64_MAX - alignment) {
+    return nullptr;
+  }
+  byte* raw = static_cast<byte*>(map(length + alignment));
+  if (raw == nullptr) {
+    return nullptr;
+  }
+
+  // Trim the unaligned head and the unused tail
+  const uint64 address = reinterpret_cast<uint64>(raw);
+  byte* aligned = reinterpret_cast<byte*>((address + alignment - 1) &
+                                          ~(alignment - 1));
+  const uint64 head = static_cast<uint64>(aligned - raw);
+  const uint64 tail = alignment - head;
+  if (head > 0) {
+    unmap(raw, head);
+  }
+  if (tail > 0) {
+    unmap(aligned + length, tail);
+  }
+  return aligned;
+}
+
+// === Implementation of memory::heap ===
+
+constexpr uint32 memory::heap::size_class(const uint64 size) {
+  // 16-byte steps up to 128 bytes
+  if (size <= 128) {
+    return size == 0 ? 0 : static_cast<uint32>((size + 15) / 16 - 1);
+  }
+
+  // Four classes per power of two above: size lies in (2^p, 2^(p+1)]
+  const uint32 p = 63U - static_cast<uint32>(__builtin_clzll(size - 1));
+  const uint64 step = 1ULL << (p - 2);
+  const uint64 offset = (size - (1ULL << p) + step - 1) / step - 1;
+  return 8 + (p - 7) * 4 + static_cast<uint32>(offset);
+}
+
+constexpr uint64 memory::heap::class_size(const uint32 index) {
+  if (index < 8) {
+    return (index + 1) * 16ULL;
+  }
+  const uint32 k = index - 8;
+  const uint32 p = 7 + k / 4;
+  return (1ULL << p) + (k % 4 + 1) * (1ULL << (p - 2));
+}
+
+constexpr uint32 memory::heap::batch_size(const uint32 index) {
+  // Move about 32 KiB per batch, between 4 and 64 blocks
+  const uint64 blocks = 32 * 1024 / class_size(index);
+  return static_cast<uint32>(blocks < 4 ? 4 : (blocks > 64 ? 64 : blocks));
+}
+
+inline void memory::heap::lock() {
+  // Spin with a relaxed read between attempts to keep the line shared,
+  // hinting the CPU so a sibling hyperthread can run meanwhile
+  while (__atomic_exchange_n(&central.lock, 1, __ATOMIC_ACQUIRE) != 0) {
+    while (__atomic_load_n(&central.lock, __ATOMIC_RELAXED) != 0) {
+#if defined(ARCHITECTURE_X64) || defined(ARCHITECTURE_X86)
+      __builtin_ia32_pause();
+#elif defined(ARCHITECTURE_ARM64)
+      __asm__ volatile("yield");
+#endif
+    }
+  }
+}
+
+inline void memory::heap::unlock() {
+  __atomic_store_n(&central.lock, 0, __ATOMIC_RELEASE);
+}
+
+inline bool memory::heap::carve(const uint32 index) {
+  // Map a fresh, SPAN-aligned slab and tag it with its size class
+  byte* span = static_cast<byte*>(pages::map_aligned(SPAN, SPAN));
+  if (span == nullptr) {
+    return false;
+  }
+  SpanHeader* header = reinterpret_cast<SpanHeader*>(span);
+  header->size_class = index;
+  header->mapped = SPAN;
+
+  // Thread every block of the slab onto the central list
+  const uint64 block = class_size(index);
+  const uint64 count = (SPAN - HEADER) / block;
+  for (uint64 i = count; i > 0; i--) {
+    Node* node = reinterpret_cast<Node*>(span + HEADER + (i - 1) * block);
+    node->next = central.lists[index];
+    central.lists[index] = node;
+  }
+  return true;
+}
+
+inline bool memory::heap::refill(const uint32 index) {
+  ThreadCache& cache = thread_cache;
+  const uint32 batch = batch_size(index);
+  attach(cache);
+
+  lock();
+
+  // Carve a new slab when the central list ran dry
+  if (central.lists[index] == nullptr && !carve(index)) {
+    unlock();
+    return false;
+  }
+
+  // Detach up to one batch from the central list
+  Node* first = central.lists[index];
+  Node* last = first;
+  uint32 taken = 1;
+  while (taken < batch && last->next != nullptr) {
+    last = last->next;
+    taken++;
+  }
+  central.lists[index] = last->next;
+
+  unlock();
+
+  // Splice the batch in front of the thread's list
+  last->next = cache.lists[index];
+  cache.lists[index] = first;
+  cache.counts[index] += taken;
+  return true;
+}
+
+inline void memory::heap::flush(ThreadCache& cache, const uint32 index,
+                                uint32 count) {
+  if (count == 0 || cache.lists[index] == nullptr) {
+    return;
+  }
+
+  // Detach count blocks from the thread's list outside the lock
+  Node* first = cache.lists[index];
+  Node* last = first;
+  uint32 moved = 1;
+  while (moved < count && last->next != nullptr) {
+    last = last->next;
+    moved++;
+  }
+  cache.lists[index] = last->next;
+  cache.counts[index] -= moved;
+
+  // Splice them in front of the central list
+  lock();
+  last->next = central.lists[index];
+  central.lists[index] = first;
+  unlock();
+}
+
+inline void memory::heap::flush_thread() {
+  // Give every cached block back so other threads can reuse it
+  ThreadCache& cache = thread_cache;
+  for (uint32 index = 0; index < CLASS_COUNT; index++) {
+    flush(cache, index, cache.counts[index]);
+  }
+}
+
+inline void memory::heap::attach(ThreadCache& cache) {
+  if (cache.attached) {
+    return;
+  }
+  cache.attached = true;
+#if defined(HEAP_THREAD_KEY)
+  // The key destructor runs after the thread's C++ destructors; the value
+  // only has to be non-null for it to be called. It detaches first, so a
+  // free made by a later key destructor registers another flush round
+  pthread_once(&exit_key_once, [] {
+    pthread_key_create(&exit_key, [](void*) {
+      thread_cache.attached = false;
+      flush_thread();
+    });
+  });
+  pthread_setspecific(exit_key, &cache);
+#endif
+}
+
+inline void* memory::heap::allocate(const uint64 size) {
+  // Large requests get their own aligned mapping
+  if (size > MAX_SMALL) {
+    if (size > UINT64_MAX - HEADER - pages::SIZE) {
+      return nullptr;
+    }
+    const uint64 mapped =
+        (HEADER + size + pages::SIZE - 1) & ~(pages::SIZE - 1);
+    byte* base = static_cast<byte*>(pages::map_aligned(mapped, SPAN));
+    if (base == nullptr) {
+      return nullptr;
+    }
+    SpanHeader* header = reinterpret_cast<SpanHeader*>(base);
+    header->size_class = LARGE;
+    header->mapped = mapped;
+    return base + HEADER;
+  }
+
+  // Pop from the thread cache, refilling it from the central list if empty
+  const uint32 index = size_class(size);
+  ThreadCache& cache = thread_cache;
+  if (cache.lists[index] == nullptr && !refill(index)) {
+    return nullptr;
+  }
+  Node* node = cache.lists[index];
+  cache.lists[index] = node->next;
+  cache.counts[index]--;
+  return node;
+}
+
+inline void memory::heap::deallocate(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+
+  // Find the header of the slab or mapping the block belongs to
+  const SpanHeader* header = reinterpret_cast<const SpanHeader*>(
+      reinterpret_cast<uint64>(ptr) & ~(SPAN - 1));
+
+  // Large blocks go straight back to the OS
+  if (header->size_class == LARGE) {
+    pages::unmap(const_cast<SpanHeader*>(header), header->mapped);
+    return;
+  }
+
+  // Small blocks go to the thread cache, which sheds a batch when too long
+  const uint32 index = header->size_class;
+  ThreadCache& cache = thread_cache;
+  attach(cache);
+  Node* node = static_cast<Node*>(ptr);
+  node->next = cache.lists[index];
+  cache.lists[index] = node;
+  cache.counts[index]++;
+  if (cache.counts[index] > 2 * batch_size(index)) {
+    flush(cache, index, batch_size(index));
+  }
+}
+
+inline uint64 memory::heap::usable_size(const void* ptr) {
+  const SpanHeader* header = reinterpret_cast<const SpanHeader*>(
+      reinterpret_cast<uint64>(ptr) & ~(SPAN - 1));
+  if (header->size_class == LARGE) {
+    return header->mapped - HEADER;
+  }
+  return class_size(header->size_class);
+}
+
+inline void* memory::heap::reallocate(void* ptr, const uint64 size) {
+  if (ptr == nullptr) {
+    return allocate(size);
+  }
+
+  // Keep the block while the new size fits and does not waste over half of it
+  const uint64 usable = usable_size(ptr);
+  if (size <= usable && size > usable / 2) {
+    return ptr;
+  }
+
+  // Otherwise move the contents to a block of the right size
+  void* new_ptr = allocate(size);
+  if (new_ptr == nullptr) {
+    return nullptr;
+  }
+  simd::active().copy(static_cast<byte*>(new_ptr),
+                      static_cast<const byte*>(ptr),
+                      usable < size ? usable : size);
+  deallocate(ptr);
+  return new_ptr;
+}
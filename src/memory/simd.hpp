@@ -0,0 +1,746 @@
+// @file simd.hpp
+
+#pragma once
+
+#include "../os/cpu.hpp"
+#include "../utilities/architecture.h"
+#include "../utilities/compiler.h"
+#include "../utilities/types.h"
+
+#if defined(ARCHITECTURE_X64) || defined(ARCHITECTURE_X86)
+#include <immintrin.h>  // SSE2/AVX2 intrinsics (freestanding)
+#elif defined(ARCHITECTURE_ARM64)
+#include <arm_neon.h>  // NEON intrinsics (freestanding)
+#endif
+
+// @brief Freestanding byte kernels backing the memory:: manipulation
+// functions. Every instruction set gets the same five entry points so callers
+// can pick one at compile time (memory::simd::native) or at run time
+// (memory::simd::active).
+namespace memory::simd {
+
+// @brief Loads an unaligned 64-bit word (constant-size builtin copies compile
+// to a single load, never to a libc call).
+// @param src Pointer to the bytes to load.
+// @return The loaded word.
+uint64 load64(const byte* src);
+
+// @brief Stores a 64-bit word at an unaligned address.
+// @param dest Pointer to the destination bytes.
+// @param word The word to store.
+void store64(byte* dest, const uint64 word);
+
+// @brief Portable kernels working one 64-bit word at a time.
+namespace scalar {
+
+// @brief Copies size bytes between non-overlapping blocks.
+// @param dest Pointer to the destination block.
+// @param src Pointer to the source block.
+// @param size The number of bytes to copy.
+void copy(byte* dest, const byte* src, const uint64 size);
+
+// @brief Copies size bytes between possibly overlapping blocks.
+// @param dest Pointer to the destination block.
+// @param src Pointer to the source block.
+// @param size The number of bytes to copy.
+void move(byte* dest, const byte* src, const uint64 size);
+
+// @brief Fills size bytes with value.
+// @param dest Pointer to the block to fill.
+// @param value The byte value written.
+// @param size The number of bytes to fill.
+void set(byte* dest, const byte value, const uint64 size);
+
+// @brief Checks two blocks for equality.
+// @param s1 Pointer to the first block.
+// @param s2 Pointer to the second block.
+// @param size The number of bytes to compare.
+// @return true if all size bytes match, false otherwise.
+bool compare(const byte* s1, const byte* s2, const uint64 size);
+
+// @brief Finds the first occurrence of needle inside haystack.
+// @param haystack Pointer to the bytes searched.
+// @param haystack_size The number of bytes searched.
+// @param needle Pointer to the pattern.
+// @param needle_size The length of the pattern in bytes.
+// @return A pointer to the first match inside haystack, or nullptr.
+const byte* find(const byte* haystack, const uint64 haystack_size,
+                 const byte* needle, const uint64 needle_size);
+
+}  // namespace scalar
+
+#if defined(ARCHITECTURE_X64) || \
+    (defined(ARCHITECTURE_X86) && defined(__SSE2__))
+#define MEMORY_SIMD_SSE2
+#define MEMORY_SIMD_AVX2
+
+// @brief 16-byte SSE2 kernels (baseline on every x86-64 CPU).
+namespace sse2 {
+void copy(byte* dest, const byte* src, const uint64 size);
+void move(byte* dest, const byte* src, const uint64 size);
+void set(byte* dest, const byte value, const uint64 size);
+bool compare(const byte* s1, const byte* s2, const uint64 size);
+const byte* find(const byte* haystack, const uint64 haystack_size,
+                 const byte* needle, const uint64 needle_size);
+}  // namespace sse2
+
+// @brief 32-byte AVX2 kernels. Only call them on CPUs reporting AVX2; blocks
+// smaller than one register are handed to the SSE2 kernels.
+namespace avx2 {
+void copy(byte* dest, const byte* src, const uint64 size);
+void move(byte* dest, const byte* src, const uint64 size);
+void set(byte* dest, const byte value, const uint64 size);
+bool compare(const byte* s1, const byte* s2, const uint64 size);
+const byte* find(const byte* haystack, const uint64 haystack_size,
+                 const byte* needle, const uint64 needle_size);
+}  // namespace avx2
+
+#elif defined(ARCHITECTURE_ARM64)
+#define MEMORY_SIMD_NEON
+
+// @brief 16-byte NEON kernels (baseline on every ARM64 CPU).
+namespace neon {
+// @brief Compresses a byte-wise comparison result into a 64-bit mask holding
+// one nibble per byte (NEON has no movemask instruction).
+// @param matches The comparison result (0x00 or 0xFF per byte).
+// @return The nibble mask.
+uint64 mask(const uint8x16_t matches);
+
+void copy(byte* dest, const byte* src, const uint64 size);
+void move(byte* dest, const byte* src, const uint64 size);
+void set(byte* dest, const byte value, const uint64 size);
+bool compare(const byte* s1, const byte* s2, const uint64 size);
+const byte* find(const byte* haystack, const uint64 haystack_size,
+                 const byte* needle, const uint64 needle_size);
+}  // namespace neon
+#endif
+
+// @brief The best kernel set the compiler baseline allows.
+#if defined(MEMORY_SIMD_AVX2) && defined(__AVX2__)
+namespace native = avx2;
+#elif defined(MEMORY_SIMD_SSE2)
+namespace native = sse2;
+#elif defined(MEMORY_SIMD_NEON)
+namespace native = neon;
+#else
+namespace native = scalar;
+#endif
+
+// @brief A set of kernels selected for the running CPU.
+struct Kernels {
+  void (*copy)(byte* dest, const byte* src, const uint64 size);
+  void (*move)(byte* dest, const byte* src, const uint64 size);
+  void (*set)(byte* dest, const byte value, const uint64 size);
+  bool (*compare)(const byte* s1, const byte* s2, const uint64 size);
+  const byte* (*find)(const byte* haystack, const uint64 haystack_size,
+                      const byte* needle, const uint64 needle_size);
+};
+
+// @brief Picks the widest kernel set supported by the running CPU (reported
+// by os::system::cpu), so a binary built for the baseline still uses AVX2
+// where available.
+// @return The resolved kernel table.
+Kernels resolve();
+
+// @brief Returns the kernel table for the running CPU, resolved on first use.
+// @return A reference to the cached table.
+const Kernels& active();
+
+}  // namespace memory::simd
+
+// === Implementation of memory::simd ===
+
+inline uint64 memory::simd::load64(const byte* src) {
+  uint64 word;
+  __builtin_memcpy(&word, src, sizeof(word));
+  return word;
+}
+
+inline void memory::simd::store64(byte* dest, const uint64 word) {
+  __builtin_memcpy(dest, &word, sizeof(word));
+}
+
+// === Implementation of memory::simd::scalar ===
+
+COMPILER_NO_LIBC_PATTERNS
+inline void memory::simd::scalar::copy(byte* dest, const byte* src,
+                                       const uint64 size) {
+  // Copy whole words, then the trailing bytes
+  uint64 i = 0;
+  for (; i + 8 <= size; i += 8) {
+    store64(dest + i, load64(src + i));
+  }
+  for (; i < size; i++) {
+    dest[i] = src[i];
+  }
+}
+
+COMPILER_NO_LIBC_PATTERNS
+inline void memory::simd::scalar::move(byte* dest, const byte* src,
+                                       const uint64 size) {
+  if (dest == src || size == 0) {
+    return;
+  }
+
+  // Copy front to back when the destination starts before the source
+  if (dest < src) {
+    uint64 i = 0;
+    for (; i + 8 <= size; i += 8) {
+      store64(dest + i, load64(src + i));
+    }
+    for (; i < size; i++) {
+      dest[i] = src[i];
+    }
+    return;
+  }
+
+  // Otherwise copy back to front so the source is read before it is clobbered
+  uint64 i = size;
+  for (; i >= 8; i -= 8) {
+    store64(dest + i - 8, load64(src + i - 8));
+  }
+  for (; i > 0; i--) {
+    dest[i - 1] = src[i - 1];
+  }
+}
+
+COMPILER_NO_LIBC_PATTERNS
+inline void memory::simd::scalar::set(byte* dest, const byte value,
+                                      const uint64 size) {
+  // Broadcast the byte into a word and store whole words
+  const uint64 word = value * 0x0101010101010101ULL;
+  uint64 i = 0;
+  for (; i + 8 <= size; i += 8) {
+    store64(dest + i, word);
+  }
+  for (; i < size; i++) {
+    dest[i] = value;
+  }
+}
+
+inline bool memory::simd::scalar::compare(const byte* s1, const byte* s2,
+                                          const uint64 size) {
+  // Compare whole words, then the trailing bytes
+  uint64 i = 0;
+  for (; i + 8 <= size; i += 8) {
+    if (load64(s1 + i) != load64(s2 + i)) {
+      return false;
+    }
+  }
+  for (; i < size; i++) {
+    if (s1[i] != s2[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline const byte* memory::simd::scalar::find(const byte* haystack,
+                                              const uint64 haystack_size,
+                                              const byte* needle,
+                                              const uint64 needle_size) {
+  // An empty needle matches at the start; a longer needle never matches
+  if (needle_size == 0) {
+    return haystack;
+  }
+  if (needle_size > haystack_size) {
+    return nullptr;
+  }
+
+  // Filter candidates on the first and last byte, then verify the middle
+  const byte first = needle[0];
+  const byte last = needle[needle_size - 1];
+  const uint64 end = haystack_size - needle_size;
+  for (uint64 i = 0; i <= end; i++) {
+    if (haystack[i] == first && haystack[i + needle_size - 1] == last &&
+        compare(haystack + i, needle, needle_size)) {
+      return haystack + i;
+    }
+  }
+  return nullptr;
+}
+
+#if defined(MEMORY_SIMD_SSE2)
+
+// === Implementation of memory::simd::sse2 ===
+
+COMPILER_TARGET("sse2")
+inline void memory::simd::sse2::copy(byte* dest, const byte* src,
+                                     const uint64 size) {
+  // Small blocks do not fill a register
+  if (size < 16) {
+    scalar::copy(dest, src, size);
+    return;
+  }
+
+  // Copy 64 bytes per iteration, then single registers
+  uint64 i = 0;
+  for (; i + 64 <= size; i += 64) {
+    const __m128i a =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+    const __m128i c =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+    const __m128i d =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), a);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 16), b);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 32), c);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 48), d);
+  }
+  for (; i + 16 <= size; i += 16) {
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dest + i),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+  }
+
+  // Finish with one register overlapping the bytes already copied
+  if (i < size) {
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dest + size - 16),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + size - 16)));
+  }
+}
+
+COMPILER_TARGET("sse2")
+inline void memory::simd::sse2::move(byte* dest, const byte* src,
+                                     const uint64 size) {
+  if (size < 16 || dest == src) {
+    scalar::move(dest, src, size);
+    return;
+  }
+
+  if (dest < src || dest >= src + size) {
+    // Forward: save the last register first, it may be clobbered by the loop
+    const __m128i tail =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + size - 16));
+    uint64 i = 0;
+    for (; i + 16 <= size; i += 16) {
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(dest + i),
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + size - 16), tail);
+  } else {
+    // Backward: save the first register first, then walk down
+    const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    uint64 i = size;
+    for (; i >= 16; i -= 16) {
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(dest + i - 16),
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i - 16)));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), head);
+  }
+}
+
+COMPILER_TARGET("sse2")
+inline void memory::simd::sse2::set(byte* dest, const byte value,
+                                    const uint64 size) {
+  if (size < 16) {
+    scalar::set(dest, value, size);
+    return;
+  }
+
+  // Store the broadcast register, finishing with an overlapping store
+  const __m128i fill = _mm_set1_epi8(static_cast<char>(value));
+  uint64 i = 0;
+  for (; i + 16 <= size; i += 16) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), fill);
+  }
+  if (i < size) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + size - 16), fill);
+  }
+}
+
+COMPILER_TARGET("sse2")
+inline bool memory::simd::sse2::compare(const byte* s1, const byte* s2,
+                                        const uint64 size) {
+  if (size < 16) {
+    return scalar::compare(s1, s2, size);
+  }
+
+  // Compare one register at a time; any differing byte clears a mask bit
+  uint64 i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + i));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s2 + i));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF) {
+      return false;
+    }
+  }
+
+  // Check the remaining bytes with one overlapping register
+  if (i < size) {
+    const __m128i a =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + size - 16));
+    const __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s2 + size - 16));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF;
+  }
+  return true;
+}
+
+COMPILER_TARGET("sse2")
+inline const byte* memory::simd::sse2::find(const byte* haystack,
+                                            const uint64 haystack_size,
+                                            const byte* needle,
+                                            const uint64 needle_size) {
+  if (needle_size == 0 || needle_size > haystack_size) {
+    return scalar::find(haystack, haystack_size, needle, needle_size);
+  }
+
+  // Compare 16 candidate positions at once against the first and last byte
+  // of the needle, verifying the middle only for positions matching both
+  const __m128i first = _mm_set1_epi8(static_cast<char>(needle[0]));
+  const __m128i last =
+      _mm_set1_epi8(static_cast<char>(needle[needle_size - 1]));
+  uint64 i = 0;
+  for (; i + needle_size - 1 + 16 <= haystack_size; i += 16) {
+    const __m128i block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+    const __m128i block_last = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(haystack + i + needle_size - 1));
+    uint32 mask = static_cast<uint32>(_mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))));
+    while (mask != 0) {
+      const uint32 bit = static_cast<uint32>(__builtin_ctz(mask));
+      if (needle_size <= 2 ||
+          compare(haystack + i + bit + 1, needle + 1, needle_size - 2)) {
+        return haystack + i + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+
+  // Search the positions left over by the last full register
+  return scalar::find(haystack + i, haystack_size - i, needle, needle_size);
+}
+
+// === Implementation of memory::simd::avx2 ===
+
+COMPILER_TARGET("avx2")
+inline void memory::simd::avx2::copy(byte* dest, const byte* src,
+                                     const uint64 size) {
+  if (size < 32) {
+    sse2::copy(dest, src, size);
+    return;
+  }
+
+  // Copy 128 bytes per iteration, then single registers
+  uint64 i = 0;
+  for (; i + 128 <= size; i += 128) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+    const __m256i c =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 64));
+    const __m256i d =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 96));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), a);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i + 32), b);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i + 64), c);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i + 96), d);
+  }
+  for (; i + 32 <= size; i += 32) {
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(dest + i),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+  }
+
+  // Finish with one register overlapping the bytes already copied
+  if (i < size) {
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(dest + size - 32),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + size - 32)));
+  }
+}
+
+COMPILER_TARGET("avx2")
+inline void memory::simd::avx2::move(byte* dest, const byte* src,
+                                     const uint64 size) {
+  if (size < 32 || dest == src) {
+    sse2::move(dest, src, size);
+    return;
+  }
+
+  if (dest < src || dest >= src + size) {
+    // Forward: save the last register first, it may be clobbered by the loop
+    const __m256i tail =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + size - 32));
+    uint64 i = 0;
+    for (; i + 32 <= size; i += 32) {
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(dest + i),
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + size - 32), tail);
+  } else {
+    // Backward: save the first register first, then walk down
+    const __m256i head =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    uint64 i = size;
+    for (; i >= 32; i -= 32) {
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(dest + i - 32),
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i - 32)));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), head);
+  }
+}
+
+COMPILER_TARGET("avx2")
+inline void memory::simd::avx2::set(byte* dest, const byte value,
+                                    const uint64 size) {
+  if (size < 32) {
+    sse2::set(dest, value, size);
+    return;
+  }
+
+  // Store the broadcast register, finishing with an overlapping store
+  const __m256i fill = _mm256_set1_epi8(static_cast<char>(value));
+  uint64 i = 0;
+  for (; i + 32 <= size; i += 32) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), fill);
+  }
+  if (i < size) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + size - 32), fill);
+  }
+}
+
+COMPILER_TARGET("avx2")
+inline bool memory::simd::avx2::compare(const byte* s1, const byte* s2,
+                                        const uint64 size) {
+  if (size < 32) {
+    return sse2::compare(s1, s2, size);
+  }
+
+  // Compare one register at a time; any differing byte clears a mask bit
+  uint64 i = 0;
+  for (; i + 32 <= size; i += 32) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + i));
+    const __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s2 + i));
+    if (static_cast<uint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b))) !=
+        0xFFFFFFFFU) {
+      return false;
+    }
+  }
+
+  // Check the remaining bytes with one overlapping register
+  if (i < size) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + size - 32));
+    const __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s2 + size - 32));
+    return static_cast<uint32>(_mm256_movemask_epi8(
+               _mm256_cmpeq_epi8(a, b))) == 0xFFFFFFFFU;
+  }
+  return true;
+}
+
+COMPILER_TARGET("avx2")
+inline const byte* memory::simd::avx2::find(const byte* haystack,
+                                            const uint64 haystack_size,
+                                            const byte* needle,
+                                            const uint64 needle_size) {
+  if (needle_size == 0 || needle_size > haystack_size) {
+    return scalar::find(haystack, haystack_size, needle, needle_size);
+  }
+
+  // Compare 32 candidate positions at once against the first and last byte
+  // of the needle, verifying the middle only for positions matching both
+  const __m256i first = _mm256_set1_epi8(static_cast<char>(needle[0]));
+  const __m256i last =
+      _mm256_set1_epi8(static_cast<char>(needle[needle_size - 1]));
+  uint64 i = 0;
+  for (; i + needle_size - 1 + 32 <= haystack_size; i += 32) {
+    const __m256i block_first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i));
+    const __m256i block_last = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(haystack + i + needle_size - 1));
+    const __m256i matches =
+        _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first),
+                         _mm256_cmpeq_epi8(block_last, last));
+    uint32 mask = static_cast<uint32>(_mm256_movemask_epi8(matches));
+    while (mask != 0) {
+      const uint32 bit = static_cast<uint32>(__builtin_ctz(mask));
+      if (needle_size <= 2 ||
+          compare(haystack + i + bit + 1, needle + 1, needle_size - 2)) {
+        return haystack + i + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+
+  // Let the SSE2 kernel search the positions left over
+  return sse2::find(haystack + i, haystack_size - i, needle, needle_size);
+}
+
+#endif
+
+#if defined(MEMORY_SIMD_NEON)
+
+// === Implementation of memory::simd::neon ===
+
+inline uint64 memory::simd::neon::mask(const uint8x16_t matches) {
+  const uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(matches), 4);
+  return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+}
+
+inline void memory::simd::neon::copy(byte* dest, const byte* src,
+                                     const uint64 size) {
+  if (size < 16) {
+    scalar::copy(dest, src, size);
+    return;
+  }
+
+  // Copy 64 bytes per iteration, then single registers
+  uint64 i = 0;
+  for (; i + 64 <= size; i += 64) {
+    const uint8x16_t a = vld1q_u8(src + i);
+    const uint8x16_t b = vld1q_u8(src + i + 16);
+    const uint8x16_t c = vld1q_u8(src + i + 32);
+    const uint8x16_t d = vld1q_u8(src + i + 48);
+    vst1q_u8(dest + i, a);
+    vst1q_u8(dest + i + 16, b);
+    vst1q_u8(dest + i + 32, c);
+    vst1q_u8(dest + i + 48, d);
+  }
+  for (; i + 16 <= size; i += 16) {
+    vst1q_u8(dest + i, vld1q_u8(src + i));
+  }
+
+  // Finish with one register overlapping the bytes already copied
+  if (i < size) {
+    vst1q_u8(dest + size - 16, vld1q_u8(src + size - 16));
+  }
+}
+
+inline void memory::simd::neon::move(byte* dest, const byte* src,
+                                     const uint64 size) {
+  if (size < 16 || dest == src) {
+    scalar::move(dest, src, size);
+    return;
+  }
+
+  if (dest < src || dest >= src + size) {
+    // Forward: save the last register first, it may be clobbered by the loop
+    const uint8x16_t tail = vld1q_u8(src + size - 16);
+    uint64 i = 0;
+    for (; i + 16 <= size; i += 16) {
+      vst1q_u8(dest + i, vld1q_u8(src + i));
+    }
+    vst1q_u8(dest + size - 16, tail);
+  } else {
+    // Backward: save the first register first, then walk down
+    const uint8x16_t head = vld1q_u8(src);
+    uint64 i = size;
+    for (; i >= 16; i -= 16) {
+      vst1q_u8(dest + i - 16, vld1q_u8(src + i - 16));
+    }
+    vst1q_u8(dest, head);
+  }
+}
+
+inline void memory::simd::neon::set(byte* dest, const byte value,
+                                    const uint64 size) {
+  if (size < 16) {
+    scalar::set(dest, value, size);
+    return;
+  }
+
+  // Store the broadcast register, finishing with an overlapping store
+  const uint8x16_t fill = vdupq_n_u8(value);
+  uint64 i = 0;
+  for (; i + 16 <= size; i += 16) {
+    vst1q_u8(dest + i, fill);
+  }
+  if (i < size) {
+    vst1q_u8(dest + size - 16, fill);
+  }
+}
+
+inline bool memory::simd::neon::compare(const byte* s1, const byte* s2,
+                                        const uint64 size) {
+  if (size < 16) {
+    return scalar::compare(s1, s2, size);
+  }
+
+  // Compare one register at a time; the minimum lane is 0 on any mismatch
+  uint64 i = 0;
+  for (; i + 16 <= size; i += 16) {
+    if (vminvq_u8(vceqq_u8(vld1q_u8(s1 + i), vld1q_u8(s2 + i))) == 0) {
+      return false;
+    }
+  }
+
+  // Check the remaining bytes with one overlapping register
+  if (i < size) {
+    return vminvq_u8(vceqq_u8(vld1q_u8(s1 + size - 16),
+                              vld1q_u8(s2 + size - 16))) != 0;
+  }
+  return true;
+}
+
+inline const byte* memory::simd::neon::find(const byte* haystack,
+                                            const uint64 haystack_size,
+                                            const byte* needle,
+                                            const uint64 needle_size) {
+  if (needle_size == 0 || needle_size > haystack_size) {
+    return scalar::find(haystack, haystack_size, needle, needle_size);
+  }
+
+  // Compare 16 candidate positions at once against the first and last byte
+  // of the needle, verifying the middle only for positions matching both
+  const uint8x16_t first = vdupq_n_u8(needle[0]);
+  const uint8x16_t last = vdupq_n_u8(needle[needle_size - 1]);
+  uint64 i = 0;
+  for (; i + needle_size - 1 + 16 <= haystack_size; i += 16) {
+    const uint8x16_t matches =
+        vandq_u8(vceqq_u8(vld1q_u8(haystack + i), first),
+                 vceqq_u8(vld1q_u8(haystack + i + needle_size - 1), last));
+    uint64 bits = mask(matches);
+    while (bits != 0) {
+      const uint64 bit = static_cast<uint64>(__builtin_ctzll(bits)) >> 2;
+      if (needle_size <= 2 ||
+          compare(haystack + i + bit + 1, needle + 1, needle_size - 2)) {
+        return haystack + i + bit;
+      }
+      bits &= ~(0xFULL << (bit << 2));
+    }
+  }
+
+  // Search the positions left over by the last full register
+  return scalar::find(haystack + i, haystack_size - i, needle, needle_size);
+}
+
+#endif
+
+// === Implementation of memory::simd dispatch ===
+
+inline memory::simd::Kernels memory::simd::resolve() {
+#if defined(MEMORY_SIMD_AVX2)
+  // Prefer AVX2 when both the CPU and the OS support it
+  if (os::system::cpu::features().avx2) {
+    return {avx2::copy, avx2::move, avx2::set, avx2::compare, avx2::find};
+  }
+#endif
+#if defined(MEMORY_SIMD_SSE2)
+  return {sse2::copy, sse2::move, sse2::set, sse2::compare, sse2::find};
+#elif defined(MEMORY_SIMD_NEON)
+  return {neon::copy, neon::move, neon::set, neon::compare, neon::find};
+#else
+  return {scalar::copy, scalar::move, scalar::set, scalar::compare,
+          scalar::find};
+#endif
+}
+
+inline const memory::simd::Kernels& memory::simd::active() {
+  // Resolve once; later calls only read the cached table
+  static const Kernels kernels = resolve();
+  return kernels;
+}
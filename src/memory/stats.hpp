@@ -0,0 +1,420 @@
+// @file stats.hpp
+
+#pragma once
+
+#include "../utilities/types.h"
+#include "heap.hpp"
+
+// @brief Optional allocation instrumentation. Everything is compiled out
+// unless RECREATIONS_MEMORY_STATS is defined; the hooks then become empty
+// inline functions and snapshot() returns zeros. When enabled, every block
+// carries a HEADER-byte prefix remembering its size and tag, and counters are
+// updated with relaxed atomics.
+namespace memory::stats {
+
+#ifdef RECREATIONS_MEMORY_STATS
+// @brief Whether instrumentation is compiled in.
+inline constexpr bool ENABLED = true;
+#else
+// @brief Whether instrumentation is compiled in.
+inline constexpr bool ENABLED = false;
+#endif
+
+// @brief The bytes reserved in front of every instrumented block.
+inline constexpr uint64 HEADER = 16;
+
+// @brief The maximum number of distinct tags (tag 0 is "untagged").
+inline constexpr uint32 MAX_TAGS = 64;
+
+// @brief The number of size histogram buckets: one per heap size class, plus
+// one for large blocks.
+inline constexpr uint32 BUCKETS = heap::CLASS_COUNT + 1;
+
+// @brief Counters attributed to one tag.
+struct TagStats {
+  // @brief The tag name, or nullptr for unused slots.
+  const char* name;
+
+  // @brief The number of allocations made under the tag.
+  uint64 allocations;
+
+  // @brief The bytes currently allocated under the tag.
+  uint64 live_bytes;
+
+  // @brief The bytes ever allocated under the tag.
+  uint64 total_bytes;
+};
+
+// @brief A point-in-time copy of every counter.
+struct Snapshot {
+  uint64 allocations;
+  uint64 reallocations;
+  uint64 deallocations;
+  uint64 live_bytes;
+  uint64 peak_bytes;
+  uint64 total_bytes;
+
+  // @brief Reallocations performed by growing or shrinking containers.
+  uint64 container_reallocations;
+
+  // @brief Allocation counts per size bucket (see BUCKETS).
+  uint64 size_histogram[BUCKETS];
+
+  // @brief Per-tag counters, indexed by tag id.
+  TagStats tags[MAX_TAGS];
+
+  // @brief The number of used tag slots.
+  uint32 tag_count;
+};
+
+// @brief Registers a tag name (or finds an existing one with the same text).
+// Cache the id in a static: registration scans the tag table.
+// @param name The tag name; must outlive the program (a string literal).
+// @return The tag id, or 0 if the table is full or stats are disabled.
+uint32 tag(const char* name);
+
+// @brief Attributes every allocation made by the current thread to a tag
+// while in scope, restoring the previous tag on exit.
+class Scope {
+ public:
+  // @brief Makes tag_id the current thread's tag.
+  // @param tag_id An id returned by tag().
+  Scope(const uint32 tag_id);
+
+  // @brief Restores the previous tag.
+  ~Scope();
+
+  // @brief Deleted copy constructor. Scopes are tied to a block.
+  Scope(const Scope&) = delete;
+
+  // @brief Deleted copy assignment operator. Scopes are tied to a block.
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  // @brief The tag active before this scope.
+  uint32 previous;
+};
+
+// @brief Copies every counter.
+// @return The snapshot.
+Snapshot snapshot();
+
+// @brief Formats a snapshot as human-readable text.
+// @param buffer Destination of the text (always NUL-terminated if capacity is
+// non-zero).
+// @param capacity The size of buffer in bytes.
+// @return The number of characters written, excluding the terminator.
+uint64 dump(char* buffer, const uint64 capacity);
+
+// @brief Records a new block. Called by memory::allocate.
+// @param raw The block including its header (may be nullptr).
+// @param size The size requested by the caller.
+// @return The pointer handed to the caller, or nullptr if raw was nullptr.
+void* track(void* raw, const uint64 size);
+
+// @brief Records a resized block. Called by memory::reallocate.
+// @param raw The new block including its header.
+// @param size The new size requested by the caller.
+// @return The pointer handed to the caller.
+void* retrack(void* raw, const uint64 size);
+
+// @brief Records a freed block. Called by memory::deallocate.
+// @param raw The block including its header.
+void untrack(void* raw);
+
+// @brief Returns the header address of an instrumented block.
+// @param ptr The pointer handed to the caller.
+// @return The start of the block including its header.
+void* header_of(void* ptr);
+
+// @brief Records that a container moved its storage to a new block.
+// @param bytes The size of the new block.
+void count_container_reallocation(const uint64 bytes);
+
+// @brief Header stored in front of every instrumented block.
+struct BlockHeader {
+  uint64 size;
+  uint32 tag;
+  uint32 reserved;
+};
+
+// @brief Global counters, updated with relaxed atomics.
+struct Counters {
+  uint64 allocations;
+  uint64 reallocations;
+  uint64 deallocations;
+  uint64 live_bytes;
+  uint64 peak_bytes;
+  uint64 total_bytes;
+  uint64 container_reallocations;
+  uint64 size_histogram[BUCKETS];
+  TagStats tags[MAX_TAGS];
+  uint32 tag_count;
+  uint8 tag_lock;
+};
+
+// @brief The global counters.
+inline Counters counters = {};
+
+// @brief The tag the calling thread's allocations are attributed to.
+inline thread_local uint32 current_tag = 0;
+
+// @brief Adds size to the live byte counters of the process and a tag,
+// raising the peak if needed.
+// @param tag_id The tag to charge.
+// @param size The number of bytes.
+void charge(const uint32 tag_id, const uint64 size);
+
+// @brief Subtracts size from the live byte counters of the process and a tag.
+// @param tag_id The tag to credit.
+// @param size The number of bytes.
+void credit(const uint32 tag_id, const uint64 size);
+
+}  // namespace memory::stats
+
+// === Implementation of memory::stats ===
+
+inline void memory::stats::charge(const uint32 tag_id, const uint64 size) {
+  // Account the bytes globally and keep the peak up to date
+  const uint64 live =
+      __atomic_add_fetch(&counters.live_bytes, size, __ATOMIC_RELAXED);
+  uint64 peak = __atomic_load_n(&counters.peak_bytes, __ATOMIC_RELAXED);
+  while (live > peak &&
+         !__atomic_compare_exchange_n(&counters.peak_bytes, &peak, live, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+  __atomic_add_fetch(&counters.total_bytes, size, __ATOMIC_RELAXED);
+
+  // Account the bytes to the tag
+  TagStats& tag_stats = counters.tags[tag_id];
+  __atomic_add_fetch(&tag_stats.live_bytes, size, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&tag_stats.total_bytes, size, __ATOMIC_RELAXED);
+
+  // Bucket the size by heap size class
+  const uint32 bucket =
+      size > heap::MAX_SMALL ? BUCKETS - 1 : heap::size_class(size);
+  __atomic_add_fetch(&counters.size_histogram[bucket], 1, __ATOMIC_RELAXED);
+}
+
+inline void memory::stats::credit(const uint32 tag_id, const uint64 size) {
+  __atomic_sub_fetch(&counters.live_bytes, size, __ATOMIC_RELAXED);
+  __atomic_sub_fetch(&counters.tags[tag_id].live_bytes, size,
+                     __ATOMIC_RELAXED);
+}
+
+inline uint32 memory::stats::tag(const char* name) {
+  if constexpr (!ENABLED) {
+    (void)name;
+    return 0;
+  }
+
+  // Spin on the registration lock
+  while (__atomic_exchange_n(&counters.tag_lock, 1, __ATOMIC_ACQUIRE) != 0) {
+  }
+
+  // Reuse an existing slot with the same name
+  uint32 id = 0;
+  for (uint32 i = 1; i < counters.tag_count; i++) {
+    const char* a = counters.tags[i].name;
+    const char* b = name;
+    while (*a != '\0' && *a == *b) {
+      a++;
+      b++;
+    }
+    if (*a == *b) {
+      id = i;
+      break;
+    }
+  }
+
+  // Otherwise claim the next free slot (slot 0 is "untagged")
+  if (id == 0) {
+    if (counters.tag_count == 0) {
+      counters.tags[0].name = "untagged";
+      counters.tag_count = 1;
+    }
+    if (counters.tag_count < MAX_TAGS) {
+      id = counters.tag_count++;
+      counters.tags[id].name = name;
+    }
+  }
+
+  __atomic_store_n(&counters.tag_lock, 0, __ATOMIC_RELEASE);
+  return id;
+}
+
+inline memory::stats::Scope::Scope(const uint32 tag_id)
+    : previous(current_tag) {
+  if constexpr (ENABLED) {
+    current_tag = tag_id < MAX_TAGS ? tag_id : 0;
+  }
+}
+
+inline memory::stats::Scope::~Scope() {
+  if constexpr (ENABLED) {
+    current_tag = this->previous;
+  }
+}
+
+inline void* memory::stats::track(void* raw, const uint64 size) {
+  if (raw == nullptr) {
+    return nullptr;
+  }
+
+  // Stamp the header, then count the allocation
+  BlockHeader* header = static_cast<BlockHeader*>(raw);
+  header->size = size;
+  header->tag = current_tag;
+  __atomic_add_fetch(&counters.allocations, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&counters.tags[header->tag].allocations, 1,
+                     __ATOMIC_RELAXED);
+  charge(header->tag, size);
+  return static_cast<byte*>(raw) + HEADER;
+}
+
+inline void* memory::stats::retrack(void* raw, const uint64 size) {
+  // The header moved with the block: swap the old size for the new one
+  BlockHeader* header = static_cast<BlockHeader*>(raw);
+  credit(header->tag, header->size);
+  header->size = size;
+  charge(header->tag, size);
+  __atomic_add_fetch(&counters.reallocations, 1, __ATOMIC_RELAXED);
+  return static_cast<byte*>(raw) + HEADER;
+}
+
+inline void memory::stats::untrack(void* raw) {
+  const BlockHeader* header = static_cast<const BlockHeader*>(raw);
+  credit(header->tag, header->size);
+  __atomic_add_fetch(&counters.deallocations, 1, __ATOMIC_RELAXED);
+}
+
+inline void* memory::stats::header_of(void* ptr) {
+  return static_cast<byte*>(ptr) - HEADER;
+}
+
+inline void memory::stats::count_container_reallocation(const uint64 bytes) {
+  if constexpr (ENABLED) {
+    (void)bytes;
+    __atomic_add_fetch(&counters.container_reallocations, 1,
+                       __ATOMIC_RELAXED);
+  } else {
+    (void)bytes;
+  }
+}
+
+inline memory::stats::Snapshot memory::stats::snapshot() {
+  Snapshot result = {};
+  if constexpr (!ENABLED) {
+    return result;
+  }
+
+  // Copy the global counters
+  result.allocations = __atomic_load_n(&counters.allocations, __ATOMIC_RELAXED);
+  result.reallocations =
+      __atomic_load_n(&counters.reallocations, __ATOMIC_RELAXED);
+  result.deallocations =
+      __atomic_load_n(&counters.deallocations, __ATOMIC_RELAXED);
+  result.live_bytes = __atomic_load_n(&counters.live_bytes, __ATOMIC_RELAXED);
+  result.peak_bytes = __atomic_load_n(&counters.peak_bytes, __ATOMIC_RELAXED);
+  result.total_bytes = __atomic_load_n(&counters.total_bytes, __ATOMIC_RELAXED);
+  result.container_reallocations =
+      __atomic_load_n(&counters.container_reallocations, __ATOMIC_RELAXED);
+  for (uint32 i = 0; i < BUCKETS; i++) {
+    result.size_histogram[i] =
+        __atomic_load_n(&counters.size_histogram[i], __ATOMIC_RELAXED);
+  }
+
+  // Copy the tag table (untagged allocations appear even if no tag exists)
+  result.tag_count = __atomic_load_n(&counters.tag_count, __ATOMIC_ACQUIRE);
+  if (result.tag_count == 0) {
+    result.tag_count = 1;
+  }
+  for (uint32 i = 0; i < result.tag_count; i++) {
+    const TagStats& source = counters.tags[i];
+    result.tags[i].name = source.name != nullptr ? source.name : "untagged";
+    result.tags[i].allocations =
+        __atomic_load_n(&source.allocations, __ATOMIC_RELAXED);
+    result.tags[i].live_bytes =
+        __atomic_load_n(&source.live_bytes, __ATOMIC_RELAXED);
+    result.tags[i].total_bytes =
+        __atomic_load_n(&source.total_bytes, __ATOMIC_RELAXED);
+  }
+  return result;
+}
+
+inline uint64 memory::stats::dump(char* buffer, const uint64 capacity) {
+  if (capacity == 0) {
+    return 0;
+  }
+  uint64 length = 0;
+
+  // Appends a NUL-terminated string, truncating at the end of the buffer
+  auto text = [&](const char* string) {
+    for (; *string != '\0' && length + 1 < capacity; string++) {
+      buffer[length++] = *string;
+    }
+  };
+
+  // Appends an unsigned decimal number
+  auto number = [&](uint64 value) {
+    char digits[20];
+    uint32 count = 0;
+    do {
+      digits[count++] = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value != 0);
+    while (count > 0 && length + 1 < capacity) {
+      buffer[length++] = digits[--count];
+    }
+  };
+
+  // Totals
+  const Snapshot data = snapshot();
+  text("allocations ");
+  number(data.allocations);
+  text("\nreallocations ");
+  number(data.reallocations);
+  text("\ndeallocations ");
+  number(data.deallocations);
+  text("\ncontainer_reallocations ");
+  number(data.container_reallocations);
+  text("\nlive_bytes ");
+  number(data.live_bytes);
+  text("\npeak_bytes ");
+  number(data.peak_bytes);
+  text("\ntotal_bytes ");
+  number(data.total_bytes);
+  text("\n");
+
+  // Non-empty size buckets
+  for (uint32 i = 0; i < BUCKETS; i++) {
+    if (data.size_histogram[i] == 0) {
+      continue;
+    }
+    text("size<=");
+    if (i + 1 == BUCKETS) {
+      text("large");
+    } else {
+      number(heap::class_size(i));
+    }
+    text(" ");
+    number(data.size_histogram[i]);
+    text("\n");
+  }
+
+  // Tags
+  for (uint32 i = 0; i < data.tag_count; i++) {
+    text("tag ");
+    text(data.tags[i].name);
+    text(" allocations ");
+    number(data.tags[i].allocations);
+    text(" live_bytes ");
+    number(data.tags[i].live_bytes);
+    text(" total_bytes ");
+    number(data.tags[i].total_bytes);
+    text("\n");
+  }
+
+  buffer[length] = '\0';
+  return length;
+}
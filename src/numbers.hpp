@@ -166,4 +166,39 @@ template <typename T>
 concept Integer = isInteger<T>::value;
 
 template <typename T>
-concept FloatingPoint = isFloatingPoint<T>::value;
\ No newline at end of file
+concept FloatingPoint = isFloatingPoint<T>::value;
+
+// === Trivially copyable type trait ===
+
+// @brief Whether objects can be duplicated by copying their bytes, letting
+// containers copy ranges with a single memory::copy.
+template <typename T>
+struct isTriviallyCopyable {
+  static constexpr bool value = __is_trivially_copyable(T);
+};
+
+// === Trivially constructible type trait ===
+
+// @brief Whether default construction does nothing, so value-initializing a
+// range is the same as zeroing its bytes.
+template <typename T>
+struct isTriviallyConstructible {
+  static constexpr bool value = __is_trivially_constructible(T);
+};
+
+// === Trivially relocatable type trait ===
+
+// @brief Whether moving an object to a new address and forgetting the source
+// is equivalent to copying its bytes. Containers keep their memmove/realloc
+// fast path for these types. Defaults to trivially copyable types; specialize
+// for resource-owning types that hold no pointers into themselves.
+template <typename T>
+struct isTriviallyRelocatable {
+  static constexpr bool value = isTriviallyCopyable<T>::value;
+};
+
+template <typename T>
+concept TriviallyRelocatable = isTriviallyRelocatable<T>::value;
+
+#include "numbers/arithmetic.hpp"
+#include "numbers/conversion.hpp"
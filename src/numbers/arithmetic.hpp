@@ -0,0 +1,367 @@
+// @file arithmetic.hpp
+
+#pragma once
+
+#include "../numbers.hpp"
+#include "../utilities/compiler.h"
+#include "../utilities/types.h"
+
+// GCC and Clang report overflow straight from the flags of the add/sub/mul
+// instruction; elsewhere it is derived from the wrapped result.
+#if defined(COMPILER_GCC) || defined(COMPILER_CLANG)
+#define NUMBERS_OVERFLOW_BUILTINS
+#endif
+
+// @brief Integer arithmetic with explicit overflow behaviour: checked_*
+// reports it, saturating_* clamps to limits<T> and wrapping_* wraps around
+// modulo 2^bits. None of them ever invoke undefined behaviour.
+namespace numbers {
+
+// === Checked arithmetic (Declaration) ===
+
+// @brief Adds two integers, reporting overflow.
+// @param a The first operand.
+// @param b The second operand.
+// @param result Receives the sum, wrapped around if it overflowed.
+// @return false if the sum does not fit in T.
+template <Integer T>
+bool checked_add(const T a, const T b, T& result);
+
+// @brief Subtracts two integers, reporting overflow.
+// @param a The first operand.
+// @param b The operand subtracted from a.
+// @param result Receives the difference, wrapped around if it overflowed.
+// @return false if the difference does not fit in T.
+template <Integer T>
+bool checked_sub(const T a, const T b, T& result);
+
+// @brief Multiplies two integers, reporting overflow.
+// @param a The first operand.
+// @param b The second operand.
+// @param result Receives the product, wrapped around if it overflowed.
+// @return false if the product does not fit in T.
+template <Integer T>
+bool checked_mul(const T a, const T b, T& result);
+
+// @brief Converts an integer to another integer type, reporting values the
+// target cannot represent.
+// @param value The integer.
+// @param result Receives the converted value, wrapped around if it did not
+// fit.
+// @return false if value is out of the range of To.
+template <Integer To, Integer From>
+bool checked_cast(const From value, To& result);
+
+// === Saturating arithmetic (Declaration) ===
+
+// @brief Adds two integers, clamping the sum to limits<T>. Branchless.
+// @param a The first operand.
+// @param b The second operand.
+// @return The sum, or limits<T>::min / limits<T>::max on overflow.
+template <Integer T>
+T saturating_add(const T a, const T b);
+
+// @brief Subtracts two integers, clamping the difference to limits<T>.
+// Branchless.
+// @param a The first operand.
+// @param b The operand subtracted from a.
+// @return The difference, or limits<T>::min / limits<T>::max on overflow.
+template <Integer T>
+T saturating_sub(const T a, const T b);
+
+// @brief Multiplies two integers, clamping the product to limits<T>.
+// @param a The first operand.
+// @param b The second operand.
+// @return The product, or limits<T>::min / limits<T>::max on overflow.
+template <Integer T>
+T saturating_mul(const T a, const T b);
+
+// @brief Converts an integer to another integer type, clamping it to the
+// range of the target.
+// @param value The integer.
+// @return value, or limits<To>::min / limits<To>::max if it does not fit.
+template <Integer To, Integer From>
+To saturating_cast(const From value);
+
+// @brief Adds others[i] to values[i] for every i, clamping each sum. The
+// loop has no branches, so the compiler vectorizes it (paddsw and friends
+// on x86 for 8 and 16 bit types).
+// @param values The accumulators, updated in place.
+// @param others The amounts to add.
+// @param count The number of elements in both ranges.
+template <Integer T>
+void saturating_add(T* values, const T* others, const uint64 count);
+
+// @brief Subtracts others[i] from values[i] for every i, clamping each
+// difference. Vectorized like saturating_add.
+// @param values The accumulators, updated in place.
+// @param others The amounts to subtract.
+// @param count The number of elements in both ranges.
+template <Integer T>
+void saturating_sub(T* values, const T* others, const uint64 count);
+
+// === Wrapping arithmetic (Declaration) ===
+
+// @brief Adds two integers modulo 2^bits.
+// @param a The first operand.
+// @param b The second operand.
+// @return The wrapped sum.
+template <Integer T>
+T wrapping_add(const T a, const T b);
+
+// @brief Subtracts two integers modulo 2^bits.
+// @param a The first operand.
+// @param b The operand subtracted from a.
+// @return The wrapped difference.
+template <Integer T>
+T wrapping_sub(const T a, const T b);
+
+// @brief Multiplies two integers modulo 2^bits.
+// @param a The first operand.
+// @param b The second operand.
+// @return The wrapped product.
+template <Integer T>
+T wrapping_mul(const T a, const T b);
+
+// === Building blocks (Declaration) ===
+
+// @brief The unsigned integer type with the same width as T.
+template <typename T>
+struct makeUnsigned;
+
+template <>
+struct makeUnsigned<int8> {
+  using type = uint8;
+};
+
+template <>
+struct makeUnsigned<int16> {
+  using type = uint16;
+};
+
+template <>
+struct makeUnsigned<int32> {
+  using type = uint32;
+};
+
+template <>
+struct makeUnsigned<int64> {
+  using type = uint64;
+};
+
+template <>
+struct makeUnsigned<uint8> {
+  using type = uint8;
+};
+
+template <>
+struct makeUnsigned<uint16> {
+  using type = uint16;
+};
+
+template <>
+struct makeUnsigned<uint32> {
+  using type = uint32;
+};
+
+template <>
+struct makeUnsigned<uint64> {
+  using type = uint64;
+};
+
+// @brief Returns the value a saturating operation clamps to when its result
+// overflows: limits<T>::min when the exact result is negative, else max.
+// @param negative Whether the exact result is below zero.
+// @return The bound.
+template <Integer T>
+T saturation_bound(const bool negative);
+
+}  // namespace numbers
+
+// === Implementation of checked arithmetic ===
+
+template <Integer T>
+inline bool numbers::checked_add(const T a, const T b, T& result) {
+#ifdef NUMBERS_OVERFLOW_BUILTINS
+  return !__builtin_add_overflow(a, b, &result);
+#else
+  result = wrapping_add(a, b);
+  if constexpr (isSigned<T>::value) {
+    // Overflow flips the sign away from two operands that agree
+    return ((a ^ result) & (b ^ result)) >= 0;
+  } else {
+    return result >= a;
+  }
+#endif
+}
+
+template <Integer T>
+inline bool numbers::checked_sub(const T a, const T b, T& result) {
+#ifdef NUMBERS_OVERFLOW_BUILTINS
+  return !__builtin_sub_overflow(a, b, &result);
+#else
+  result = wrapping_sub(a, b);
+  if constexpr (isSigned<T>::value) {
+    // Only operands of different signs can overflow, away from a's sign
+    return ((a ^ b) & (a ^ result)) >= 0;
+  } else {
+    return a >= b;
+  }
+#endif
+}
+
+template <Integer T>
+inline bool numbers::checked_mul(const T a, const T b, T& result) {
+#ifdef NUMBERS_OVERFLOW_BUILTINS
+  return !__builtin_mul_overflow(a, b, &result);
+#else
+  result = wrapping_mul(a, b);
+  if constexpr (sizeof(T) < sizeof(int64)) {
+    // The exact product fits in 64 bits; compare it with the wrapped one
+    if constexpr (isSigned<T>::value) {
+      return static_cast<int64>(a) * b == result;
+    } else {
+      return static_cast<uint64>(a) * b == result;
+    }
+  } else if constexpr (isSigned<T>::value) {
+    // -1 * min is the one product that overflows the division check too
+    if ((a == -1 && b == limits<T>::min) || (b == -1 && a == limits<T>::min)) {
+      return false;
+    }
+    return a == 0 || result / a == b;
+  } else {
+    return a == 0 || result / a == b;
+  }
+#endif
+}
+
+template <Integer To, Integer From>
+inline bool numbers::checked_cast(const From value, To& result) {
+  result = static_cast<To>(value);
+
+  // A value fits if it survives the round trip without changing sign
+  if (static_cast<From>(result) != value) {
+    return false;
+  }
+  if constexpr (isSigned<From>::value && !isSigned<To>::value) {
+    return value >= 0;
+  } else if constexpr (!isSigned<From>::value && isSigned<To>::value) {
+    return result >= 0;
+  } else {
+    return true;
+  }
+}
+
+// === Implementation of saturating arithmetic ===
+
+template <Integer T>
+inline T numbers::saturating_add(const T a, const T b) {
+  using U = typename makeUnsigned<T>::type;
+  constexpr uint32 SIGN = sizeof(T) * 8 - 1;
+  const U sum = static_cast<U>(static_cast<U>(a) + static_cast<U>(b));
+
+  if constexpr (isSigned<T>::value) {
+    // Overflow flips the sign away from two operands that agree; the bound
+    // then follows a's sign. Selects instead of branches so loops vectorize
+    const U flipped = static_cast<U>((static_cast<U>(a) ^ sum) &
+                                     (static_cast<U>(b) ^ sum));
+    const U bound = static_cast<U>((static_cast<U>(a) >> SIGN) +
+                                   static_cast<U>(limits<T>::max));
+    return static_cast<T>((flipped >> SIGN) != 0 ? bound : sum);
+  } else {
+    // A wrapped sum is smaller than either operand
+    return static_cast<T>(sum < a ? limits<T>::max : sum);
+  }
+}
+
+template <Integer T>
+inline T numbers::saturating_sub(const T a, const T b) {
+  using U = typename makeUnsigned<T>::type;
+  constexpr uint32 SIGN = sizeof(T) * 8 - 1;
+  const U difference = static_cast<U>(static_cast<U>(a) - static_cast<U>(b));
+
+  if constexpr (isSigned<T>::value) {
+    // Only operands of different signs can overflow, away from a's sign
+    const U flipped = static_cast<U>((static_cast<U>(a) ^ static_cast<U>(b)) &
+                                     (static_cast<U>(a) ^ difference));
+    const U bound = static_cast<U>((static_cast<U>(a) >> SIGN) +
+                                   static_cast<U>(limits<T>::max));
+    return static_cast<T>((flipped >> SIGN) != 0 ? bound : difference);
+  } else {
+    return static_cast<T>(a < b ? 0 : difference);
+  }
+}
+
+template <Integer T>
+inline T numbers::saturating_mul(const T a, const T b) {
+  T product;
+  if (checked_mul(a, b, product)) {
+    return product;
+  }
+  if constexpr (isSigned<T>::value) {
+    return saturation_bound<T>((a < 0) != (b < 0));
+  } else {
+    return limits<T>::max;
+  }
+}
+
+template <Integer To, Integer From>
+inline To numbers::saturating_cast(const From value) {
+  To result;
+  if (checked_cast(value, result)) {
+    return result;
+  }
+  if constexpr (isSigned<From>::value) {
+    return saturation_bound<To>(value < 0);
+  } else {
+    return limits<To>::max;
+  }
+}
+
+template <Integer T>
+inline void numbers::saturating_add(T* values, const T* others,
+                                    const uint64 count) {
+  for (uint64 i = 0; i < count; i++) {
+    values[i] = saturating_add(values[i], others[i]);
+  }
+}
+
+template <Integer T>
+inline void numbers::saturating_sub(T* values, const T* others,
+                                    const uint64 count) {
+  for (uint64 i = 0; i < count; i++) {
+    values[i] = saturating_sub(values[i], others[i]);
+  }
+}
+
+// === Implementation of wrapping arithmetic ===
+
+// Unsigned arithmetic is modular, and C++20 defines the conversion back to
+// a signed type as modular too. Going through uint64 keeps uint8/uint16
+// operands from being promoted to int, where a product could overflow.
+
+template <Integer T>
+inline T numbers::wrapping_add(const T a, const T b) {
+  return static_cast<T>(static_cast<uint64>(a) + static_cast<uint64>(b));
+}
+
+template <Integer T>
+inline T numbers::wrapping_sub(const T a, const T b) {
+  return static_cast<T>(static_cast<uint64>(a) - static_cast<uint64>(b));
+}
+
+template <Integer T>
+inline T numbers::wrapping_mul(const T a, const T b) {
+  return static_cast<T>(static_cast<uint64>(a) * static_cast<uint64>(b));
+}
+
+// === Implementation of building blocks ===
+
+template <Integer T>
+inline T numbers::saturation_bound(const bool negative) {
+  if constexpr (isSigned<T>::value) {
+    return negative ? limits<T>::min : limits<T>::max;
+  } else {
+    return negative ? T(0) : limits<T>::max;
+  }
+}
@@ -0,0 +1,1054 @@
+// @file conversion.hpp
+
+#pragma once
+
+#include "../numbers.hpp"
+#include "../utilities/types.h"
+#include "powers.hpp"
+
+// Eight digits are validated and converted at once by loading them into one
+// 64-bit word (SWAR), which assumes little-endian byte order.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define NUMBERS_SWAR
+#endif
+
+// @brief The status codes for parsing numbers.
+enum class ParseStatus : int8 {
+  OK = 1,
+  INVALID_ERROR = 0,
+  OVERFLOW_ERROR = -1,
+};
+
+// @brief Conversions between numbers and decimal text. Nothing allocates and
+// nothing depends on the C library, so they work in freestanding builds.
+namespace numbers {
+
+// === Conversions (Declaration) ===
+
+// @brief Enough characters for any number formatted by to_string.
+inline constexpr uint32 MAX_CHARS = 32;
+
+// @brief Formats an integer in decimal.
+// @param value The integer.
+// @param out Receives the characters (not NUL-terminated); MAX_CHARS always
+// suffice.
+// @return The number of characters written.
+template <Integer T>
+uint32 to_string(const T value, char* out);
+
+// @brief Formats a floating point number so that it parses back to the same
+// value, with the fewest digits in all but about 0.1% of cases (Grisu2 may
+// emit one digit more than needed). Like JavaScript, fixed notation is used
+// for decimal exponents in [-7, 21) and d.ddde+X otherwise; special values are
+// written nan, inf and -inf.
+// @param value The number.
+// @param out Receives the characters (not NUL-terminated); MAX_CHARS always
+// suffice.
+// @return The number of characters written.
+template <FloatingPoint T>
+uint32 to_string(const T value, char* out);
+
+// @brief Parses a whole string as a decimal integer with an optional sign.
+// @param text The characters.
+// @param length The number of characters.
+// @param value Receives the integer (clamped to limits<T> on overflow).
+// @return OK, INVALID_ERROR (not a number, or trailing characters) or
+// OVERFLOW_ERROR.
+template <Integer T>
+ParseStatus from_string(const char* text, const uint64 length, T& value);
+
+// @brief Parses the longest prefix that is a decimal integer.
+// @param text The characters.
+// @param length The number of characters.
+// @param value Receives the integer (clamped to limits<T> on overflow).
+// @param consumed Receives the length of the prefix (0 if invalid).
+// @return OK, INVALID_ERROR or OVERFLOW_ERROR.
+template <Integer T>
+ParseStatus from_string(const char* text, const uint64 length, T& value,
+                        uint64& consumed);
+
+// @brief Parses a whole string as a floating point number: an optional sign,
+// digits with an optional point, an optional exponent, or inf, infinity, nan
+// in any case. The result is correctly rounded.
+// @param text The characters.
+// @param length The number of characters.
+// @param value Receives the number (infinite on overflow).
+// @return OK, INVALID_ERROR (not a number, or trailing characters) or
+// OVERFLOW_ERROR.
+template <FloatingPoint T>
+ParseStatus from_string(const char* text, const uint64 length, T& value);
+
+// @brief Parses the longest prefix that is a floating point number.
+// @param text The characters.
+// @param length The number of characters.
+// @param value Receives the number (infinite on overflow).
+// @param consumed Receives the length of the prefix (0 if invalid).
+// @return OK, INVALID_ERROR or OVERFLOW_ERROR.
+template <FloatingPoint T>
+ParseStatus from_string(const char* text, const uint64 length, T& value,
+                        uint64& consumed);
+
+// === Building blocks (Declaration) ===
+
+// @brief The powers of ten that fit in 64 bits.
+inline constexpr uint64 POWERS_OF_TEN[20] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+// @brief "00" to "99", so two digits cost one division and one copy.
+inline constexpr char DIGIT_PAIRS[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536"
+    "37383940414243444546474849505152535455565758596061626364656667686970717273"
+    "7475767778798081828384858687888990919293949596979899";
+
+// @brief Returns the number of decimal digits of a value without a loop:
+// log2 from the leading zero count, times log10(2) ~= 1233/4096, corrected
+// with one comparison.
+// @param value The value.
+// @return The digit count (1 for zero).
+uint32 digit_count(const uint64 value);
+
+// @brief Writes exactly count digits of a value, two at a time from the
+// right, padding with leading zeros.
+// @param value The value (below 10^count).
+// @param count The number of digits.
+// @param out Receives the digits.
+void write_digits(uint64 value, const uint32 count, char* out);
+
+// @brief Checks that eight characters are digits and converts them with
+// three multiplications.
+// @param text The characters (eight readable bytes).
+// @param value Receives the number.
+// @return false if a character is not a digit.
+bool parse_eight_digits(const char* text, uint32& value);
+
+// @brief Multiplies two 64-bit values into 128 bits.
+// @param a The first factor.
+// @param b The second factor.
+// @param high Receives the upper 64 bits.
+// @return The lower 64 bits.
+uint64 multiply(const uint64 a, const uint64 b, uint64& high);
+
+// @brief The IEEE-754 layout of a floating point type.
+template <typename T>
+struct FloatLayout;
+
+template <>
+struct FloatLayout<float64> {
+  using Bits = uint64;
+  static constexpr int32 MANTISSA = 52;
+  static constexpr int32 EXPONENT = 11;
+  static constexpr int32 BIAS = -1023;
+  // @brief 10^k is exact for k up to this, and so are integers below 10^15.
+  static constexpr int32 EXACT_POWER = 22;
+  static constexpr int32 EXACT_DIGITS = 15;
+};
+
+template <>
+struct FloatLayout<float32> {
+  using Bits = uint32;
+  static constexpr int32 MANTISSA = 23;
+  static constexpr int32 EXPONENT = 8;
+  static constexpr int32 BIAS = -127;
+  static constexpr int32 EXACT_POWER = 10;
+  static constexpr int32 EXACT_DIGITS = 7;
+};
+
+// @brief The powers of ten exactly representable as float64.
+inline constexpr float64 EXACT_POWERS[23] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// @brief A "do it yourself" float: significand * 2^exponent with a full
+// 64-bit significand, as used by Grisu.
+struct DiyFp {
+  uint64 significand;
+  int32 exponent;
+};
+
+// @brief Generates the shortest digits of a positive finite value (Grisu2).
+// @param bits The bits of the value.
+// @param digits Receives at most 17 digits (no point, no sign).
+// @param count Receives the number of digits.
+// @param exponent Receives the decimal exponent: value = digits * 10^exponent.
+template <FloatingPoint T>
+void grisu(const typename FloatLayout<T>::Bits bits, char* digits,
+           uint32& count, int32& exponent);
+
+// @brief Converts mantissa * 10^exponent when both are exact in T, so one
+// correctly rounded multiplication or division gives the answer.
+// @param mantissa The decimal significand.
+// @param exponent The decimal exponent.
+// @param result Receives the value.
+// @return false if the fast path does not apply.
+template <FloatingPoint T>
+bool parse_exact(const uint64 mantissa, const int64 exponent, T& result);
+
+// @brief Converts mantissa * 10^exponent with one 128-bit multiplication by a
+// truncated power of ten (Eisel-Lemire).
+// @param mantissa The decimal significand (not zero).
+// @param exponent The decimal exponent.
+// @param bits Receives the bits of the positive result.
+// @return false when the result cannot be decided this way (halfway cases,
+// subnormals, overflow); the caller falls back to parse_slow.
+template <FloatingPoint T>
+bool eisel_lemire(uint64 mantissa, const int64 exponent,
+                  typename FloatLayout<T>::Bits& bits);
+
+// @brief Converts an already validated decimal string with arbitrary
+// precision arithmetic on its digits. Correct for every input; only used
+// when the fast paths cannot decide.
+// @param text The characters of the number (no sign).
+// @param length The number of characters.
+// @param overflow Set if the value is too large for T.
+// @return The bits of the positive result.
+template <FloatingPoint T>
+typename FloatLayout<T>::Bits parse_slow(const char* text,
+                                         const uint64 length, bool& overflow);
+
+}  // namespace numbers
+
+// === Implementation of numbers building blocks ===
+
+inline uint32 numbers::digit_count(const uint64 value) {
+  // value | 1 has the same digit count and a defined leading zero count
+  const uint64 nonzero = value | 1;
+  const uint32 bits = 64 - static_cast<uint32>(__builtin_clzll(nonzero));
+  const uint32 guess = (bits * 1233) >> 12;
+  return guess + 1 - (nonzero < POWERS_OF_TEN[guess] ? 1 : 0);
+}
+
+inline void numbers::write_digits(uint64 value, const uint32 count,
+                                  char* out) {
+  char* end = out + count;
+  while (end - out >= 2) {
+    const uint64 pair = (value % 100) * 2;
+    value /= 100;
+    end -= 2;
+    end[0] = DIGIT_PAIRS[pair];
+    end[1] = DIGIT_PAIRS[pair + 1];
+  }
+  if (end != out) {
+    *out = static_cast<char>('0' + value % 10);
+  }
+}
+
+inline bool numbers::parse_eight_digits(const char* text, uint32& value) {
+#ifdef NUMBERS_SWAR
+  uint64 chunk;
+  __builtin_memcpy(&chunk, text, 8);
+
+  // Every byte is a digit iff its high nibble is 3 and adding 6 keeps it 3
+  if (((chunk & 0xF0F0F0F0F0F0F0F0) |
+       (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) !=
+      0x3333333333333333) {
+    return false;
+  }
+
+  // Combine neighbours into pairs, then pairs into quads, then the halves
+  chunk -= 0x3030303030303030;
+  chunk = (chunk * 10) + (chunk >> 8);
+  chunk = (((chunk & 0x000000FF000000FF) * 0x000F424000000064) +
+           (((chunk >> 16) & 0x000000FF000000FF) * 0x0000271000000001)) >>
+          32;
+  value = static_cast<uint32>(chunk);
+  return true;
+#else
+  uint32 result = 0;
+  for (uint32 i = 0; i < 8; i++) {
+    if (text[i] < '0' || text[i] > '9') {
+      return false;
+    }
+    result = result * 10 + static_cast<uint32>(text[i] - '0');
+  }
+  value = result;
+  return true;
+#endif
+}
+
+inline uint64 numbers::multiply(const uint64 a, const uint64 b,
+                                uint64& high) {
+#if defined(__SIZEOF_INT128__)
+  __extension__ typedef unsigned __int128 uint128;
+  const uint128 product = static_cast<uint128>(a) * b;
+  high = static_cast<uint64>(product >> 64);
+  return static_cast<uint64>(product);
+#else
+  // Schoolbook multiplication on 32-bit halves
+  const uint64 a_low = a & 0xFFFFFFFF;
+  const uint64 a_high = a >> 32;
+  const uint64 b_low = b & 0xFFFFFFFF;
+  const uint64 b_high = b >> 32;
+  const uint64 low_low = a_low * b_low;
+  const uint64 low_high = a_low * b_high;
+  const uint64 high_low = a_high * b_low;
+  const uint64 middle =
+      (low_low >> 32) + (low_high & 0xFFFFFFFF) + (high_low & 0xFFFFFFFF);
+  high = a_high * b_high + (low_high >> 32) + (high_low >> 32) +
+         (middle >> 32);
+  return (middle << 32) | (low_low & 0xFFFFFFFF);
+#endif
+}
+
+template <FloatingPoint T>
+inline void numbers::grisu(const typename FloatLayout<T>::Bits bits,
+                           char* digits, uint32& count, int32& exponent) {
+  using Layout = FloatLayout<T>;
+  constexpr uint64 HIDDEN = uint64(1) << Layout::MANTISSA;
+  constexpr int32 SHIFT = -Layout::BIAS + Layout::MANTISSA;
+
+  // Decode the value and the midpoints to its neighbours, m- and m+
+  const uint64 fraction = bits & (HIDDEN - 1);
+  const int32 biased = static_cast<int32>(bits >> Layout::MANTISSA);
+  DiyFp value = biased == 0 ? DiyFp{fraction, 1 - SHIFT}
+                            : DiyFp{fraction + HIDDEN, biased - SHIFT};
+  const bool lower_closer = fraction == 0 && biased > 1;
+  DiyFp plus = {2 * value.significand + 1, value.exponent - 1};
+  DiyFp minus = lower_closer
+                    ? DiyFp{4 * value.significand - 1, value.exponent - 2}
+                    : DiyFp{2 * value.significand - 1, value.exponent - 1};
+
+  // Normalize m+ and v; m- shares the exponent of m+
+  const int32 plus_shift = __builtin_clzll(plus.significand);
+  plus = {plus.significand << plus_shift, plus.exponent - plus_shift};
+  minus = {minus.significand << (minus.exponent - plus.exponent),
+           plus.exponent};
+  const int32 value_shift = __builtin_clzll(value.significand);
+  value = {value.significand << value_shift, value.exponent - value_shift};
+
+  // Pick the cached 10^-k that scales m+ into binary exponents [-60, -32]
+  const int32 target = -60 - plus.exponent - 1;
+  const int32 k = (target * 78913) / (1 << 18) + (target > 0 ? 1 : 0);
+  const powers::Cached& cached =
+      powers::CACHED[(-powers::CACHED_MIN + k + (powers::CACHED_STEP - 1)) /
+                     powers::CACHED_STEP];
+  const DiyFp power = {cached.significand, cached.binary_exponent};
+  auto scale = [&power](const DiyFp x) {
+    uint64 high;
+    const uint64 low = multiply(x.significand, power.significand, high);
+    return DiyFp{high + (low >> 63), x.exponent + power.exponent + 64};
+  };
+  const DiyFp scaled = scale(value);
+  DiyFp upper = scale(plus);
+  DiyFp lower = scale(minus);
+  lower.significand++;
+  upper.significand--;
+  exponent = -cached.decimal_exponent;
+
+  // Split the scaled m+ into integral and fractional parts
+  uint64 delta = upper.significand - lower.significand;
+  uint64 distance = upper.significand - scaled.significand;
+  const int32 shift = -upper.exponent;
+  const uint64 one = uint64(1) << shift;
+  uint32 integral = static_cast<uint32>(upper.significand >> shift);
+  uint64 fractional = upper.significand & (one - 1);
+
+  // Emit digits until the remainder fits in the rounding interval, then
+  // nudge the last digit towards the exact value (grisu2_round)
+  auto nudge = [&digits, &count](const uint64 dist, const uint64 range,
+                                 uint64 rest, const uint64 ten) {
+    while (rest < dist && range - rest >= ten &&
+           (rest + ten < dist || dist - rest > rest + ten - dist)) {
+      digits[count - 1]--;
+      rest += ten;
+    }
+  };
+  count = 0;
+  uint32 remaining = digit_count(integral);
+  uint32 divisor = static_cast<uint32>(POWERS_OF_TEN[remaining - 1]);
+  while (remaining > 0) {
+    digits[count++] = static_cast<char>('0' + integral / divisor);
+    integral %= divisor;
+    remaining--;
+    const uint64 rest = (static_cast<uint64>(integral) << shift) + fractional;
+    if (rest <= delta) {
+      exponent += static_cast<int32>(remaining);
+      nudge(distance, delta, rest, static_cast<uint64>(divisor) << shift);
+      return;
+    }
+    divisor /= 10;
+  }
+  int32 fraction_digits = 0;
+  for (;;) {
+    fractional *= 10;
+    digits[count++] = static_cast<char>('0' + (fractional >> shift));
+    fractional &= one - 1;
+    fraction_digits++;
+    delta *= 10;
+    distance *= 10;
+    if (fractional <= delta) {
+      break;
+    }
+  }
+  exponent -= fraction_digits;
+  nudge(distance, delta, fractional, one);
+}
+
+template <FloatingPoint T>
+inline bool numbers::parse_exact(const uint64 mantissa, const int64 exponent,
+                                 T& result) {
+  using Layout = FloatLayout<T>;
+  if ((mantissa >> Layout::MANTISSA) != 0) {
+    return false;
+  }
+  T number = static_cast<T>(mantissa);
+  if (exponent == 0) {
+    result = number;
+    return true;
+  }
+  if (exponent > 0 && exponent <= Layout::EXACT_DIGITS + Layout::EXACT_POWER) {
+    // Move surplus zeros into the integer while it stays exact
+    int64 power = exponent;
+    if (power > Layout::EXACT_POWER) {
+      number *= static_cast<T>(EXACT_POWERS[power - Layout::EXACT_POWER]);
+      power = Layout::EXACT_POWER;
+    }
+    if (number > static_cast<T>(EXACT_POWERS[Layout::EXACT_DIGITS])) {
+      return false;
+    }
+    result = number * static_cast<T>(EXACT_POWERS[power]);
+    return true;
+  }
+  if (exponent < 0 && exponent >= -Layout::EXACT_POWER) {
+    result = number / static_cast<T>(EXACT_POWERS[-exponent]);
+    return true;
+  }
+  return false;
+}
+
+template <FloatingPoint T>
+inline bool numbers::eisel_lemire(uint64 mantissa, const int64 exponent,
+                                  typename FloatLayout<T>::Bits& bits) {
+  using Layout = FloatLayout<T>;
+  using Bits = typename FloatLayout<T>::Bits;
+  if (exponent < powers::DETAILED_MIN || exponent > powers::DETAILED_MAX) {
+    return false;
+  }
+
+  // Normalize; log2(10) ~= 217706/65536 estimates the binary exponent
+  const int32 zeros = __builtin_clzll(mantissa);
+  mantissa <<= zeros;
+  uint64 binary = static_cast<uint64>(
+      ((217706 * static_cast<int32>(exponent)) >> 16) + 64 - Layout::BIAS -
+      zeros);
+
+  // Multiply by the truncated power; widen to 192 bits if the discarded
+  // low bits could still carry into the result
+  constexpr int32 SURPLUS = 64 - Layout::MANTISSA - 3;
+  constexpr uint64 MASK = (uint64(1) << SURPLUS) - 1;
+  const uint64* power = powers::DETAILED[exponent - powers::DETAILED_MIN];
+  uint64 high;
+  uint64 low = multiply(mantissa, power[1], high);
+  if ((high & MASK) == MASK && low + mantissa < mantissa) {
+    uint64 extra_high;
+    const uint64 extra_low = multiply(mantissa, power[0], extra_high);
+    uint64 merged_high = high;
+    const uint64 merged_low = low + extra_high;
+    if (merged_low < low) {
+      merged_high++;
+    }
+    if ((merged_high & MASK) == MASK && merged_low + 1 == 0 &&
+        extra_low + mantissa < mantissa) {
+      return false;
+    }
+    high = merged_high;
+    low = merged_low;
+  }
+
+  // Keep MANTISSA + 2 bits, refuse exact halfway cases, round to even
+  const uint64 top = high >> 63;
+  uint64 result = high >> (top + SURPLUS);
+  binary -= 1 ^ top;
+  if (low == 0 && (high & MASK) == 0 && (result & 3) == 1) {
+    return false;
+  }
+  result += result & 1;
+  result >>= 1;
+  if ((result >> (Layout::MANTISSA + 1)) > 0) {
+    result >>= 1;
+    binary++;
+  }
+
+  // Subnormal, infinite and NaN results are left to the slow path
+  constexpr uint64 MAX_BINARY = (uint64(1) << Layout::EXPONENT) - 1;
+  if (binary - 1 >= MAX_BINARY - 1) {
+    return false;
+  }
+  bits = static_cast<Bits>(
+      (binary << Layout::MANTISSA) |
+      (result & ((uint64(1) << Layout::MANTISSA) - 1)));
+  return true;
+}
+
+template <FloatingPoint T>
+inline typename numbers::FloatLayout<T>::Bits numbers::parse_slow(
+    const char* text, const uint64 length, bool& overflow) {
+  using Layout = FloatLayout<T>;
+  using Bits = typename FloatLayout<T>::Bits;
+
+  // A decimal 0.d1d2d3... * 10^point with up to CAPACITY digits; truncated
+  // records that non-zero digits were dropped beyond them
+  constexpr int32 CAPACITY = 800;
+  struct Decimal {
+    uint8 digits[CAPACITY + 24];
+    int32 count;
+    int32 point;
+    bool truncated;
+  } decimal;
+  decimal.count = 0;
+  decimal.point = 0;
+  decimal.truncated = false;
+  overflow = false;
+
+  // Load the digits (the syntax was checked by the caller)
+  uint64 i = 0;
+  bool dot = false;
+  for (; i < length; i++) {
+    const char c = text[i];
+    if (c == '.') {
+      dot = true;
+      decimal.point = decimal.count;
+      continue;
+    }
+    if (c < '0' || c > '9') {
+      break;
+    }
+    if (c == '0' && decimal.count == 0) {
+      decimal.point--;
+      continue;
+    }
+    if (decimal.count < CAPACITY) {
+      decimal.digits[decimal.count++] = static_cast<uint8>(c - '0');
+    } else if (c != '0') {
+      decimal.truncated = true;
+    }
+  }
+  if (!dot) {
+    decimal.point = decimal.count;
+  }
+  if (i < length) {
+    // The exponent, capped well beyond any representable value
+    i++;
+    bool negative = false;
+    if (text[i] == '+' || text[i] == '-') {
+      negative = text[i] == '-';
+      i++;
+    }
+    int32 value = 0;
+    for (; i < length && text[i] >= '0' && text[i] <= '9'; i++) {
+      if (value < 10000) {
+        value = value * 10 + (text[i] - '0');
+      }
+    }
+    decimal.point += negative ? -value : value;
+  }
+
+  auto trim = [&decimal]() {
+    while (decimal.count > 0 && decimal.digits[decimal.count - 1] == 0) {
+      decimal.count--;
+    }
+    if (decimal.count == 0) {
+      decimal.point = 0;
+    }
+  };
+  trim();
+
+  // Multiply or divide by 2^k, k <= 60 so digit * 2^k fits in 64 bits
+  auto shift_right = [&decimal, &trim](const uint32 k) {
+    int32 read = 0;
+    int32 write = 0;
+    uint64 n = 0;
+    for (; (n >> k) == 0; read++) {
+      if (read >= decimal.count) {
+        if (n == 0) {
+          decimal.count = 0;
+          return;
+        }
+        while ((n >> k) == 0) {
+          n *= 10;
+          read++;
+        }
+        break;
+      }
+      n = n * 10 + decimal.digits[read];
+    }
+    decimal.point -= read - 1;
+    const uint64 mask = (uint64(1) << k) - 1;
+    for (; read < decimal.count; read++) {
+      const uint64 digit = n >> k;
+      n &= mask;
+      decimal.digits[write++] = static_cast<uint8>(digit);
+      n = n * 10 + decimal.digits[read];
+    }
+    while (n > 0) {
+      const uint64 digit = n >> k;
+      n &= mask;
+      if (write < CAPACITY) {
+        decimal.digits[write++] = static_cast<uint8>(digit);
+      } else if (digit > 0) {
+        decimal.truncated = true;
+      }
+      n *= 10;
+    }
+    decimal.count = write;
+    trim();
+  };
+  auto shift_left = [&decimal, &trim](const uint32 k) {
+    // Write from the right into the slack, at most k / 3 + 1 new digits
+    const int32 grown = static_cast<int32>(k / 3 + 1);
+    int32 write = decimal.count + grown;
+    uint64 n = 0;
+    for (int32 read = decimal.count - 1; read >= 0; read--) {
+      n += static_cast<uint64>(decimal.digits[read]) << k;
+      decimal.digits[--write] = static_cast<uint8>(n % 10);
+      n /= 10;
+    }
+    while (n > 0) {
+      decimal.digits[--write] = static_cast<uint8>(n % 10);
+      n /= 10;
+    }
+
+    // Slide the digits back to the front and drop what does not fit
+    int32 count = decimal.count + grown - write;
+    for (int32 j = 0; j < count; j++) {
+      decimal.digits[j] = decimal.digits[write + j];
+    }
+    decimal.point += grown - write;
+    if (count > CAPACITY) {
+      for (int32 j = CAPACITY; j < count; j++) {
+        decimal.truncated |= decimal.digits[j] != 0;
+      }
+      count = CAPACITY;
+    }
+    decimal.count = count;
+    trim();
+  };
+  auto shift = [&decimal, &shift_left, &shift_right](int32 k) {
+    if (decimal.count == 0) {
+      return;
+    }
+    for (; k > 60; k -= 60) {
+      shift_left(60);
+    }
+    for (; k < -60; k += 60) {
+      shift_right(60);
+    }
+    if (k > 0) {
+      shift_left(static_cast<uint32>(k));
+    } else if (k < 0) {
+      shift_right(static_cast<uint32>(-k));
+    }
+  };
+
+  // Go's strconv floatBits: scale into [0.5, 1) by powers of two, then take
+  // MANTISSA + 1 bits rounded to even
+  constexpr int32 MAX_BIASED = (1 << Layout::EXPONENT) - 1;
+  constexpr int32 STEPS[9] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+  int32 binary = 0;
+  uint64 mantissa = 0;
+  if (decimal.count == 0 || decimal.point < -330) {
+    binary = Layout::BIAS;
+  } else if (decimal.point > 310) {
+    overflow = true;
+  } else {
+    while (decimal.point > 0) {
+      const int32 n = decimal.point >= 9 ? 27 : STEPS[decimal.point];
+      shift(-n);
+      binary += n;
+    }
+    while (decimal.point < 0 ||
+           (decimal.point == 0 && decimal.count > 0 && decimal.digits[0] < 5)) {
+      const int32 n = -decimal.point >= 9 ? 27 : STEPS[-decimal.point];
+      shift(n);
+      binary -= n;
+    }
+    binary--;
+
+    // Denormals keep the minimum exponent and lose precision instead
+    if (binary < Layout::BIAS + 1) {
+      const int32 n = Layout::BIAS + 1 - binary;
+      shift(-n);
+      binary += n;
+    }
+    if (binary - Layout::BIAS >= MAX_BIASED) {
+      overflow = true;
+    } else {
+      shift(Layout::MANTISSA + 1);
+
+      // Round the integer part, halfway cases to even
+      int32 j = 0;
+      for (; j < decimal.point && j < decimal.count; j++) {
+        mantissa = mantissa * 10 + decimal.digits[j];
+      }
+      for (; j < decimal.point; j++) {
+        mantissa *= 10;
+      }
+      const int32 p = decimal.point;
+      if (p >= 0 && p < decimal.count) {
+        const bool up =
+            decimal.digits[p] == 5 && p + 1 == decimal.count
+                ? decimal.truncated || (p > 0 && decimal.digits[p - 1] % 2 == 1)
+                : decimal.digits[p] >= 5;
+        mantissa += up ? 1 : 0;
+      }
+      if (mantissa == (uint64(2) << Layout::MANTISSA)) {
+        mantissa >>= 1;
+        binary++;
+        overflow = binary - Layout::BIAS >= MAX_BIASED;
+      }
+      if ((mantissa & (uint64(1) << Layout::MANTISSA)) == 0) {
+        binary = Layout::BIAS;
+      }
+    }
+  }
+  if (overflow) {
+    mantissa = 0;
+    binary = MAX_BIASED + Layout::BIAS;
+  }
+  return static_cast<Bits>(
+      (mantissa & ((uint64(1) << Layout::MANTISSA) - 1)) |
+      (static_cast<uint64>(binary - Layout::BIAS) << Layout::MANTISSA));
+}
+
+// === Implementation of numbers conversions ===
+
+template <Integer T>
+inline uint32 numbers::to_string(const T value, char* out) {
+  uint32 size = 0;
+  uint64 magnitude = static_cast<uint64>(value);
+  if constexpr (isSigned<T>::value) {
+    if (value < 0) {
+      out[size++] = '-';
+      magnitude = 0 - magnitude;
+    }
+  }
+  const uint32 count = digit_count(magnitude);
+  write_digits(magnitude, count, out + size);
+  return size + count;
+}
+
+template <FloatingPoint T>
+inline uint32 numbers::to_string(const T value, char* out) {
+  using Layout = FloatLayout<T>;
+  using Bits = typename FloatLayout<T>::Bits;
+  constexpr uint32 SIGN = sizeof(Bits) * 8 - 1;
+  constexpr Bits INFINITE = static_cast<Bits>(
+      ((Bits(1) << Layout::EXPONENT) - 1) << Layout::MANTISSA);
+
+  // Special values
+  Bits bits;
+  __builtin_memcpy(&bits, &value, sizeof(bits));
+  uint32 size = 0;
+  const Bits magnitude = bits & static_cast<Bits>(~(Bits(1) << SIGN));
+  if (magnitude > INFINITE) {
+    out[0] = 'n';
+    out[1] = 'a';
+    out[2] = 'n';
+    return 3;
+  }
+  if ((bits >> SIGN) != 0) {
+    out[size++] = '-';
+  }
+  if (magnitude == INFINITE) {
+    out[size++] = 'i';
+    out[size++] = 'n';
+    out[size++] = 'f';
+    return size;
+  }
+  if (magnitude == 0) {
+    out[size++] = '0';
+    return size;
+  }
+
+  // Shortest digits, value = 0.digits * 10^point
+  char digits[20];
+  uint32 count = 0;
+  int32 exponent = 0;
+  grisu<T>(magnitude, digits, count, exponent);
+  const int32 length = static_cast<int32>(count);
+  const int32 point = length + exponent;
+
+  auto put = [out, &size](const char c) { out[size++] = c; };
+  if (length <= point && point <= 21) {
+    // Integer: digits then zeros
+    for (int32 i = 0; i < length; i++) {
+      put(digits[i]);
+    }
+    for (int32 i = length; i < point; i++) {
+      put('0');
+    }
+  } else if (0 < point && point <= 21) {
+    // Point inside the digits
+    for (int32 i = 0; i < length; i++) {
+      if (i == point) {
+        put('.');
+      }
+      put(digits[i]);
+    }
+  } else if (-6 < point && point <= 0) {
+    // Small: 0.000ddd
+    put('0');
+    put('.');
+    for (int32 i = point; i < 0; i++) {
+      put('0');
+    }
+    for (int32 i = 0; i < length; i++) {
+      put(digits[i]);
+    }
+  } else {
+    // Scientific: d.ddde+X
+    put(digits[0]);
+    if (length > 1) {
+      put('.');
+      for (int32 i = 1; i < length; i++) {
+        put(digits[i]);
+      }
+    }
+    put('e');
+    const int32 scientific = point - 1;
+    put(scientific < 0 ? '-' : '+');
+    const uint64 absolute =
+        static_cast<uint64>(scientific < 0 ? -scientific : scientific);
+    const uint32 width = digit_count(absolute);
+    write_digits(absolute, width, out + size);
+    size += width;
+  }
+  return size;
+}
+
+template <Integer T>
+inline ParseStatus numbers::from_string(const char* text, const uint64 length,
+                                        T& value) {
+  uint64 consumed = 0;
+  const ParseStatus status = from_string(text, length, value, consumed);
+  if (status == ParseStatus::OK && consumed != length) {
+    return ParseStatus::INVALID_ERROR;
+  }
+  return status;
+}
+
+template <Integer T>
+inline ParseStatus numbers::from_string(const char* text, const uint64 length,
+                                        T& value, uint64& consumed) {
+  consumed = 0;
+  value = 0;
+
+  // Sign; unsigned types only take '+'
+  uint64 i = 0;
+  bool negative = false;
+  if (i < length && (text[i] == '+' || text[i] == '-')) {
+    negative = text[i] == '-';
+    i++;
+  }
+  if (negative && !isSigned<T>::value) {
+    return ParseStatus::INVALID_ERROR;
+  }
+
+  // Eight digits per step while they last, then one at a time
+  const uint64 start = i;
+  uint64 magnitude = 0;
+  bool overflow = false;
+  uint32 eight = 0;
+  while (length - i >= 8 && parse_eight_digits(text + i, eight)) {
+    if (__builtin_mul_overflow(magnitude, uint64(100000000), &magnitude) ||
+        __builtin_add_overflow(magnitude, uint64(eight), &magnitude)) {
+      overflow = true;
+    }
+    i += 8;
+  }
+  for (; i < length && text[i] >= '0' && text[i] <= '9'; i++) {
+    if (__builtin_mul_overflow(magnitude, uint64(10), &magnitude) ||
+        __builtin_add_overflow(magnitude, uint64(text[i] - '0'), &magnitude)) {
+      overflow = true;
+    }
+  }
+  if (i == start) {
+    return ParseStatus::INVALID_ERROR;
+  }
+  consumed = i;
+
+  // Range check against limits<T>; the negative range is one larger
+  const uint64 limit = negative ? static_cast<uint64>(limits<T>::max) + 1
+                                : static_cast<uint64>(limits<T>::max);
+  if (overflow || magnitude > limit) {
+    value = negative ? limits<T>::min : limits<T>::max;
+    return ParseStatus::OVERFLOW_ERROR;
+  }
+  value = negative ? static_cast<T>(0 - magnitude) : static_cast<T>(magnitude);
+  return ParseStatus::OK;
+}
+
+template <FloatingPoint T>
+inline ParseStatus numbers::from_string(const char* text, const uint64 length,
+                                        T& value) {
+  uint64 consumed = 0;
+  const ParseStatus status = from_string(text, length, value, consumed);
+  if (status != ParseStatus::INVALID_ERROR && consumed != length) {
+    return ParseStatus::INVALID_ERROR;
+  }
+  return status;
+}
+
+template <FloatingPoint T>
+inline ParseStatus numbers::from_string(const char* text, const uint64 length,
+                                        T& value, uint64& consumed) {
+  using Layout = FloatLayout<T>;
+  using Bits = typename FloatLayout<T>::Bits;
+  constexpr Bits SIGN = Bits(1) << (sizeof(Bits) * 8 - 1);
+  constexpr Bits INFINITE = static_cast<Bits>(
+      ((Bits(1) << Layout::EXPONENT) - 1) << Layout::MANTISSA);
+  consumed = 0;
+  value = 0;
+
+  uint64 i = 0;
+  bool negative = false;
+  if (i < length && (text[i] == '+' || text[i] == '-')) {
+    negative = text[i] == '-';
+    i++;
+  }
+  auto finish = [&value, negative](const Bits bits) {
+    const Bits signed_bits = negative ? static_cast<Bits>(bits | SIGN) : bits;
+    __builtin_memcpy(&value, &signed_bits, sizeof(value));
+  };
+
+  // inf, infinity and nan in any case
+  auto matches = [text, length, i](const char* word, const uint64 size) {
+    if (length - i < size) {
+      return false;
+    }
+    for (uint64 j = 0; j < size; j++) {
+      if ((text[i + j] | 0x20) != word[j]) {
+        return false;
+      }
+    }
+    return true;
+  };
+  if (matches("inf", 3)) {
+    consumed = i + (matches("infinity", 8) ? 8 : 3);
+    finish(INFINITE);
+    return ParseStatus::OK;
+  }
+  if (matches("nan", 3)) {
+    consumed = i + 3;
+    finish(static_cast<Bits>(INFINITE | (Bits(1) << (Layout::MANTISSA - 1))));
+    return ParseStatus::OK;
+  }
+
+  // Keep the first 19 significant digits; leading zeros only move the point
+  const uint64 start = i;
+  uint64 mantissa = 0;
+  int32 significant = 0;
+  int32 taken = 0;
+  int64 point = 0;
+  bool dot = false;
+  bool digits = false;
+  bool truncated = false;
+  for (; i < length; i++) {
+    const char c = text[i];
+    if (c == '.') {
+      if (dot) {
+        break;
+      }
+      dot = true;
+      point = significant;
+      continue;
+    }
+    if (c < '0' || c > '9') {
+      break;
+    }
+    digits = true;
+    if (c == '0' && significant == 0) {
+      point--;
+      continue;
+    }
+
+    // Take eight digits at once while they fit in the mantissa
+    uint32 eight = 0;
+    if (taken <= 11 && length - i >= 8 && parse_eight_digits(text + i, eight)) {
+      mantissa = mantissa * 100000000 + eight;
+      taken += 8;
+      significant += 8;
+      i += 7;
+      continue;
+    }
+    significant++;
+    if (taken < 19) {
+      mantissa = mantissa * 10 + static_cast<uint64>(c - '0');
+      taken++;
+    } else if (c != '0') {
+      truncated = true;
+    }
+  }
+  if (!digits) {
+    return ParseStatus::INVALID_ERROR;
+  }
+  if (!dot) {
+    point = significant;
+  }
+
+  // The exponent only counts if it has digits
+  if (i < length && (text[i] == 'e' || text[i] == 'E')) {
+    uint64 j = i + 1;
+    bool exponent_negative = false;
+    if (j < length && (text[j] == '+' || text[j] == '-')) {
+      exponent_negative = text[j] == '-';
+      j++;
+    }
+    if (j < length && text[j] >= '0' && text[j] <= '9') {
+      int64 exponent = 0;
+      for (; j < length && text[j] >= '0' && text[j] <= '9'; j++) {
+        if (exponent < 100000) {
+          exponent = exponent * 10 + (text[j] - '0');
+        }
+      }
+      point += exponent_negative ? -exponent : exponent;
+      i = j;
+    }
+  }
+  consumed = i;
+  if (mantissa == 0) {
+    finish(0);
+    return ParseStatus::OK;
+  }
+
+  // Exact arithmetic, then Eisel-Lemire, then digit-by-digit arithmetic
+  const int64 exponent = point - taken;
+  if (!truncated) {
+    T exact;
+    if (parse_exact(mantissa, exponent, exact)) {
+      value = negative ? -exact : exact;
+      return ParseStatus::OK;
+    }
+  }
+  Bits bits = 0;
+  Bits upper = 0;
+  if (eisel_lemire<T>(mantissa, exponent, bits) &&
+      (!truncated || (eisel_lemire<T>(mantissa + 1, exponent, upper) &&
+                      upper == bits))) {
+    finish(bits);
+    return ParseStatus::OK;
+  }
+  bool overflow = false;
+  finish(parse_slow<T>(text + start, i - start, overflow));
+  return overflow ? ParseStatus::OVERFLOW_ERROR : ParseStatus::OK;
+}
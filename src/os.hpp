@@ -2,10 +2,21 @@
 
 #pragma once
 
-#ifndef RECREATION_ONLY
+#ifndef RECREATIONS_ONLY
 #include "utilities/os.hpp"
 #endif
 
+#include "os/clock.hpp"
+#include "os/cpu.hpp"
+#include "os/file.hpp"
+#include "os/io.hpp"
+#include "os/network.hpp"
+#include "os/process.hpp"
+#include "os/thread.hpp"
+#include "os/trace.hpp"
+#include "os/transfer.hpp"
+#include "os/writer.hpp"
+
 namespace os {
 namespace io {}  // namespace io
 
@@ -13,9 +24,7 @@ namespace file {}  // namespace file
 
 namespace directory {}  // namespace directory
 
-namespace process {
-int exit(const int code);
-}  // namespace process
+namespace process {}  // namespace process
 
 namespace thread {}  // namespace thread
 
@@ -30,14 +39,3 @@ namespace network {}  // namespace network
 namespace memory {}  // namespace memory
 
 }  // namespace os
-
-inline int os::process::exit(const int code) {
-#ifndef RECREATION_ONLY
-#if defined(OS_WINDOWS)
-  ExitProcess(static_cast<UINT>(code));
-
-#elif defined(OS_POSIX_COMPATIBLE)
-  _exit(code);
-#endif
-#endif
-}
\ No newline at end of file
@@ -0,0 +1,151 @@
+// @file clock.hpp
+
+#pragma once
+
+#include "../utilities/architecture.h"
+#include "../utilities/compiler.h"
+#include "../utilities/types.h"
+
+#ifndef RECREATIONS_ONLY
+#include "../utilities/os.hpp"
+#endif
+
+// The monotonic clock comes from clock_gettime on POSIX systems; freestanding
+// builds have no clock and read 0.
+#if defined(OS_POSIX_COMPATIBLE)
+#define CLOCK_POSIX
+#include <time.h>  // clock_gettime, CLOCK_MONOTONIC
+#endif
+
+// The cycle counter is the time stamp counter on x86 and the virtual counter
+// on ARM64. Anywhere else ticks() falls back to the monotonic clock.
+#if (defined(ARCHITECTURE_X64) || defined(ARCHITECTURE_X86)) && \
+    (defined(COMPILER_GCC) || defined(COMPILER_CLANG))
+#define CLOCK_TSC
+#elif defined(ARCHITECTURE_ARM64) && \
+    (defined(COMPILER_GCC) || defined(COMPILER_CLANG))
+#define CLOCK_CNTVCT
+#endif
+
+// @brief Time measurement: a monotonic nanosecond clock, and a cycle counter
+// that is cheaper to read and is converted to nanoseconds after the fact.
+namespace os::system::clock {
+
+// @brief How long calibrate() watches the monotonic clock to time the TSC.
+inline constexpr uint64 CALIBRATION_NS = 5000000;
+
+// @brief The mapping from counter ticks to the monotonic clock.
+struct Calibration {
+  // @brief A ticks() reading taken at ns_origin.
+  uint64 tick_origin;
+
+  // @brief A now() reading taken at tick_origin.
+  uint64 ns_origin;
+
+  // @brief The length of one tick in nanoseconds.
+  float64 ns_per_tick;
+};
+
+// @brief Reads the monotonic clock.
+// @return Nanoseconds since an arbitrary start (0 in freestanding builds).
+uint64 now();
+
+// @brief Reads the cycle counter (rdtsc on x86, cntvct_el0 on ARM64, now()
+// elsewhere). Only meaningful relative to other readings.
+// @return The counter value.
+uint64 ticks();
+
+// @brief Measures the counter against the monotonic clock. The x86 counter
+// is timed over CALIBRATION_NS; ARM64 reports its frequency in cntfrq_el0.
+// Without a clock to time against, one tick counts as one nanosecond.
+// Prefer calibration(), which caches the result.
+// @return The calibration.
+Calibration calibrate();
+
+// @brief Returns the calibration, measured once on first use.
+// @return A reference to the cached calibration.
+const Calibration& calibration();
+
+// @brief Converts a ticks() reading to a point on the now() timeline.
+// @param tick_count The counter value.
+// @return The time in nanoseconds.
+uint64 timestamp(const uint64 tick_count);
+
+// @brief Converts a difference of two ticks() readings to nanoseconds.
+// @param tick_count The number of ticks.
+// @return The duration in nanoseconds.
+uint64 duration(const uint64 tick_count);
+
+}  // namespace os::system::clock
+
+// === Implementation of os::system::clock ===
+
+inline uint64 os::system::clock::now() {
+#ifdef CLOCK_POSIX
+  timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return static_cast<uint64>(time.tv_sec) * 1000000000ULL +
+         static_cast<uint64>(time.tv_nsec);
+#else
+  return 0;
+#endif
+}
+
+inline uint64 os::system::clock::ticks() {
+#if defined(CLOCK_TSC)
+  return __builtin_ia32_rdtsc();
+#elif defined(CLOCK_CNTVCT)
+  uint64 value;
+  __asm__ volatile("mrs %0, cntvct_el0" : "=r"(value));
+  return value;
+#else
+  return now();
+#endif
+}
+
+inline os::system::clock::Calibration os::system::clock::calibrate() {
+  Calibration result = {ticks(), now(), 1.0};
+#if defined(CLOCK_TSC) && defined(CLOCK_POSIX)
+  // Spin until the clock has moved far enough for its jitter not to matter
+  uint64 tick_end = result.tick_origin;
+  uint64 ns_end = result.ns_origin;
+  while (ns_end - result.ns_origin < CALIBRATION_NS) {
+    tick_end = ticks();
+    ns_end = now();
+  }
+  if (tick_end > result.tick_origin) {
+    result.ns_per_tick = static_cast<float64>(ns_end - result.ns_origin) /
+                         static_cast<float64>(tick_end - result.tick_origin);
+  }
+#elif defined(CLOCK_CNTVCT)
+  // The counter frequency is published by the firmware
+  uint64 frequency;
+  __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+  if (frequency > 0) {
+    result.ns_per_tick = 1e9 / static_cast<float64>(frequency);
+  }
+#endif
+  return result;
+}
+
+inline const os::system::clock::Calibration&
+os::system::clock::calibration() {
+  // Calibrate once; later calls only read the cached copy
+  static const Calibration measured = calibrate();
+  return measured;
+}
+
+inline uint64 os::system::clock::timestamp(const uint64 tick_count) {
+  // Readings from before the calibration land before its origin
+  const Calibration& origin = calibration();
+  if (tick_count >= origin.tick_origin) {
+    return origin.ns_origin + duration(tick_count - origin.tick_origin);
+  }
+  const uint64 before = duration(origin.tick_origin - tick_count);
+  return before < origin.ns_origin ? origin.ns_origin - before : 0;
+}
+
+inline uint64 os::system::clock::duration(const uint64 tick_count) {
+  return static_cast<uint64>(static_cast<float64>(tick_count) *
+                             calibration().ns_per_tick);
+}
@@ -0,0 +1,131 @@
+// @file cpu.hpp
+
+#pragma once
+
+#include "../utilities/architecture.h"
+#include "../utilities/compiler.h"
+#include "../utilities/types.h"
+
+#if (defined(ARCHITECTURE_X64) || defined(ARCHITECTURE_X86)) && \
+    (defined(COMPILER_GCC) || defined(COMPILER_CLANG))
+#define CPU_DETECT_CPUID
+#include <cpuid.h>  // __get_cpuid_count (compiler-provided, freestanding)
+#endif
+
+#if defined(ARCHITECTURE_ARM64) && defined(__linux__) && \
+    !defined(RECREATIONS_ONLY)
+#define CPU_DETECT_AUXV
+#include <sys/auxv.h>  // getauxval(AT_HWCAP)
+#endif
+
+// @brief Run-time detection of the instruction set extensions available on
+// the machine the binary is running on (as opposed to the compile-time
+// baseline reported by architecture.h).
+namespace os::system::cpu {
+
+// @brief The instruction set extensions usable on the running CPU. AVX
+// features are only reported when the OS also saves the wide registers.
+struct Features {
+  bool sse2 = false;
+  bool sse42 = false;
+  bool popcnt = false;
+  bool avx = false;
+  bool avx2 = false;
+  bool bmi2 = false;
+  bool avx512f = false;
+  bool avx512bw = false;
+  bool neon = false;
+  bool sve = false;
+};
+
+// @brief Queries the CPU (cpuid/xgetbv on x86, the auxiliary vector on ARM64
+// Linux). Prefer features(), which caches the result.
+// @return The detected features.
+Features detect();
+
+// @brief Returns the features of the running CPU, detected once on first use.
+// @return A reference to the cached features.
+const Features& features();
+
+// @brief Returns the name of the widest vector extension available.
+// @return "avx512", "avx2", "sse4.2", "sse2", "sve", "neon" or "scalar".
+const char* best_extension();
+
+}  // namespace os::system::cpu
+
+// === Implementation of os::system::cpu ===
+
+inline os::system::cpu::Features os::system::cpu::detect() {
+  Features result;
+
+#if defined(CPU_DETECT_CPUID)
+  uint32 eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+  // Leaf 1: baseline SSE and the OS-managed AVX state flag
+  if (__get_cpuid_count(1, 0, &eax, &ebx, &ecx, &edx) == 0) {
+    return result;
+  }
+  result.sse2 = (edx & (1U << 26)) != 0;
+  result.sse42 = (ecx & (1U << 20)) != 0;
+  result.popcnt = (ecx & (1U << 23)) != 0;
+  const bool osxsave = (ecx & (1U << 27)) != 0;
+  const bool cpu_avx = (ecx & (1U << 28)) != 0;
+
+  // Ask the OS which register states it saves on context switch (XCR0)
+  uint64 xcr0 = 0;
+  if (osxsave) {
+    uint32 xcr0_low = 0, xcr0_high = 0;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+    xcr0 = (static_cast<uint64>(xcr0_high) << 32) | xcr0_low;
+  }
+  const bool os_avx = (xcr0 & 0x6) == 0x6;       // XMM + YMM
+  const bool os_avx512 = (xcr0 & 0xE6) == 0xE6;  // + opmask, ZMM
+  result.avx = cpu_avx && os_avx;
+
+  // Leaf 7: AVX2, BMI2 and AVX-512
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0) {
+    result.avx2 = result.avx && (ebx & (1U << 5)) != 0;
+    result.bmi2 = (ebx & (1U << 8)) != 0;
+    result.avx512f = os_avx512 && (ebx & (1U << 16)) != 0;
+    result.avx512bw = result.avx512f && (ebx & (1U << 30)) != 0;
+  }
+
+#elif defined(ARCHITECTURE_ARM64)
+  // Advanced SIMD is mandatory on ARMv8-A
+  result.neon = true;
+#if defined(CPU_DETECT_AUXV) && defined(HWCAP_SVE)
+  result.sve = (getauxval(AT_HWCAP) & HWCAP_SVE) != 0;
+#endif
+#endif
+
+  return result;
+}
+
+inline const os::system::cpu::Features& os::system::cpu::features() {
+  // Detect once; later calls only read the cached copy
+  static const Features detected = detect();
+  return detected;
+}
+
+inline const char* os::system::cpu::best_extension() {
+  const Features& cpu = features();
+  if (cpu.avx512bw) {
+    return "avx512";
+  }
+  if (cpu.avx2) {
+    return "avx2";
+  }
+  if (cpu.sse42) {
+    return "sse4.2";
+  }
+  if (cpu.sse2) {
+    return "sse2";
+  }
+  if (cpu.sve) {
+    return "sve";
+  }
+  if (cpu.neon) {
+    return "neon";
+  }
+  return "scalar";
+}
@@ -0,0 +1,685 @@
+// @file file.hpp
+
+#pragma once
+
+#include "../memory.hpp"
+#include "../span.hpp"
+#include "../utilities/types.h"
+#include "../vector.hpp"
+
+#ifndef RECREATIONS_ONLY
+#include "../utilities/os.hpp"
+#endif
+
+// File I/O goes through the POSIX descriptor API; elsewhere every operation
+// reports UNSUPPORTED_ERROR.
+#if defined(OS_POSIX_COMPATIBLE)
+#define FILE_POSIX
+#include <errno.h>  // errno, EINTR
+#endif
+
+// @brief The status codes for operations on files and mappings.
+enum class FileStatus : int8 {
+  OK = 1,
+  OPEN_ERROR = 0,
+  READ_ERROR = -1,
+  WRITE_ERROR = -2,
+  MAP_ERROR = -3,
+  NOT_OPEN_ERROR = -4,
+  ALLOCATION_ERROR = -5,
+  UNSUPPORTED_ERROR = -6,
+};
+
+// @brief Unbuffered file access through descriptors, and memory-mapped files.
+namespace os::file {
+
+// @brief How a File is opened.
+enum class Mode : uint8 {
+  // @brief Read an existing file.
+  READ,
+  // @brief Create or truncate a file for writing.
+  WRITE,
+  // @brief Read and write an existing file.
+  READ_WRITE,
+  // @brief Create a file if needed and write at its end.
+  APPEND,
+};
+
+// @brief How a MappedFile maps its file.
+enum class Access : uint8 {
+  // @brief Shared read-only mapping; writing to it faults.
+  READ_ONLY,
+  // @brief Shared writable mapping; stores reach the file (see sync()).
+  READ_WRITE,
+};
+
+// @brief Access pattern hints forwarded to madvise.
+enum class Advice : uint8 {
+  // @brief Default read-ahead.
+  NORMAL,
+  // @brief Aggressive read-ahead; pages behind the cursor may be dropped.
+  SEQUENTIAL,
+  // @brief No read-ahead.
+  RANDOM,
+  // @brief Start reading the range in now.
+  WILL_NEED,
+  // @brief The range will not be needed soon; its pages may be dropped.
+  DONT_NEED,
+};
+
+// @brief An open file descriptor. Closed on destruction.
+class File {
+ public:
+  // @brief Creates a handle with no file attached.
+  File() = default;
+
+  // @brief Destructor. Closes the file if open.
+  ~File();
+
+  // @brief Deleted copy constructor. Files are owned by one handle.
+  File(const File&) = delete;
+
+  // @brief Deleted copy assignment operator. Files are owned by one handle.
+  File& operator=(const File&) = delete;
+
+  // @brief Move constructor. Takes over the descriptor of another handle.
+  // @param other The handle to move from.
+  File(File&& other) noexcept;
+
+  // @brief Move assignment operator. Closes the current file first.
+  // @param other The handle to move from.
+  // @return A reference to this handle.
+  File& operator=(File&& other) noexcept;
+
+  // @brief Opens a file, closing any file already attached.
+  // @param path The NUL-terminated path.
+  // @param mode How to open the file.
+  // @return OK or OPEN_ERROR.
+  FileStatus open(const char* path, const Mode mode);
+
+  // @brief Closes the file. Does nothing if no file is attached.
+  void close();
+
+  // @brief Reads up to size bytes at the current position, retrying on
+  // interruption and short reads until size bytes or end of file.
+  // @param buffer The destination.
+  // @param size The number of bytes wanted.
+  // @param read_count Receives the number of bytes read (0 at end of file).
+  // @return OK, NOT_OPEN_ERROR or READ_ERROR.
+  FileStatus read(void* buffer, const uint64 size, uint64& read_count);
+
+  // @brief Writes size bytes at the current position, retrying on
+  // interruption and short writes.
+  // @param buffer The source.
+  // @param size The number of bytes to write.
+  // @return OK, NOT_OPEN_ERROR or WRITE_ERROR.
+  FileStatus write(const void* buffer, const uint64 size);
+
+  // @brief Reads up to size bytes at an offset without moving the position.
+  // @param buffer The destination.
+  // @param size The number of bytes wanted.
+  // @param offset The file offset to read from.
+  // @param read_count Receives the number of bytes read.
+  // @return OK, NOT_OPEN_ERROR or READ_ERROR.
+  FileStatus read_at(void* buffer, const uint64 size, const uint64 offset,
+                     uint64& read_count);
+
+  // @brief Writes size bytes at an offset without moving the position.
+  // @param buffer The source.
+  // @param size The number of bytes to write.
+  // @param offset The file offset to write at.
+  // @return OK, NOT_OPEN_ERROR or WRITE_ERROR.
+  FileStatus write_at(const void* buffer, const uint64 size,
+                      const uint64 offset);
+
+  // @brief Flushes written data to the storage device.
+  // @return OK, NOT_OPEN_ERROR or WRITE_ERROR.
+  FileStatus sync();
+
+  // @brief Queries the size of the file.
+  // @param size Receives the size in bytes.
+  // @return OK, NOT_OPEN_ERROR or READ_ERROR.
+  FileStatus getSize(uint64& size) const;
+
+  // @brief Returns the underlying descriptor.
+  // @return The descriptor, or -1 if no file is attached.
+  int getDescriptor() const;
+
+  // @brief Checks whether a file is attached.
+  // @return true if open.
+  bool isOpen() const;
+
+ private:
+  // @brief The descriptor, or -1.
+  int descriptor = -1;
+};
+
+// @brief A whole file mapped into memory. Reading it touches the page cache
+// directly: no copy into a user buffer and no second resident copy.
+class MappedFile {
+ public:
+  // @brief Creates a handle with nothing mapped.
+  MappedFile() = default;
+
+  // @brief Destructor. Unmaps the file.
+  ~MappedFile();
+
+  // @brief Deleted copy constructor. Mappings are owned by one handle.
+  MappedFile(const MappedFile&) = delete;
+
+  // @brief Deleted copy assignment operator. Mappings are owned by one handle.
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // @brief Move constructor. Takes over the mapping of another handle.
+  // @param other The handle to move from.
+  MappedFile(MappedFile&& other) noexcept;
+
+  // @brief Move assignment operator. Unmaps the current file first.
+  // @param other The handle to move from.
+  // @return A reference to this handle.
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  // @brief Maps a whole file, unmapping any file already mapped. Empty files
+  // map successfully to an empty view.
+  // @param path The NUL-terminated path.
+  // @param access Read-only or read-write.
+  // @param huge_pages Ask the kernel to back the mapping with transparent huge
+  // pages (MADV_HUGEPAGE) to cut TLB misses on large scans. Only a hint: it
+  // is ignored where the kernel or filesystem does not support it.
+  // @return OK, OPEN_ERROR, READ_ERROR or MAP_ERROR.
+  FileStatus map(const char* path, const Access access,
+                 const bool huge_pages = false);
+
+  // @brief Unmaps the file. Does nothing if nothing is mapped.
+  void unmap();
+
+  // @brief Tells the kernel how a range will be accessed.
+  // @param advice The access pattern.
+  // @param offset The start of the range (rounded down to a page).
+  // @param length The length of the range (clamped to the mapping).
+  // @return OK, NOT_OPEN_ERROR or MAP_ERROR.
+  FileStatus advise(const Advice advice, const uint64 offset = 0,
+                    const uint64 length = UINT64_MAX);
+
+  // @brief Writes modified pages of a read-write mapping back to the file.
+  // @return OK, NOT_OPEN_ERROR or WRITE_ERROR.
+  FileStatus sync();
+
+  // @brief Returns a read-only view of the mapped bytes.
+  // @return The view (empty if nothing is mapped).
+  Span<const byte> view() const;
+
+  // @brief Returns a writable view of the mapped bytes. Writing through it
+  // faults unless the file was mapped READ_WRITE.
+  // @return The view (empty if nothing is mapped).
+  Span<byte> view_mutable();
+
+  // @brief Returns the first mapped byte.
+  // @return The address, or nullptr if nothing (or an empty file) is mapped.
+  byte* getData() const;
+
+  // @brief Returns the size of the mapping.
+  // @return The size in bytes.
+  uint64 getSize() const;
+
+  // @brief Checks whether a file is mapped.
+  // @return true after a successful map().
+  bool isMapped() const;
+
+ private:
+  // @brief The mapping, or nullptr.
+  byte* data = nullptr;
+
+  // @brief The length of the mapping in bytes.
+  uint64 size = 0;
+
+  // @brief Whether map() succeeded (an empty file has no address).
+  bool mapped = false;
+};
+
+// @brief Reads a whole file into a vector, replacing its contents.
+// @param path The NUL-terminated path.
+// @param out Receives the bytes (an initialized vector, resized to the file
+// size).
+// @return OK, OPEN_ERROR, READ_ERROR, or ALLOCATION_ERROR if out could not be
+// resized.
+template <memory::Allocator A, GrowthPolicy G>
+FileStatus read_all(const char* path, Vector<byte, A, G>& out);
+
+// @brief Creates or truncates a file and writes bytes to it.
+// @param path The NUL-terminated path.
+// @param bytes The bytes to write.
+// @return OK, OPEN_ERROR or WRITE_ERROR.
+FileStatus write_all(const char* path, const Span<const byte> bytes);
+
+}  // namespace os::file
+
+// === Implementation of os::file::File ===
+
+inline os::file::File::~File() { this->close(); }
+
+inline os::file::File::File(File&& other) noexcept
+    : descriptor(other.descriptor) {
+  other.descriptor = -1;
+}
+
+inline os::file::File& os::file::File::operator=(File&& other) noexcept {
+  if (this != &other) {
+    this->close();
+    this->descriptor = other.descriptor;
+    other.descriptor = -1;
+  }
+  return *this;
+}
+
+inline FileStatus os::file::File::open(const char* path, const Mode mode) {
+  this->close();
+#ifdef FILE_POSIX
+  // Translate the mode; descriptors never leak into spawned processes
+  int flags = O_CLOEXEC;
+  switch (mode) {
+    case Mode::READ:
+      flags |= O_RDONLY;
+      break;
+    case Mode::WRITE:
+      flags |= O_WRONLY | O_CREAT | O_TRUNC;
+      break;
+    case Mode::READ_WRITE:
+      flags |= O_RDWR;
+      break;
+    case Mode::APPEND:
+      flags |= O_WRONLY | O_CREAT | O_APPEND;
+      break;
+  }
+
+  // Retry if a signal interrupts the open
+  int result;
+  do {
+    result = ::open(path, flags, 0644);
+  } while (result < 0 && errno == EINTR);
+  if (result < 0) {
+    return FileStatus::OPEN_ERROR;
+  }
+  this->descriptor = result;
+  return FileStatus::OK;
+#else
+  (void)path;
+  (void)mode;
+  return FileStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline void os::file::File::close() {
+#ifdef FILE_POSIX
+  // close() must not be retried on EINTR: the descriptor is already released
+  if (this->descriptor >= 0) {
+    ::close(this->descriptor);
+  }
+#endif
+  this->descriptor = -1;
+}
+
+inline FileStatus os::file::File::read(void* buffer, const uint64 size,
+                                       uint64& read_count) {
+  os::system::trace::Zone zone("File::read");
+  read_count = 0;
+  if (this->descriptor < 0) {
+    return FileStatus::NOT_OPEN_ERROR;
+  }
+#ifdef FILE_POSIX
+  // Loop over short reads until the buffer is full or the file ends
+  byte* cursor = static_cast<byte*>(buffer);
+  while (read_count < size) {
+    const ssize_t result = ::read(this->descriptor, cursor + read_count,
+                                  static_cast<size_t>(size - read_count));
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return FileStatus::READ_ERROR;
+    }
+    if (result == 0) {
+      break;
+    }
+    read_count += static_cast<uint64>(result);
+  }
+  return FileStatus::OK;
+#else
+  (void)buffer;
+  (void)size;
+  return FileStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline FileStatus os::file::File::write(const void* buffer,
+                                        const uint64 size) {
+  os::system::trace::Zone zone("File::write");
+  if (this->descriptor < 0) {
+    return FileStatus::NOT_OPEN_ERROR;
+  }
+#ifdef FILE_POSIX
+  // Loop over short writes until everything is written
+  const byte* cursor = static_cast<const byte*>(buffer);
+  uint64 written = 0;
+  while (written < size) {
+    const ssize_t result = ::write(this->descriptor, cursor + written,
+                                   static_cast<size_t>(size - written));
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return FileStatus::WRITE_ERROR;
+    }
+    written += static_cast<uint64>(result);
+  }
+  return FileStatus::OK;
+#else
+  (void)buffer;
+  (void)size;
+  return FileStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline FileStatus os::file::File::read_at(void* buffer, const uint64 size,
+                                          const uint64 offset,
+                                          uint64& read_count) {
+  os::system::trace::Zone zone("File::read_at");
+  read_count = 0;
+  if (this->descriptor < 0) {
+    return FileStatus::NOT_OPEN_ERROR;
+  }
+#ifdef FILE_POSIX
+  byte* cursor = static_cast<byte*>(buffer);
+  while (read_count < size) {
+    const ssize_t result =
+        ::pread(this->descriptor, cursor + read_count,
+                static_cast<size_t>(size - read_count),
+                static_cast<off_t>(offset + read_count));
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return FileStatus::READ_ERROR;
+    }
+    if (result == 0) {
+      break;
+    }
+    read_count += static_cast<uint64>(result);
+  }
+  return FileStatus::OK;
+#else
+  (void)buffer;
+  (void)size;
+  (void)offset;
+  return FileStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline FileStatus os::file::File::write_at(const void* buffer,
+                                           const uint64 size,
+                                           const uint64 offset) {
+  os::system::trace::Zone zone("File::write_at");
+  if (this->descriptor < 0) {
+    return FileStatus::NOT_OPEN_ERROR;
+  }
+#ifdef FILE_POSIX
+  const byte* cursor = static_cast<const byte*>(buffer);
+  uint64 written = 0;
+  while (written < size) {
+    const ssize_t result =
+        ::pwrite(this->descriptor, cursor + written,
+                 static_cast<size_t>(size - written),
+                 static_cast<off_t>(offset + written));
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return FileStatus::WRITE_ERROR;
+    }
+    written += static_cast<uint64>(result);
+  }
+  return FileStatus::OK;
+#else
+  (void)buffer;
+  (void)size;
+  (void)offset;
+  return FileStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline FileStatus os::file::File::sync() {
+  os::system::trace::Zone zone("File::sync");
+  if (this->descriptor < 0) {
+    return FileStatus::NOT_OPEN_ERROR;
+  }
+#ifdef FILE_POSIX
+  return ::fsync(this->descriptor) == 0 ? FileStatus::OK
+                                         : FileStatus::WRITE_ERROR;
+#else
+  return FileStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline FileStatus os::file::File::getSize(uint64& size) const {
+  size = 0;
+  if (this->descriptor < 0) {
+    return FileStatus::NOT_OPEN_ERROR;
+  }
+#ifdef FILE_POSIX
+  struct stat information;
+  if (::fstat(this->descriptor, &information) != 0) {
+    return FileStatus::READ_ERROR;
+  }
+  size = static_cast<uint64>(information.st_size);
+  return FileStatus::OK;
+#else
+  return FileStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline int os::file::File::getDescriptor() const { return this->descriptor; }
+
+inline bool os::file::File::isOpen() const { return this->descriptor >= 0; }
+
+// === Implementation of os::file::MappedFile ===
+
+inline os::file::MappedFile::~MappedFile() { this->unmap(); }
+
+inline os::file::MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data(other.data), size(other.size), mapped(other.mapped) {
+  other.data = nullptr;
+  other.size = 0;
+  other.mapped = false;
+}
+
+inline os::file::MappedFile& os::file::MappedFile::operator=(
+    MappedFile&& other) noexcept {
+  if (this != &other) {
+    this->unmap();
+    this->data = other.data;
+    this->size = other.size;
+    this->mapped = other.mapped;
+    other.data = nullptr;
+    other.size = 0;
+    other.mapped = false;
+  }
+  return *this;
+}
+
+inline FileStatus os::file::MappedFile::map(const char* path,
+                                            const Access access,
+                                            const bool huge_pages) {
+  this->unmap();
+#ifdef FILE_POSIX
+  // Open with matching permissions; the mapping outlives the descriptor
+  File file;
+  const FileStatus opened = file.open(
+      path, access == Access::READ_ONLY ? Mode::READ : Mode::READ_WRITE);
+  if (opened != FileStatus::OK) {
+    return opened;
+  }
+  uint64 length = 0;
+  const FileStatus sized = file.getSize(length);
+  if (sized != FileStatus::OK) {
+    return sized;
+  }
+
+  // mmap rejects empty ranges; an empty file is an empty view
+  if (length == 0) {
+    this->mapped = true;
+    return FileStatus::OK;
+  }
+
+  const int protection =
+      access == Access::READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+  void* address = ::mmap(nullptr, static_cast<size_t>(length), protection,
+                         MAP_SHARED, file.getDescriptor(), 0);
+  if (address == MAP_FAILED) {
+    return FileStatus::MAP_ERROR;
+  }
+  this->data = static_cast<byte*>(address);
+  this->size = length;
+  this->mapped = true;
+
+  // Huge pages are best effort: unsupported kernels/filesystems just refuse
+#if defined(MADV_HUGEPAGE)
+  if (huge_pages) {
+    ::madvise(address, static_cast<size_t>(length), MADV_HUGEPAGE);
+  }
+#else
+  (void)huge_pages;
+#endif
+  return FileStatus::OK;
+#else
+  (void)path;
+  (void)access;
+  (void)huge_pages;
+  return FileStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline void os::file::MappedFile::unmap() {
+#ifdef FILE_POSIX
+  if (this->data != nullptr) {
+    ::munmap(this->data, static_cast<size_t>(this->size));
+  }
+#endif
+  this->data = nullptr;
+  this->size = 0;
+  this->mapped = false;
+}
+
+inline FileStatus os::file::MappedFile::advise(const Advice advice,
+                                               const uint64 offset,
+                                               const uint64 length) {
+  if (!this->mapped) {
+    return FileStatus::NOT_OPEN_ERROR;
+  }
+  if (offset >= this->size) {
+    return FileStatus::OK;
+  }
+#ifdef FILE_POSIX
+  // madvise wants a page-aligned start
+  const uint64 page = static_cast<uint64>(sysconf(_SC_PAGESIZE));
+  const uint64 start = offset & ~(page - 1);
+  const uint64 available = this->size - start;
+  const uint64 wanted = length > UINT64_MAX - (offset - start)
+                            ? UINT64_MAX
+                            : length + (offset - start);
+  const uint64 range = wanted < available ? wanted : available;
+
+  int native = MADV_NORMAL;
+  switch (advice) {
+    case Advice::NORMAL:
+      native = MADV_NORMAL;
+      break;
+    case Advice::SEQUENTIAL:
+      native = MADV_SEQUENTIAL;
+      break;
+    case Advice::RANDOM:
+      native = MADV_RANDOM;
+      break;
+    case Advice::WILL_NEED:
+      native = MADV_WILLNEED;
+      break;
+    case Advice::DONT_NEED:
+      native = MADV_DONTNEED;
+      break;
+  }
+  return ::madvise(this->data + start, static_cast<size_t>(range), native) == 0
+             ? FileStatus::OK
+             : FileStatus::MAP_ERROR;
+#else
+  (void)advice;
+  (void)length;
+  return FileStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline FileStatus os::file::MappedFile::sync() {
+  if (!this->mapped) {
+    return FileStatus::NOT_OPEN_ERROR;
+  }
+  if (this->data == nullptr) {
+    return FileStatus::OK;
+  }
+#ifdef FILE_POSIX
+  return ::msync(this->data, static_cast<size_t>(this->size), MS_SYNC) == 0
+             ? FileStatus::OK
+             : FileStatus::WRITE_ERROR;
+#else
+  return FileStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline Span<const byte> os::file::MappedFile::view() const {
+  return Span<const byte>(this->data, this->size);
+}
+
+inline Span<byte> os::file::MappedFile::view_mutable() {
+  return Span<byte>(this->data, this->size);
+}
+
+inline byte* os::file::MappedFile::getData() const { return this->data; }
+
+inline uint64 os::file::MappedFile::getSize() const { return this->size; }
+
+inline bool os::file::MappedFile::isMapped() const { return this->mapped; }
+
+// === Implementation of os::file ===
+
+template <memory::Allocator A, GrowthPolicy G>
+inline FileStatus os::file::read_all(const char* path,
+                                     Vector<byte, A, G>& out) {
+  File file;
+  const FileStatus opened = file.open(path, Mode::READ);
+  if (opened != FileStatus::OK) {
+    return opened;
+  }
+
+  // Size the vector once from the file size
+  uint64 length = 0;
+  const FileStatus sized = file.getSize(length);
+  if (sized != FileStatus::OK) {
+    return sized;
+  }
+  if (out.resize(length) != VectorStatus::OK) {
+    return FileStatus::ALLOCATION_ERROR;
+  }
+
+  // The file may have shrunk in between: keep what was actually read
+  uint64 read_count = 0;
+  const FileStatus status = file.read(out.getData(), length, read_count);
+  out.resize(read_count);
+  return status;
+}
+
+inline FileStatus os::file::write_all(const char* path,
+                                      const Span<const byte> bytes) {
+  File file;
+  const FileStatus opened = file.open(path, Mode::WRITE);
+  if (opened != FileStatus::OK) {
+    return opened;
+  }
+  return file.write(bytes.getData(), bytes.getSize());
+}
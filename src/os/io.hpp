@@ -0,0 +1,905 @@
+// @file io.hpp
+
+#pragma once
+
+#include "../memory.hpp"
+#include "../queue.hpp"
+#include "../span.hpp"
+#include "../utilities/types.h"
+#include "thread.hpp"
+
+#ifndef RECREATIONS_ONLY
+#include "../utilities/os.hpp"
+#endif
+
+// The asynchronous engine drives io_uring through raw system calls where the
+// kernel headers provide it, and a pool of blocking pread/pwrite threads on
+// any other POSIX system. Freestanding builds report UNSUPPORTED_ERROR.
+#if defined(OS_POSIX_COMPATIBLE)
+#define IO_THREAD_POOL
+#include <errno.h>    // errno, EINTR
+#include <sys/uio.h>  // iovec
+#endif
+
+#if defined(OS_LINUX) && __has_include(<linux/io_uring.h>)
+#define IO_KERNEL_RING
+#include <linux/io_uring.h>  // io_uring_params, io_uring_sqe, io_uring_cqe
+#include <sys/syscall.h>     // __NR_io_uring_*
+#endif
+
+// @brief The status codes for operations on an asynchronous I/O engine.
+enum class IOStatus : int8 {
+  OK = 1,
+  SETUP_ERROR = 0,
+  QUEUE_FULL_ERROR = -1,
+  SUBMIT_ERROR = -2,
+  REGISTER_ERROR = -3,
+  BUFFER_ERROR = -4,
+  NOT_OPEN_ERROR = -5,
+  ALLOCATION_ERROR = -6,
+  UNSUPPORTED_ERROR = -7,
+};
+
+// @brief Asynchronous I/O. Requests are queued without blocking, handed to the
+// kernel in batches, and their completions are collected later by polling,
+// so a single thread can keep dozens of reads in flight.
+namespace os::io {
+
+// @brief The implementation behind an Engine.
+enum class Backend : uint8 {
+  // @brief io_uring if the kernel allows it, the thread pool otherwise.
+  AUTOMATIC,
+  // @brief Shared submission/completion rings with the kernel (Linux 5.1+).
+  IO_URING,
+  // @brief Blocking pread/pwrite calls on a pool of I/O threads.
+  THREAD_POOL,
+};
+
+// @brief How an Engine is set up.
+struct Options {
+  // @brief The maximum number of requests in flight (rounded up to a power of
+  // two by io_uring).
+  uint32 depth = 64;
+
+  // @brief The backend to use.
+  Backend backend = Backend::AUTOMATIC;
+
+  // @brief io_uring only: let a kernel thread poll the submission ring so
+  // flush() needs no system call while it is awake. Falls back to normal
+  // submission if the kernel refuses.
+  bool kernel_polling = false;
+
+  // @brief Thread pool only: the number of I/O threads (0: twice
+  // hardware_concurrency(), at most depth).
+  uint32 thread_count = 0;
+};
+
+// @brief A finished request.
+struct Completion {
+  // @brief The value passed when the request was submitted.
+  uint64 user_data;
+
+  // @brief The number of bytes transferred (possibly short, as with
+  // pread/pwrite), or a negated errno value.
+  int64 result;
+};
+
+// @brief An asynchronous read/write engine. Buffers passed to a submission
+// must stay valid until its completion has been polled. An engine is driven
+// from one thread at a time.
+class Engine {
+ public:
+  // @brief Creates an engine that is not open.
+  Engine() = default;
+
+  // @brief Destructor. Waits for every request in flight, then closes.
+  ~Engine();
+
+  // @brief Deleted copy constructor. Engines own kernel rings and threads.
+  Engine(const Engine&) = delete;
+
+  // @brief Deleted copy assignment operator. Engines own kernel rings and
+  // threads.
+  Engine& operator=(const Engine&) = delete;
+
+  // @brief Sets the engine up, closing it first if it is open.
+  // @param options The queue depth and backend.
+  // @return OK, SETUP_ERROR, ALLOCATION_ERROR or UNSUPPORTED_ERROR.
+  IOStatus open(const Options& options = Options());
+
+  // @brief Waits for every request in flight, then releases the engine.
+  void close();
+
+  // @brief Registers buffers with the kernel once, so the *_fixed requests
+  // skip pinning and mapping the pages on every call. Replaces any previous
+  // registration. No request may be in flight.
+  // @param regions The buffers (e.g. Vector<byte> storage).
+  // @param count The number of buffers.
+  // @return OK, NOT_OPEN_ERROR, SUBMIT_ERROR (requests in flight),
+  // ALLOCATION_ERROR or REGISTER_ERROR.
+  IOStatus register_buffers(const Span<byte>* regions, const uint32 count);
+
+  // @brief Queues a read of buffer.getSize() bytes at an offset.
+  // @param descriptor The file (see file::File::getDescriptor).
+  // @param buffer The destination.
+  // @param offset The file offset to read from.
+  // @param user_data Returned with the completion.
+  // @return OK, NOT_OPEN_ERROR, BUFFER_ERROR (more than UINT32_MAX bytes) or
+  // QUEUE_FULL_ERROR.
+  IOStatus submit_read(const int descriptor, const Span<byte> buffer,
+                       const uint64 offset, const uint64 user_data);
+
+  // @brief Queues a write of buffer.getSize() bytes at an offset.
+  // @param descriptor The file (see file::File::getDescriptor).
+  // @param buffer The source.
+  // @param offset The file offset to write at.
+  // @param user_data Returned with the completion.
+  // @return OK, NOT_OPEN_ERROR, BUFFER_ERROR (more than UINT32_MAX bytes) or
+  // QUEUE_FULL_ERROR.
+  IOStatus submit_write(const int descriptor, const Span<const byte> buffer,
+                        const uint64 offset, const uint64 user_data);
+
+  // @brief Queues a read into the start of a registered buffer.
+  // @param descriptor The file.
+  // @param index The index of the buffer in the registration.
+  // @param size The number of bytes to read (at most the buffer size and
+  // UINT32_MAX).
+  // @param offset The file offset to read from.
+  // @param user_data Returned with the completion.
+  // @return OK, NOT_OPEN_ERROR, BUFFER_ERROR or QUEUE_FULL_ERROR.
+  IOStatus submit_read_fixed(const int descriptor, const uint32 index,
+                             const uint64 size, const uint64 offset,
+                             const uint64 user_data);
+
+  // @brief Queues a write from the start of a registered buffer.
+  // @param descriptor The file.
+  // @param index The index of the buffer in the registration.
+  // @param size The number of bytes to write (at most the buffer size and
+  // UINT32_MAX).
+  // @param offset The file offset to write at.
+  // @param user_data Returned with the completion.
+  // @return OK, NOT_OPEN_ERROR, BUFFER_ERROR or QUEUE_FULL_ERROR.
+  IOStatus submit_write_fixed(const int descriptor, const uint32 index,
+                              const uint64 size, const uint64 offset,
+                              const uint64 user_data);
+
+  // @brief Hands every queued request to the kernel (or the I/O threads) in
+  // one batch. Called by poll() as well.
+  // @return OK, NOT_OPEN_ERROR or SUBMIT_ERROR (the unsubmitted requests stay
+  // queued).
+  IOStatus flush();
+
+  // @brief Flushes, then collects finished requests.
+  // @param out Receives the completions.
+  // @param capacity The number of entries out can hold.
+  // @param wait_for Block until at least this many completions are available
+  // (clamped to the requests in flight; 0 never blocks).
+  // @return The number of completions written.
+  uint32 poll(Completion* out, const uint32 capacity,
+              const uint32 wait_for = 0);
+
+  // @brief Returns the backend in use.
+  // @return IO_URING or THREAD_POOL (AUTOMATIC if not open).
+  Backend getBackend() const;
+
+  // @brief Returns the maximum number of requests in flight.
+  // @return The depth (0 if not open).
+  uint32 getDepth() const;
+
+  // @brief Returns the number of requests queued or running whose
+  // completion has not been polled yet.
+  // @return The outstanding request count.
+  uint32 getOutstanding() const;
+
+  // @brief Checks whether the engine is set up.
+  // @return true after a successful open().
+  bool isOpen() const;
+
+ private:
+  // @brief The kinds of request.
+  enum class Operation : uint8 { READ, WRITE };
+
+  // @brief A request waiting for an I/O thread.
+  struct Request {
+    int descriptor;
+    Operation operation;
+    byte* buffer;
+    uint64 size;
+    uint64 offset;
+    uint64 user_data;
+  };
+
+  // @brief The state shared with the I/O threads. Requests and completions
+  // are handed over through lock-free queues of at least depth entries, which
+  // never fill up since at most depth requests are outstanding; the mutex
+  // only guards sleeping and waking.
+  struct Pool {
+    MPMCQueue<Request> requests;
+    MPMCQueue<Completion> completions;
+    bool stopping;
+    os::thread::Thread* threads;
+    uint32 thread_count;
+#ifdef IO_THREAD_POOL
+    pthread_mutex_t mutex;
+    pthread_cond_t work;
+    pthread_cond_t done;
+#endif
+  };
+
+  // @brief The backend in use.
+  Backend backend = Backend::AUTOMATIC;
+
+  // @brief The maximum number of outstanding requests.
+  uint32 depth = 0;
+
+  // @brief Requests queued or submitted whose completion was not polled.
+  uint32 outstanding = 0;
+
+  // @brief Requests queued since the last flush.
+  uint32 pending = 0;
+
+  // @brief The registered buffers.
+  Span<byte>* buffers = nullptr;
+  uint32 buffer_count = 0;
+
+  // @brief The io_uring descriptor, or -1.
+  int ring = -1;
+
+  // @brief Whether a kernel thread polls the submission ring.
+  bool kernel_polling = false;
+
+  // @brief The mapped submission ring, completion ring and entry array.
+  void* sq_map = nullptr;
+  uint64 sq_map_size = 0;
+  void* cq_map = nullptr;
+  uint64 cq_map_size = 0;
+  void* sq_entries = nullptr;
+  uint64 sq_entries_size = 0;
+
+  // @brief Pointers into the mapped rings.
+  uint32* sq_tail = nullptr;
+  uint32* sq_mask = nullptr;
+  uint32* sq_flags = nullptr;
+  uint32* sq_array = nullptr;
+  uint32* cq_head = nullptr;
+  uint32* cq_tail = nullptr;
+  uint32* cq_mask = nullptr;
+  void* cq_entries = nullptr;
+
+  // @brief The submission tail as seen by this side, published on flush.
+  uint32 sq_local_tail = 0;
+
+  // @brief The thread pool, or nullptr.
+  Pool* pool = nullptr;
+
+  // @brief Sets up io_uring.
+  // @param options The requested depth and polling mode.
+  // @return OK or SETUP_ERROR.
+  IOStatus open_ring(const Options& options);
+
+  // @brief Starts the thread pool.
+  // @param options The requested depth and thread count.
+  // @return OK, ALLOCATION_ERROR or SETUP_ERROR.
+  IOStatus open_pool(const Options& options);
+
+  // @brief Queues one request on the active backend.
+  // @param operation Read or write.
+  // @param descriptor The file.
+  // @param buffer The buffer.
+  // @param size The number of bytes.
+  // @param offset The file offset.
+  // @param user_data Returned with the completion.
+  // @param index The registered buffer index, or UINT32_MAX.
+  // @return OK, NOT_OPEN_ERROR, BUFFER_ERROR or QUEUE_FULL_ERROR.
+  IOStatus queue(const Operation operation, const int descriptor,
+                 byte* buffer, const uint64 size, const uint64 offset,
+                 const uint64 user_data, const uint32 index);
+
+  // @brief Copies available io_uring completions without blocking.
+  // @param out Receives the completions.
+  // @param capacity The number of entries out can hold.
+  // @return The number of completions copied.
+  uint32 reap_ring(Completion* out, const uint32 capacity);
+
+  // @brief The loop run by every I/O thread.
+  // @param argument The Pool.
+  static void pool_main(void* argument);
+};
+
+}  // namespace os::io
+
+// === Implementation of os::io::Engine ===
+
+inline os::io::Engine::~Engine() { this->close(); }
+
+inline IOStatus os::io::Engine::open(const Options& options) {
+  this->close();
+  if (options.depth == 0) {
+    return IOStatus::SETUP_ERROR;
+  }
+
+  // Prefer io_uring; AUTOMATIC falls back when the kernel refuses it
+  if (options.backend != Backend::THREAD_POOL) {
+    const IOStatus status = this->open_ring(options);
+    if (status == IOStatus::OK || options.backend == Backend::IO_URING) {
+      return status;
+    }
+  }
+  return this->open_pool(options);
+}
+
+inline void os::io::Engine::close() {
+  // Requests still in flight write into caller buffers: let them finish
+  Completion drained[64];
+  while (this->outstanding > 0) {
+    if (this->poll(drained, 64, 1) == 0) {
+      break;
+    }
+  }
+
+#ifdef IO_KERNEL_RING
+  // Unmapping and closing the ring also drops the buffer registration
+  if (this->sq_entries != nullptr) {
+    ::munmap(this->sq_entries, static_cast<size_t>(this->sq_entries_size));
+  }
+  if (this->cq_map != nullptr && this->cq_map != this->sq_map) {
+    ::munmap(this->cq_map, static_cast<size_t>(this->cq_map_size));
+  }
+  if (this->sq_map != nullptr) {
+    ::munmap(this->sq_map, static_cast<size_t>(this->sq_map_size));
+  }
+  if (this->ring >= 0) {
+    ::close(this->ring);
+  }
+#endif
+  this->ring = -1;
+  this->sq_map = nullptr;
+  this->cq_map = nullptr;
+  this->sq_entries = nullptr;
+
+#ifdef IO_THREAD_POOL
+  // Stop and join the I/O threads
+  if (this->pool != nullptr) {
+    Pool* shared = this->pool;
+    pthread_mutex_lock(&shared->mutex);
+    shared->stopping = true;
+    pthread_cond_broadcast(&shared->work);
+    pthread_mutex_unlock(&shared->mutex);
+    for (uint32 i = 0; i < shared->thread_count; i++) {
+      ::memory::destroy(&shared->threads[i]);
+    }
+    pthread_cond_destroy(&shared->done);
+    pthread_cond_destroy(&shared->work);
+    pthread_mutex_destroy(&shared->mutex);
+    ::memory::deallocate(shared->threads);
+    ::memory::destroy(shared);
+    ::memory::deallocate(shared);
+  }
+#endif
+  this->pool = nullptr;
+
+  ::memory::deallocate(this->buffers);
+  this->buffers = nullptr;
+  this->buffer_count = 0;
+  this->backend = Backend::AUTOMATIC;
+  this->depth = 0;
+  this->outstanding = 0;
+  this->pending = 0;
+  this->kernel_polling = false;
+  this->sq_local_tail = 0;
+}
+
+inline IOStatus os::io::Engine::open_ring(const Options& options) {
+#ifdef IO_KERNEL_RING
+  // Create the ring, with a kernel polling thread if asked and allowed
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  long result = -1;
+  if (options.kernel_polling) {
+    params.flags = IORING_SETUP_SQPOLL;
+    params.sq_thread_idle = 1000;
+    result = syscall(__NR_io_uring_setup, options.depth, &params);
+    this->kernel_polling = result >= 0;
+  }
+  if (result < 0) {
+    memset(&params, 0, sizeof(params));
+    result = syscall(__NR_io_uring_setup, options.depth, &params);
+  }
+  if (result < 0) {
+    return IOStatus::SETUP_ERROR;
+  }
+  this->ring = static_cast<int>(result);
+
+  // Map the rings: one mapping for both on kernels with SINGLE_MMAP
+  this->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(uint32);
+  this->cq_map_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single && this->cq_map_size > this->sq_map_size) {
+    this->sq_map_size = this->cq_map_size;
+  }
+  void* sq = ::mmap(nullptr, static_cast<size_t>(this->sq_map_size),
+                    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    this->ring, IORING_OFF_SQ_RING);
+  if (sq == MAP_FAILED) {
+    this->close();
+    return IOStatus::SETUP_ERROR;
+  }
+  this->sq_map = sq;
+  if (single) {
+    this->cq_map = sq;
+  } else {
+    void* cq = ::mmap(nullptr, static_cast<size_t>(this->cq_map_size),
+                      PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      this->ring, IORING_OFF_CQ_RING);
+    if (cq == MAP_FAILED) {
+      this->close();
+      return IOStatus::SETUP_ERROR;
+    }
+    this->cq_map = cq;
+  }
+  this->sq_entries_size = params.sq_entries * sizeof(io_uring_sqe);
+  void* entries = ::mmap(nullptr, static_cast<size_t>(this->sq_entries_size),
+                         PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         this->ring, IORING_OFF_SQES);
+  if (entries == MAP_FAILED) {
+    this->close();
+    return IOStatus::SETUP_ERROR;
+  }
+  this->sq_entries = entries;
+
+  // Locate the ring fields
+  byte* sq_base = static_cast<byte*>(this->sq_map);
+  byte* cq_base = static_cast<byte*>(this->cq_map);
+  this->sq_tail = reinterpret_cast<uint32*>(sq_base + params.sq_off.tail);
+  this->sq_mask = reinterpret_cast<uint32*>(sq_base + params.sq_off.ring_mask);
+  this->sq_flags = reinterpret_cast<uint32*>(sq_base + params.sq_off.flags);
+  this->sq_array = reinterpret_cast<uint32*>(sq_base + params.sq_off.array);
+  this->cq_head = reinterpret_cast<uint32*>(cq_base + params.cq_off.head);
+  this->cq_tail = reinterpret_cast<uint32*>(cq_base + params.cq_off.tail);
+  this->cq_mask = reinterpret_cast<uint32*>(cq_base + params.cq_off.ring_mask);
+  this->cq_entries = cq_base + params.cq_off.cqes;
+  this->sq_local_tail = *this->sq_tail;
+
+  // The completion ring is at least as large, so it never overflows
+  this->depth = params.sq_entries;
+  this->backend = Backend::IO_URING;
+  return IOStatus::OK;
+#else
+  (void)options;
+  return IOStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline IOStatus os::io::Engine::open_pool(const Options& options) {
+#ifdef IO_THREAD_POOL
+  // Blocking threads overlap I/O, not computation: use more than the CPUs
+  uint32 count = options.thread_count;
+  if (count == 0) {
+    count = 2 * os::thread::hardware_concurrency();
+  }
+  if (count > options.depth) {
+    count = options.depth;
+  }
+
+  // Allocate the shared state and both queues
+  Pool* shared = static_cast<Pool*>(::memory::allocate(sizeof(Pool)));
+  if (shared == nullptr) {
+    return IOStatus::ALLOCATION_ERROR;
+  }
+  ::memory::construct(&shared->requests, options.depth);
+  ::memory::construct(&shared->completions, options.depth);
+  shared->threads = static_cast<os::thread::Thread*>(
+      ::memory::allocate(count * sizeof(os::thread::Thread)));
+  if (!shared->requests.isInitialized() ||
+      !shared->completions.isInitialized() || shared->threads == nullptr) {
+    ::memory::deallocate(shared->threads);
+    ::memory::destroy(&shared->completions);
+    ::memory::destroy(&shared->requests);
+    ::memory::deallocate(shared);
+    return IOStatus::ALLOCATION_ERROR;
+  }
+  shared->stopping = false;
+  shared->thread_count = count;
+  pthread_mutex_init(&shared->mutex, nullptr);
+  pthread_cond_init(&shared->work, nullptr);
+  pthread_cond_init(&shared->done, nullptr);
+  this->pool = shared;
+  this->depth = options.depth;
+  this->backend = Backend::THREAD_POOL;
+
+  // Start the threads; without any the engine could never complete
+  uint32 started = 0;
+  for (uint32 i = 0; i < count; i++) {
+    ::memory::construct(&shared->threads[i]);
+    started += shared->threads[i].start(&pool_main, shared) ? 1 : 0;
+  }
+  if (started == 0) {
+    this->close();
+    return IOStatus::SETUP_ERROR;
+  }
+  return IOStatus::OK;
+#else
+  (void)options;
+  return IOStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline IOStatus os::io::Engine::register_buffers(const Span<byte>* regions,
+                                                 const uint32 count) {
+  if (!this->isOpen()) {
+    return IOStatus::NOT_OPEN_ERROR;
+  }
+  if (this->outstanding > 0) {
+    return IOStatus::SUBMIT_ERROR;
+  }
+
+  // Keep a copy for bounds checks and for the thread pool
+  Span<byte>* copy = nullptr;
+  if (count > 0) {
+    copy = static_cast<Span<byte>*>(
+        ::memory::allocate(count * sizeof(Span<byte>)));
+    if (copy == nullptr) {
+      return IOStatus::ALLOCATION_ERROR;
+    }
+    for (uint32 i = 0; i < count; i++) {
+      ::memory::construct(&copy[i], regions[i]);
+    }
+  }
+
+#ifdef IO_KERNEL_RING
+  // Replace the kernel registration: pages are pinned once, here
+  if (this->backend == Backend::IO_URING) {
+    if (this->buffer_count > 0) {
+      syscall(__NR_io_uring_register, this->ring, IORING_UNREGISTER_BUFFERS,
+              nullptr, 0);
+    }
+    if (count > 0) {
+      iovec* vectors =
+          static_cast<iovec*>(::memory::allocate(count * sizeof(iovec)));
+      if (vectors == nullptr) {
+        ::memory::deallocate(copy);
+        this->buffer_count = 0;
+        return IOStatus::ALLOCATION_ERROR;
+      }
+      for (uint32 i = 0; i < count; i++) {
+        vectors[i].iov_base = regions[i].getData();
+        vectors[i].iov_len = static_cast<size_t>(regions[i].getSize());
+      }
+      const long result =
+          syscall(__NR_io_uring_register, this->ring, IORING_REGISTER_BUFFERS,
+                  vectors, count);
+      ::memory::deallocate(vectors);
+      if (result < 0) {
+        ::memory::deallocate(copy);
+        ::memory::deallocate(this->buffers);
+        this->buffers = nullptr;
+        this->buffer_count = 0;
+        return IOStatus::REGISTER_ERROR;
+      }
+    }
+  }
+#endif
+
+  ::memory::deallocate(this->buffers);
+  this->buffers = copy;
+  this->buffer_count = count;
+  return IOStatus::OK;
+}
+
+inline IOStatus os::io::Engine::submit_read(const int descriptor,
+                                            const Span<byte> buffer,
+                                            const uint64 offset,
+                                            const uint64 user_data) {
+  return this->queue(Operation::READ, descriptor, buffer.getData(),
+                     buffer.getSize(), offset, user_data, UINT32_MAX);
+}
+
+inline IOStatus os::io::Engine::submit_write(const int descriptor,
+                                             const Span<const byte> buffer,
+                                             const uint64 offset,
+                                             const uint64 user_data) {
+  // The buffer is only read; the request type is shared with reads
+  return this->queue(Operation::WRITE, descriptor,
+                     const_cast<byte*>(buffer.getData()), buffer.getSize(),
+                     offset, user_data, UINT32_MAX);
+}
+
+inline IOStatus os::io::Engine::submit_read_fixed(const int descriptor,
+                                                  const uint32 index,
+                                                  const uint64 size,
+                                                  const uint64 offset,
+                                                  const uint64 user_data) {
+  if (index >= this->buffer_count || size > this->buffers[index].getSize()) {
+    return this->isOpen() ? IOStatus::BUFFER_ERROR : IOStatus::NOT_OPEN_ERROR;
+  }
+  return this->queue(Operation::READ, descriptor,
+                     this->buffers[index].getData(), size, offset, user_data,
+                     index);
+}
+
+inline IOStatus os::io::Engine::submit_write_fixed(const int descriptor,
+                                                   const uint32 index,
+                                                   const uint64 size,
+                                                   const uint64 offset,
+                                                   const uint64 user_data) {
+  if (index >= this->buffer_count || size > this->buffers[index].getSize()) {
+    return this->isOpen() ? IOStatus::BUFFER_ERROR : IOStatus::NOT_OPEN_ERROR;
+  }
+  return this->queue(Operation::WRITE, descriptor,
+                     this->buffers[index].getData(), size, offset, user_data,
+                     index);
+}
+
+inline IOStatus os::io::Engine::queue(const Operation operation,
+                                      const int descriptor, byte* buffer,
+                                      const uint64 size, const uint64 offset,
+                                      const uint64 user_data,
+                                      const uint32 index) {
+  if (!this->isOpen()) {
+    return IOStatus::NOT_OPEN_ERROR;
+  }
+  // A submission entry holds a 32-bit length; both engines share the limit
+  if (size > UINT32_MAX) {
+    return IOStatus::BUFFER_ERROR;
+  }
+  if (this->outstanding == this->depth) {
+    return IOStatus::QUEUE_FULL_ERROR;
+  }
+
+#ifdef IO_KERNEL_RING
+  if (this->backend == Backend::IO_URING) {
+    // Fill the next submission entry; the kernel sees it on flush()
+    const uint32 slot = this->sq_local_tail & *this->sq_mask;
+    io_uring_sqe* entry = static_cast<io_uring_sqe*>(this->sq_entries) + slot;
+    memset(entry, 0, sizeof(*entry));
+    const bool fixed = index != UINT32_MAX;
+    if (operation == Operation::READ) {
+      entry->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    } else {
+      entry->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    }
+    entry->fd = descriptor;
+    entry->off = offset;
+    entry->addr = reinterpret_cast<uint64>(buffer);
+    entry->len = static_cast<uint32>(size);
+    entry->user_data = user_data;
+    if (fixed) {
+      entry->buf_index = static_cast<uint16>(index);
+    }
+    this->sq_array[slot] = slot;
+    this->sq_local_tail++;
+    this->pending++;
+    this->outstanding++;
+    return IOStatus::OK;
+  }
+#endif
+
+#ifdef IO_THREAD_POOL
+  // Hand the request over without locking; the threads are woken on flush()
+  (void)index;
+  this->pool->requests.push(
+      {descriptor, operation, buffer, size, offset, user_data});
+  this->pending++;
+  this->outstanding++;
+  return IOStatus::OK;
+#else
+  (void)operation;
+  (void)descriptor;
+  (void)buffer;
+  (void)size;
+  (void)offset;
+  (void)user_data;
+  (void)index;
+  return IOStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline IOStatus os::io::Engine::flush() {
+  if (!this->isOpen()) {
+    return IOStatus::NOT_OPEN_ERROR;
+  }
+  if (this->pending == 0) {
+    return IOStatus::OK;
+  }
+
+#ifdef IO_KERNEL_RING
+  if (this->backend == Backend::IO_URING) {
+    // Publish the entries filled since the last flush
+    __atomic_store_n(this->sq_tail, this->sq_local_tail, __ATOMIC_RELEASE);
+
+    // A polling kernel thread picks them up itself unless it went idle
+    if (this->kernel_polling) {
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+      if ((__atomic_load_n(this->sq_flags, __ATOMIC_RELAXED) &
+           IORING_SQ_NEED_WAKEUP) != 0) {
+        syscall(__NR_io_uring_enter, this->ring, 0, 0,
+                IORING_ENTER_SQ_WAKEUP, nullptr, 0);
+      }
+      this->pending = 0;
+      return IOStatus::OK;
+    }
+
+    // One system call submits the whole batch
+    while (this->pending > 0) {
+      const long result = syscall(__NR_io_uring_enter, this->ring,
+                                  this->pending, 0, 0, nullptr, 0);
+      if (result < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return IOStatus::SUBMIT_ERROR;
+      }
+      if (result == 0) {
+        return IOStatus::SUBMIT_ERROR;
+      }
+      this->pending -= static_cast<uint32>(result);
+    }
+    return IOStatus::OK;
+  }
+#endif
+
+#ifdef IO_THREAD_POOL
+  // Wake as many threads as there are new requests
+  Pool* shared = this->pool;
+  pthread_mutex_lock(&shared->mutex);
+  if (this->pending >= shared->thread_count) {
+    pthread_cond_broadcast(&shared->work);
+  } else {
+    for (uint32 i = 0; i < this->pending; i++) {
+      pthread_cond_signal(&shared->work);
+    }
+  }
+  pthread_mutex_unlock(&shared->mutex);
+  this->pending = 0;
+  return IOStatus::OK;
+#else
+  return IOStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline uint32 os::io::Engine::poll(Completion* out, const uint32 capacity,
+                                   const uint32 wait_for) {
+  if (this->flush() != IOStatus::OK && this->pending == this->outstanding) {
+    return 0;
+  }
+
+  // Never wait for more than can arrive or fit
+  const uint32 submitted = this->outstanding - this->pending;
+  uint32 wanted = wait_for < submitted ? wait_for : submitted;
+  if (wanted > capacity) {
+    wanted = capacity;
+  }
+
+#ifdef IO_KERNEL_RING
+  if (this->backend == Backend::IO_URING) {
+    uint32 count = this->reap_ring(out, capacity);
+    while (count < wanted) {
+      const long result =
+          syscall(__NR_io_uring_enter, this->ring, 0, wanted - count,
+                  IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (result < 0 && errno != EINTR) {
+        break;
+      }
+      count += this->reap_ring(out + count, capacity - count);
+    }
+    this->outstanding -= count;
+    return count;
+  }
+#endif
+
+#ifdef IO_THREAD_POOL
+  // Drain what has completed; only sleep if that is not enough. Threads
+  // publish before taking the mutex to signal, so no wakeup is missed.
+  Pool* shared = this->pool;
+  uint32 count =
+      static_cast<uint32>(shared->completions.pop_batch(out, capacity));
+  if (count < wanted) {
+    pthread_mutex_lock(&shared->mutex);
+    for (;;) {
+      count += static_cast<uint32>(
+          shared->completions.pop_batch(out + count, capacity - count));
+      if (count >= wanted) {
+        break;
+      }
+      pthread_cond_wait(&shared->done, &shared->mutex);
+    }
+    pthread_mutex_unlock(&shared->mutex);
+  }
+  this->outstanding -= count;
+  return count;
+#else
+  (void)out;
+  return 0;
+#endif
+}
+
+inline uint32 os::io::Engine::reap_ring(Completion* out,
+                                        const uint32 capacity) {
+#ifdef IO_KERNEL_RING
+  // The kernel publishes the tail after writing the entries before it
+  const uint32 mask = *this->cq_mask;
+  uint32 head = *this->cq_head;
+  const uint32 tail = __atomic_load_n(this->cq_tail, __ATOMIC_ACQUIRE);
+  const io_uring_cqe* entries =
+      static_cast<const io_uring_cqe*>(this->cq_entries);
+  uint32 count = 0;
+  while (head != tail && count < capacity) {
+    const io_uring_cqe& entry = entries[head & mask];
+    out[count].user_data = entry.user_data;
+    out[count].result = entry.res;
+    count++;
+    head++;
+  }
+
+  // Hand the consumed slots back
+  __atomic_store_n(this->cq_head, head, __ATOMIC_RELEASE);
+  return count;
+#else
+  (void)out;
+  (void)capacity;
+  return 0;
+#endif
+}
+
+inline void os::io::Engine::pool_main(void* argument) {
+#ifdef IO_THREAD_POOL
+  Pool* shared = static_cast<Pool*>(argument);
+  for (;;) {
+    // Sleep until there is a request or the engine closes. The queue is
+    // checked again under the mutex flush() signals with, so a request
+    // pushed meanwhile is never slept through.
+    Request request;
+    if (shared->requests.pop(request) != QueueStatus::OK) {
+      pthread_mutex_lock(&shared->mutex);
+      while (shared->requests.isEmpty() && !shared->stopping) {
+        pthread_cond_wait(&shared->work, &shared->mutex);
+      }
+      const bool stop = shared->requests.isEmpty();
+      pthread_mutex_unlock(&shared->mutex);
+      if (stop) {
+        break;
+      }
+      continue;
+    }
+
+    // One blocking call, like a single io_uring operation
+    ssize_t result;
+    do {
+      if (request.operation == Operation::READ) {
+        result = ::pread(request.descriptor, request.buffer,
+                         static_cast<size_t>(request.size),
+                         static_cast<off_t>(request.offset));
+      } else {
+        result = ::pwrite(request.descriptor, request.buffer,
+                          static_cast<size_t>(request.size),
+                          static_cast<off_t>(request.offset));
+      }
+    } while (result < 0 && errno == EINTR);
+    const int64 value =
+        result < 0 ? -static_cast<int64>(errno) : static_cast<int64>(result);
+
+    // Publish the completion, then wake a poll() that may be waiting for it
+    shared->completions.push({request.user_data, value});
+    pthread_mutex_lock(&shared->mutex);
+    pthread_cond_signal(&shared->done);
+    pthread_mutex_unlock(&shared->mutex);
+  }
+#else
+  (void)argument;
+#endif
+}
+
+inline os::io::Backend os::io::Engine::getBackend() const {
+  return this->backend;
+}
+
+inline uint32 os::io::Engine::getDepth() const { return this->depth; }
+
+inline uint32 os::io::Engine::getOutstanding() const {
+  return this->outstanding;
+}
+
+inline bool os::io::Engine::isOpen() const {
+  return this->backend != Backend::AUTOMATIC;
+}
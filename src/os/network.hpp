@@ -0,0 +1,1748 @@
+// @file network.hpp
+
+#pragma once
+
+#include "../memory.hpp"
+#include "../span.hpp"
+#include "../utilities/types.h"
+#include "../vector.hpp"
+#include "clock.hpp"
+
+#ifndef RECREATIONS_ONLY
+#include "../utilities/os.hpp"
+#endif
+
+// Sockets go through the BSD socket API on any POSIX system; the event loop
+// needs epoll, so it is Linux only. Elsewhere operations report
+// UNSUPPORTED_ERROR.
+#if defined(OS_POSIX_COMPATIBLE)
+#define NETWORK_POSIX
+#include <errno.h>        // errno, EINTR, EAGAIN
+#include <netinet/tcp.h>  // TCP_NODELAY
+#endif
+
+#if defined(OS_LINUX)
+#define NETWORK_EPOLL
+#include <sys/epoll.h>    // epoll_create1, epoll_ctl, epoll_wait
+#include <sys/eventfd.h>  // eventfd
+#endif
+
+// @brief The status codes for operations on sockets and event loops.
+enum class NetworkStatus : int8 {
+  OK = 1,
+  CREATE_ERROR = 0,
+  ADDRESS_ERROR = -1,
+  BIND_ERROR = -2,
+  LISTEN_ERROR = -3,
+  CONNECT_ERROR = -4,
+  ACCEPT_ERROR = -5,
+  OPTION_ERROR = -6,
+  READ_ERROR = -7,
+  WRITE_ERROR = -8,
+  WOULD_BLOCK_ERROR = -9,
+  CLOSED_ERROR = -10,
+  NOT_OPEN_ERROR = -11,
+  POLL_ERROR = -12,
+  ALLOCATION_ERROR = -13,
+  UNSUPPORTED_ERROR = -14,
+};
+
+// @brief Non-blocking TCP over IPv4, a single-threaded epoll reactor and a
+// connection server on top of it. Run one Loop and Server per core, each
+// listening on the same port with reuse_port: the kernel then spreads the
+// incoming connections over the loops and no state is shared between them.
+namespace os::network {
+
+// @brief Readiness flags passed to Loop::watch and reported to handlers.
+namespace event {
+
+// @brief Data can be read, or a listener has connections to accept.
+inline constexpr uint32 READABLE = 1;
+
+// @brief Data can be written, or a connect finished.
+inline constexpr uint32 WRITABLE = 2;
+
+// @brief The peer closed its side (reported even if not asked for).
+inline constexpr uint32 HANGUP = 4;
+
+// @brief The socket has a pending error (reported even if not asked for).
+inline constexpr uint32 FAILED = 8;
+
+}  // namespace event
+
+// @brief An IPv4 endpoint.
+struct Address {
+  // @brief The address in host byte order (0x7F000001 is 127.0.0.1).
+  uint32 host = 0;
+
+  // @brief The port in host byte order.
+  uint16 port = 0;
+};
+
+// @brief Returns the loopback address (127.0.0.1).
+// @param port The port.
+// @return The address.
+Address loopback(const uint16 port);
+
+// @brief Returns the wildcard address (0.0.0.0), listening on every
+// interface.
+// @param port The port.
+// @return The address.
+Address any(const uint16 port);
+
+// @brief Parses a dotted IPv4 address.
+// @param text The NUL-terminated text ("192.168.1.10").
+// @param port The port.
+// @param address Receives the address.
+// @return OK, ADDRESS_ERROR or UNSUPPORTED_ERROR.
+NetworkStatus parse_address(const char* text, const uint16 port,
+                            Address& address);
+
+// @brief A non-blocking TCP socket. Closed on destruction.
+class Socket {
+ public:
+  // @brief Creates a handle with no socket attached.
+  Socket() = default;
+
+  // @brief Destructor. Closes the socket if open.
+  ~Socket();
+
+  // @brief Deleted copy constructor. Sockets are owned by one handle.
+  Socket(const Socket&) = delete;
+
+  // @brief Deleted copy assignment operator. Sockets are owned by one handle.
+  Socket& operator=(const Socket&) = delete;
+
+  // @brief Move constructor. Takes over the descriptor of another handle.
+  // @param other The handle to move from.
+  Socket(Socket&& other) noexcept;
+
+  // @brief Move assignment operator. Closes the current socket first.
+  // @param other The handle to move from.
+  // @return A reference to this handle.
+  Socket& operator=(Socket&& other) noexcept;
+
+  // @brief Opens a listening socket, closing any socket already attached.
+  // The local address is always reusable, so restarts do not wait out
+  // TIME_WAIT.
+  // @param address The address to bind (port 0 picks a free port; see
+  // getLocalAddress).
+  // @param reuse_port Let several sockets listen on the same port, one per
+  // loop, with the kernel balancing connections between them.
+  // @param backlog The length of the queue of unaccepted connections.
+  // @return OK, CREATE_ERROR, OPTION_ERROR, BIND_ERROR, LISTEN_ERROR or
+  // UNSUPPORTED_ERROR.
+  NetworkStatus listen(const Address& address, const bool reuse_port = false,
+                       const int backlog = 1024);
+
+  // @brief Starts connecting to a server, closing any socket already
+  // attached. The connection usually completes later: wait for WRITABLE,
+  // then check getError().
+  // @param address The server.
+  // @return OK (connected or in progress), CREATE_ERROR, CONNECT_ERROR or
+  // UNSUPPORTED_ERROR.
+  NetworkStatus connect(const Address& address);
+
+  // @brief Accepts one pending connection as a non-blocking socket.
+  // @param client Receives the connection (any socket it held is closed).
+  // @return OK, WOULD_BLOCK_ERROR (none pending), NOT_OPEN_ERROR or
+  // ACCEPT_ERROR (e.g. out of descriptors).
+  NetworkStatus accept(Socket& client);
+
+  // @brief Reads the bytes available, without waiting.
+  // @param buffer The destination.
+  // @param size The number of bytes buffer can hold.
+  // @param read_count Receives the number of bytes read.
+  // @return OK, WOULD_BLOCK_ERROR, CLOSED_ERROR (the peer closed its side),
+  // NOT_OPEN_ERROR or READ_ERROR.
+  NetworkStatus read(void* buffer, const uint64 size, uint64& read_count);
+
+  // @brief Writes as much as the socket buffer takes, without waiting.
+  // Never raises SIGPIPE.
+  // @param buffer The source.
+  // @param size The number of bytes to write.
+  // @param written Receives the number of bytes written (possibly short).
+  // @return OK, WOULD_BLOCK_ERROR, CLOSED_ERROR (the peer is gone),
+  // NOT_OPEN_ERROR or WRITE_ERROR.
+  NetworkStatus write(const void* buffer, const uint64 size, uint64& written);
+
+  // @brief Enables or disables Nagle's algorithm. Disabled, small writes go
+  // out immediately instead of waiting to be coalesced.
+  // @param enabled true to send small writes immediately.
+  // @return OK, NOT_OPEN_ERROR or OPTION_ERROR.
+  NetworkStatus set_no_delay(const bool enabled);
+
+  // @brief Closes the socket. Does nothing if no socket is attached.
+  void close();
+
+  // @brief Reads and clears the pending socket error, e.g. the outcome of a
+  // connect.
+  // @return OK, NOT_OPEN_ERROR or CONNECT_ERROR.
+  NetworkStatus getError() const;
+
+  // @brief Queries the address the socket is bound to.
+  // @param address Receives the address.
+  // @return OK, NOT_OPEN_ERROR or OPTION_ERROR.
+  NetworkStatus getLocalAddress(Address& address) const;
+
+  // @brief Returns the underlying descriptor, for Loop::watch.
+  // @return The descriptor, or -1 if not open.
+  int getDescriptor() const;
+
+  // @brief Checks whether a socket is attached.
+  // @return true if open.
+  bool isOpen() const;
+
+ private:
+  // @brief The socket descriptor, or -1.
+  int descriptor = -1;
+
+  // @brief Creates a non-blocking, close-on-exec TCP socket.
+  // @return The descriptor, or -1 on failure.
+  static int create();
+
+  // @brief Checks whether errno says the call would have blocked.
+  // @return true for EAGAIN and EWOULDBLOCK.
+  static bool would_block();
+};
+
+// @brief A single-threaded reactor. Descriptors are watched edge-triggered:
+// a handler is called when a socket becomes readable or writable and must
+// then read or write until WOULD_BLOCK_ERROR, or it will not be called
+// again. Timers run on the same thread. Only stop() may be called from other
+// threads.
+class Loop {
+ public:
+  // @brief Called when a watched descriptor becomes ready.
+  // @param context The value given to watch().
+  // @param events The event:: flags that are ready.
+  using Handler = void (*)(void* context, const uint32 events);
+
+  // @brief Called when a timer expires.
+  // @param context The value given to add_timer().
+  using TimerFunction = void (*)(void* context);
+
+  // @brief The largest number of readiness events handled per wait.
+  static constexpr uint32 BATCH = 256;
+
+  // @brief Creates a loop that is not open.
+  Loop() = default;
+
+  // @brief Destructor. Closes the loop.
+  ~Loop();
+
+  // @brief Deleted copy constructor. Loops own kernel objects.
+  Loop(const Loop&) = delete;
+
+  // @brief Deleted copy assignment operator. Loops own kernel objects.
+  Loop& operator=(const Loop&) = delete;
+
+  // @brief Sets the loop up, closing it first if it is open.
+  // @return OK, POLL_ERROR, ALLOCATION_ERROR or UNSUPPORTED_ERROR.
+  NetworkStatus open();
+
+  // @brief Releases the loop. Watched descriptors are not closed and pending
+  // timers are dropped.
+  void close();
+
+  // @brief Starts watching a descriptor, replacing any previous watch of it.
+  // @param descriptor The descriptor (made non-blocking by the caller).
+  // @param events The event:: flags of interest (HANGUP and FAILED are always
+  // reported).
+  // @param handler Called on readiness.
+  // @param context Passed to handler.
+  // @return OK, NOT_OPEN_ERROR, ALLOCATION_ERROR or POLL_ERROR (negative
+  // descriptor, or refused by the kernel).
+  NetworkStatus watch(const int descriptor, const uint32 events,
+                      Handler handler, void* context);
+
+  // @brief Changes the events a watched descriptor is interested in.
+  // @param descriptor The descriptor.
+  // @param events The new event:: flags.
+  // @return OK, NOT_OPEN_ERROR or POLL_ERROR (not watched).
+  NetworkStatus modify(const int descriptor, const uint32 events);
+
+  // @brief Stops watching a descriptor. Events of it already collected in
+  // the current batch are dropped, even if the descriptor number is reused
+  // by a new watch meanwhile. Call before closing the descriptor.
+  // @param descriptor The descriptor.
+  // @return OK, NOT_OPEN_ERROR or POLL_ERROR (not watched).
+  NetworkStatus unwatch(const int descriptor);
+
+  // @brief Schedules a function to run once after a delay.
+  // @param delay The delay in milliseconds (0: on the next iteration).
+  // @param function The function.
+  // @param context Passed to function.
+  // @param id Receives the handle for cancel_timer() (0, which is never a
+  // valid handle, on failure).
+  // @return OK, NOT_OPEN_ERROR or ALLOCATION_ERROR.
+  NetworkStatus add_timer(const uint64 delay, TimerFunction function,
+                          void* context, uint64& id);
+
+  // @brief Cancels a pending timer in O(log n).
+  // @param id The handle from add_timer().
+  // @return false if the timer already ran or was cancelled.
+  bool cancel_timer(const uint64 id);
+
+  // @brief Waits for readiness or the next timer, then runs the handlers of
+  // up to BATCH ready descriptors and every expired timer.
+  // @param timeout The longest wait in milliseconds (-1: until something
+  // happens, 0: never wait).
+  // @return The number of handlers and timers run (0 if the wait failed;
+  // see getError()).
+  uint32 run_once(const int64 timeout);
+
+  // @brief Runs iterations until stop() is called or a wait fails.
+  // @return OK once stopped, NOT_OPEN_ERROR or POLL_ERROR (see getError()).
+  NetworkStatus run();
+
+  // @brief Makes run() return after the current iteration. Any thread.
+  void stop();
+
+  // @brief Returns the monotonic time of the current iteration, for timeouts
+  // measured without another system call.
+  // @return The time in milliseconds since an arbitrary point.
+  uint64 getTime() const;
+
+  // @brief Returns the number of pending timers.
+  // @return The timer count.
+  uint64 getTimerCount() const;
+
+  // @brief Returns why the last wait of run_once() failed.
+  // @return The errno of the failed epoll_wait, or 0 if it succeeded.
+  int getError() const;
+
+  // @brief Checks whether the loop is set up.
+  // @return true after a successful open().
+  bool isOpen() const;
+
+ private:
+  // @brief A watched descriptor. The generation changes with every watch(),
+  // so stale events of a reused descriptor number are recognized.
+  struct Watch {
+    Handler handler;
+    void* context;
+    uint32 generation;
+  };
+
+  // @brief A timer slot. Pending timers sit in a binary min-heap of slot
+  // indices; free slots are chained through position.
+  struct Timer {
+    uint64 deadline;
+    TimerFunction function;
+    void* context;
+    uint32 generation;
+    uint32 position;
+  };
+
+  // @brief The position of a free timer slot.
+  static constexpr uint32 FREE = 0xFFFFFFFF;
+
+  // @brief The epoll descriptor, or -1.
+  int poller = -1;
+
+  // @brief The eventfd stop() writes to, or -1.
+  int waker = -1;
+
+  // @brief Set by stop(); read by run().
+  bool stopping = false;
+
+  // @brief The errno of the last failed wait, or 0.
+  int error = 0;
+
+  // @brief The time of the current iteration in milliseconds.
+  uint64 time = 0;
+
+  // @brief Set while expired timers run, so the timers they add wait for
+  // the next iteration.
+  bool firing = false;
+
+  // @brief The watches, indexed by descriptor.
+  Vector<Watch> watches;
+
+  // @brief The timer slots, the heap of pending slot indices, and the free
+  // slots.
+  Vector<Timer> timers;
+  Vector<uint32> heap;
+  Vector<uint32> free_timers;
+
+  // @brief Reads the monotonic clock.
+  // @return The time in milliseconds.
+  static uint64 now();
+
+  // @brief Translates event:: flags to epoll flags (edge-triggered).
+  // @param events The event:: flags.
+  // @return The epoll flags.
+  static uint32 to_epoll(const uint32 events);
+
+  // @brief Translates epoll flags to event:: flags.
+  // @param flags The epoll flags.
+  // @return The event:: flags.
+  static uint32 from_epoll(const uint32 flags);
+
+  // @brief Drains the eventfd stop() wrote to.
+  // @param context The Loop.
+  // @param events Unused.
+  static void wake(void* context, const uint32 events);
+
+  // @brief Runs the timers whose deadline has passed.
+  // @return The number of timers run.
+  uint32 fire_timers();
+
+  // @brief Moves the heap entry at position up to its place.
+  void sift_up(uint32 position);
+
+  // @brief Moves the heap entry at position down to its place.
+  void sift_down(uint32 position);
+
+  // @brief Takes the heap entry at position out of the heap and frees its
+  // slot.
+  void remove_timer(const uint32 position);
+
+  // @brief Returns whether heap entry a expires before heap entry b.
+  bool earlier(const uint32 a, const uint32 b) const;
+};
+
+class Server;
+
+// @brief A connection accepted by a Server. Input is read into a buffer from
+// the server's pool while the handlers process it, and output that the
+// socket does not take at once waits in another pooled buffer. Both go back
+// to the pool as soon as they are empty, so idle connections hold no buffer.
+class Connection {
+ public:
+  // @brief Creates a detached connection. Servers take them from their pool;
+  // there is no use for one elsewhere.
+  Connection() = default;
+
+  // @brief Deleted copy constructor. Connections are owned by their server.
+  Connection(const Connection&) = delete;
+
+  // @brief Deleted copy assignment operator. Connections are owned by their
+  // server.
+  Connection& operator=(const Connection&) = delete;
+
+  // @brief Returns the bytes received and not consumed yet.
+  // @return The unread input.
+  Span<byte> getInput() const;
+
+  // @brief Marks input bytes as processed.
+  // @param count The number of bytes (at most getInput().getSize()).
+  void consume(const uint64 count);
+
+  // @brief Sends bytes, buffering what the socket does not take at once.
+  // @param data The bytes.
+  // @param size The number of bytes.
+  // @return The number of bytes accepted; fewer than size when the output
+  // buffer is full (wait for the drain handler) or the connection is
+  // closing.
+  uint64 write(const void* data, const uint64 size);
+
+  // @brief Returns the number of bytes accepted by write() but not sent yet.
+  // @return The buffered output size.
+  uint64 getPendingOutput() const;
+
+  // @brief Closes the connection once its buffered output is sent. The close
+  // handler runs, then the connection is released; do not use it after
+  // returning from the current handler.
+  void close();
+
+  // @brief Attaches a user value to the connection.
+  // @param value The value.
+  void setContext(void* value);
+
+  // @brief Returns the user value (nullptr until set).
+  // @return The value.
+  void* getContext() const;
+
+  // @brief Returns the socket, e.g. to set options.
+  // @return The socket.
+  Socket& getSocket();
+
+ private:
+  friend class Server;
+
+  // @brief The socket.
+  Socket socket;
+
+  // @brief The owning server.
+  Server* server = nullptr;
+
+  // @brief Links in the server's list of connections.
+  Connection* previous = nullptr;
+  Connection* next = nullptr;
+
+  // @brief The pooled input buffer and its unread range, or nullptr.
+  byte* input = nullptr;
+  uint64 input_start = 0;
+  uint64 input_end = 0;
+
+  // @brief The pooled output buffer and its unsent range, or nullptr.
+  byte* output = nullptr;
+  uint64 output_start = 0;
+  uint64 output_end = 0;
+
+  // @brief The user value.
+  void* context = nullptr;
+
+  // @brief close() was called or the socket failed.
+  bool closing = false;
+
+  // @brief A handler of this connection is running, so releasing it must
+  // wait until the handler returns.
+  bool dispatching = false;
+};
+
+// @brief Accepts connections on a Loop and drives them: reads input into
+// pooled buffers, hands it to the handlers, and sends their output. Neither
+// connections nor buffers are allocated per connection once the pools have
+// grown to the peak load.
+class Server {
+ public:
+  // @brief The callbacks of a server. Every one may be nullptr but data.
+  struct Handlers {
+    // @brief Called for every accepted connection.
+    void (*open)(void* context, Connection& connection);
+
+    // @brief Called when input arrived: process getInput(), then consume()
+    // what was used. Unconsumed input stays for the next call; a connection
+    // whose input buffer fills up without progress is closed.
+    void (*data)(void* context, Connection& connection);
+
+    // @brief Called when the output buffered by write() has been sent.
+    void (*drain)(void* context, Connection& connection);
+
+    // @brief Called once when the connection closes, before it is released.
+    void (*close)(void* context, Connection& connection);
+
+    // @brief Passed to every callback.
+    void* context;
+  };
+
+  // @brief The default size of input and output buffers.
+  static constexpr uint64 BUFFER_SIZE = 16384;
+
+  // @brief Creates a server that is not listening.
+  // @param event_loop The loop driving the server (must outlive it).
+  // @param callbacks The handlers.
+  // @param block_size The size of every input and output buffer.
+  Server(Loop& event_loop, const Handlers& callbacks,
+         const uint64 block_size = BUFFER_SIZE);
+
+  // @brief Destructor. Stops listening and closes every connection.
+  ~Server();
+
+  // @brief Deleted copy constructor. Servers are registered by address.
+  Server(const Server&) = delete;
+
+  // @brief Deleted copy assignment operator. Servers are registered by
+  // address.
+  Server& operator=(const Server&) = delete;
+
+  // @brief Starts accepting connections.
+  // @param address The address to listen on.
+  // @param reuse_port Share the port with the servers of other loops.
+  // @param backlog The length of the queue of unaccepted connections.
+  // @return OK, NOT_OPEN_ERROR (the loop is not open) or an error of
+  // Socket::listen / Loop::watch.
+  NetworkStatus listen(const Address& address, const bool reuse_port = true,
+                       const int backlog = 1024);
+
+  // @brief Stops listening and closes every connection without waiting for
+  // their output. Must not be called from a handler of this server.
+  void close();
+
+  // @brief Returns the address the server listens on.
+  // @param address Receives the address.
+  // @return OK, NOT_OPEN_ERROR or OPTION_ERROR.
+  NetworkStatus getLocalAddress(Address& address) const;
+
+  // @brief Returns the number of open connections.
+  // @return The connection count.
+  uint64 getConnectionCount() const;
+
+ private:
+  friend class Connection;
+
+  // @brief How long to wait before accepting again when out of descriptors.
+  static constexpr uint64 ACCEPT_RETRY = 10;
+
+  // @brief The loop.
+  Loop& loop;
+
+  // @brief The handlers.
+  Handlers handlers;
+
+  // @brief The listening socket.
+  Socket listener;
+
+  // @brief The pools connections and their buffers come from.
+  ::memory::Pool connections;
+  ::memory::Pool buffers;
+
+  // @brief The size of every buffer.
+  uint64 buffer_size;
+
+  // @brief The open connections.
+  Connection* first = nullptr;
+  uint64 connection_count = 0;
+
+  // @brief The pending accept retry timer, or 0.
+  uint64 retry_timer = 0;
+
+  // @brief Accepts every pending connection.
+  // @param context The Server.
+  // @param events Unused.
+  static void on_accept(void* context, const uint32 events);
+
+  // @brief Accepts again after running out of descriptors.
+  // @param context The Server.
+  static void on_retry(void* context);
+
+  // @brief Reads, dispatches and writes for a ready connection.
+  // @param context The Connection.
+  // @param events The ready events.
+  static void on_ready(void* context, const uint32 events);
+
+  // @brief Reads until the socket would block, calling the data handler
+  // after every read.
+  // @param connection The connection.
+  void receive(Connection& connection);
+
+  // @brief Sends buffered output until done or the socket would block.
+  // @param connection The connection.
+  void flush(Connection& connection);
+
+  // @brief Releases the connection if it is closing, idle and not inside a
+  // handler.
+  // @param connection The connection.
+  void settle(Connection& connection);
+
+  // @brief Runs the close handler, unregisters the socket and releases the
+  // connection and its buffers.
+  // @param connection The connection.
+  void release(Connection& connection);
+};
+
+}  // namespace os::network
+
+// === Implementation of os::network ===
+
+inline os::network::Address os::network::loopback(const uint16 port) {
+  return Address{0x7F000001, port};
+}
+
+inline os::network::Address os::network::any(const uint16 port) {
+  return Address{0, port};
+}
+
+inline NetworkStatus os::network::parse_address(const char* text,
+                                                const uint16 port,
+                                                Address& address) {
+#ifdef NETWORK_POSIX
+  in_addr parsed;
+  if (inet_pton(AF_INET, text, &parsed) != 1) {
+    return NetworkStatus::ADDRESS_ERROR;
+  }
+  address.host = ntohl(parsed.s_addr);
+  address.port = port;
+  return NetworkStatus::OK;
+#else
+  (void)text;
+  (void)port;
+  (void)address;
+  return NetworkStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+// === Implementation of os::network::Socket ===
+
+inline os::network::Socket::~Socket() { this->close(); }
+
+inline os::network::Socket::Socket(Socket&& other) noexcept
+    : descriptor(other.descriptor) {
+  other.descriptor = -1;
+}
+
+inline os::network::Socket& os::network::Socket::operator=(
+    Socket&& other) noexcept {
+  if (this != &other) {
+    this->close();
+    this->descriptor = other.descriptor;
+    other.descriptor = -1;
+  }
+  return *this;
+}
+
+inline int os::network::Socket::create() {
+#ifdef NETWORK_POSIX
+#if defined(OS_LINUX)
+  // One call sets both flags
+  return ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+#else
+  const int result = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (result >= 0) {
+    ::fcntl(result, F_SETFL, ::fcntl(result, F_GETFL) | O_NONBLOCK);
+    ::fcntl(result, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+    const int enable = 1;
+    ::setsockopt(result, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+  }
+  return result;
+#endif
+#else
+  return -1;
+#endif
+}
+
+inline bool os::network::Socket::would_block() {
+#ifdef NETWORK_POSIX
+  // The two are the same value on most systems
+#if EAGAIN != EWOULDBLOCK
+  if (errno == EWOULDBLOCK) {
+    return true;
+  }
+#endif
+  return errno == EAGAIN;
+#else
+  return false;
+#endif
+}
+
+inline NetworkStatus os::network::Socket::listen(const Address& address,
+                                                 const bool reuse_port,
+                                                 const int backlog) {
+  this->close();
+#ifdef NETWORK_POSIX
+  const int result = create();
+  if (result < 0) {
+    return NetworkStatus::CREATE_ERROR;
+  }
+  this->descriptor = result;
+
+  // Reusable addresses; a shared port is opt-in
+  const int enable = 1;
+  ::setsockopt(result, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+#ifdef SO_REUSEPORT
+  if (reuse_port &&
+      ::setsockopt(result, SOL_SOCKET, SO_REUSEPORT, &enable,
+                   sizeof(enable)) != 0) {
+    this->close();
+    return NetworkStatus::OPTION_ERROR;
+  }
+#else
+  if (reuse_port) {
+    this->close();
+    return NetworkStatus::UNSUPPORTED_ERROR;
+  }
+#endif
+
+  // Bind and listen
+  sockaddr_in local;
+  memset(&local, 0, sizeof(local));
+  local.sin_family = AF_INET;
+  local.sin_addr.s_addr = htonl(address.host);
+  local.sin_port = htons(address.port);
+  if (::bind(result, reinterpret_cast<sockaddr*>(&local), sizeof(local)) !=
+      0) {
+    this->close();
+    return NetworkStatus::BIND_ERROR;
+  }
+  if (::listen(result, backlog) != 0) {
+    this->close();
+    return NetworkStatus::LISTEN_ERROR;
+  }
+  return NetworkStatus::OK;
+#else
+  (void)address;
+  (void)reuse_port;
+  (void)backlog;
+  return NetworkStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline NetworkStatus os::network::Socket::connect(const Address& address) {
+  this->close();
+#ifdef NETWORK_POSIX
+  const int result = create();
+  if (result < 0) {
+    return NetworkStatus::CREATE_ERROR;
+  }
+  this->descriptor = result;
+
+  // Non-blocking: usually still in progress when connect returns
+  sockaddr_in remote;
+  memset(&remote, 0, sizeof(remote));
+  remote.sin_family = AF_INET;
+  remote.sin_addr.s_addr = htonl(address.host);
+  remote.sin_port = htons(address.port);
+  if (::connect(result, reinterpret_cast<sockaddr*>(&remote),
+                sizeof(remote)) != 0 &&
+      errno != EINPROGRESS && errno != EINTR) {
+    this->close();
+    return NetworkStatus::CONNECT_ERROR;
+  }
+  return NetworkStatus::OK;
+#else
+  (void)address;
+  return NetworkStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline NetworkStatus os::network::Socket::accept(Socket& client) {
+  if (this->descriptor < 0) {
+    return NetworkStatus::NOT_OPEN_ERROR;
+  }
+#ifdef NETWORK_POSIX
+  int result;
+  do {
+#if defined(OS_LINUX)
+    result = ::accept4(this->descriptor, nullptr, nullptr,
+                       SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    result = ::accept(this->descriptor, nullptr, nullptr);
+#endif
+  } while (result < 0 && (errno == EINTR || errno == ECONNABORTED));
+  if (result < 0) {
+    return would_block() ? NetworkStatus::WOULD_BLOCK_ERROR
+                         : NetworkStatus::ACCEPT_ERROR;
+  }
+#if !defined(OS_LINUX)
+  ::fcntl(result, F_SETFL, ::fcntl(result, F_GETFL) | O_NONBLOCK);
+  ::fcntl(result, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+  const int enable = 1;
+  ::setsockopt(result, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+#endif
+  client.close();
+  client.descriptor = result;
+  return NetworkStatus::OK;
+#else
+  (void)client;
+  return NetworkStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline NetworkStatus os::network::Socket::read(void* buffer,
+                                               const uint64 size,
+                                               uint64& read_count) {
+  os::system::trace::Zone zone("Socket::read");
+  read_count = 0;
+  if (this->descriptor < 0) {
+    return NetworkStatus::NOT_OPEN_ERROR;
+  }
+#ifdef NETWORK_POSIX
+  ssize_t result;
+  do {
+    result = ::recv(this->descriptor, buffer, static_cast<size_t>(size), 0);
+  } while (result < 0 && errno == EINTR);
+  if (result > 0) {
+    read_count = static_cast<uint64>(result);
+    return NetworkStatus::OK;
+  }
+  if (result == 0) {
+    return size == 0 ? NetworkStatus::OK : NetworkStatus::CLOSED_ERROR;
+  }
+  if (would_block()) {
+    return NetworkStatus::WOULD_BLOCK_ERROR;
+  }
+  return errno == ECONNRESET ? NetworkStatus::CLOSED_ERROR
+                             : NetworkStatus::READ_ERROR;
+#else
+  (void)buffer;
+  (void)size;
+  return NetworkStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline NetworkStatus os::network::Socket::write(const void* buffer,
+                                                const uint64 size,
+                                                uint64& written) {
+  os::system::trace::Zone zone("Socket::write");
+  written = 0;
+  if (this->descriptor < 0) {
+    return NetworkStatus::NOT_OPEN_ERROR;
+  }
+#ifdef NETWORK_POSIX
+  // A vanished peer must be an error, not a process-killing signal
+  int flags = 0;
+#ifdef MSG_NOSIGNAL
+  flags = MSG_NOSIGNAL;
+#endif
+  ssize_t result;
+  do {
+    result =
+        ::send(this->descriptor, buffer, static_cast<size_t>(size), flags);
+  } while (result < 0 && errno == EINTR);
+  if (result >= 0) {
+    written = static_cast<uint64>(result);
+    return NetworkStatus::OK;
+  }
+  if (would_block()) {
+    return NetworkStatus::WOULD_BLOCK_ERROR;
+  }
+  return errno == EPIPE || errno == ECONNRESET ? NetworkStatus::CLOSED_ERROR
+                                               : NetworkStatus::WRITE_ERROR;
+#else
+  (void)buffer;
+  (void)size;
+  return NetworkStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline NetworkStatus os::network::Socket::set_no_delay(const bool enabled) {
+  if (this->descriptor < 0) {
+    return NetworkStatus::NOT_OPEN_ERROR;
+  }
+#ifdef NETWORK_POSIX
+  const int value = enabled ? 1 : 0;
+  return ::setsockopt(this->descriptor, IPPROTO_TCP, TCP_NODELAY, &value,
+                      sizeof(value)) == 0
+             ? NetworkStatus::OK
+             : NetworkStatus::OPTION_ERROR;
+#else
+  (void)enabled;
+  return NetworkStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline void os::network::Socket::close() {
+#ifdef NETWORK_POSIX
+  // Like files, sockets must not be closed again on EINTR
+  if (this->descriptor >= 0) {
+    ::close(this->descriptor);
+  }
+#endif
+  this->descriptor = -1;
+}
+
+inline NetworkStatus os::network::Socket::getError() const {
+  if (this->descriptor < 0) {
+    return NetworkStatus::NOT_OPEN_ERROR;
+  }
+#ifdef NETWORK_POSIX
+  int error = 0;
+  socklen_t length = sizeof(error);
+  if (::getsockopt(this->descriptor, SOL_SOCKET, SO_ERROR, &error, &length) !=
+          0 ||
+      error != 0) {
+    return NetworkStatus::CONNECT_ERROR;
+  }
+  return NetworkStatus::OK;
+#else
+  return NetworkStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline NetworkStatus os::network::Socket::getLocalAddress(
+    Address& address) const {
+  if (this->descriptor < 0) {
+    return NetworkStatus::NOT_OPEN_ERROR;
+  }
+#ifdef NETWORK_POSIX
+  sockaddr_in local;
+  socklen_t length = sizeof(local);
+  if (::getsockname(this->descriptor, reinterpret_cast<sockaddr*>(&local),
+                    &length) != 0) {
+    return NetworkStatus::OPTION_ERROR;
+  }
+  address.host = ntohl(local.sin_addr.s_addr);
+  address.port = ntohs(local.sin_port);
+  return NetworkStatus::OK;
+#else
+  (void)address;
+  return NetworkStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline int os::network::Socket::getDescriptor() const {
+  return this->descriptor;
+}
+
+inline bool os::network::Socket::isOpen() const {
+  return this->descriptor >= 0;
+}
+
+// === Implementation of os::network::Loop ===
+
+inline os::network::Loop::~Loop() { this->close(); }
+
+inline NetworkStatus os::network::Loop::open() {
+  this->close();
+#ifdef NETWORK_EPOLL
+  // The tables start small and grow with the descriptors and timers
+  this->watches = Vector<Watch>(64);
+  this->timers = Vector<Timer>(16);
+  this->heap = Vector<uint32>(16);
+  this->free_timers = Vector<uint32>(16);
+  if (!this->watches.isInitialized() || !this->timers.isInitialized() ||
+      !this->heap.isInitialized() || !this->free_timers.isInitialized()) {
+    this->close();
+    return NetworkStatus::ALLOCATION_ERROR;
+  }
+
+  // The eventfd lets stop() interrupt a wait from another thread
+  this->poller = ::epoll_create1(EPOLL_CLOEXEC);
+  this->waker = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (this->poller < 0 || this->waker < 0) {
+    this->close();
+    return NetworkStatus::POLL_ERROR;
+  }
+  const NetworkStatus status =
+      this->watch(this->waker, event::READABLE, &wake, this);
+  if (status != NetworkStatus::OK) {
+    this->close();
+    return status;
+  }
+  this->stopping = false;
+  this->error = 0;
+  this->time = now();
+  return NetworkStatus::OK;
+#else
+  return NetworkStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline void os::network::Loop::close() {
+#ifdef NETWORK_EPOLL
+  if (this->waker >= 0) {
+    ::close(this->waker);
+  }
+  if (this->poller >= 0) {
+    ::close(this->poller);
+  }
+#endif
+  this->waker = -1;
+  this->poller = -1;
+  this->watches = Vector<Watch>();
+  this->timers = Vector<Timer>();
+  this->heap = Vector<uint32>();
+  this->free_timers = Vector<uint32>();
+}
+
+inline NetworkStatus os::network::Loop::watch(const int descriptor,
+                                              const uint32 events,
+                                              Handler handler,
+                                              void* context) {
+  if (this->poller < 0) {
+    return NetworkStatus::NOT_OPEN_ERROR;
+  }
+#ifdef NETWORK_EPOLL
+  // A closed socket reports -1, which has no slot in the table
+  if (descriptor < 0) {
+    return NetworkStatus::POLL_ERROR;
+  }
+
+  // Grow the table to cover the descriptor
+  const uint64 index = static_cast<uint64>(descriptor);
+  if (index >= this->watches.getSize() &&
+      this->watches.resize(index + 1, Watch{nullptr, nullptr, 0}) !=
+          VectorStatus::OK) {
+    return NetworkStatus::ALLOCATION_ERROR;
+  }
+
+  // The event carries the descriptor and its generation
+  Watch& entry = this->watches.getData()[index];
+  const bool watched = entry.handler != nullptr;
+  entry.handler = handler;
+  entry.context = context;
+  entry.generation++;
+  epoll_event registration;
+  registration.events = to_epoll(events);
+  registration.data.u64 = static_cast<uint64>(entry.generation) << 32 | index;
+  // A descriptor closed without unwatch() has left the epoll set already
+  int result = -1;
+  if (watched) {
+    result =
+        ::epoll_ctl(this->poller, EPOLL_CTL_MOD, descriptor, &registration);
+  }
+  if (result != 0) {
+    result =
+        ::epoll_ctl(this->poller, EPOLL_CTL_ADD, descriptor, &registration);
+  }
+  if (result != 0) {
+    entry.handler = nullptr;
+    return NetworkStatus::POLL_ERROR;
+  }
+  return NetworkStatus::OK;
+#else
+  (void)descriptor;
+  (void)events;
+  (void)handler;
+  (void)context;
+  return NetworkStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline NetworkStatus os::network::Loop::modify(const int descriptor,
+                                               const uint32 events) {
+  if (this->poller < 0) {
+    return NetworkStatus::NOT_OPEN_ERROR;
+  }
+#ifdef NETWORK_EPOLL
+  const uint64 index = static_cast<uint64>(descriptor);
+  Watch* entry = this->watches.get(index);
+  if (entry == nullptr || entry->handler == nullptr) {
+    return NetworkStatus::POLL_ERROR;
+  }
+  epoll_event registration;
+  registration.events = to_epoll(events);
+  registration.data.u64 = static_cast<uint64>(entry->generation) << 32 | index;
+  return ::epoll_ctl(this->poller, EPOLL_CTL_MOD, descriptor,
+                     &registration) == 0
+             ? NetworkStatus::OK
+             : NetworkStatus::POLL_ERROR;
+#else
+  (void)descriptor;
+  (void)events;
+  return NetworkStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline NetworkStatus os::network::Loop::unwatch(const int descriptor) {
+  if (this->poller < 0) {
+    return NetworkStatus::NOT_OPEN_ERROR;
+  }
+#ifdef NETWORK_EPOLL
+  // Bumping the generation invalidates events already collected
+  Watch* entry = this->watches.get(static_cast<uint64>(descriptor));
+  if (entry == nullptr || entry->handler == nullptr) {
+    return NetworkStatus::POLL_ERROR;
+  }
+  entry->handler = nullptr;
+  entry->context = nullptr;
+  entry->generation++;
+  return ::epoll_ctl(this->poller, EPOLL_CTL_DEL, descriptor, nullptr) == 0
+             ? NetworkStatus::OK
+             : NetworkStatus::POLL_ERROR;
+#else
+  (void)descriptor;
+  return NetworkStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline NetworkStatus os::network::Loop::add_timer(const uint64 delay,
+                                                  TimerFunction function,
+                                                  void* context, uint64& id) {
+  id = 0;
+  if (this->poller < 0) {
+    return NetworkStatus::NOT_OPEN_ERROR;
+  }
+
+  // Reuse a free slot, or add one
+  uint32 slot;
+  if (this->free_timers.pop(slot) != VectorStatus::OK) {
+    slot = static_cast<uint32>(this->timers.getSize());
+    if (this->timers.push(Timer{0, nullptr, nullptr, 0, FREE}) !=
+        VectorStatus::OK) {
+      return NetworkStatus::ALLOCATION_ERROR;
+    }
+  }
+  if (this->heap.push(slot) != VectorStatus::OK) {
+    this->free_timers.push(slot);
+    return NetworkStatus::ALLOCATION_ERROR;
+  }
+
+  // Deadlines count from the current time, not the start of the iteration,
+  // and never fall into the pass of fire_timers() that is running
+  Timer& timer = this->timers.getData()[slot];
+  timer.deadline = now() + delay;
+  if (this->firing && timer.deadline <= this->time) {
+    timer.deadline = this->time + 1;
+  }
+  timer.function = function;
+  timer.context = context;
+  timer.generation++;
+  timer.position = static_cast<uint32>(this->heap.getSize() - 1);
+  this->sift_up(timer.position);
+
+  // Slot 0 generation 0 never occurs, so 0 is never a valid id
+  id = static_cast<uint64>(timer.generation) << 32 | slot;
+  return NetworkStatus::OK;
+}
+
+inline bool os::network::Loop::cancel_timer(const uint64 id) {
+  Timer* timer = this->timers.get(id & 0xFFFFFFFF);
+  if (timer == nullptr || timer->position == FREE ||
+      timer->generation != static_cast<uint32>(id >> 32)) {
+    return false;
+  }
+  this->remove_timer(timer->position);
+  return true;
+}
+
+inline uint32 os::network::Loop::run_once(const int64 timeout) {
+  if (this->poller < 0) {
+    return 0;
+  }
+#ifdef NETWORK_EPOLL
+  // Wake up in time for the earliest timer
+  int64 wait = timeout;
+  if (this->heap.getSize() > 0) {
+    const uint64 deadline =
+        this->timers.getData()[this->heap.getData()[0]].deadline;
+    const uint64 current = now();
+    const int64 until =
+        deadline > current ? static_cast<int64>(deadline - current) : 0;
+    if (wait < 0 || until < wait) {
+      wait = until;
+    }
+  }
+  if (wait > 0x7FFFFFFF) {
+    wait = 0x7FFFFFFF;
+  }
+
+  // Retry interrupted waits; any other failure is kept for the caller
+  epoll_event ready[BATCH];
+  int count;
+  do {
+    count = ::epoll_wait(this->poller, ready, static_cast<int>(BATCH),
+                         static_cast<int>(wait));
+  } while (count < 0 && errno == EINTR);
+  this->error = count < 0 ? errno : 0;
+  this->time = now();
+  if (count < 0) {
+    return 0;
+  }
+
+  // Dispatch, skipping events of descriptors unwatched meanwhile
+  uint32 handled = 0;
+  for (int i = 0; i < count; i++) {
+    const uint64 data = ready[i].data.u64;
+    const Watch* entry = this->watches.get(data & 0xFFFFFFFF);
+    if (entry == nullptr || entry->handler == nullptr ||
+        entry->generation != static_cast<uint32>(data >> 32)) {
+      continue;
+    }
+    entry->handler(entry->context, from_epoll(ready[i].events));
+    handled++;
+  }
+  return handled + this->fire_timers();
+#else
+  (void)timeout;
+  return 0;
+#endif
+}
+
+inline NetworkStatus os::network::Loop::run() {
+  if (this->poller < 0) {
+    return NetworkStatus::NOT_OPEN_ERROR;
+  }
+  while (!__atomic_load_n(&this->stopping, __ATOMIC_ACQUIRE)) {
+    this->run_once(-1);
+    if (this->error != 0) {
+      return NetworkStatus::POLL_ERROR;
+    }
+  }
+  __atomic_store_n(&this->stopping, false, __ATOMIC_RELAXED);
+  return NetworkStatus::OK;
+}
+
+inline void os::network::Loop::stop() {
+  __atomic_store_n(&this->stopping, true, __ATOMIC_RELEASE);
+#ifdef NETWORK_EPOLL
+  // Interrupt a wait in progress
+  if (this->waker >= 0) {
+    const uint64 one = 1;
+    const ssize_t result = ::write(this->waker, &one, sizeof(one));
+    (void)result;
+  }
+#endif
+}
+
+inline uint64 os::network::Loop::getTime() const { return this->time; }
+
+inline int os::network::Loop::getError() const { return this->error; }
+
+inline uint64 os::network::Loop::getTimerCount() const {
+  return this->heap.getSize();
+}
+
+inline bool os::network::Loop::isOpen() const { return this->poller >= 0; }
+
+inline uint64 os::network::Loop::now() {
+  return os::system::clock::now() / 1000000;
+}
+
+inline uint32 os::network::Loop::to_epoll(const uint32 events) {
+#ifdef NETWORK_EPOLL
+  uint32 flags = EPOLLET | EPOLLRDHUP;
+  if ((events & event::READABLE) != 0) {
+    flags |= EPOLLIN;
+  }
+  if ((events & event::WRITABLE) != 0) {
+    flags |= EPOLLOUT;
+  }
+  return flags;
+#else
+  return events;
+#endif
+}
+
+inline uint32 os::network::Loop::from_epoll(const uint32 flags) {
+#ifdef NETWORK_EPOLL
+  uint32 events = 0;
+  if ((flags & EPOLLIN) != 0) {
+    events |= event::READABLE;
+  }
+  if ((flags & EPOLLOUT) != 0) {
+    events |= event::WRITABLE;
+  }
+  if ((flags & (EPOLLRDHUP | EPOLLHUP)) != 0) {
+    events |= event::HANGUP;
+  }
+  if ((flags & EPOLLERR) != 0) {
+    events |= event::FAILED;
+  }
+  return events;
+#else
+  return flags;
+#endif
+}
+
+inline void os::network::Loop::wake(void* context, const uint32 events) {
+  (void)events;
+#ifdef NETWORK_EPOLL
+  Loop* loop = static_cast<Loop*>(context);
+  uint64 count;
+  while (::read(loop->waker, &count, sizeof(count)) > 0) {
+  }
+#else
+  (void)context;
+#endif
+}
+
+inline uint32 os::network::Loop::fire_timers() {
+  // Take expired timers off the heap before calling them: a function may add
+  // or cancel timers
+  uint32 fired = 0;
+  this->firing = true;
+  while (this->heap.getSize() > 0) {
+    const uint32 slot = this->heap.getData()[0];
+    const Timer timer = this->timers.getData()[slot];
+    if (timer.deadline > this->time) {
+      break;
+    }
+    this->remove_timer(0);
+    timer.function(timer.context);
+    fired++;
+  }
+  this->firing = false;
+  return fired;
+}
+
+inline void os::network::Loop::sift_up(uint32 position) {
+  uint32* entries = this->heap.getData();
+  Timer* slots = this->timers.getData();
+  const uint32 moving = entries[position];
+  while (position > 0) {
+    const uint32 parent = (position - 1) / 2;
+    if (!(slots[moving].deadline < slots[entries[parent]].deadline)) {
+      break;
+    }
+    entries[position] = entries[parent];
+    slots[entries[position]].position = position;
+    position = parent;
+  }
+  entries[position] = moving;
+  slots[moving].position = position;
+}
+
+inline void os::network::Loop::sift_down(uint32 position) {
+  uint32* entries = this->heap.getData();
+  Timer* slots = this->timers.getData();
+  const uint32 size = static_cast<uint32>(this->heap.getSize());
+  const uint32 moving = entries[position];
+  for (;;) {
+    uint32 child = 2 * position + 1;
+    if (child >= size) {
+      break;
+    }
+    if (child + 1 < size && this->earlier(child + 1, child)) {
+      child++;
+    }
+    if (!(slots[entries[child]].deadline < slots[moving].deadline)) {
+      break;
+    }
+    entries[position] = entries[child];
+    slots[entries[position]].position = position;
+    position = child;
+  }
+  entries[position] = moving;
+  slots[moving].position = position;
+}
+
+inline void os::network::Loop::remove_timer(const uint32 position) {
+  uint32* entries = this->heap.getData();
+  const uint32 slot = entries[position];
+  uint32 last;
+  this->heap.pop(last);
+
+  // Fill the hole with the last entry, which may need to go either way
+  if (position < this->heap.getSize()) {
+    entries[position] = last;
+    this->timers.getData()[last].position = position;
+    this->sift_down(position);
+    this->sift_up(this->timers.getData()[last].position);
+  }
+
+  // Free the slot; the push cannot fail, the vector held it before
+  this->timers.getData()[slot].position = FREE;
+  this->free_timers.push(slot);
+}
+
+inline bool os::network::Loop::earlier(const uint32 a, const uint32 b) const {
+  const uint32* entries = this->heap.getData();
+  const Timer* slots = this->timers.getData();
+  return slots[entries[a]].deadline < slots[entries[b]].deadline;
+}
+
+// === Implementation of os::network::Connection ===
+
+inline Span<byte> os::network::Connection::getInput() const {
+  return Span<byte>(this->input + this->input_start,
+                    this->input_end - this->input_start);
+}
+
+inline void os::network::Connection::consume(const uint64 count) {
+  const uint64 available = this->input_end - this->input_start;
+  this->input_start += count < available ? count : available;
+}
+
+inline uint64 os::network::Connection::write(const void* data,
+                                             const uint64 size) {
+  if (this->closing) {
+    return 0;
+  }
+  const byte* source = static_cast<const byte*>(data);
+  uint64 accepted = 0;
+
+  // Nothing queued: try the socket first, skipping the copy
+  if (this->output_end == this->output_start) {
+    uint64 written;
+    const NetworkStatus status = this->socket.write(source, size, written);
+    if (status != NetworkStatus::OK &&
+        status != NetworkStatus::WOULD_BLOCK_ERROR) {
+      this->closing = true;
+      return 0;
+    }
+    accepted = written;
+    if (accepted == size) {
+      return accepted;
+    }
+  }
+
+  // Queue the rest in the pooled output buffer, compacting it if needed
+  const uint64 capacity = this->server->buffer_size;
+  if (this->output == nullptr) {
+    this->output = static_cast<byte*>(this->server->buffers.allocate(capacity));
+    if (this->output == nullptr) {
+      return accepted;
+    }
+  }
+  if (size - accepted > capacity - this->output_end &&
+      this->output_start > 0) {
+    const uint64 pending = this->output_end - this->output_start;
+    ::memory::move(this->output, this->output + this->output_start, pending);
+    this->output_start = 0;
+    this->output_end = pending;
+  }
+  uint64 queued = capacity - this->output_end;
+  if (queued > size - accepted) {
+    queued = size - accepted;
+  }
+  ::memory::copy(this->output + this->output_end, source + accepted, queued);
+  this->output_end += queued;
+  return accepted + queued;
+}
+
+inline uint64 os::network::Connection::getPendingOutput() const {
+  return this->output_end - this->output_start;
+}
+
+inline void os::network::Connection::close() {
+  this->closing = true;
+  this->server->settle(*this);
+}
+
+inline void os::network::Connection::setContext(void* value) {
+  this->context = value;
+}
+
+inline void* os::network::Connection::getContext() const {
+  return this->context;
+}
+
+inline os::network::Socket& os::network::Connection::getSocket() {
+  return this->socket;
+}
+
+// === Implementation of os::network::Server ===
+
+inline os::network::Server::Server(Loop& event_loop, const Handlers& callbacks,
+                                   const uint64 block_size)
+    : loop(event_loop),
+      handlers(callbacks),
+      connections(sizeof(Connection), 256),
+      buffers(block_size, 16),
+      buffer_size(block_size) {}
+
+inline os::network::Server::~Server() { this->close(); }
+
+inline NetworkStatus os::network::Server::listen(const Address& address,
+                                                 const bool reuse_port,
+                                                 const int backlog) {
+  if (!this->loop.isOpen()) {
+    return NetworkStatus::NOT_OPEN_ERROR;
+  }
+  NetworkStatus status = this->listener.listen(address, reuse_port, backlog);
+  if (status == NetworkStatus::OK) {
+    status = this->loop.watch(this->listener.getDescriptor(), event::READABLE,
+                              &on_accept, this);
+  }
+  if (status != NetworkStatus::OK) {
+    this->listener.close();
+  }
+  return status;
+}
+
+inline void os::network::Server::close() {
+  if (this->listener.isOpen()) {
+    this->loop.unwatch(this->listener.getDescriptor());
+    this->listener.close();
+  }
+  if (this->retry_timer != 0) {
+    this->loop.cancel_timer(this->retry_timer);
+    this->retry_timer = 0;
+  }
+  while (this->first != nullptr) {
+    this->release(*this->first);
+  }
+}
+
+inline NetworkStatus os::network::Server::getLocalAddress(
+    Address& address) const {
+  return this->listener.getLocalAddress(address);
+}
+
+inline uint64 os::network::Server::getConnectionCount() const {
+  return this->connection_count;
+}
+
+inline void os::network::Server::on_accept(void* context,
+                                           const uint32 events) {
+  (void)events;
+  Server* server = static_cast<Server*>(context);
+
+  // Edge-triggered: accept until the queue is empty
+  for (;;) {
+    Socket client;
+    const NetworkStatus status = server->listener.accept(client);
+    if (status == NetworkStatus::WOULD_BLOCK_ERROR) {
+      return;
+    }
+    if (status != NetworkStatus::OK) {
+      // Out of descriptors: no new edge will come, so retry on a timer
+      if (server->retry_timer == 0) {
+        server->loop.add_timer(ACCEPT_RETRY, &on_retry, server,
+                               server->retry_timer);
+      }
+      return;
+    }
+
+    // Take a connection from the pool and watch it for both directions;
+    // with edge triggering an idle writable socket costs nothing
+    Connection* connection = static_cast<Connection*>(
+        server->connections.allocate(sizeof(Connection)));
+    if (connection == nullptr) {
+      continue;
+    }
+    ::memory::construct(connection);
+    connection->socket = static_cast<Socket&&>(client);
+    connection->server = server;
+    if (server->loop.watch(connection->socket.getDescriptor(),
+                           event::READABLE | event::WRITABLE, &on_ready,
+                           connection) != NetworkStatus::OK) {
+      ::memory::destroy(connection);
+      server->connections.deallocate(connection, sizeof(Connection));
+      continue;
+    }
+    connection->next = server->first;
+    if (server->first != nullptr) {
+      server->first->previous = connection;
+    }
+    server->first = connection;
+    server->connection_count++;
+
+    if (server->handlers.open != nullptr) {
+      connection->dispatching = true;
+      server->handlers.open(server->handlers.context, *connection);
+      connection->dispatching = false;
+      server->settle(*connection);
+    }
+  }
+}
+
+inline void os::network::Server::on_retry(void* context) {
+  Server* server = static_cast<Server*>(context);
+  server->retry_timer = 0;
+  on_accept(server, event::READABLE);
+}
+
+inline void os::network::Server::on_ready(void* context,
+                                          const uint32 events) {
+  Connection* connection = static_cast<Connection*>(context);
+  Server* server = connection->server;
+
+  // Writes first: room in the socket may let the handlers' output through
+  connection->dispatching = true;
+  if ((events & event::WRITABLE) != 0) {
+    server->flush(*connection);
+  }
+  if ((events & (event::READABLE | event::HANGUP | event::FAILED)) != 0 &&
+      !connection->closing) {
+    server->receive(*connection);
+  }
+  if ((events & event::FAILED) != 0) {
+    connection->closing = true;
+  }
+  connection->dispatching = false;
+  server->settle(*connection);
+}
+
+inline void os::network::Server::receive(Connection& connection) {
+  const uint64 capacity = this->buffer_size;
+  while (!connection.closing) {
+    // Borrow a buffer; make room by dropping consumed input
+    if (connection.input == nullptr) {
+      connection.input =
+          static_cast<byte*>(this->buffers.allocate(capacity));
+      if (connection.input == nullptr) {
+        connection.closing = true;
+        break;
+      }
+      connection.input_start = 0;
+      connection.input_end = 0;
+    }
+    if (connection.input_end == capacity) {
+      if (connection.input_start == 0) {
+        // The handler cannot make progress with a full buffer
+        connection.closing = true;
+        break;
+      }
+      const uint64 pending = connection.input_end - connection.input_start;
+      ::memory::move(connection.input,
+                     connection.input + connection.input_start, pending);
+      connection.input_start = 0;
+      connection.input_end = pending;
+    }
+
+    // Read what is there and let the handler see it
+    uint64 read_count;
+    const NetworkStatus status = connection.socket.read(
+        connection.input + connection.input_end,
+        capacity - connection.input_end, read_count);
+    if (status == NetworkStatus::WOULD_BLOCK_ERROR) {
+      break;
+    }
+    if (status != NetworkStatus::OK) {
+      connection.closing = true;
+      break;
+    }
+    connection.input_end += read_count;
+    this->handlers.data(this->handlers.context, connection);
+    if (connection.input_start == connection.input_end) {
+      connection.input_start = 0;
+      connection.input_end = 0;
+    }
+  }
+
+  // Idle connections give their input buffer back
+  if (connection.input != nullptr &&
+      connection.input_start == connection.input_end) {
+    this->buffers.deallocate(connection.input, capacity);
+    connection.input = nullptr;
+    connection.input_start = 0;
+    connection.input_end = 0;
+  }
+}
+
+inline void os::network::Server::flush(Connection& connection) {
+  if (connection.output == nullptr) {
+    return;
+  }
+  while (connection.output_start < connection.output_end) {
+    uint64 written;
+    const NetworkStatus status = connection.socket.write(
+        connection.output + connection.output_start,
+        connection.output_end - connection.output_start, written);
+    if (status == NetworkStatus::WOULD_BLOCK_ERROR) {
+      return;
+    }
+    if (status != NetworkStatus::OK) {
+      connection.closing = true;
+      return;
+    }
+    connection.output_start += written;
+  }
+
+  // Drained: give the buffer back and ask for more
+  this->buffers.deallocate(connection.output, this->buffer_size);
+  connection.output = nullptr;
+  connection.output_start = 0;
+  connection.output_end = 0;
+  if (this->handlers.drain != nullptr && !connection.closing) {
+    this->handlers.drain(this->handlers.context, connection);
+  }
+}
+
+inline void os::network::Server::settle(Connection& connection) {
+  if (!connection.closing || connection.dispatching) {
+    return;
+  }
+
+  // Let the output go out first, unless the socket itself failed
+  if (connection.output_start < connection.output_end) {
+    uint64 written;
+    const NetworkStatus status = connection.socket.write(
+        connection.output + connection.output_start,
+        connection.output_end - connection.output_start, written);
+    connection.output_start += written;
+    const bool alive = status == NetworkStatus::OK ||
+                       status == NetworkStatus::WOULD_BLOCK_ERROR;
+    if (alive && connection.output_start < connection.output_end) {
+      return;
+    }
+  }
+  this->release(connection);
+}
+
+inline void os::network::Server::release(Connection& connection) {
+  if (this->handlers.close != nullptr) {
+    connection.dispatching = true;
+    this->handlers.close(this->handlers.context, connection);
+  }
+
+  // Unlink, unwatch and close the socket, then return everything to the
+  // pools
+  if (connection.previous != nullptr) {
+    connection.previous->next = connection.next;
+  } else {
+    this->first = connection.next;
+  }
+  if (connection.next != nullptr) {
+    connection.next->previous = connection.previous;
+  }
+  this->connection_count--;
+  this->loop.unwatch(connection.socket.getDescriptor());
+  if (connection.input != nullptr) {
+    this->buffers.deallocate(connection.input, this->buffer_size);
+  }
+  if (connection.output != nullptr) {
+    this->buffers.deallocate(connection.output, this->buffer_size);
+  }
+  ::memory::destroy(&connection);
+  this->connections.deallocate(&connection, sizeof(Connection));
+}
@@ -0,0 +1,539 @@
+// @file process.hpp
+
+#pragma once
+
+#include "../memory.hpp"
+#include "../utilities/types.h"
+#include "../vector.hpp"
+
+#ifndef RECREATIONS_ONLY
+#include "../utilities/os.hpp"
+#endif
+
+// Children are started with posix_spawn, which C libraries implement with
+// vfork or clone(CLONE_VM | CLONE_VFORK): the parent's address space is
+// never copied, so launching costs the same from a small or a huge process.
+// Elsewhere operations report UNSUPPORTED_ERROR.
+#if defined(OS_POSIX_COMPATIBLE)
+#define PROCESS_POSIX
+#include <errno.h>     // errno, EINTR
+#include <fcntl.h>     // fcntl, FD_CLOEXEC, O_CLOEXEC
+#include <signal.h>    // kill, sigset_t, SIGPIPE, SIGTERM
+#include <spawn.h>     // posix_spawnp, posix_spawn_file_actions_*
+#include <sys/wait.h>  // waitpid, WNOHANG, WIFEXITED, WEXITSTATUS
+
+// @brief The environment of the calling process.
+extern char** environ;
+#endif
+
+// @brief The status codes for operations on processes and pipes.
+enum class ProcessStatus : int8 {
+  OK = 1,
+  SPAWN_ERROR = 0,
+  PIPE_ERROR = -1,
+  WAIT_ERROR = -2,
+  READ_ERROR = -3,
+  SIGNAL_ERROR = -4,
+  RUNNING_ERROR = -5,
+  NOT_RUNNING_ERROR = -6,
+  ALLOCATION_ERROR = -7,
+  UNSUPPORTED_ERROR = -8,
+};
+
+// @brief Starting child processes, wiring their descriptors, and waiting for
+// them.
+namespace os::process {
+
+// @brief Wires a descriptor of the child before it runs.
+struct Redirect {
+  // @brief The descriptor number in the child (0 stdin, 1 stdout, 2 stderr).
+  int target;
+
+  // @brief The parent descriptor the child sees as target, or -1 to close
+  // target in the child.
+  int source;
+};
+
+// @brief An anonymous pipe. Both ends are close-on-exec, so they only reach
+// a child through a Redirect. Closed on destruction.
+class Pipe {
+ public:
+  // @brief Creates a handle with no pipe attached.
+  Pipe() = default;
+
+  // @brief Destructor. Closes both ends.
+  ~Pipe();
+
+  // @brief Deleted copy constructor. Pipes are owned by one handle.
+  Pipe(const Pipe&) = delete;
+
+  // @brief Deleted copy assignment operator. Pipes are owned by one handle.
+  Pipe& operator=(const Pipe&) = delete;
+
+  // @brief Move constructor. Takes over the ends of another handle.
+  // @param other The handle to move from.
+  Pipe(Pipe&& other) noexcept;
+
+  // @brief Move assignment operator. Closes the current ends first.
+  // @param other The handle to move from.
+  // @return A reference to this handle.
+  Pipe& operator=(Pipe&& other) noexcept;
+
+  // @brief Creates a pipe, closing any pipe already attached.
+  // @return OK, PIPE_ERROR or UNSUPPORTED_ERROR.
+  ProcessStatus open();
+
+  // @brief Closes both ends.
+  void close();
+
+  // @brief Closes the read end, e.g. once it has been handed to a child.
+  void close_read();
+
+  // @brief Closes the write end. The parent must close its copy after
+  // spawning a writer, or reads never see end of file.
+  void close_write();
+
+  // @brief Returns the read end.
+  // @return The descriptor, or -1 if closed.
+  int getReadDescriptor() const;
+
+  // @brief Returns the write end.
+  // @return The descriptor, or -1 if closed.
+  int getWriteDescriptor() const;
+
+ private:
+  // @brief The read end (-1 when closed).
+  int read_end = -1;
+
+  // @brief The write end (-1 when closed).
+  int write_end = -1;
+};
+
+// @brief A child process. Destroying a handle leaves the child running;
+// wait() reaps it.
+class Child {
+ public:
+  // @brief Creates a handle with no child attached.
+  Child() = default;
+
+  // @brief Deleted copy constructor. Children are owned by one handle.
+  Child(const Child&) = delete;
+
+  // @brief Deleted copy assignment operator. Children are owned by one
+  // handle.
+  Child& operator=(const Child&) = delete;
+
+  // @brief Move constructor. Takes over the child of another handle.
+  // @param other The handle to move from.
+  Child(Child&& other) noexcept;
+
+  // @brief Move assignment operator. The current child must not be running.
+  // @param other The handle to move from.
+  // @return A reference to this handle.
+  Child& operator=(Child&& other) noexcept;
+
+  // @brief Starts a program. Names without a slash are looked up in PATH.
+  // The child starts with every signal unblocked and SIGPIPE at its default
+  // action, whatever the parent uses.
+  // @param arguments The program followed by its arguments, nullptr
+  // terminated.
+  // @param redirects Descriptors to wire before the program runs, applied in
+  // order.
+  // @param redirect_count The number of redirects.
+  // @param environment NAME=value strings, nullptr terminated, or nullptr to
+  // inherit the environment of this process.
+  // @return OK, RUNNING_ERROR, SPAWN_ERROR (the program could not be run),
+  // ALLOCATION_ERROR or UNSUPPORTED_ERROR.
+  ProcessStatus spawn(const char* const* arguments,
+                      const Redirect* redirects = nullptr,
+                      const uint32 redirect_count = 0,
+                      const char* const* environment = nullptr);
+
+  // @brief Reaps the child if it has exited, without blocking.
+  // @param exited Receives whether the child has exited.
+  // @return OK, NOT_RUNNING_ERROR or WAIT_ERROR.
+  ProcessStatus try_wait(bool& exited);
+
+  // @brief Blocks until the child exits and reaps it.
+  // @return OK, NOT_RUNNING_ERROR or WAIT_ERROR.
+  ProcessStatus wait();
+
+  // @brief Sends a signal to the child.
+  // @param number The signal, e.g. SIGTERM or SIGKILL.
+  // @return OK, NOT_RUNNING_ERROR or SIGNAL_ERROR.
+  ProcessStatus signal(const int number);
+
+  // @brief Returns the process id.
+  // @return The id, or -1 if no child was spawned.
+  int getId() const;
+
+  // @brief Returns how the child ended: its exit status, or 128 plus the
+  // signal that killed it, as shells report it.
+  // @return The exit code, or -1 until the child has been reaped.
+  int getExitCode() const;
+
+  // @brief Checks whether the child was spawned and not reaped yet.
+  // @return true while the child may be running.
+  bool isRunning() const;
+
+ private:
+  // @brief Records the status reported by waitpid.
+  // @param raw The status.
+  void reap(const int raw);
+
+  // @brief The process id (-1 before spawn).
+  int id = -1;
+
+  // @brief The exit code (-1 until reaped).
+  int exit_code = -1;
+
+  // @brief Whether the child was spawned and not reaped yet.
+  bool running = false;
+};
+
+// @brief Runs a program to completion and captures its standard output.
+// @param arguments The program followed by its arguments, nullptr
+// terminated.
+// @param output Receives the output, replacing its contents. Must be
+// initialized; its capacity is reused, so one vector serves many runs
+// without reallocating.
+// @param exit_code Receives the exit code (see Child::getExitCode).
+// @param merge_errors Whether standard error is captured too.
+// @return OK, SPAWN_ERROR, PIPE_ERROR, READ_ERROR, WAIT_ERROR,
+// ALLOCATION_ERROR or UNSUPPORTED_ERROR.
+template <memory::Allocator A, GrowthPolicy G>
+ProcessStatus capture(const char* const* arguments, Vector<byte, A, G>& output,
+                      int& exit_code, const bool merge_errors = false);
+
+// @brief Ends the calling process immediately, without running destructors
+// or flushing stdio buffers (flush os::io::Writer instances first).
+// @param code The exit status.
+[[noreturn]] void exit(const int code);
+
+}  // namespace os::process
+
+// === Implementation of os::process::Pipe ===
+
+inline os::process::Pipe::~Pipe() { this->close(); }
+
+inline os::process::Pipe::Pipe(Pipe&& other) noexcept
+    : read_end(other.read_end), write_end(other.write_end) {
+  other.read_end = -1;
+  other.write_end = -1;
+}
+
+inline os::process::Pipe& os::process::Pipe::operator=(
+    Pipe&& other) noexcept {
+  if (this != &other) {
+    this->close();
+    this->read_end = other.read_end;
+    this->write_end = other.write_end;
+    other.read_end = -1;
+    other.write_end = -1;
+  }
+  return *this;
+}
+
+inline ProcessStatus os::process::Pipe::open() {
+  this->close();
+#ifdef PROCESS_POSIX
+  int ends[2];
+#if defined(OS_LINUX)
+  // Create both ends close-on-exec atomically
+  if (::pipe2(ends, O_CLOEXEC) != 0) {
+    return ProcessStatus::PIPE_ERROR;
+  }
+#else
+  if (::pipe(ends) != 0) {
+    return ProcessStatus::PIPE_ERROR;
+  }
+  ::fcntl(ends[0], F_SETFD, FD_CLOEXEC);
+  ::fcntl(ends[1], F_SETFD, FD_CLOEXEC);
+#endif
+  this->read_end = ends[0];
+  this->write_end = ends[1];
+  return ProcessStatus::OK;
+#else
+  return ProcessStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline void os::process::Pipe::close() {
+  this->close_read();
+  this->close_write();
+}
+
+inline void os::process::Pipe::close_read() {
+#ifdef PROCESS_POSIX
+  if (this->read_end >= 0) {
+    ::close(this->read_end);
+  }
+#endif
+  this->read_end = -1;
+}
+
+inline void os::process::Pipe::close_write() {
+#ifdef PROCESS_POSIX
+  if (this->write_end >= 0) {
+    ::close(this->write_end);
+  }
+#endif
+  this->write_end = -1;
+}
+
+inline int os::process::Pipe::getReadDescriptor() const {
+  return this->read_end;
+}
+
+inline int os::process::Pipe::getWriteDescriptor() const {
+  return this->write_end;
+}
+
+// === Implementation of os::process::Child ===
+
+inline os::process::Child::Child(Child&& other) noexcept
+    : id(other.id), exit_code(other.exit_code), running(other.running) {
+  other.id = -1;
+  other.exit_code = -1;
+  other.running = false;
+}
+
+inline os::process::Child& os::process::Child::operator=(
+    Child&& other) noexcept {
+  if (this != &other) {
+    this->id = other.id;
+    this->exit_code = other.exit_code;
+    this->running = other.running;
+    other.id = -1;
+    other.exit_code = -1;
+    other.running = false;
+  }
+  return *this;
+}
+
+inline ProcessStatus os::process::Child::spawn(
+    const char* const* arguments, const Redirect* redirects,
+    const uint32 redirect_count, const char* const* environment) {
+  if (this->running) {
+    return ProcessStatus::RUNNING_ERROR;
+  }
+  if (arguments == nullptr || arguments[0] == nullptr) {
+    return ProcessStatus::SPAWN_ERROR;
+  }
+#ifdef PROCESS_POSIX
+  // Queue the redirects; the C library applies them in the child
+  posix_spawn_file_actions_t actions;
+  if (posix_spawn_file_actions_init(&actions) != 0) {
+    return ProcessStatus::ALLOCATION_ERROR;
+  }
+  int failed = 0;
+  for (uint32 i = 0; i < redirect_count && failed == 0; i++) {
+    failed = redirects[i].source < 0
+                 ? posix_spawn_file_actions_addclose(&actions,
+                                                     redirects[i].target)
+                 : posix_spawn_file_actions_adddup2(
+                       &actions, redirects[i].source, redirects[i].target);
+  }
+
+  // Undo the signal state a server typically sets up for itself
+  posix_spawnattr_t attributes;
+  if (failed == 0 && posix_spawnattr_init(&attributes) != 0) {
+    failed = -1;
+  }
+  if (failed == 0) {
+    sigset_t signals;
+    sigemptyset(&signals);
+    posix_spawnattr_setsigmask(&attributes, &signals);
+    sigaddset(&signals, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attributes, &signals);
+    posix_spawnattr_setflags(&attributes,
+                             POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    // The child shares no memory with this process once it calls exec, and
+    // posix_spawnp only reads the strings
+    pid_t child;
+    failed = posix_spawnp(
+        &child, arguments[0], &actions, &attributes,
+        const_cast<char* const*>(arguments),
+        environment != nullptr ? const_cast<char* const*>(environment)
+                               : environ);
+    posix_spawnattr_destroy(&attributes);
+    if (failed == 0) {
+      this->id = child;
+      this->exit_code = -1;
+      this->running = true;
+    }
+  }
+  posix_spawn_file_actions_destroy(&actions);
+  if (failed != 0) {
+    return failed == ENOMEM ? ProcessStatus::ALLOCATION_ERROR
+                            : ProcessStatus::SPAWN_ERROR;
+  }
+  return ProcessStatus::OK;
+#else
+  (void)redirects;
+  (void)redirect_count;
+  (void)environment;
+  return ProcessStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline ProcessStatus os::process::Child::try_wait(bool& exited) {
+  exited = false;
+  if (!this->running) {
+    return ProcessStatus::NOT_RUNNING_ERROR;
+  }
+#ifdef PROCESS_POSIX
+  int raw = 0;
+  pid_t result;
+  do {
+    result = ::waitpid(this->id, &raw, WNOHANG);
+  } while (result < 0 && errno == EINTR);
+  if (result < 0) {
+    return ProcessStatus::WAIT_ERROR;
+  }
+  if (result == this->id) {
+    this->reap(raw);
+    exited = true;
+  }
+  return ProcessStatus::OK;
+#else
+  return ProcessStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline ProcessStatus os::process::Child::wait() {
+  if (!this->running) {
+    return ProcessStatus::NOT_RUNNING_ERROR;
+  }
+#ifdef PROCESS_POSIX
+  int raw = 0;
+  pid_t result;
+  do {
+    result = ::waitpid(this->id, &raw, 0);
+  } while (result < 0 && errno == EINTR);
+  if (result < 0) {
+    return ProcessStatus::WAIT_ERROR;
+  }
+  this->reap(raw);
+  return ProcessStatus::OK;
+#else
+  return ProcessStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline ProcessStatus os::process::Child::signal(const int number) {
+  if (!this->running) {
+    return ProcessStatus::NOT_RUNNING_ERROR;
+  }
+#ifdef PROCESS_POSIX
+  if (::kill(this->id, number) != 0) {
+    return ProcessStatus::SIGNAL_ERROR;
+  }
+  return ProcessStatus::OK;
+#else
+  (void)number;
+  return ProcessStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline int os::process::Child::getId() const { return this->id; }
+
+inline int os::process::Child::getExitCode() const { return this->exit_code; }
+
+inline bool os::process::Child::isRunning() const { return this->running; }
+
+inline void os::process::Child::reap(const int raw) {
+#ifdef PROCESS_POSIX
+  if (WIFEXITED(raw)) {
+    this->exit_code = WEXITSTATUS(raw);
+  } else if (WIFSIGNALED(raw)) {
+    this->exit_code = 128 + WTERMSIG(raw);
+  }
+#else
+  (void)raw;
+#endif
+  this->running = false;
+}
+
+// === Implementation of os::process ===
+
+template <memory::Allocator A, GrowthPolicy G>
+inline ProcessStatus os::process::capture(const char* const* arguments,
+                                          Vector<byte, A, G>& output,
+                                          int& exit_code,
+                                          const bool merge_errors) {
+  exit_code = -1;
+  if (output.resize(0) != VectorStatus::OK) {
+    return ProcessStatus::ALLOCATION_ERROR;
+  }
+  Pipe pipe;
+  const ProcessStatus opened = pipe.open();
+  if (opened != ProcessStatus::OK) {
+    return opened;
+  }
+
+  // Only the child may hold the write end, or the reads never end
+  const Redirect redirects[2] = {{1, pipe.getWriteDescriptor()},
+                                 {2, pipe.getWriteDescriptor()}};
+  Child child;
+  const ProcessStatus spawned =
+      child.spawn(arguments, redirects, merge_errors ? 2 : 1);
+  pipe.close_write();
+  if (spawned != ProcessStatus::OK) {
+    return spawned;
+  }
+
+#ifdef PROCESS_POSIX
+  // Read straight into the vector: extend it by up to a pipe's worth of
+  // bytes at a time (within its capacity after the first runs), then trim
+  // it to what arrived
+  constexpr uint64 CHUNK = 65536;
+  ProcessStatus status = ProcessStatus::OK;
+  uint64 used = 0;
+  while (true) {
+    if (used == output.getSize()) {
+      if (output.resize(used + CHUNK) != VectorStatus::OK) {
+        status = ProcessStatus::ALLOCATION_ERROR;
+        break;
+      }
+    }
+    const ssize_t result =
+        ::read(pipe.getReadDescriptor(), output.getData() + used,
+               static_cast<size_t>(output.getSize() - used));
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      status = ProcessStatus::READ_ERROR;
+      break;
+    }
+    if (result == 0) {
+      break;
+    }
+    used += static_cast<uint64>(result);
+  }
+  output.resize(used);
+
+  // Reap the child even if the output could not be kept; closing the read
+  // end first unblocks a child still writing
+  pipe.close_read();
+  const ProcessStatus waited = child.wait();
+  exit_code = child.getExitCode();
+  return status != ProcessStatus::OK ? status : waited;
+#else
+  return ProcessStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline void os::process::exit(const int code) {
+#if defined(OS_WINDOWS)
+  ExitProcess(static_cast<UINT>(code));
+#elif defined(PROCESS_POSIX)
+  _exit(code);
+#else
+  // No operating system to return to: stop here
+  (void)code;
+#endif
+  __builtin_trap();
+}
@@ -0,0 +1,970 @@
+// @file thread.hpp
+
+#pragma once
+
+#include "../memory.hpp"
+#include "../utilities/architecture.h"
+#include "../utilities/types.h"
+
+#ifndef RECREATIONS_ONLY
+#include "../utilities/os.hpp"
+#endif
+
+// Threads need pthreads; freestanding builds get a scheduler without workers
+// whose task groups run everything on the waiting thread.
+#if defined(OS_POSIX_COMPATIBLE)
+#define THREAD_PTHREADS
+#include <sched.h>  // sched_yield, sched_getaffinity, cpu_set_t
+#endif
+
+#if defined(OS_LINUX)
+#define THREAD_AFFINITY
+#endif
+
+// @brief Threads and a work-stealing task scheduler. Every worker owns a
+// Chase-Lev deque: it pushes and pops its own tasks at the bottom (LIFO, cache
+// friendly) while idle workers steal from the top (FIFO, oldest and usually
+// largest work first). Tasks submitted from outside the pool go through a
+// shared injection queue.
+namespace os::thread {
+
+class TaskGroup;
+
+// @brief Hints the CPU that the caller is spinning.
+void pause();
+
+// @brief Gives the rest of the time slice to another thread.
+void yield();
+
+// @brief Returns the number of CPUs the process may run on.
+// @return The CPU count (at least 1).
+uint32 hardware_concurrency();
+
+// @brief Lists the CPUs the process may run on, one hardware thread per
+// physical core first (read from /sys/devices/system/cpu/*/topology), then the
+// remaining SMT siblings. Pinning workers in this order spreads them over
+// cores before doubling up on hyper-threads.
+// @param cpus Receives the CPU ids.
+// @param capacity The number of entries cpus can hold.
+// @return The number of ids written (0 where affinity is unsupported).
+uint32 cpu_order(uint32* cpus, const uint32 capacity);
+
+// @brief An OS thread running a plain function. Joined on destruction.
+class Thread {
+ public:
+  // @brief The entry point of a thread.
+  using Function = void (*)(void* argument);
+
+  // @brief Creates a handle with no thread attached.
+  Thread() = default;
+
+  // @brief Destructor. Joins the thread if it is still running.
+  ~Thread();
+
+  // @brief Deleted copy constructor. Threads are owned by one handle.
+  Thread(const Thread&) = delete;
+
+  // @brief Deleted copy assignment operator. Threads are owned by one handle.
+  Thread& operator=(const Thread&) = delete;
+
+  // @brief Starts a thread running function(argument).
+  // @param function The entry point.
+  // @param argument The value passed to function.
+  // @return false if a thread is already attached or creation failed.
+  bool start(Function function, void* argument);
+
+  // @brief Waits for the thread to finish.
+  // @return false if no thread is attached or joining failed.
+  bool join();
+
+  // @brief Restricts the thread to a single CPU.
+  // @param cpu The CPU id (see cpu_order).
+  // @return false if no thread is attached or pinning is unsupported/failed.
+  bool pin(const uint32 cpu);
+
+  // @brief Returns whether a thread is attached to the handle.
+  // @return true between a successful start and join.
+  bool isRunning() const;
+
+ private:
+#ifdef THREAD_PTHREADS
+  // @brief The pthread handle.
+  pthread_t handle{};
+#endif
+
+  // @brief Whether a thread is attached.
+  bool running = false;
+};
+
+// @brief A unit of work. Tasks are intrusive so the queues never allocate
+// per task; TaskGroup embeds one in front of every spawned callable.
+struct Task {
+  // @brief Runs and then releases the task.
+  void (*run)(Task* task);
+
+  // @brief The group notified when the task completes.
+  TaskGroup* group;
+
+  // @brief Link used by the injection queue.
+  Task* next;
+};
+
+// @brief Chase-Lev work-stealing deque (Le, Pop, Cohen, Zappa Nardelli 2013).
+// Only the owning thread may push and take; any thread may steal.
+class Deque {
+ public:
+  // @brief Creates a deque.
+  // @param initial_capacity The initial ring size (rounded up to a power of
+  // two); the ring doubles when full.
+  Deque(const uint64 initial_capacity = 256);
+
+  // @brief Destructor. Frees the ring and every ring retired by growth.
+  ~Deque();
+
+  // @brief Deleted copy constructor. Deques are shared by address.
+  Deque(const Deque&) = delete;
+
+  // @brief Deleted copy assignment operator. Deques are shared by address.
+  Deque& operator=(const Deque&) = delete;
+
+  // @brief Pushes a task at the bottom. Owner only.
+  // @param task The task to push.
+  // @return false if the ring was full and could not grow.
+  bool push(Task* task);
+
+  // @brief Pops the most recently pushed task. Owner only.
+  // @return The task, or nullptr if the deque is empty.
+  Task* take();
+
+  // @brief Steals the oldest task. Any thread.
+  // @return The task, or nullptr if the deque is empty or another thread won
+  // the race for it.
+  Task* steal();
+
+ private:
+  // @brief A power-of-two ring of task pointers. Grown rings keep a link to
+  // their predecessor, which thieves may still be reading.
+  struct Ring {
+    uint64 capacity;
+    Ring* retired;
+    Task** slots;
+  };
+
+  // @brief The index thieves steal from.
+  int64 top = 0;
+
+  // @brief Keeps top and bottom on separate cache lines. (alignas would ask
+  // for more than the 16 bytes memory::allocate guarantees to workers.)
+  byte top_padding[56];
+
+  // @brief The index the owner pushes to.
+  int64 bottom = 0;
+
+  // @brief The current ring.
+  Ring* ring = nullptr;
+
+  // @brief Keeps the owner's fields off the next deque's cache line.
+  byte bottom_padding[48];
+
+  // @brief Allocates a ring.
+  // @param capacity The number of slots (a power of two).
+  // @return The ring, or nullptr on allocation failure.
+  static Ring* allocate_ring(const uint64 capacity);
+
+  // @brief Doubles the ring, copying the live range [from, to).
+  // @return The new ring, or nullptr on allocation failure.
+  Ring* grow(const int64 from, const int64 to);
+};
+
+// @brief A pool of worker threads executing tasks with work stealing. Threads
+// that wait on a TaskGroup execute tasks too, so the default worker count
+// leaves one CPU for the submitting thread.
+class Scheduler {
+ public:
+  // @brief Starts the workers.
+  // @param thread_count The number of worker threads (0: one less than
+  // hardware_concurrency()).
+  // @param pin_workers Whether to pin worker i to the i-th CPU of cpu_order.
+  Scheduler(const uint32 thread_count = 0, const bool pin_workers = false);
+
+  // @brief Destructor. Stops and joins the workers. Every TaskGroup using the
+  // scheduler must have been waited on.
+  ~Scheduler();
+
+  // @brief Deleted copy constructor. Schedulers own their workers.
+  Scheduler(const Scheduler&) = delete;
+
+  // @brief Deleted copy assignment operator. Schedulers own their workers.
+  Scheduler& operator=(const Scheduler&) = delete;
+
+  // @brief Queues a task: on the caller's own deque if it is a worker of
+  // this scheduler, on the injection queue otherwise.
+  // @param task The task to run.
+  void submit(Task* task);
+
+  // @brief Finds and runs one task, as a worker would.
+  // @return true if a task was run.
+  bool help();
+
+  // @brief Returns the number of worker threads.
+  // @return The worker count.
+  uint32 getWorkerCount() const;
+
+ private:
+  // @brief The per-thread state of a worker.
+  struct Worker {
+    Scheduler* owner;
+    Deque deque;
+    Thread thread;
+  };
+
+  // @brief The workers.
+  Worker* workers = nullptr;
+
+  // @brief The number of workers.
+  uint32 worker_count = 0;
+
+  // @brief FIFO of tasks submitted from outside the pool.
+  Task* injected_head = nullptr;
+  Task* injected_tail = nullptr;
+
+  // @brief Spin lock protecting the injection queue.
+  uint8 injection_lock = 0;
+
+  // @brief Tasks pushed to any queue and not yet taken.
+  uint64 queued = 0;
+
+  // @brief Workers blocked waiting for work.
+  uint32 sleepers = 0;
+
+  // @brief Set when the workers must exit.
+  bool stopping = false;
+
+#ifdef THREAD_PTHREADS
+  // @brief Mutex and condition idle workers block on.
+  pthread_mutex_t park_mutex = PTHREAD_MUTEX_INITIALIZER;
+  pthread_cond_t park_condition = PTHREAD_COND_INITIALIZER;
+#endif
+
+  // @brief The loop run by every worker thread.
+  // @param argument The Worker.
+  static void worker_main(void* argument);
+
+  // @brief Looks for a task: own deque, then the injection queue, then the
+  // other workers' deques starting from a random victim.
+  // @param self The calling worker, or nullptr for outside threads.
+  // @return A task, or nullptr if none was found.
+  Task* find(Worker* self);
+
+  // @brief Pops the oldest injected task.
+  // @return The task, or nullptr if the queue is empty.
+  Task* pop_injected();
+
+  // @brief Blocks the calling worker until work is queued or the scheduler
+  // stops.
+  void park();
+
+  // @brief Returns the calling thread's worker if it belongs to this
+  // scheduler.
+  // @return The worker, or nullptr.
+  Worker* current();
+};
+
+// @brief A set of tasks that can be waited on together.
+class TaskGroup {
+ public:
+  // @brief Creates an empty group.
+  // @param target The scheduler tasks are submitted to.
+  TaskGroup(Scheduler& target);
+
+  // @brief Destructor. Waits for every spawned task.
+  ~TaskGroup();
+
+  // @brief Deleted copy constructor. Tasks refer to their group by address.
+  TaskGroup(const TaskGroup&) = delete;
+
+  // @brief Deleted copy assignment operator. Tasks refer to their group by
+  // address.
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  // @brief Runs function() asynchronously. If the task cannot be allocated,
+  // function runs immediately on the calling thread instead.
+  // @param function The callable (moved into the task).
+  template <typename F>
+  void spawn(F function);
+
+  // @brief Runs queued tasks until every task spawned in the group finished.
+  void wait();
+
+ private:
+  // @brief A spawned callable together with its task header.
+  // @param F The callable type.
+  template <typename F>
+  struct FunctionTask : Task {
+    F function;
+
+    // @brief Builds the task.
+    // @param owner The group to notify on completion.
+    // @param callable The callable to move in.
+    FunctionTask(TaskGroup* owner, F& callable);
+
+    // @brief Runs, destroys and frees the task, then notifies the group.
+    // @param task The task.
+    static void execute(Task* task);
+  };
+
+  // @brief The scheduler tasks are submitted to.
+  Scheduler& scheduler;
+
+  // @brief Tasks spawned and not yet finished.
+  uint64 pending = 0;
+};
+
+// @brief Calls body(first, last) over disjoint chunks covering [begin, end)
+// in parallel. The range is split in halves recursively, so idle workers
+// steal large pieces and the owner keeps working on cache-warm ones.
+// @param scheduler The scheduler to run on.
+// @param begin The first index.
+// @param end One past the last index.
+// @param grain The largest chunk handed to body (0: picked from the worker
+// count).
+// @param body Callable taking (uint64 first, uint64 last); must be safe to
+// call concurrently.
+template <typename F>
+void parallel_for(Scheduler& scheduler, const uint64 begin, const uint64 end,
+                  uint64 grain, const F& body);
+
+// @brief parallel_for on the process-wide pool().
+// @param begin The first index.
+// @param end One past the last index.
+// @param grain The largest chunk handed to body (0: automatic).
+// @param body Callable taking (uint64 first, uint64 last).
+template <typename F>
+void parallel_for(const uint64 begin, const uint64 end, const uint64 grain,
+                  const F& body);
+
+// @brief Returns the process-wide scheduler, started on first use with the
+// default worker count.
+// @return The scheduler.
+Scheduler& pool();
+
+// @brief Splits [begin, end) until chunks fit in grain. Used by parallel_for.
+// @param group The group the halves are spawned in.
+// @param begin The first index.
+// @param end One past the last index.
+// @param grain The largest chunk handed to body.
+// @param body The body passed to parallel_for.
+template <typename F>
+void parallel_split(TaskGroup& group, uint64 begin, uint64 end,
+                    const uint64 grain, const F& body);
+
+// @brief The worker the calling thread runs, if any.
+inline thread_local void* current_worker = nullptr;
+
+// @brief State of the victim-selection generator of the calling thread.
+inline thread_local uint64 steal_seed = 0;
+
+}  // namespace os::thread
+
+// === Implementation of os::thread ===
+
+inline void os::thread::pause() {
+#if defined(ARCHITECTURE_X64) || defined(ARCHITECTURE_X86)
+  __builtin_ia32_pause();
+#elif defined(ARCHITECTURE_ARM64)
+  __asm__ volatile("yield");
+#endif
+}
+
+inline void os::thread::yield() {
+#ifdef THREAD_PTHREADS
+  sched_yield();
+#endif
+}
+
+inline uint32 os::thread::hardware_concurrency() {
+#if defined(THREAD_AFFINITY)
+  // Honour the affinity mask (taskset, cgroups cpusets)
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+    const int count = CPU_COUNT(&allowed);
+    return count > 0 ? static_cast<uint32>(count) : 1;
+  }
+#endif
+#if defined(THREAD_PTHREADS)
+  const long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? static_cast<uint32>(count) : 1;
+#else
+  return 1;
+#endif
+}
+
+inline uint32 os::thread::cpu_order(uint32* cpus, const uint32 capacity) {
+#if defined(THREAD_AFFINITY)
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    return 0;
+  }
+
+  // Reads the first CPU of a core's sibling list ("2,34" or "2-3")
+  auto first_sibling = [](const uint32 cpu) -> uint32 {
+    const char prefix[] = "/sys/devices/system/cpu/cpu";
+    const char suffix[] = "/topology/thread_siblings_list";
+    char path[sizeof(prefix) + sizeof(suffix) + 10];
+    uint64 length = 0;
+    for (uint64 i = 0; prefix[i] != '\0'; i++) {
+      path[length++] = prefix[i];
+    }
+    char digits[10];
+    uint32 digit_count = 0;
+    uint32 value = cpu;
+    do {
+      digits[digit_count++] = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value != 0);
+    while (digit_count > 0) {
+      path[length++] = digits[--digit_count];
+    }
+    for (uint64 i = 0; i < sizeof(suffix); i++) {
+      path[length++] = suffix[i];
+    }
+
+    // Without topology information every CPU counts as its own core
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return cpu;
+    }
+    char text[32];
+    const ssize_t read_count = read(fd, text, sizeof(text));
+    close(fd);
+    uint32 first = 0;
+    ssize_t i = 0;
+    for (; i < read_count && text[i] >= '0' && text[i] <= '9'; i++) {
+      first = first * 10 + static_cast<uint32>(text[i] - '0');
+    }
+    return i > 0 ? first : cpu;
+  };
+
+  // First pass: one CPU per core; second pass: the SMT siblings
+  uint32 count = 0;
+  for (uint32 pass = 0; pass < 2; pass++) {
+    for (uint32 cpu = 0; cpu < CPU_SETSIZE && count < capacity; cpu++) {
+      if (!CPU_ISSET(cpu, &allowed)) {
+        continue;
+      }
+      const bool primary = first_sibling(cpu) == cpu;
+      if (primary == (pass == 0)) {
+        cpus[count++] = cpu;
+      }
+    }
+  }
+  return count;
+#else
+  (void)cpus;
+  (void)capacity;
+  return 0;
+#endif
+}
+
+// === Implementation of os::thread::Thread ===
+
+inline os::thread::Thread::~Thread() { this->join(); }
+
+inline bool os::thread::Thread::start(Function function, void* argument) {
+#ifdef THREAD_PTHREADS
+  if (this->running) {
+    return false;
+  }
+
+  // pthreads wants void* (*)(void*): trampoline through a heap-allocated pair
+  struct Start {
+    Function function;
+    void* argument;
+  };
+  Start* start = static_cast<Start*>(::memory::allocate(sizeof(Start)));
+  if (start == nullptr) {
+    return false;
+  }
+  start->function = function;
+  start->argument = argument;
+  auto trampoline = [](void* pair) -> void* {
+    const Start copy = *static_cast<Start*>(pair);
+    ::memory::deallocate(pair);
+    copy.function(copy.argument);
+    return nullptr;
+  };
+
+  if (pthread_create(&this->handle, nullptr, trampoline, start) != 0) {
+    ::memory::deallocate(start);
+    return false;
+  }
+  this->running = true;
+  return true;
+#else
+  (void)function;
+  (void)argument;
+  return false;
+#endif
+}
+
+inline bool os::thread::Thread::join() {
+#ifdef THREAD_PTHREADS
+  if (!this->running) {
+    return false;
+  }
+  this->running = false;
+  return pthread_join(this->handle, nullptr) == 0;
+#else
+  return false;
+#endif
+}
+
+inline bool os::thread::Thread::pin(const uint32 cpu) {
+#if defined(THREAD_AFFINITY)
+  if (!this->running || cpu >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(this->handle, sizeof(set), &set) == 0;
+#else
+  (void)cpu;
+  return false;
+#endif
+}
+
+inline bool os::thread::Thread::isRunning() const { return this->running; }
+
+// === Implementation of os::thread::Deque ===
+
+inline os::thread::Deque::Deque(const uint64 initial_capacity) {
+  uint64 capacity = 16;
+  while (capacity < initial_capacity) {
+    capacity *= 2;
+  }
+  this->ring = allocate_ring(capacity);
+}
+
+inline os::thread::Deque::~Deque() {
+  Ring* current = this->ring;
+  while (current != nullptr) {
+    Ring* retired = current->retired;
+    ::memory::deallocate(current);
+    current = retired;
+  }
+}
+
+inline os::thread::Deque::Ring* os::thread::Deque::allocate_ring(
+    const uint64 capacity) {
+  // The slots follow the header in the same block
+  Ring* result = static_cast<Ring*>(
+      ::memory::allocate(sizeof(Ring) + capacity * sizeof(Task*)));
+  if (result != nullptr) {
+    result->capacity = capacity;
+    result->retired = nullptr;
+    result->slots = reinterpret_cast<Task**>(result + 1);
+  }
+  return result;
+}
+
+inline os::thread::Deque::Ring* os::thread::Deque::grow(const int64 from,
+                                                         const int64 to) {
+  Ring* old_ring = this->ring;
+  Ring* new_ring = allocate_ring(old_ring->capacity * 2);
+  if (new_ring == nullptr) {
+    return nullptr;
+  }
+
+  // Copy the live tasks; thieves may keep reading the old ring, so it is only
+  // freed with the deque
+  const uint64 old_mask = old_ring->capacity - 1;
+  const uint64 new_mask = new_ring->capacity - 1;
+  for (int64 i = from; i < to; i++) {
+    Task* task = __atomic_load_n(
+        &old_ring->slots[static_cast<uint64>(i) & old_mask], __ATOMIC_RELAXED);
+    __atomic_store_n(&new_ring->slots[static_cast<uint64>(i) & new_mask], task,
+                     __ATOMIC_RELAXED);
+  }
+  new_ring->retired = old_ring;
+  __atomic_store_n(&this->ring, new_ring, __ATOMIC_RELEASE);
+  return new_ring;
+}
+
+inline bool os::thread::Deque::push(Task* task) {
+  const int64 b = __atomic_load_n(&this->bottom, __ATOMIC_RELAXED);
+  const int64 t = __atomic_load_n(&this->top, __ATOMIC_ACQUIRE);
+  Ring* current = __atomic_load_n(&this->ring, __ATOMIC_RELAXED);
+  if (current == nullptr) {
+    return false;
+  }
+
+  // Grow when full
+  if (b - t > static_cast<int64>(current->capacity) - 1) {
+    current = this->grow(t, b);
+    if (current == nullptr) {
+      return false;
+    }
+  }
+
+  // Publish the slot before the new bottom
+  __atomic_store_n(
+      &current->slots[static_cast<uint64>(b) & (current->capacity - 1)], task,
+      __ATOMIC_RELAXED);
+  __atomic_store_n(&this->bottom, b + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+inline os::thread::Task* os::thread::Deque::take() {
+  Ring* current = __atomic_load_n(&this->ring, __ATOMIC_RELAXED);
+  if (current == nullptr) {
+    return nullptr;
+  }
+
+  // Reserve the bottom slot, then check whether a thief got there first. The
+  // sequentially consistent exchange stands in for the store + full fence of
+  // the paper (same cost on x86, and visible to ThreadSanitizer).
+  const int64 b = __atomic_load_n(&this->bottom, __ATOMIC_RELAXED) - 1;
+  __atomic_exchange_n(&this->bottom, b, __ATOMIC_SEQ_CST);
+  int64 t = __atomic_load_n(&this->top, __ATOMIC_SEQ_CST);
+
+  Task* task = nullptr;
+  if (t <= b) {
+    task = __atomic_load_n(
+        &current->slots[static_cast<uint64>(b) & (current->capacity - 1)],
+        __ATOMIC_RELAXED);
+    if (t == b) {
+      // Last task: race the thieves for it
+      if (!__atomic_compare_exchange_n(&this->top, &t, t + 1, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        task = nullptr;
+      }
+      __atomic_store_n(&this->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+  } else {
+    // Empty: restore the bottom
+    __atomic_store_n(&this->bottom, b + 1, __ATOMIC_RELAXED);
+  }
+  return task;
+}
+
+inline os::thread::Task* os::thread::Deque::steal() {
+  int64 t = __atomic_load_n(&this->top, __ATOMIC_SEQ_CST);
+  const int64 b = __atomic_load_n(&this->bottom, __ATOMIC_SEQ_CST);
+  if (t >= b) {
+    return nullptr;
+  }
+
+  // Read the task before claiming it; the claim fails if the owner or another
+  // thief took it meanwhile
+  Ring* current = __atomic_load_n(&this->ring, __ATOMIC_ACQUIRE);
+  Task* task = __atomic_load_n(
+      &current->slots[static_cast<uint64>(t) & (current->capacity - 1)],
+      __ATOMIC_RELAXED);
+  if (!__atomic_compare_exchange_n(&this->top, &t, t + 1, false,
+                                   __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+    return nullptr;
+  }
+  return task;
+}
+
+// === Implementation of os::thread::Scheduler ===
+
+inline os::thread::Scheduler::Scheduler(const uint32 thread_count,
+                                        const bool pin_workers) {
+  // Pick the worker count; the waiting thread makes up the last CPU
+  uint32 count = thread_count;
+  if (count == 0) {
+    count = hardware_concurrency() - 1;
+  }
+#ifndef THREAD_PTHREADS
+  count = 0;
+#endif
+  if (count == 0) {
+    return;
+  }
+
+  // Construct every worker before starting any, since thieves scan them all
+  this->workers =
+      static_cast<Worker*>(::memory::allocate(count * sizeof(Worker)));
+  if (this->workers == nullptr) {
+    return;
+  }
+  for (uint32 i = 0; i < count; i++) {
+    ::memory::construct(&this->workers[i]);
+    this->workers[i].owner = this;
+  }
+  this->worker_count = count;
+
+  // Start (and optionally pin) the threads
+  uint32 cpus[1024];
+  const uint32 cpu_count = pin_workers ? cpu_order(cpus, 1024) : 0;
+  for (uint32 i = 0; i < count; i++) {
+    Worker& worker = this->workers[i];
+    if (worker.thread.start(&worker_main, &worker) && cpu_count > 0) {
+      worker.thread.pin(cpus[i % cpu_count]);
+    }
+  }
+}
+
+inline os::thread::Scheduler::~Scheduler() {
+  // Tell the workers to exit and wake the sleeping ones
+  __atomic_store_n(&this->stopping, true, __ATOMIC_SEQ_CST);
+#ifdef THREAD_PTHREADS
+  pthread_mutex_lock(&this->park_mutex);
+  pthread_cond_broadcast(&this->park_condition);
+  pthread_mutex_unlock(&this->park_mutex);
+#endif
+
+  // Join the threads, then release the workers
+  for (uint32 i = 0; i < this->worker_count; i++) {
+    this->workers[i].thread.join();
+  }
+  for (uint32 i = 0; i < this->worker_count; i++) {
+    ::memory::destroy(&this->workers[i]);
+  }
+  ::memory::deallocate(this->workers);
+
+#ifdef THREAD_PTHREADS
+  pthread_cond_destroy(&this->park_condition);
+  pthread_mutex_destroy(&this->park_mutex);
+#endif
+}
+
+inline os::thread::Scheduler::Worker* os::thread::Scheduler::current() {
+  Worker* worker = static_cast<Worker*>(current_worker);
+  return worker != nullptr && worker->owner == this ? worker : nullptr;
+}
+
+inline void os::thread::Scheduler::submit(Task* task) {
+  // Workers push to their own deque; everyone else (or a full deque) injects
+  Worker* self = this->current();
+  if (self == nullptr || !self->deque.push(task)) {
+    task->next = nullptr;
+    while (__atomic_exchange_n(&this->injection_lock, 1, __ATOMIC_ACQUIRE)) {
+      pause();
+    }
+    if (this->injected_tail != nullptr) {
+      this->injected_tail->next = task;
+    } else {
+      __atomic_store_n(&this->injected_head, task, __ATOMIC_RELAXED);
+    }
+    this->injected_tail = task;
+    __atomic_store_n(&this->injection_lock, 0, __ATOMIC_RELEASE);
+  }
+
+  // Count the task, then wake a sleeper. Sleepers announce themselves before
+  // re-checking queued, so one of the two sides always sees the other.
+  __atomic_add_fetch(&this->queued, 1, __ATOMIC_SEQ_CST);
+#ifdef THREAD_PTHREADS
+  if (__atomic_load_n(&this->sleepers, __ATOMIC_SEQ_CST) != 0) {
+    pthread_mutex_lock(&this->park_mutex);
+    pthread_cond_signal(&this->park_condition);
+    pthread_mutex_unlock(&this->park_mutex);
+  }
+#endif
+}
+
+inline os::thread::Task* os::thread::Scheduler::pop_injected() {
+  // Skip the lock when the queue looks empty
+  if (__atomic_load_n(&this->injected_head, __ATOMIC_RELAXED) == nullptr) {
+    return nullptr;
+  }
+  while (__atomic_exchange_n(&this->injection_lock, 1, __ATOMIC_ACQUIRE)) {
+    pause();
+  }
+  Task* task = this->injected_head;
+  if (task != nullptr) {
+    __atomic_store_n(&this->injected_head, task->next, __ATOMIC_RELAXED);
+    if (task->next == nullptr) {
+      this->injected_tail = nullptr;
+    }
+  }
+  __atomic_store_n(&this->injection_lock, 0, __ATOMIC_RELEASE);
+  return task;
+}
+
+inline os::thread::Task* os::thread::Scheduler::find(Worker* self) {
+  // Own work first, newest first
+  Task* task = self != nullptr ? self->deque.take() : nullptr;
+
+  // Then work submitted from outside the pool
+  if (task == nullptr) {
+    task = this->pop_injected();
+  }
+
+  // Then steal, starting from a random victim (xorshift64)
+  if (task == nullptr && this->worker_count > 0) {
+    if (steal_seed == 0) {
+      steal_seed = reinterpret_cast<uint64>(&steal_seed) | 1;
+    }
+    steal_seed ^= steal_seed << 13;
+    steal_seed ^= steal_seed >> 7;
+    steal_seed ^= steal_seed << 17;
+    const uint32 start = static_cast<uint32>(steal_seed % this->worker_count);
+    for (uint32 i = 0; i < this->worker_count && task == nullptr; i++) {
+      Worker& victim = this->workers[(start + i) % this->worker_count];
+      if (&victim != self) {
+        task = victim.deque.steal();
+      }
+    }
+  }
+
+  if (task != nullptr) {
+    __atomic_sub_fetch(&this->queued, 1, __ATOMIC_RELAXED);
+  }
+  return task;
+}
+
+inline bool os::thread::Scheduler::help() {
+  Task* task = this->find(this->current());
+  if (task == nullptr) {
+    return false;
+  }
+  task->run(task);
+  return true;
+}
+
+inline void os::thread::Scheduler::park() {
+#ifdef THREAD_PTHREADS
+  pthread_mutex_lock(&this->park_mutex);
+  __atomic_add_fetch(&this->sleepers, 1, __ATOMIC_SEQ_CST);
+  while (__atomic_load_n(&this->queued, __ATOMIC_SEQ_CST) == 0 &&
+         !__atomic_load_n(&this->stopping, __ATOMIC_SEQ_CST)) {
+    pthread_cond_wait(&this->park_condition, &this->park_mutex);
+  }
+  __atomic_sub_fetch(&this->sleepers, 1, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(&this->park_mutex);
+#endif
+}
+
+inline void os::thread::Scheduler::worker_main(void* argument) {
+  Worker* self = static_cast<Worker*>(argument);
+  Scheduler& scheduler = *self->owner;
+  current_worker = self;
+
+  // Run tasks; spin briefly when out of work, then sleep
+  uint32 idle = 0;
+  while (!__atomic_load_n(&scheduler.stopping, __ATOMIC_ACQUIRE)) {
+    Task* task = scheduler.find(self);
+    if (task != nullptr) {
+      task->run(task);
+      idle = 0;
+    } else if (++idle < 64) {
+      pause();
+    } else {
+      scheduler.park();
+      idle = 0;
+    }
+  }
+  current_worker = nullptr;
+}
+
+inline uint32 os::thread::Scheduler::getWorkerCount() const {
+  return this->worker_count;
+}
+
+// === Implementation of os::thread::TaskGroup ===
+
+inline os::thread::TaskGroup::TaskGroup(Scheduler& target)
+    : scheduler(target) {}
+
+inline os::thread::TaskGroup::~TaskGroup() { this->wait(); }
+
+template <typename F>
+inline os::thread::TaskGroup::FunctionTask<F>::FunctionTask(TaskGroup* owner,
+                                                            F& callable)
+    : Task{&FunctionTask::execute, owner, nullptr},
+      function(::memory::pass_ownership(callable)) {}
+
+template <typename F>
+inline void os::thread::TaskGroup::FunctionTask<F>::execute(Task* task) {
+  // Read the group first: it may be gone as soon as pending drops
+  FunctionTask* self = static_cast<FunctionTask*>(task);
+  TaskGroup* owner = self->group;
+  self->function();
+  ::memory::destroy(self);
+  ::memory::deallocate(self);
+  __atomic_sub_fetch(&owner->pending, 1, __ATOMIC_RELEASE);
+}
+
+template <typename F>
+inline void os::thread::TaskGroup::spawn(F function) {
+  static_assert(alignof(F) <= 16, "memory::allocate aligns to 16 bytes");
+
+  // Run inline if the task cannot be allocated
+  void* storage = ::memory::allocate(sizeof(FunctionTask<F>));
+  if (storage == nullptr) {
+    function();
+    return;
+  }
+  FunctionTask<F>* task = ::memory::construct(
+      static_cast<FunctionTask<F>*>(storage), this, function);
+
+  __atomic_add_fetch(&this->pending, 1, __ATOMIC_RELAXED);
+  this->scheduler.submit(task);
+}
+
+inline void os::thread::TaskGroup::wait() {
+  // Help with any queued work rather than blocking
+  uint32 idle = 0;
+  while (__atomic_load_n(&this->pending, __ATOMIC_ACQUIRE) != 0) {
+    if (this->scheduler.help()) {
+      idle = 0;
+    } else if (++idle < 64) {
+      pause();
+    } else {
+      yield();
+    }
+  }
+}
+
+// === Implementation of os::thread parallel algorithms ===
+
+template <typename F>
+inline void os::thread::parallel_split(TaskGroup& group, uint64 begin,
+                                       uint64 end, const uint64 grain,
+                                       const F& body) {
+  // Hand the upper half to a thief and keep splitting the lower one
+  while (end - begin > grain) {
+    const uint64 middle = begin + (end - begin) / 2;
+    group.spawn([&group, &body, middle, end, grain] {
+      parallel_split(group, middle, end, grain, body);
+    });
+    end = middle;
+  }
+  body(begin, end);
+}
+
+template <typename F>
+inline void os::thread::parallel_for(Scheduler& scheduler, const uint64 begin,
+                                     const uint64 end, uint64 grain,
+                                     const F& body) {
+  if (begin >= end) {
+    return;
+  }
+
+  // Aim for about eight chunks per thread to balance load
+  if (grain == 0) {
+    const uint64 threads = scheduler.getWorkerCount() + 1;
+    grain = (end - begin) / (threads * 8);
+    if (grain == 0) {
+      grain = 1;
+    }
+  }
+
+  TaskGroup group(scheduler);
+  parallel_split(group, begin, end, grain, body);
+  group.wait();
+}
+
+template <typename F>
+inline void os::thread::parallel_for(const uint64 begin, const uint64 end,
+                                     const uint64 grain, const F& body) {
+  parallel_for(pool(), begin, end, grain, body);
+}
+
+inline os::thread::Scheduler& os::thread::pool() {
+  static Scheduler scheduler;
+  return scheduler;
+}
@@ -0,0 +1,348 @@
+// @file trace.hpp
+
+#pragma once
+
+#include "../memory/heap.hpp"
+#include "../numbers.hpp"
+#include "../utilities/types.h"
+#include "clock.hpp"
+
+// @brief Optional timing instrumentation. Everything is compiled out unless
+// RECREATIONS_TRACE is defined; zones then become empty objects and
+// write_json() emits an empty trace. When enabled, a zone costs one relaxed
+// load while recording is stopped, and two counter reads plus a handful of
+// stores into the calling thread's ring while it runs. Rings are mapped
+// straight from pages, so memory::allocate can carry zones of its own.
+namespace os::system::trace {
+
+#ifdef RECREATIONS_TRACE
+// @brief Whether instrumentation is compiled in.
+inline constexpr bool ENABLED = true;
+#else
+// @brief Whether instrumentation is compiled in.
+inline constexpr bool ENABLED = false;
+#endif
+
+// @brief The number of zones each thread keeps; older ones are overwritten.
+inline constexpr uint64 CAPACITY = 8192;
+
+// @brief Receives the exported trace piece by piece (the signature matches
+// os::io::Writer sinks).
+// @param context The pointer given to write_json.
+// @param data The bytes to write.
+// @param size The number of bytes.
+// @return false to abort the export.
+using Sink = bool (*)(void* context, const byte* data, const uint64 size);
+
+// @brief Times the enclosing block while recording is on. Place one at the
+// top of a scope: os::system::trace::Zone zone("Vector::grow");
+class Zone {
+ public:
+  // @brief Reads the counter if recording is on.
+  // @param zone_name The name shown in the trace; must outlive the program
+  // (a string literal).
+  Zone(const char* zone_name);
+
+  // @brief Records the zone into the calling thread's ring.
+  ~Zone();
+
+  // @brief Deleted copy constructor. Zones are tied to a block.
+  Zone(const Zone&) = delete;
+
+  // @brief Deleted copy assignment operator. Zones are tied to a block.
+  Zone& operator=(const Zone&) = delete;
+
+#ifdef RECREATIONS_TRACE
+ private:
+  // @brief The name of the zone.
+  const char* name;
+
+  // @brief The counter value on entry, or 0 while not recording.
+  uint64 start;
+#endif
+};
+
+// @brief Turns recording on, calibrating the clock first so the conversion
+// cost is not paid inside a zone.
+void start();
+
+// @brief Turns recording off. Zones already entered are still recorded.
+void stop();
+
+// @brief Checks whether zones are being recorded.
+// @return true between start() and stop().
+bool isRecording();
+
+// @brief Forgets every zone recorded so far, in every thread.
+void clear();
+
+// @brief Exports the recorded zones as Chrome trace JSON (chrome://tracing,
+// Perfetto). Threads may keep recording meanwhile; zones they overwrite
+// during the export are skipped.
+// @param sink Receives the JSON text.
+// @param context Passed to sink.
+// @return false if the sink failed.
+bool write_json(Sink sink, void* context);
+
+// @brief A recorded zone, in counter ticks.
+struct Event {
+  const char* name;
+  uint64 start;
+  uint64 end;
+};
+
+// @brief The zones of one thread. Written by that thread only and kept
+// after it exits, so its zones can still be exported.
+struct Ring {
+  Event events[CAPACITY];
+
+  // @brief The number of zones ever recorded; the next slot is head %
+  // CAPACITY.
+  uint64 head;
+
+  // @brief The head at the last clear(); older zones are not exported.
+  uint64 floor;
+
+  // @brief The thread number shown in the trace.
+  uint32 thread;
+
+  // @brief The next ring in the registry.
+  Ring* next;
+};
+
+// @brief Every ring ever created, newest first.
+inline Ring* rings = nullptr;
+
+// @brief The number of rings created.
+inline uint32 ring_count = 0;
+
+// @brief The ring of the calling thread (nullptr until its first zone).
+inline thread_local Ring* thread_ring = nullptr;
+
+// @brief Whether zones are being recorded.
+inline bool recording = false;
+
+// @brief Maps a ring for the calling thread and registers it.
+// @return The ring, or nullptr if no pages could be mapped.
+Ring* create_ring();
+
+// @brief Appends a zone to the calling thread's ring.
+// @param name The zone name.
+// @param start The counter value on entry.
+// @param end The counter value on exit.
+void record(const char* name, const uint64 start, const uint64 end);
+
+// @brief Buffers JSON text in front of a sink.
+struct Output {
+  Sink sink;
+  void* context;
+  uint64 used;
+  bool failed;
+  char text[4096];
+};
+
+// @brief Appends characters, flushing to the sink when the buffer is full.
+// @param output The output.
+// @param data The characters.
+// @param size The number of characters.
+void put(Output& output, const char* data, const uint64 size);
+
+// @brief Appends a NUL-terminated string as a JSON string body.
+// @param output The output.
+// @param text The string.
+void put_escaped(Output& output, const char* text);
+
+// @brief Appends nanoseconds as decimal microseconds (the trace time unit).
+// @param output The output.
+// @param ns The nanoseconds.
+void put_micros(Output& output, const uint64 ns);
+
+// @brief Hands the buffered text to the sink.
+// @param output The output.
+void flush(Output& output);
+
+}  // namespace os::system::trace
+
+// === Implementation of os::system::trace ===
+
+#ifdef RECREATIONS_TRACE
+
+inline os::system::trace::Zone::Zone(const char* zone_name)
+    : name(zone_name), start(0) {
+  if (__atomic_load_n(&recording, __ATOMIC_RELAXED)) {
+    this->start = clock::ticks();
+  }
+}
+
+inline os::system::trace::Zone::~Zone() {
+  if (this->start != 0) {
+    record(this->name, this->start, clock::ticks());
+  }
+}
+
+#else
+
+inline os::system::trace::Zone::Zone(const char* zone_name) {
+  (void)zone_name;
+}
+
+inline os::system::trace::Zone::~Zone() {}
+
+#endif
+
+inline void os::system::trace::start() {
+#ifdef RECREATIONS_TRACE
+  clock::calibration();
+  __atomic_store_n(&recording, true, __ATOMIC_RELAXED);
+#endif
+}
+
+inline void os::system::trace::stop() {
+  __atomic_store_n(&recording, false, __ATOMIC_RELAXED);
+}
+
+inline bool os::system::trace::isRecording() {
+  return __atomic_load_n(&recording, __ATOMIC_RELAXED);
+}
+
+inline void os::system::trace::clear() {
+  for (Ring* ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); ring != nullptr;
+       ring = ring->next) {
+    __atomic_store_n(&ring->floor,
+                     __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE),
+                     __ATOMIC_RELAXED);
+  }
+}
+
+inline os::system::trace::Ring* os::system::trace::create_ring() {
+  Ring* ring = static_cast<Ring*>(::memory::pages::map(sizeof(Ring)));
+  if (ring == nullptr) {
+    return nullptr;
+  }
+  ring->thread = __atomic_add_fetch(&ring_count, 1, __ATOMIC_RELAXED);
+
+  // Publish it at the front of the registry
+  ring->next = __atomic_load_n(&rings, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(&rings, &ring->next, ring, true,
+                                      __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+  }
+  thread_ring = ring;
+  return ring;
+}
+
+inline void os::system::trace::record(const char* name, const uint64 start,
+                                      const uint64 end) {
+  Ring* ring = thread_ring;
+  if (ring == nullptr) {
+    ring = create_ring();
+    if (ring == nullptr) {
+      return;
+    }
+  }
+
+  // Fill the slot, then publish it. Release stores order the previous head
+  // before the new contents, so a reader that sees them also sees the head
+  // that tells it the slot was rewritten
+  const uint64 head = ring->head;
+  Event& event = ring->events[head % CAPACITY];
+  __atomic_store_n(&event.name, name, __ATOMIC_RELEASE);
+  __atomic_store_n(&event.start, start, __ATOMIC_RELEASE);
+  __atomic_store_n(&event.end, end, __ATOMIC_RELEASE);
+  __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+inline bool os::system::trace::write_json(Sink sink, void* context) {
+  Output output;
+  output.sink = sink;
+  output.context = context;
+  output.used = 0;
+  output.failed = false;
+  put(output, "{\"traceEvents\":[", 16);
+
+  // One complete ("X") event per zone; timestamps are in microseconds
+  bool first = true;
+  for (Ring* ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); ring != nullptr;
+       ring = ring->next) {
+    const uint64 head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    const uint64 floor = __atomic_load_n(&ring->floor, __ATOMIC_RELAXED);
+    uint64 index = head > CAPACITY ? head - CAPACITY : 0;
+    index = index < floor ? floor : index;
+    for (; index < head && !output.failed; index++) {
+      const Event& slot = ring->events[index % CAPACITY];
+      // Acquire loads keep the second read of head behind the slot reads
+      const Event event = {__atomic_load_n(&slot.name, __ATOMIC_ACQUIRE),
+                           __atomic_load_n(&slot.start, __ATOMIC_ACQUIRE),
+                           __atomic_load_n(&slot.end, __ATOMIC_ACQUIRE)};
+
+      // Skip the slot if the owner may have rewritten it since head was read
+      const uint64 latest = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+      if (latest - index >= CAPACITY) {
+        continue;
+      }
+      put(output, first ? "\n{\"name\":\"" : ",\n{\"name\":\"",
+          first ? 10 : 11);
+      first = false;
+      put_escaped(output, event.name);
+      put(output, "\",\"ph\":\"X\",\"pid\":1,\"tid\":", 25);
+      char digits[20];
+      const uint32 count = numbers::digit_count(ring->thread);
+      numbers::write_digits(ring->thread, count, digits);
+      put(output, digits, count);
+      put(output, ",\"ts\":", 6);
+      put_micros(output, clock::timestamp(event.start));
+      put(output, ",\"dur\":", 7);
+      put_micros(output, event.end > event.start
+                             ? clock::duration(event.end - event.start)
+                             : 0);
+      put(output, "}", 1);
+    }
+  }
+  put(output, "\n],\"displayTimeUnit\":\"ns\"}\n", 27);
+  flush(output);
+  return !output.failed;
+}
+
+inline void os::system::trace::put(Output& output, const char* data,
+                                   const uint64 size) {
+  for (uint64 i = 0; i < size; i++) {
+    if (output.used == sizeof(output.text)) {
+      flush(output);
+    }
+    output.text[output.used++] = data[i];
+  }
+}
+
+inline void os::system::trace::put_escaped(Output& output, const char* text) {
+  // Names are literals; only quotes, backslashes and control characters
+  // need escaping
+  for (const char* cursor = text; *cursor != '\0'; cursor++) {
+    const char character = *cursor;
+    if (character == '"' || character == '\\') {
+      const char escaped[2] = {'\\', character};
+      put(output, escaped, 2);
+    } else if (static_cast<unsigned char>(character) < 0x20) {
+      put(output, " ", 1);
+    } else {
+      put(output, &character, 1);
+    }
+  }
+}
+
+inline void os::system::trace::put_micros(Output& output, const uint64 ns) {
+  char digits[24];
+  const uint64 whole = ns / 1000;
+  const uint32 count = numbers::digit_count(whole);
+  numbers::write_digits(whole, count, digits);
+  digits[count] = '.';
+  numbers::write_digits(ns % 1000, 3, digits + count + 1);
+  put(output, digits, count + 4);
+}
+
+inline void os::system::trace::flush(Output& output) {
+  if (output.used > 0 && !output.failed &&
+      !output.sink(output.context,
+                   reinterpret_cast<const byte*>(output.text), output.used)) {
+    output.failed = true;
+  }
+  output.used = 0;
+}
@@ -0,0 +1,423 @@
+// @file transfer.hpp
+
+#pragma once
+
+#include "../memory.hpp"
+#include "../span.hpp"
+#include "../utilities/types.h"
+#include "file.hpp"
+
+#ifndef RECREATIONS_ONLY
+#include "../utilities/os.hpp"
+#endif
+
+// Scatter-gather goes through readv/writev and the copying fallback through
+// read/pread/write on any POSIX system. Linux adds sendfile and splice, which
+// move the bytes inside the kernel. Freestanding builds report
+// UNSUPPORTED_ERROR.
+#if defined(OS_POSIX_COMPATIBLE)
+#define TRANSFER_POSIX
+#include <errno.h>    // errno, EINTR, EAGAIN, EINVAL, ESPIPE
+#include <poll.h>     // poll, POLLOUT
+#include <sys/uio.h>  // readv, writev, iovec
+#include <unistd.h>   // read, pread, write
+#endif
+
+#if defined(OS_LINUX)
+#define TRANSFER_LINUX
+#include <fcntl.h>         // splice, SPLICE_F_MOVE
+#include <sys/sendfile.h>  // sendfile
+#endif
+
+// @brief Moving bytes between descriptors without staging them in a Vector:
+// kernel-side copies and scatter-gather over lists of spans. A non-blocking
+// descriptor that would block ends a call early with OK and a short count.
+namespace os::io {
+
+// @brief The size of the buffer the copying fallback stages bytes through.
+constexpr uint64 BOUNCE_SIZE = 65536;
+
+// @brief The most bytes one sendfile or splice call is asked to move (Linux
+// caps every transfer just below 2 GiB).
+constexpr uint64 TRANSFER_LIMIT = 0x7ffff000;
+
+// @brief The most buffers passed to one readv or writev call.
+constexpr uint32 VECTOR_BATCH = 64;
+
+// @brief Checks whether an errno value means a non-blocking descriptor has
+// nothing to give or take right now.
+// @param error The errno value.
+// @return true for EAGAIN and EWOULDBLOCK.
+bool would_block(const int error);
+
+// @brief Reads into several buffers in order with one readv per attempt,
+// retrying on interruption and short reads until every buffer is full.
+// @param source The descriptor to read from.
+// @param buffers The buffers (as_writable_bytes views any Span or Vector).
+// @param count The number of buffers.
+// @param read_count Receives the number of bytes read across all buffers:
+// short at end of file or when a non-blocking source would block.
+// @return OK, READ_ERROR or UNSUPPORTED_ERROR.
+FileStatus read_vector(const int source, const Span<byte>* buffers,
+                       const uint32 count, uint64& read_count);
+
+// @brief Writes several buffers in order with one writev per attempt,
+// retrying on interruption and short writes until all are written.
+// @param target The descriptor to write to.
+// @param buffers The buffers (as_bytes views any Span or Vector).
+// @param count The number of buffers.
+// @param written Receives the number of bytes written across all buffers:
+// short only when a non-blocking target would block.
+// @return OK, WRITE_ERROR or UNSUPPORTED_ERROR.
+FileStatus write_vector(const int target, const Span<const byte>* buffers,
+                        const uint32 count, uint64& written);
+
+// @brief Copies part of a file to any descriptor (a socket, pipe or file)
+// with sendfile, so the bytes never enter user space. Falls back to copy()
+// where sendfile is missing or refuses the descriptors.
+// @param target The descriptor to write to.
+// @param source The file to read from. Its position is left unchanged.
+// @param offset The file offset to start at.
+// @param size The number of bytes to copy.
+// @param transferred Receives the number of bytes copied: short at end of
+// file or when a non-blocking target would block; resume at
+// offset + transferred.
+// @return OK, READ_ERROR, WRITE_ERROR, ALLOCATION_ERROR or
+// UNSUPPORTED_ERROR.
+FileStatus send_file(const int target, const int source, const uint64 offset,
+                     const uint64 size, uint64& transferred);
+
+// @brief Moves bytes from the current position of one descriptor to another
+// with splice, which stays in the kernel when either end is a pipe. Falls
+// back to copy() for any other pair, or where splice is missing.
+// @param target The descriptor to write to.
+// @param source The descriptor to read from.
+// @param size The number of bytes to move.
+// @param transferred Receives the number of bytes moved: short at end of
+// input or when a non-blocking descriptor would block.
+// @return OK, READ_ERROR, WRITE_ERROR (also for failures splice cannot pin
+// on either end), ALLOCATION_ERROR or UNSUPPORTED_ERROR.
+FileStatus splice(const int target, const int source, const uint64 size,
+                  uint64& transferred);
+
+// @brief Copies bytes between descriptors through a bounce buffer in user
+// space: the portable path send_file and splice fall back to.
+// @param target The descriptor to write to.
+// @param source The descriptor to read from.
+// @param offset The source offset to pread from, or nullptr to read at (and
+// advance) the source position.
+// @param size The number of bytes to copy.
+// @param transferred Receives the number of bytes copied. Bytes read without
+// an offset are always written out, waiting on a non-blocking target if
+// needed; with an offset the copy stops instead and can be resumed.
+// @return OK, READ_ERROR, WRITE_ERROR, ALLOCATION_ERROR or
+// UNSUPPORTED_ERROR.
+FileStatus copy(const int target, const int source, const uint64* offset,
+                const uint64 size, uint64& transferred);
+
+}  // namespace os::io
+
+// === Implementation of the transfer primitives ===
+
+inline bool os::io::would_block(const int error) {
+#ifdef TRANSFER_POSIX
+#if EAGAIN != EWOULDBLOCK
+  if (error == EWOULDBLOCK) {
+    return true;
+  }
+#endif
+  return error == EAGAIN;
+#else
+  (void)error;
+  return false;
+#endif
+}
+
+inline FileStatus os::io::read_vector(const int source,
+                                      const Span<byte>* buffers,
+                                      const uint32 count,
+                                      uint64& read_count) {
+  os::system::trace::Zone zone("io::read_vector");
+  read_count = 0;
+#ifdef TRANSFER_POSIX
+  // Resume mid-buffer after a short read: index is the buffer being filled
+  // and skip the bytes it already holds
+  uint32 index = 0;
+  uint64 skip = 0;
+  while (index < count) {
+    iovec vectors[VECTOR_BATCH];
+    uint32 used = 0;
+    for (uint32 i = index; i < count && used < VECTOR_BATCH; i++) {
+      const uint64 start = i == index ? skip : 0;
+      const uint64 length = buffers[i].getSize();
+      if (length > start) {
+        vectors[used].iov_base = buffers[i].getData() + start;
+        vectors[used].iov_len = static_cast<size_t>(length - start);
+        used++;
+      }
+    }
+    if (used == 0) {
+      break;
+    }
+    const ssize_t result = ::readv(source, vectors, static_cast<int>(used));
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (would_block(errno)) {
+        break;
+      }
+      return FileStatus::READ_ERROR;
+    }
+    if (result == 0) {
+      break;
+    }
+    read_count += static_cast<uint64>(result);
+
+    // Step over the buffers this read completed
+    uint64 left = static_cast<uint64>(result);
+    while (index < count && left >= buffers[index].getSize() - skip) {
+      left -= buffers[index].getSize() - skip;
+      skip = 0;
+      index++;
+    }
+    skip += left;
+  }
+  return FileStatus::OK;
+#else
+  (void)source;
+  (void)buffers;
+  (void)count;
+  return FileStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline FileStatus os::io::write_vector(const int target,
+                                       const Span<const byte>* buffers,
+                                       const uint32 count, uint64& written) {
+  os::system::trace::Zone zone("io::write_vector");
+  written = 0;
+#ifdef TRANSFER_POSIX
+  // Same walk as read_vector, gathering instead of scattering
+  uint32 index = 0;
+  uint64 skip = 0;
+  while (index < count) {
+    iovec vectors[VECTOR_BATCH];
+    uint32 used = 0;
+    for (uint32 i = index; i < count && used < VECTOR_BATCH; i++) {
+      const uint64 start = i == index ? skip : 0;
+      const uint64 length = buffers[i].getSize();
+      if (length > start) {
+        // writev only reads through iov_base
+        vectors[used].iov_base =
+            const_cast<byte*>(buffers[i].getData() + start);
+        vectors[used].iov_len = static_cast<size_t>(length - start);
+        used++;
+      }
+    }
+    if (used == 0) {
+      break;
+    }
+    const ssize_t result = ::writev(target, vectors, static_cast<int>(used));
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (would_block(errno)) {
+        break;
+      }
+      return FileStatus::WRITE_ERROR;
+    }
+    written += static_cast<uint64>(result);
+
+    // Step over the buffers this write completed
+    uint64 left = static_cast<uint64>(result);
+    while (index < count && left >= buffers[index].getSize() - skip) {
+      left -= buffers[index].getSize() - skip;
+      skip = 0;
+      index++;
+    }
+    skip += left;
+  }
+  return FileStatus::OK;
+#else
+  (void)target;
+  (void)buffers;
+  (void)count;
+  return FileStatus::UNSUPPORTED_ERROR;
+#endif
+}
+
+inline FileStatus os::io::send_file(const int target, const int source,
+                                    const uint64 offset, const uint64 size,
+                                    uint64& transferred) {
+  os::system::trace::Zone zone("io::send_file");
+  transferred = 0;
+#ifdef TRANSFER_LINUX
+  // sendfile reads at its own cursor, so the file position is untouched
+  while (transferred < size) {
+    const uint64 remaining = size - transferred;
+    off_t cursor = static_cast<off_t>(offset + transferred);
+    const ssize_t result = ::sendfile(
+        target, source, &cursor,
+        static_cast<size_t>(remaining < TRANSFER_LIMIT ? remaining
+                                                       : TRANSFER_LIMIT));
+    if (result > 0) {
+      transferred += static_cast<uint64>(result);
+      continue;
+    }
+    if (result == 0) {
+      break;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    if (would_block(errno)) {
+      break;
+    }
+
+    // The descriptors are not ones sendfile handles: copy the rest
+    if (errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP) {
+      const uint64 resume = offset + transferred;
+      uint64 copied;
+      const FileStatus status =
+          copy(target, source, &resume, remaining, copied);
+      transferred += copied;
+      return status;
+    }
+    // A failing or unseekable source is a read error; the rest are the
+    // target's
+    if (errno == EIO || errno == ESPIPE) {
+      return FileStatus::READ_ERROR;
+    }
+    return FileStatus::WRITE_ERROR;
+  }
+  return FileStatus::OK;
+#else
+  return copy(target, source, &offset, size, transferred);
+#endif
+}
+
+inline FileStatus os::io::splice(const int target, const int source,
+                                 const uint64 size, uint64& transferred) {
+  os::system::trace::Zone zone("io::splice");
+  transferred = 0;
+#ifdef TRANSFER_LINUX
+  while (transferred < size) {
+    const uint64 remaining = size - transferred;
+    const ssize_t result = ::splice(
+        source, nullptr, target, nullptr,
+        static_cast<size_t>(remaining < TRANSFER_LIMIT ? remaining
+                                                       : TRANSFER_LIMIT),
+        SPLICE_F_MOVE);
+    if (result > 0) {
+      transferred += static_cast<uint64>(result);
+      continue;
+    }
+    if (result == 0) {
+      break;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    if (would_block(errno)) {
+      break;
+    }
+
+    // Neither end is a pipe (or splice is missing): copy the rest
+    if (errno == EINVAL || errno == ENOSYS) {
+      uint64 copied;
+      const FileStatus status =
+          copy(target, source, nullptr, remaining, copied);
+      transferred += copied;
+      return status;
+    }
+    return FileStatus::WRITE_ERROR;
+  }
+  return FileStatus::OK;
+#else
+  return copy(target, source, nullptr, size, transferred);
+#endif
+}
+
+inline FileStatus os::io::copy(const int target, const int source,
+                               const uint64* offset, const uint64 size,
+                               uint64& transferred) {
+  os::system::trace::Zone zone("io::copy");
+  transferred = 0;
+#ifdef TRANSFER_POSIX
+  if (size == 0) {
+    return FileStatus::OK;
+  }
+  const uint64 capacity = size < BOUNCE_SIZE ? size : BOUNCE_SIZE;
+  byte* bounce = static_cast<byte*>(::memory::allocate(capacity));
+  if (bounce == nullptr) {
+    return FileStatus::ALLOCATION_ERROR;
+  }
+
+  FileStatus status = FileStatus::OK;
+  while (transferred < size) {
+    // Fill the bounce buffer
+    const uint64 remaining = size - transferred;
+    const size_t wanted =
+        static_cast<size_t>(remaining < capacity ? remaining : capacity);
+    const ssize_t result =
+        offset != nullptr
+            ? ::pread(source, bounce, wanted,
+                      static_cast<off_t>(*offset + transferred))
+            : ::read(source, bounce, wanted);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (!would_block(errno)) {
+        status = FileStatus::READ_ERROR;
+      }
+      break;
+    }
+    if (result == 0) {
+      break;
+    }
+
+    // Drain it. Bytes taken off a stream cannot be put back, so a target
+    // that would block is waited on; a positioned copy just stops
+    const uint64 filled = static_cast<uint64>(result);
+    uint64 drained = 0;
+    while (drained < filled) {
+      const ssize_t sent = ::write(target, bounce + drained,
+                                   static_cast<size_t>(filled - drained));
+      if (sent >= 0) {
+        drained += static_cast<uint64>(sent);
+        continue;
+      }
+      if (errno == EINTR) {
+        continue;
+      }
+      if (!would_block(errno)) {
+        status = FileStatus::WRITE_ERROR;
+        break;
+      }
+      if (offset != nullptr) {
+        break;
+      }
+      pollfd writable = {target, POLLOUT, 0};
+      if (::poll(&writable, 1, -1) < 0 && errno != EINTR) {
+        status = FileStatus::WRITE_ERROR;
+        break;
+      }
+    }
+    transferred += drained;
+    if (status != FileStatus::OK || drained < filled) {
+      break;
+    }
+  }
+  ::memory::deallocate(bounce);
+  return status;
+#else
+  (void)target;
+  (void)source;
+  (void)offset;
+  (void)size;
+  return FileStatus::UNSUPPORTED_ERROR;
+#endif
+}
@@ -0,0 +1,362 @@
+// @file writer.hpp
+
+#pragma once
+
+#include "../memory.hpp"
+#include "../numbers.hpp"
+#include "../utilities/types.h"
+#include "file.hpp"
+#include "transfer.hpp"
+
+#ifndef RECREATIONS_ONLY
+#include "../utilities/os.hpp"
+#endif
+
+// Descriptors are flushed with write_vector (writev); without it a writer
+// needs a user-supplied sink (a serial port, a log ring...).
+
+namespace os::io {
+
+// @brief Buffered text output. Everything is formatted straight into a fixed
+// buffer that is handed to the OS only when full (or on flush()), so many
+// small writes cost one system call and nothing is allocated.
+class Writer {
+ public:
+  // @brief The size of the buffer in bytes.
+  static constexpr uint64 CAPACITY = 8192;
+
+  // @brief The largest number of fraction digits write() accepts for floats.
+  static constexpr uint8 MAX_PRECISION = 17;
+
+  // @brief A destination for flushed bytes.
+  // @param context The value given to the constructor.
+  // @param data The bytes.
+  // @param size The number of bytes.
+  // @return false if the bytes could not be written.
+  using Sink = bool (*)(void* context, const byte* data, const uint64 size);
+
+  // @brief Creates a writer flushing to a descriptor.
+  // @param target The descriptor (1 for standard output).
+  Writer(const int target);
+
+  // @brief Creates a writer flushing to a sink.
+  // @param function The sink receiving the bytes.
+  // @param argument Passed to every call of function.
+  Writer(Sink function, void* argument);
+
+  // @brief Destructor. Flushes the buffer.
+  ~Writer();
+
+  // @brief Deleted copy constructor. The buffer is owned by one writer.
+  Writer(const Writer&) = delete;
+
+  // @brief Deleted copy assignment operator. The buffer is owned by one
+  // writer.
+  Writer& operator=(const Writer&) = delete;
+
+  // @brief Writes a NUL-terminated string.
+  // @param text The string.
+  // @return A reference to this writer.
+  Writer& write(const char* text);
+
+  // @brief Writes characters. Runs longer than the buffer go out in a single
+  // writev together with what is already buffered, without being copied.
+  // @param text The characters.
+  // @param length The number of characters.
+  // @return A reference to this writer.
+  Writer& write(const char* text, const uint64 length);
+
+  // @brief Writes one character.
+  // @param character The character.
+  // @return A reference to this writer.
+  Writer& write(const char character);
+
+  // @brief Writes an integer in decimal.
+  // @param value The integer.
+  // @return A reference to this writer.
+  template <Integer T>
+  Writer& write(const T value);
+
+  // @brief Writes a floating point number with the shortest digits that
+  // read back as the same value (see numbers::to_string).
+  // @param value The number.
+  // @return A reference to this writer.
+  template <FloatingPoint T>
+  Writer& write(const T value);
+
+  // @brief Writes a floating point number in fixed notation, or as
+  // d.ddde+XX when it is too large for that; nan and inf are spelled out.
+  // @param value The number.
+  // @param precision The number of digits after the point (at most
+  // MAX_PRECISION).
+  // @return A reference to this writer.
+  template <FloatingPoint T>
+  Writer& write(const T value, const uint8 precision);
+
+  // @brief Hands the buffered bytes to the descriptor or sink.
+  // @return OK, WRITE_ERROR or UNSUPPORTED_ERROR.
+  FileStatus flush();
+
+  // @brief Returns the first error met since construction. Writes after an
+  // error are dropped.
+  // @return OK, WRITE_ERROR or UNSUPPORTED_ERROR.
+  FileStatus getStatus() const;
+
+  // @brief Returns the number of bytes waiting in the buffer.
+  // @return The buffered byte count.
+  uint64 getBuffered() const;
+
+ private:
+  // @brief The buffer.
+  char buffer[CAPACITY];
+
+  // @brief The number of bytes in the buffer.
+  uint64 used = 0;
+
+  // @brief The destination descriptor, or -1 when writing to a sink.
+  int descriptor = -1;
+
+  // @brief The destination sink, or nullptr.
+  Sink sink = nullptr;
+  void* context = nullptr;
+
+  // @brief The first error met.
+  FileStatus status = FileStatus::OK;
+
+  // @brief Writes two ranges in order: one call per range for sinks, one
+  // gathered write_vector() for descriptors (which retries interruptions and
+  // short writes). A non-blocking descriptor that would block leaves a short
+  // count, reported as WRITE_ERROR; the unwritten bytes are not retried.
+  // @param first The first range.
+  // @param first_size Its size.
+  // @param second The second range (may be empty).
+  // @param second_size Its size.
+  // @return OK, WRITE_ERROR or UNSUPPORTED_ERROR.
+  FileStatus drain(const char* first, uint64 first_size, const char* second,
+                   uint64 second_size);
+
+  // @brief Makes room for a formatted value, flushing if needed.
+  // @param size The number of bytes needed (at most CAPACITY).
+  // @return false after an error.
+  bool reserve(const uint64 size);
+
+  // @brief Formats an unsigned value at the end of the buffer.
+  // @param value The value.
+  // @param width Pad with leading zeros to at least this many digits.
+  void put_unsigned(const uint64 value, const uint8 width);
+};
+
+// @brief Returns the writer for standard output. Flushed at normal program
+// exit; call flush() before os::process::exit.
+// @return The writer.
+Writer& output();
+
+// @brief Returns the writer for standard error. Flush it after each message
+// that must be seen immediately.
+// @return The writer.
+Writer& error();
+
+}  // namespace os::io
+
+// === Implementation of os::io::Writer ===
+
+inline os::io::Writer::Writer(const int target) : descriptor(target) {}
+
+inline os::io::Writer::Writer(Sink function, void* argument)
+    : sink(function), context(argument) {}
+
+inline os::io::Writer::~Writer() { this->flush(); }
+
+inline os::io::Writer& os::io::Writer::write(const char* text) {
+  uint64 length = 0;
+  while (text[length] != '\0') {
+    length++;
+  }
+  return this->write(text, length);
+}
+
+inline os::io::Writer& os::io::Writer::write(const char* text,
+                                             const uint64 length) {
+  if (this->status != FileStatus::OK) {
+    return *this;
+  }
+
+  // Common case: append to the buffer
+  if (length <= CAPACITY - this->used) {
+    ::memory::copy(this->buffer + this->used, text, length);
+    this->used += length;
+    return *this;
+  }
+
+  // Short runs top up the buffer so every flush is a full one
+  if (length < CAPACITY) {
+    const uint64 head = CAPACITY - this->used;
+    ::memory::copy(this->buffer + this->used, text, head);
+    this->used = CAPACITY;
+    if (this->flush() == FileStatus::OK) {
+      ::memory::copy(this->buffer, text + head, length - head);
+      this->used = length - head;
+    }
+    return *this;
+  }
+
+  // Long runs go out directly, behind the buffered bytes
+  this->status = this->drain(this->buffer, this->used, text, length);
+  this->used = 0;
+  return *this;
+}
+
+inline os::io::Writer& os::io::Writer::write(const char character) {
+  if (this->reserve(1)) {
+    this->buffer[this->used++] = character;
+  }
+  return *this;
+}
+
+template <Integer T>
+inline os::io::Writer& os::io::Writer::write(const T value) {
+  if (this->reserve(numbers::MAX_CHARS)) {
+    this->used += numbers::to_string(value, this->buffer + this->used);
+  }
+  return *this;
+}
+
+template <FloatingPoint T>
+inline os::io::Writer& os::io::Writer::write(const T value) {
+  if (this->reserve(numbers::MAX_CHARS)) {
+    this->used += numbers::to_string(value, this->buffer + this->used);
+  }
+  return *this;
+}
+
+template <FloatingPoint T>
+inline os::io::Writer& os::io::Writer::write(const T value,
+                                             const uint8 precision) {
+  // Sign, 20 digits, the point, the fraction and an exponent always fit
+  const uint8 digits = precision < MAX_PRECISION ? precision : MAX_PRECISION;
+  if (!this->reserve(48)) {
+    return *this;
+  }
+  float64 number = static_cast<float64>(value);
+
+  // Special values
+  if (number != number) {
+    return this->write("nan", 3);
+  }
+  if (number < 0 || (number == 0 && 1 / number < 0)) {
+    this->buffer[this->used++] = '-';
+    number = -number;
+  }
+  if (number - number != 0) {
+    return this->write("inf", 3);
+  }
+
+  // Fixed notation keeps the integral part exact below 1e15
+  int32 exponent = 0;
+  if (number >= 1e15) {
+    while (number >= 10) {
+      number /= 10;
+      exponent++;
+    }
+  }
+
+  // Round the fraction to the requested digits, carrying into the integer
+  uint64 scale = 1;
+  for (uint8 i = 0; i < digits; i++) {
+    scale *= 10;
+  }
+  uint64 integral = static_cast<uint64>(number);
+  uint64 fraction = static_cast<uint64>(
+      (number - static_cast<float64>(integral)) * static_cast<float64>(scale) +
+      0.5);
+  if (fraction >= scale) {
+    fraction -= scale;
+    integral++;
+    if (exponent > 0 && integral == 10) {
+      integral = 1;
+      exponent++;
+    }
+  }
+
+  this->put_unsigned(integral, 1);
+  if (digits > 0) {
+    this->buffer[this->used++] = '.';
+    this->put_unsigned(fraction, digits);
+  }
+  if (exponent > 0) {
+    this->buffer[this->used++] = 'e';
+    this->buffer[this->used++] = '+';
+    this->put_unsigned(static_cast<uint64>(exponent), 2);
+  }
+  return *this;
+}
+
+inline FileStatus os::io::Writer::flush() {
+  if (this->status != FileStatus::OK || this->used == 0) {
+    return this->status;
+  }
+  this->status = this->drain(this->buffer, this->used, nullptr, 0);
+  this->used = 0;
+  return this->status;
+}
+
+inline FileStatus os::io::Writer::getStatus() const { return this->status; }
+
+inline uint64 os::io::Writer::getBuffered() const { return this->used; }
+
+inline FileStatus os::io::Writer::drain(const char* first, uint64 first_size,
+                                        const char* second,
+                                        uint64 second_size) {
+  // Sinks take the ranges one after the other
+  if (this->sink != nullptr) {
+    const byte* data = reinterpret_cast<const byte*>(first);
+    const byte* tail = reinterpret_cast<const byte*>(second);
+    if ((first_size > 0 && !this->sink(this->context, data, first_size)) ||
+        (second_size > 0 && !this->sink(this->context, tail, second_size))) {
+      return FileStatus::WRITE_ERROR;
+    }
+    return FileStatus::OK;
+  }
+
+  // One gathered write of both ranges. Nothing retries a descriptor that
+  // would block, so a short count is a failure here
+  const Span<const byte> ranges[2] = {
+      Span<const byte>(reinterpret_cast<const byte*>(first), first_size),
+      Span<const byte>(reinterpret_cast<const byte*>(second), second_size)};
+  uint64 written;
+  const FileStatus result = write_vector(this->descriptor, ranges, 2, written);
+  if (result == FileStatus::OK && written < first_size + second_size) {
+    return FileStatus::WRITE_ERROR;
+  }
+  return result;
+}
+
+inline bool os::io::Writer::reserve(const uint64 size) {
+  if (this->status != FileStatus::OK) {
+    return false;
+  }
+  if (size > CAPACITY - this->used) {
+    return this->flush() == FileStatus::OK;
+  }
+  return true;
+}
+
+inline void os::io::Writer::put_unsigned(const uint64 value,
+                                         const uint8 width) {
+  const uint32 digits = numbers::digit_count(value);
+  const uint32 count = digits < width ? width : digits;
+  numbers::write_digits(value, count, this->buffer + this->used);
+  this->used += count;
+}
+
+// === Implementation of os::io ===
+
+inline os::io::Writer& os::io::output() {
+  static Writer writer(1);
+  return writer;
+}
+
+inline os::io::Writer& os::io::error() {
+  static Writer writer(2);
+  return writer;
+}
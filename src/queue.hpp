@@ -0,0 +1,646 @@
+// @file queue.hpp
+
+#pragma once
+
+#include "memory.hpp"
+#include "utilities/types.h"
+
+// @brief The status codes for operations within the queue classes.
+enum class QueueStatus : int8 {
+  OK = 1,
+  ALLOCATION_ERROR = 0,
+  FULL_ERROR = -1,
+  EMPTY_ERROR = -2,
+};
+
+// @brief A bounded lock-free queue for exactly one producer thread and one
+// consumer thread. Each side owns its index and keeps a cached copy of the
+// other one, so a push or pop only touches the shared cache line when the
+// cached view says the ring is full or empty.
+// @param T The element type.
+template <typename T>
+class SPSCQueue {
+ public:
+  // === Constructor & Deconstructor ===
+
+  // @brief Creates a queue.
+  // @param min_capacity The number of elements it must hold (rounded up to a
+  // power of two, at least 2). Check isInitialized() afterwards.
+  SPSCQueue(const uint64 min_capacity);
+
+  // @brief Destructor. Destroys the elements still queued and frees the ring.
+  ~SPSCQueue();
+
+  // === Disable copy and move semantics ===
+
+  // @brief Deleted copy constructor. Queues are shared by address.
+  SPSCQueue(const SPSCQueue&) = delete;
+
+  // @brief Deleted copy assignment operator. Queues are shared by address.
+  SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+  // === Producer ===
+
+  // @brief Appends a copy of an element. Producer only.
+  // @param element The element.
+  // @return OK, FULL_ERROR or ALLOCATION_ERROR (the ring was not allocated).
+  QueueStatus push(const T& element);
+
+  // @brief Appends an element by moving it. Producer only.
+  // @param element The element.
+  // @return OK, FULL_ERROR or ALLOCATION_ERROR.
+  QueueStatus push(T&& element);
+
+  // @brief Appends copies of as many elements as fit, publishing them with a
+  // single store. Producer only.
+  // @param elements The elements, in order.
+  // @param count The number of elements.
+  // @return The number of elements appended (a prefix of elements).
+  uint64 push_batch(const T* elements, const uint64 count);
+
+  // === Consumer ===
+
+  // @brief Removes the oldest element. Consumer only.
+  // @param out_element Receives the element.
+  // @return OK, EMPTY_ERROR or ALLOCATION_ERROR.
+  QueueStatus pop(T& out_element);
+
+  // @brief Removes up to capacity of the oldest elements, releasing their
+  // slots with a single store. Consumer only.
+  // @param out_elements Receives the elements, in order.
+  // @param capacity The number of entries out_elements can hold.
+  // @return The number of elements removed.
+  uint64 pop_batch(T* out_elements, const uint64 capacity);
+
+  // === Getters ===
+
+  // @brief Returns the number of queued elements. Exact from either side when
+  // the other one is idle, a snapshot otherwise.
+  // @return The element count.
+  uint64 getSize() const;
+
+  // @brief Returns the number of elements the queue can hold.
+  // @return The capacity (0 if the ring could not be allocated).
+  uint64 getCapacity() const;
+
+  // @brief Checks whether the queue holds no element (a snapshot).
+  // @return true if it is empty.
+  bool isEmpty() const;
+
+  // @brief Checks whether the ring was allocated.
+  // @return false if the constructor ran out of memory or min_capacity was
+  // too large.
+  bool isInitialized() const;
+
+ private:
+  // @brief The ring and its index mask (capacity - 1). Written once by the
+  // constructor, then only read by both sides.
+  T* slots = nullptr;
+  uint64 mask = 0;
+
+  // @brief Keeps the read-only fields off the consumer's cache line. Padded
+  // by hand like os::thread::Deque, so heap-allocated queues work too.
+  byte shared_padding[48];
+
+  // @brief The consumer's side: the next index to pop and the last tail it
+  // observed.
+  uint64 head = 0;
+  uint64 cached_tail = 0;
+
+  // @brief Keeps the consumer's fields off the producer's cache line.
+  byte head_padding[48];
+
+  // @brief The producer's side: the next index to push and the last head it
+  // observed.
+  uint64 tail = 0;
+  uint64 cached_head = 0;
+
+  // @brief Keeps the producer's fields off the next object's cache line.
+  byte tail_padding[48];
+
+  // @brief Reserves room for count elements, refreshing the cached head if
+  // the cached view is too full.
+  // @param count The number of elements wanted.
+  // @return The number of free slots, at most count.
+  uint64 reserve(const uint64 count);
+
+  // @brief Finds queued elements, refreshing the cached tail if the cached
+  // view holds fewer than count.
+  // @param count The number of elements wanted.
+  // @return The number of queued elements, at most count.
+  uint64 available(const uint64 count);
+};
+
+// @brief A bounded lock-free queue for any number of producer and consumer
+// threads (Vyukov's bounded MPMC queue). Every slot carries a sequence number
+// telling which lap of the ring it is ready for, so producers and consumers
+// claim slots with one compare-and-swap on their own index and never wait on
+// each other's locks.
+// @param T The element type.
+template <typename T>
+class MPMCQueue {
+ public:
+  // === Constructor & Deconstructor ===
+
+  // @brief Creates a queue.
+  // @param min_capacity The number of elements it must hold (rounded up to a
+  // power of two, at least 2). Check isInitialized() afterwards.
+  MPMCQueue(const uint64 min_capacity);
+
+  // @brief Destructor. Destroys the elements still queued and frees the ring.
+  // No thread may be using the queue.
+  ~MPMCQueue();
+
+  // === Disable copy and move semantics ===
+
+  // @brief Deleted copy constructor. Queues are shared by address.
+  MPMCQueue(const MPMCQueue&) = delete;
+
+  // @brief Deleted copy assignment operator. Queues are shared by address.
+  MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+  // === Producers ===
+
+  // @brief Appends a copy of an element. Any thread.
+  // @param element The element.
+  // @return OK, FULL_ERROR or ALLOCATION_ERROR (the ring was not allocated).
+  QueueStatus push(const T& element);
+
+  // @brief Appends an element by moving it. Any thread.
+  // @param element The element.
+  // @return OK, FULL_ERROR or ALLOCATION_ERROR.
+  QueueStatus push(T&& element);
+
+  // @brief Appends copies of as many elements as there are consecutive free
+  // slots, claimed together with a single compare-and-swap. Any thread.
+  // @param elements The elements, in order.
+  // @param count The number of elements.
+  // @return The number of elements appended (a prefix of elements).
+  uint64 push_batch(const T* elements, const uint64 count);
+
+  // === Consumers ===
+
+  // @brief Removes the oldest element. Any thread.
+  // @param out_element Receives the element.
+  // @return OK, EMPTY_ERROR or ALLOCATION_ERROR.
+  QueueStatus pop(T& out_element);
+
+  // @brief Removes up to capacity of the oldest elements, claimed together
+  // with a single compare-and-swap. Stops early at an element whose producer
+  // has not finished writing it. Any thread.
+  // @param out_elements Receives the elements, in order.
+  // @param capacity The number of entries out_elements can hold.
+  // @return The number of elements removed.
+  uint64 pop_batch(T* out_elements, const uint64 capacity);
+
+  // === Getters ===
+
+  // @brief Returns the number of claimed slots (a snapshot, counting pushes
+  // and pops still in progress).
+  // @return The element count.
+  uint64 getSize() const;
+
+  // @brief Returns the number of elements the queue can hold.
+  // @return The capacity (0 if the ring could not be allocated).
+  uint64 getCapacity() const;
+
+  // @brief Checks whether the queue holds no element (a snapshot).
+  // @return true if it is empty.
+  bool isEmpty() const;
+
+  // @brief Checks whether the ring was allocated.
+  // @return false if the constructor ran out of memory or min_capacity was
+  // too large.
+  bool isInitialized() const;
+
+ private:
+  // @brief A slot. sequence == i means free for the push of index i;
+  // sequence == i + 1 means holding the element pushed at index i.
+  struct Cell {
+    uint64 sequence;
+    T value;
+  };
+
+  // @brief The ring and its index mask (capacity - 1). Written once by the
+  // constructor, then only read.
+  Cell* cells = nullptr;
+  uint64 mask = 0;
+
+  // @brief Keeps the read-only fields off the consumers' cache line.
+  byte shared_padding[48];
+
+  // @brief The next index to pop.
+  uint64 head = 0;
+
+  // @brief Keeps the consumers' index off the producers' cache line.
+  byte head_padding[56];
+
+  // @brief The next index to push.
+  uint64 tail = 0;
+
+  // @brief Keeps the producers' index off the next object's cache line.
+  byte tail_padding[56];
+
+  // @brief Claims one free slot for a push.
+  // @return The cell, or nullptr if the queue is full.
+  Cell* claim_push();
+
+  // @brief Claims the oldest published slot for a pop.
+  // @return The cell, or nullptr if the queue is empty.
+  Cell* claim_pop();
+};
+
+// === Implementation of SPSCQueue ===
+
+template <typename T>
+SPSCQueue<T>::SPSCQueue(const uint64 min_capacity) {
+  // Stop doubling before the byte size overflows; a queue that cannot be
+  // sized stays uninitialized
+  const uint64 limit = UINT64_MAX / sizeof(T);
+  uint64 capacity = 2;
+  while (capacity < min_capacity && capacity <= limit / 2) {
+    capacity *= 2;
+  }
+  if (capacity < min_capacity || capacity > limit) {
+    return;
+  }
+  this->slots = static_cast<T*>(::memory::allocate(capacity * sizeof(T)));
+  if (this->slots != nullptr) {
+    this->mask = capacity - 1;
+  }
+}
+
+template <typename T>
+SPSCQueue<T>::~SPSCQueue() {
+  for (uint64 i = this->head; i != this->tail; i++) {
+    ::memory::destroy(&this->slots[i & this->mask]);
+  }
+  ::memory::deallocate(this->slots);
+  this->slots = nullptr;
+  this->mask = 0;
+}
+
+template <typename T>
+QueueStatus SPSCQueue<T>::push(const T& element) {
+  if (this->reserve(1) == 0) {
+    return this->slots != nullptr ? QueueStatus::FULL_ERROR
+                                  : QueueStatus::ALLOCATION_ERROR;
+  }
+
+  // Publish the element before the new tail
+  ::memory::construct(&this->slots[this->tail & this->mask], element);
+  __atomic_store_n(&this->tail, this->tail + 1, __ATOMIC_RELEASE);
+  return QueueStatus::OK;
+}
+
+template <typename T>
+QueueStatus SPSCQueue<T>::push(T&& element) {
+  if (this->reserve(1) == 0) {
+    return this->slots != nullptr ? QueueStatus::FULL_ERROR
+                                  : QueueStatus::ALLOCATION_ERROR;
+  }
+  ::memory::construct(&this->slots[this->tail & this->mask],
+                      static_cast<T&&>(element));
+  __atomic_store_n(&this->tail, this->tail + 1, __ATOMIC_RELEASE);
+  return QueueStatus::OK;
+}
+
+template <typename T>
+uint64 SPSCQueue<T>::push_batch(const T* elements, const uint64 count) {
+  const uint64 pushed = this->reserve(count);
+  for (uint64 i = 0; i < pushed; i++) {
+    ::memory::construct(&this->slots[(this->tail + i) & this->mask],
+                        elements[i]);
+  }
+  __atomic_store_n(&this->tail, this->tail + pushed, __ATOMIC_RELEASE);
+  return pushed;
+}
+
+template <typename T>
+QueueStatus SPSCQueue<T>::pop(T& out_element) {
+  if (this->available(1) == 0) {
+    return this->slots != nullptr ? QueueStatus::EMPTY_ERROR
+                                  : QueueStatus::ALLOCATION_ERROR;
+  }
+
+  // Move the element out before handing its slot back
+  T* slot = &this->slots[this->head & this->mask];
+  out_element = static_cast<T&&>(*slot);
+  ::memory::destroy(slot);
+  __atomic_store_n(&this->head, this->head + 1, __ATOMIC_RELEASE);
+  return QueueStatus::OK;
+}
+
+template <typename T>
+uint64 SPSCQueue<T>::pop_batch(T* out_elements, const uint64 capacity) {
+  const uint64 popped = this->available(capacity);
+  for (uint64 i = 0; i < popped; i++) {
+    T* slot = &this->slots[(this->head + i) & this->mask];
+    out_elements[i] = static_cast<T&&>(*slot);
+    ::memory::destroy(slot);
+  }
+  __atomic_store_n(&this->head, this->head + popped, __ATOMIC_RELEASE);
+  return popped;
+}
+
+template <typename T>
+uint64 SPSCQueue<T>::getSize() const {
+  // The head never passes the tail, so read it first
+  const uint64 first = __atomic_load_n(&this->head, __ATOMIC_ACQUIRE);
+  return __atomic_load_n(&this->tail, __ATOMIC_ACQUIRE) - first;
+}
+
+template <typename T>
+uint64 SPSCQueue<T>::getCapacity() const {
+  return this->slots != nullptr ? this->mask + 1 : 0;
+}
+
+template <typename T>
+bool SPSCQueue<T>::isEmpty() const {
+  return this->getSize() == 0;
+}
+
+template <typename T>
+bool SPSCQueue<T>::isInitialized() const {
+  return this->slots != nullptr;
+}
+
+template <typename T>
+uint64 SPSCQueue<T>::reserve(const uint64 count) {
+  if (this->slots == nullptr) {
+    return 0;
+  }
+
+  // Only go to the consumer's cache line when the cached head says full
+  const uint64 capacity = this->mask + 1;
+  uint64 free = capacity - (this->tail - this->cached_head);
+  if (free < count) {
+    this->cached_head = __atomic_load_n(&this->head, __ATOMIC_ACQUIRE);
+    free = capacity - (this->tail - this->cached_head);
+  }
+  return free < count ? free : count;
+}
+
+template <typename T>
+uint64 SPSCQueue<T>::available(const uint64 count) {
+  if (this->slots == nullptr) {
+    return 0;
+  }
+
+  // Only go to the producer's cache line when the cached tail says empty
+  uint64 queued = this->cached_tail - this->head;
+  if (queued < count) {
+    this->cached_tail = __atomic_load_n(&this->tail, __ATOMIC_ACQUIRE);
+    queued = this->cached_tail - this->head;
+  }
+  return queued < count ? queued : count;
+}
+
+// === Implementation of MPMCQueue ===
+
+template <typename T>
+MPMCQueue<T>::MPMCQueue(const uint64 min_capacity) {
+  // Stop doubling before the byte size overflows; a queue that cannot be
+  // sized stays uninitialized
+  const uint64 limit = UINT64_MAX / sizeof(Cell);
+  uint64 capacity = 2;
+  while (capacity < min_capacity && capacity <= limit / 2) {
+    capacity *= 2;
+  }
+  if (capacity < min_capacity || capacity > limit) {
+    return;
+  }
+  this->cells =
+      static_cast<Cell*>(::memory::allocate(capacity * sizeof(Cell)));
+  if (this->cells == nullptr) {
+    return;
+  }
+
+  // Every slot starts free for the first lap
+  for (uint64 i = 0; i < capacity; i++) {
+    this->cells[i].sequence = i;
+  }
+  this->mask = capacity - 1;
+}
+
+template <typename T>
+MPMCQueue<T>::~MPMCQueue() {
+  for (uint64 i = this->head; i != this->tail; i++) {
+    ::memory::destroy(&this->cells[i & this->mask].value);
+  }
+  ::memory::deallocate(this->cells);
+  this->cells = nullptr;
+  this->mask = 0;
+}
+
+template <typename T>
+QueueStatus MPMCQueue<T>::push(const T& element) {
+  Cell* cell = this->claim_push();
+  if (cell == nullptr) {
+    return this->cells != nullptr ? QueueStatus::FULL_ERROR
+                                  : QueueStatus::ALLOCATION_ERROR;
+  }
+
+  // Publish the element: the slot now waits for the pop of the same index
+  const uint64 index = __atomic_load_n(&cell->sequence, __ATOMIC_RELAXED);
+  ::memory::construct(&cell->value, element);
+  __atomic_store_n(&cell->sequence, index + 1, __ATOMIC_RELEASE);
+  return QueueStatus::OK;
+}
+
+template <typename T>
+QueueStatus MPMCQueue<T>::push(T&& element) {
+  Cell* cell = this->claim_push();
+  if (cell == nullptr) {
+    return this->cells != nullptr ? QueueStatus::FULL_ERROR
+                                  : QueueStatus::ALLOCATION_ERROR;
+  }
+  const uint64 index = __atomic_load_n(&cell->sequence, __ATOMIC_RELAXED);
+  ::memory::construct(&cell->value, static_cast<T&&>(element));
+  __atomic_store_n(&cell->sequence, index + 1, __ATOMIC_RELEASE);
+  return QueueStatus::OK;
+}
+
+template <typename T>
+uint64 MPMCQueue<T>::push_batch(const T* elements, const uint64 count) {
+  if (this->cells == nullptr || count == 0) {
+    return 0;
+  }
+
+  // Count the free slots from the tail, then claim them all at once. A slot
+  // free for index i can only be taken by whoever moves the tail past i, so
+  // if the tail has not moved the scan is still valid.
+  uint64 position = __atomic_load_n(&this->tail, __ATOMIC_RELAXED);
+  uint64 pushed;
+  for (;;) {
+    pushed = 0;
+    while (pushed < count && pushed <= this->mask &&
+           __atomic_load_n(&this->cells[(position + pushed) & this->mask]
+                                .sequence,
+                           __ATOMIC_ACQUIRE) == position + pushed) {
+      pushed++;
+    }
+    if (pushed == 0) {
+      // Full, unless another producer moved the tail meanwhile
+      const uint64 current = __atomic_load_n(&this->tail, __ATOMIC_RELAXED);
+      if (current == position) {
+        return 0;
+      }
+      position = current;
+      continue;
+    }
+    if (__atomic_compare_exchange_n(&this->tail, &position, position + pushed,
+                                    true, __ATOMIC_RELAXED,
+                                    __ATOMIC_RELAXED)) {
+      break;
+    }
+  }
+
+  // Fill and publish each slot
+  for (uint64 i = 0; i < pushed; i++) {
+    Cell* cell = &this->cells[(position + i) & this->mask];
+    ::memory::construct(&cell->value, elements[i]);
+    __atomic_store_n(&cell->sequence, position + i + 1, __ATOMIC_RELEASE);
+  }
+  return pushed;
+}
+
+template <typename T>
+QueueStatus MPMCQueue<T>::pop(T& out_element) {
+  Cell* cell = this->claim_pop();
+  if (cell == nullptr) {
+    return this->cells != nullptr ? QueueStatus::EMPTY_ERROR
+                                  : QueueStatus::ALLOCATION_ERROR;
+  }
+
+  // Take the element, then free the slot for the push one lap ahead
+  const uint64 index = __atomic_load_n(&cell->sequence, __ATOMIC_RELAXED) - 1;
+  out_element = static_cast<T&&>(cell->value);
+  ::memory::destroy(&cell->value);
+  __atomic_store_n(&cell->sequence, index + this->mask + 1, __ATOMIC_RELEASE);
+  return QueueStatus::OK;
+}
+
+template <typename T>
+uint64 MPMCQueue<T>::pop_batch(T* out_elements, const uint64 capacity) {
+  if (this->cells == nullptr || capacity == 0) {
+    return 0;
+  }
+
+  // Count the published slots from the head, then claim them all at once
+  uint64 position = __atomic_load_n(&this->head, __ATOMIC_RELAXED);
+  uint64 popped;
+  for (;;) {
+    popped = 0;
+    while (popped < capacity && popped <= this->mask &&
+           __atomic_load_n(&this->cells[(position + popped) & this->mask]
+                                .sequence,
+                           __ATOMIC_ACQUIRE) == position + popped + 1) {
+      popped++;
+    }
+    if (popped == 0) {
+      // Empty, unless another consumer moved the head meanwhile
+      const uint64 current = __atomic_load_n(&this->head, __ATOMIC_RELAXED);
+      if (current == position) {
+        return 0;
+      }
+      position = current;
+      continue;
+    }
+    if (__atomic_compare_exchange_n(&this->head, &position, position + popped,
+                                    true, __ATOMIC_RELAXED,
+                                    __ATOMIC_RELAXED)) {
+      break;
+    }
+  }
+
+  // Take each element and free its slot for the next lap
+  for (uint64 i = 0; i < popped; i++) {
+    Cell* cell = &this->cells[(position + i) & this->mask];
+    out_elements[i] = static_cast<T&&>(cell->value);
+    ::memory::destroy(&cell->value);
+    __atomic_store_n(&cell->sequence, position + i + this->mask + 1,
+                     __ATOMIC_RELEASE);
+  }
+  return popped;
+}
+
+template <typename T>
+uint64 MPMCQueue<T>::getSize() const {
+  // The head never passes the tail, so read it first
+  const uint64 first = __atomic_load_n(&this->head, __ATOMIC_RELAXED);
+  return __atomic_load_n(&this->tail, __ATOMIC_RELAXED) - first;
+}
+
+template <typename T>
+uint64 MPMCQueue<T>::getCapacity() const {
+  return this->cells != nullptr ? this->mask + 1 : 0;
+}
+
+template <typename T>
+bool MPMCQueue<T>::isEmpty() const {
+  return this->getSize() == 0;
+}
+
+template <typename T>
+bool MPMCQueue<T>::isInitialized() const {
+  return this->cells != nullptr;
+}
+
+template <typename T>
+typename MPMCQueue<T>::Cell* MPMCQueue<T>::claim_push() {
+  if (this->cells == nullptr) {
+    return nullptr;
+  }
+  uint64 position = __atomic_load_n(&this->tail, __ATOMIC_RELAXED);
+  for (;;) {
+    Cell* cell = &this->cells[position & this->mask];
+    const uint64 sequence =
+        __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+    const int64 lag = static_cast<int64>(sequence - position);
+
+    // Free for this index: race the other producers for it
+    if (lag == 0) {
+      if (__atomic_compare_exchange_n(&this->tail, &position, position + 1,
+                                      true, __ATOMIC_RELAXED,
+                                      __ATOMIC_RELAXED)) {
+        return cell;
+      }
+    } else if (lag < 0) {
+      // Still holding the element from the previous lap: full
+      return nullptr;
+    } else {
+      // Another producer took it; retry from the new tail
+      position = __atomic_load_n(&this->tail, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+template <typename T>
+typename MPMCQueue<T>::Cell* MPMCQueue<T>::claim_pop() {
+  if (this->cells == nullptr) {
+    return nullptr;
+  }
+  uint64 position = __atomic_load_n(&this->head, __ATOMIC_RELAXED);
+  for (;;) {
+    Cell* cell = &this->cells[position & this->mask];
+    const uint64 sequence =
+        __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+    const int64 lag = static_cast<int64>(sequence - (position + 1));
+
+    // Published for this index: race the other consumers for it
+    if (lag == 0) {
+      if (__atomic_compare_exchange_n(&this->head, &position, position + 1,
+                                      true, __ATOMIC_RELAXED,
+                                      __ATOMIC_RELAXED)) {
+        return cell;
+      }
+    } else if (lag < 0) {
+      // Not written yet for this lap: empty
+      return nullptr;
+    } else {
+      // Another consumer took it; retry from the new head
+      position = __atomic_load_n(&this->head, __ATOMIC_RELAXED);
+    }
+  }
+}
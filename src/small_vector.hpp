@@ -0,0 +1,518 @@
+// @file small_vector.hpp
+
+#pragma once
+
+#include "memory.hpp"
+#include "numbers.hpp"
+#include "utilities/types.h"
+#include "vector.hpp"
+
+// @brief A contiguous growable array that keeps up to N elements in inline
+// storage and only spills to the allocator once it outgrows them. Exposes the
+// same VectorStatus-returning API as Vector.
+// @param T The type of elements stored in the vector.
+// @param N The number of elements held inline before spilling to the heap.
+// @param A The allocator the spilled storage is obtained from.
+template <typename T, uint64 N, memory::Allocator A = memory::HeapAllocator>
+class SmallVector {
+  static_assert(N > 0, "SmallVector needs at least one inline element");
+
+ public:
+  // === Constructor & Deconstructor ===
+
+  // @brief Default constructor. Creates an empty vector using the inline
+  // storage; no allocation takes place.
+  SmallVector();
+
+  // @brief Creates an empty vector that spills through a specific allocator.
+  // @param storage_allocator The allocator used once the inline storage is
+  // outgrown.
+  SmallVector(A storage_allocator);
+
+  // @brief Destructor. Destroys the elements and frees any spilled storage.
+  ~SmallVector();
+
+  // === Disable copy semantics ===
+
+  // @brief Deleted copy constructor. SmallVector objects are non-copyable.
+  SmallVector(const SmallVector&) = delete;
+
+  // @brief Deleted copy assignment operator. SmallVector objects are
+  // non-copyable.
+  SmallVector& operator=(const SmallVector&) = delete;
+
+  // === Enable move semantics ===
+
+  // @brief Move constructor. Steals the heap block of another SmallVector, or
+  // moves its elements one by one when they live inline.
+  // @param other The SmallVector to move resources from.
+  SmallVector(SmallVector&& other) noexcept;
+
+  // @brief Move assignment operator. Releases the current elements, then
+  // acquires the resources of another SmallVector.
+  // @param other The SmallVector to move resources from.
+  // @return A reference to the current SmallVector object.
+  SmallVector& operator=(SmallVector&& other) noexcept;
+
+  // === Public Methods ===
+
+  // @brief Appends a copy of an element to the end of the vector. Spills to
+  // the heap once the inline capacity is exceeded.
+  // @param element The element to be added.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (ALLOCATION_ERROR if resize fails).
+  VectorStatus push(const T& element);
+
+  // @brief Appends an element to the end of the vector by moving it in.
+  // @param element The element to be moved in.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (ALLOCATION_ERROR if resize fails).
+  VectorStatus push(T&& element);
+
+  // @brief Constructs an element in place at the end of the vector.
+  // @param args The arguments forwarded to the constructor of T.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (ALLOCATION_ERROR).
+  template <typename... Args>
+  VectorStatus emplace(Args&&... args);
+
+  // @brief Removes the last element of the vector and moves it into
+  // 'out_element'.
+  // @param out_element A reference where the popped element will be stored.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (EMPTY_VECTOR_ERROR).
+  VectorStatus pop(T& out_element);
+
+  // @brief Inserts a copy of an element at a specified index, shifting
+  // subsequent elements.
+  // @param index The position where the element should be inserted.
+  // @param element The element to be inserted.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (OUT_OF_BOUNDS_ERROR or ALLOCATION_ERROR).
+  VectorStatus insert(uint64 index, const T& element);
+
+  // @brief Moves an element into a specified index, shifting subsequent
+  // elements.
+  // @param index The position where the element should be inserted.
+  // @param element The element to be moved in.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (OUT_OF_BOUNDS_ERROR or ALLOCATION_ERROR).
+  VectorStatus insert(uint64 index, T&& element);
+
+  // @brief Removes the element at a specified index and moves it into
+  // 'out_element', shifting subsequent elements back.
+  // @param index The position of the element to remove.
+  // @param out_element A reference where the removed element will be stored.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (OUT_OF_BOUNDS_ERROR).
+  VectorStatus remove(uint64 index, T& out_element);
+
+  // @brief Gets the element at a specified index.
+  // @param index The index of the element to retrieve.
+  // @return A pointer to the element on success, or nullptr on failure
+  // (OUT_OF_BOUNDS_ERROR).
+  T* get(uint64 index) const;
+
+  // @brief Sets the element at a specified index to a copy of a new value.
+  // @param index The index of the element to modify.
+  // @param element The new value for the element.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (OUT_OF_BOUNDS_ERROR).
+  VectorStatus set(uint64 index, const T& element);
+
+  // @brief Sets the element at a specified index by moving a new value in.
+  // @param index The index of the element to modify.
+  // @param element The new value for the element.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (OUT_OF_BOUNDS_ERROR).
+  VectorStatus set(uint64 index, T&& element);
+
+  // @brief Returns the current number of elements in the vector.
+  // @return The size of the vector.
+  uint64 getSize() const;
+
+  // @brief Returns the number of elements the vector can hold without
+  // reallocating (N while the storage is inline).
+  // @return The capacity of the vector.
+  uint64 getCapacity() const;
+
+  // @brief Always true: a SmallVector is usable as soon as it is constructed.
+  // Provided for parity with Vector.
+  // @return true.
+  bool isInitialized() const;
+
+  // @brief Checks whether the elements still live in the inline storage.
+  // @return true if no heap block has been allocated, false otherwise.
+  bool isInline() const;
+
+ private:
+  // @brief Pointer to the active storage (inline buffer or heap block).
+  T* items;
+
+  // @brief The current number of elements stored in the vector.
+  uint64 size = 0;
+
+  // @brief The number of elements the active storage can hold.
+  uint64 capacity = N;
+
+  // @brief The allocator spilled storage is obtained from.
+  [[no_unique_address]] A allocator{};
+
+  // @brief Raw inline storage for the first N elements.
+  alignas(T) byte inline_items[N * sizeof(T)];
+
+  // @brief Returns the inline buffer as an array of T.
+  // @return A pointer to the inline storage.
+  T* inline_storage();
+
+  // @brief Moves the elements into a heap block of new_capacity elements.
+  // @param new_capacity The number of elements the new block must hold.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (ALLOCATION_ERROR).
+  VectorStatus relocate_items(uint64 new_capacity);
+
+  // @brief Grows the storage when it is full.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (ALLOCATION_ERROR).
+  VectorStatus grow_if_full();
+
+  // @brief Opens an uninitialized hole of one element at index by shifting
+  // the tail right. Capacity must allow one more element.
+  // @param index The position of the hole.
+  void open_gap(uint64 index);
+
+  // @brief Closes the (already destroyed) slot at index by shifting the tail
+  // left.
+  // @param index The position of the slot to close.
+  void close_gap(uint64 index);
+
+  // @brief Destroys every element and releases the heap block, returning to
+  // the empty inline state.
+  void release_items();
+
+  // @brief Takes over the elements of other, leaving it empty and inline.
+  // @param other The SmallVector to take the elements from.
+  void steal(SmallVector& other);
+};
+
+// === Implementation of SmallVector<T, N, A> ===
+
+template <typename T, uint64 N, memory::Allocator A>
+SmallVector<T, N, A>::SmallVector() : items(inline_storage()) {}
+
+template <typename T, uint64 N, memory::Allocator A>
+SmallVector<T, N, A>::SmallVector(A storage_allocator)
+    : items(inline_storage()), allocator(storage_allocator) {}
+
+template <typename T, uint64 N, memory::Allocator A>
+SmallVector<T, N, A>::~SmallVector() {
+  this->release_items();
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+SmallVector<T, N, A>::SmallVector(SmallVector&& other) noexcept
+    : items(inline_storage()), allocator(other.allocator) {
+  this->steal(other);
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+SmallVector<T, N, A>& SmallVector<T, N, A>::operator=(
+    SmallVector&& other) noexcept {
+  // Self-assignment check
+  if (this != &other) {
+    // Free current resources before acquiring new ones
+    this->release_items();
+    this->allocator = other.allocator;
+    this->steal(other);
+  }
+  return *this;
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+T* SmallVector<T, N, A>::inline_storage() {
+  return reinterpret_cast<T*>(this->inline_items);
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+void SmallVector<T, N, A>::steal(SmallVector& other) {
+  if (!other.isInline()) {
+    // The elements live on the heap: take the block as is
+    this->items = other.items;
+    this->size = other.size;
+    this->capacity = other.capacity;
+  } else {
+    // The elements live inline: move them one by one into our inline buffer
+    for (uint64 i = 0; i < other.size; i++) {
+      memory::construct(&this->items[i],
+                        memory::pass_ownership(other.items[i]));
+      memory::destroy(&other.items[i]);
+    }
+    this->size = other.size;
+  }
+
+  // Leave 'other' empty and back on its inline storage
+  other.items = other.inline_storage();
+  other.size = 0;
+  other.capacity = N;
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+void SmallVector<T, N, A>::release_items() {
+  // Run the destructor of every live element
+  for (uint64 i = 0; i < this->size; i++) {
+    memory::destroy(&this->items[i]);
+  }
+
+  // Return the heap block, if any, and fall back to the inline storage
+  if (!this->isInline()) {
+    this->allocator.deallocate(this->items, this->capacity * sizeof(T));
+  }
+  this->items = this->inline_storage();
+  this->size = 0;
+  this->capacity = N;
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+VectorStatus SmallVector<T, N, A>::relocate_items(uint64 new_capacity) {
+  const bool was_inline = this->isInline();
+
+  if constexpr (isTriviallyRelocatable<T>::value) {
+    // Already on the heap: let the allocator grow the block
+    if (!was_inline) {
+      T* new_items = static_cast<T*>(
+          this->allocator.reallocate(this->items, this->capacity * sizeof(T),
+                                     new_capacity * sizeof(T)));
+      if (new_items == nullptr) {
+        return VectorStatus::ALLOCATION_ERROR;
+      }
+      this->items = new_items;
+      this->capacity = new_capacity;
+      return VectorStatus::OK;
+    }
+  }
+
+  // Allocate a fresh heap block for the elements
+  T* new_items =
+      static_cast<T*>(this->allocator.allocate(new_capacity * sizeof(T)));
+  if (new_items == nullptr) {
+    return VectorStatus::ALLOCATION_ERROR;
+  }
+
+  // Transfer the elements, bitwise when possible
+  if constexpr (isTriviallyRelocatable<T>::value) {
+    memory::copy(new_items, this->items, this->size * sizeof(T));
+  } else {
+    for (uint64 i = 0; i < this->size; i++) {
+      memory::construct(&new_items[i], memory::pass_ownership(this->items[i]));
+      memory::destroy(&this->items[i]);
+    }
+  }
+
+  // Release the previous heap block (the inline buffer is never freed)
+  if (!was_inline) {
+    this->allocator.deallocate(this->items, this->capacity * sizeof(T));
+  }
+  this->items = new_items;
+  this->capacity = new_capacity;
+  return VectorStatus::OK;
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+VectorStatus SmallVector<T, N, A>::grow_if_full() {
+  // Nothing to do while there is room for one more element
+  if (this->size < this->capacity) {
+    return VectorStatus::OK;
+  }
+
+  // Double the current capacity
+  return this->relocate_items(this->capacity * 2);
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+void SmallVector<T, N, A>::open_gap(uint64 index) {
+  // Calculate how many elements need to be shifted
+  const uint64 elements_to_shift = this->size - index;
+  if (elements_to_shift == 0) {
+    return;
+  }
+
+  if constexpr (isTriviallyRelocatable<T>::value) {
+    // Move memory block to create space for the new element at 'index'
+    memory::move(&(this->items[index + 1]), &(this->items[index]),
+                 elements_to_shift * sizeof(T));
+  } else {
+    // Move-construct into the tail slot, move-assign the rest back to front,
+    // then leave the slot at 'index' uninitialized
+    memory::construct(&this->items[this->size],
+                      memory::pass_ownership(this->items[this->size - 1]));
+    for (uint64 i = this->size - 1; i > index; i--) {
+      this->items[i] = memory::pass_ownership(this->items[i - 1]);
+    }
+    memory::destroy(&this->items[index]);
+  }
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+void SmallVector<T, N, A>::close_gap(uint64 index) {
+  // Calculate how many elements need to be shifted back
+  const uint64 elements_to_shift = this->size - index - 1;
+  if (elements_to_shift == 0) {
+    return;
+  }
+
+  if constexpr (isTriviallyRelocatable<T>::value) {
+    // Move subsequent elements one position to the left
+    memory::move(&(this->items[index]), &(this->items[index + 1]),
+                 elements_to_shift * sizeof(T));
+  } else {
+    // Re-create the closed slot, move-assign the rest left, then destroy the
+    // now-duplicated last slot
+    memory::construct(&this->items[index],
+                      memory::pass_ownership(this->items[index + 1]));
+    for (uint64 i = index + 1; i < this->size - 1; i++) {
+      this->items[i] = memory::pass_ownership(this->items[i + 1]);
+    }
+    memory::destroy(&this->items[this->size - 1]);
+  }
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+VectorStatus SmallVector<T, N, A>::push(const T& element) {
+  return this->emplace(element);
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+VectorStatus SmallVector<T, N, A>::push(T&& element) {
+  return this->emplace(memory::pass_ownership(element));
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+template <typename... Args>
+VectorStatus SmallVector<T, N, A>::emplace(Args&&... args) {
+  // Fast path: construct directly into the spare slot
+  if (this->size < this->capacity) {
+    memory::construct(&this->items[this->size],
+                      static_cast<Args&&>(args)...);
+    this->size++;
+    return VectorStatus::OK;
+  }
+
+  // Growth path: build the value before the storage moves, since the
+  // arguments may refer to elements of this vector
+  T element(static_cast<Args&&>(args)...);
+  const VectorStatus status = this->grow_if_full();
+  if (status != VectorStatus::OK) {
+    return status;
+  }
+
+  // Insert the new element at the end and increment the size
+  memory::construct(&this->items[this->size],
+                    memory::pass_ownership(element));
+  this->size++;
+  return VectorStatus::OK;
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+VectorStatus SmallVector<T, N, A>::pop(T& out_element) {
+  // Check for an empty vector
+  if (this->size == 0) {
+    return VectorStatus::EMPTY_VECTOR_ERROR;
+  }
+
+  // Decrement size, move the element out and destroy the vacated slot
+  this->size--;
+  out_element = memory::pass_ownership(this->items[this->size]);
+  memory::destroy(&this->items[this->size]);
+  return VectorStatus::OK;
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+VectorStatus SmallVector<T, N, A>::insert(uint64 index, const T& element) {
+  // Copy first: the element may live inside this vector
+  T copy(element);
+  return this->insert(index, memory::pass_ownership(copy));
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+VectorStatus SmallVector<T, N, A>::insert(uint64 index, T&& element) {
+  // Check if the index is valid for insertion
+  if (index > this->size) {
+    return VectorStatus::OUT_OF_BOUNDS_ERROR;
+  }
+
+  // Check capacity and spill/reallocate if necessary
+  const VectorStatus status = this->grow_if_full();
+  if (status != VectorStatus::OK) {
+    return status;
+  }
+
+  // Shift the tail right and construct the new element in the hole
+  this->open_gap(index);
+  memory::construct(&this->items[index], memory::pass_ownership(element));
+  this->size++;
+  return VectorStatus::OK;
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+VectorStatus SmallVector<T, N, A>::remove(uint64 index, T& out_element) {
+  // Check if the index is within the valid range
+  if (index >= this->size) {
+    return VectorStatus::OUT_OF_BOUNDS_ERROR;
+  }
+
+  // Move the element out, destroy its slot and close the gap
+  out_element = memory::pass_ownership(this->items[index]);
+  memory::destroy(&this->items[index]);
+  this->close_gap(index);
+  this->size--;
+  return VectorStatus::OK;
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+T* SmallVector<T, N, A>::get(uint64 index) const {
+  // Check for an out-of-bounds access
+  if (index >= this->size) {
+    return nullptr;
+  }
+  return &(this->items[index]);
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+VectorStatus SmallVector<T, N, A>::set(uint64 index, const T& element) {
+  // Check for an out-of-bounds access
+  if (index >= this->size) {
+    return VectorStatus::OUT_OF_BOUNDS_ERROR;
+  }
+  this->items[index] = element;
+  return VectorStatus::OK;
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+VectorStatus SmallVector<T, N, A>::set(uint64 index, T&& element) {
+  // Check for an out-of-bounds access
+  if (index >= this->size) {
+    return VectorStatus::OUT_OF_BOUNDS_ERROR;
+  }
+  this->items[index] = memory::pass_ownership(element);
+  return VectorStatus::OK;
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+uint64 SmallVector<T, N, A>::getSize() const {
+  return this->size;
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+uint64 SmallVector<T, N, A>::getCapacity() const {
+  return this->capacity;
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+bool SmallVector<T, N, A>::isInitialized() const {
+  return true;
+}
+
+template <typename T, uint64 N, memory::Allocator A>
+bool SmallVector<T, N, A>::isInline() const {
+  return this->items == reinterpret_cast<const T*>(this->inline_items);
+}
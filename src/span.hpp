@@ -0,0 +1,156 @@
+// @file span.hpp
+
+#pragma once
+
+#include "utilities/types.h"
+#include "vector.hpp"
+
+// @brief A non-owning view over a contiguous range of elements (a mapped
+// file, a Vector, a stack array). The viewed memory must outlive the span.
+// @param T The element type (const-qualify it for read-only views).
+template <typename T>
+class Span {
+ public:
+  // @brief Creates an empty span.
+  Span() = default;
+
+  // @brief Creates a span over count elements starting at first.
+  // @param first The first element.
+  // @param count The number of elements.
+  Span(T* first, const uint64 count);
+
+  // @brief Converts a span of U (typically T without const) into a span of T.
+  // @param other The span to view.
+  template <typename U>
+  Span(const Span<U>& other);
+
+  // @brief Creates a span over every element of a vector. Invalidated by any
+  // reallocation of the vector.
+  // @param vector The vector to view.
+  template <typename U, memory::Allocator A, GrowthPolicy G>
+  Span(Vector<U, A, G>& vector);
+
+  // @brief Creates a read-only span over every element of a vector.
+  // @param vector The vector to view.
+  template <typename U, memory::Allocator A, GrowthPolicy G>
+  Span(const Vector<U, A, G>& vector);
+
+  // @brief Gets the element at a specified index.
+  // @param index The index of the element.
+  // @return A pointer to the element, or nullptr if index is out of bounds.
+  T* get(const uint64 index) const;
+
+  // @brief Returns a view over part of this span, clamped to its bounds.
+  // @param offset The index of the first element of the view.
+  // @param count The maximum number of elements in the view.
+  // @return The sub-span (empty if offset is past the end).
+  Span subspan(const uint64 offset, const uint64 count) const;
+
+  // @brief Returns the first element.
+  // @return A pointer to the first element (nullptr for an empty span).
+  T* getData() const;
+
+  // @brief Returns the number of elements.
+  // @return The size of the span.
+  uint64 getSize() const;
+
+  // @brief Returns the size of the viewed memory in bytes.
+  // @return getSize() * sizeof(T).
+  uint64 getBytes() const;
+
+  // @brief Checks whether the span has no elements.
+  // @return true if the size is zero.
+  bool isEmpty() const;
+
+ private:
+  // @brief The first element.
+  T* items = nullptr;
+
+  // @brief The number of elements.
+  uint64 size = 0;
+};
+
+// @brief Views the memory of a span as read-only bytes, e.g. to hand the
+// storage of any Vector<T> to byte-oriented I/O.
+// @param span The span to view.
+// @return A span over span.getBytes() bytes.
+template <typename T>
+Span<const byte> as_bytes(const Span<T> span);
+
+// @brief Views the memory of a span of mutable elements as writable bytes.
+// @param span The span to view.
+// @return A span over span.getBytes() bytes.
+template <typename T>
+Span<byte> as_writable_bytes(const Span<T> span);
+
+// === Implementation of Span<T> ===
+
+template <typename T>
+Span<T>::Span(T* first, const uint64 count) : items(first), size(count) {}
+
+template <typename T>
+template <typename U>
+Span<T>::Span(const Span<U>& other)
+    : items(other.getData()), size(other.getSize()) {}
+
+template <typename T>
+template <typename U, memory::Allocator A, GrowthPolicy G>
+Span<T>::Span(Vector<U, A, G>& vector)
+    : items(vector.getData()), size(vector.getSize()) {}
+
+template <typename T>
+template <typename U, memory::Allocator A, GrowthPolicy G>
+Span<T>::Span(const Vector<U, A, G>& vector)
+    : items(vector.getData()), size(vector.getSize()) {}
+
+template <typename T>
+T* Span<T>::get(const uint64 index) const {
+  // Check for an out-of-bounds access
+  if (index >= this->size) {
+    return nullptr;
+  }
+  return &this->items[index];
+}
+
+template <typename T>
+Span<T> Span<T>::subspan(const uint64 offset, const uint64 count) const {
+  // Clamp the view to the end of this span
+  if (offset >= this->size) {
+    return Span();
+  }
+  const uint64 available = this->size - offset;
+  return Span(this->items + offset, count < available ? count : available);
+}
+
+template <typename T>
+T* Span<T>::getData() const {
+  return this->items;
+}
+
+template <typename T>
+uint64 Span<T>::getSize() const {
+  return this->size;
+}
+
+template <typename T>
+uint64 Span<T>::getBytes() const {
+  return this->size * sizeof(T);
+}
+
+template <typename T>
+bool Span<T>::isEmpty() const {
+  return this->size == 0;
+}
+
+// === Implementation of the byte views ===
+
+template <typename T>
+Span<const byte> as_bytes(const Span<T> span) {
+  return Span<const byte>(reinterpret_cast<const byte*>(span.getData()),
+                          span.getBytes());
+}
+
+template <typename T>
+Span<byte> as_writable_bytes(const Span<T> span) {
+  return Span<byte>(reinterpret_cast<byte*>(span.getData()), span.getBytes());
+}
@@ -0,0 +1,608 @@
+// @file string.hpp
+
+#pragma once
+
+#include "hash.hpp"
+#include "memory.hpp"
+#include "utilities/types.h"
+#include "vector.hpp"
+
+// @brief The status codes for operations within the String class.
+enum class StringStatus : int8 {
+  OK = 1,
+  ALLOCATION_ERROR = 0,
+  OUT_OF_BOUNDS_ERROR = -1,
+};
+
+// @brief A non-owning view over a run of characters (a String, a literal, a
+// slice of a mapped file). The viewed characters must outlive the view and
+// need not be NUL-terminated. Searches run on the memory::simd kernels.
+class StringView {
+ public:
+  // @brief Returned by find when there is no match.
+  static constexpr uint64 NOT_FOUND = ~0ULL;
+
+  // @brief Creates an empty view.
+  StringView() = default;
+
+  // @brief Creates a view over a NUL-terminated string (the terminator is
+  // not part of the view).
+  // @param text The string.
+  StringView(const char* text);
+
+  // @brief Creates a view over length characters.
+  // @param text The first character.
+  // @param length The number of characters.
+  StringView(const char* text, const uint64 length);
+
+  // @brief Gets the character at a specified index.
+  // @param index The index of the character.
+  // @return A pointer to the character, or nullptr if index is out of bounds.
+  const char* get(const uint64 index) const;
+
+  // @brief Returns a view over part of this one, clamped to its bounds.
+  // @param offset The index of the first character of the view.
+  // @param count The maximum number of characters in the view.
+  // @return The sub-view (empty if offset is past the end).
+  StringView subview(const uint64 offset, const uint64 count) const;
+
+  // @brief Finds the first occurrence of a pattern.
+  // @param pattern The characters to look for.
+  // @param from The index the search starts at.
+  // @return The index of the match, or NOT_FOUND. An empty pattern matches
+  // at from.
+  uint64 find(const StringView pattern, const uint64 from = 0) const;
+
+  // @brief Finds the first occurrence of a character.
+  // @param character The character to look for.
+  // @param from The index the search starts at.
+  // @return The index of the match, or NOT_FOUND.
+  uint64 find(const char character, const uint64 from = 0) const;
+
+  // @brief Checks whether the view begins with a prefix.
+  // @param prefix The prefix.
+  // @return true if the first characters equal prefix.
+  bool starts_with(const StringView prefix) const;
+
+  // @brief Checks whether the view ends with a suffix.
+  // @param suffix The suffix.
+  // @return true if the last characters equal suffix.
+  bool ends_with(const StringView suffix) const;
+
+  // @brief Calls a function on every piece between occurrences of a
+  // delimiter, in order. Adjacent delimiters produce empty pieces; an empty
+  // delimiter produces the whole view as one piece.
+  // @param delimiter The delimiter.
+  // @param function Called as function(StringView piece).
+  // @return The number of pieces.
+  template <typename F>
+  uint64 split(const StringView delimiter, const F& function) const;
+
+  // @brief Appends every piece between occurrences of a delimiter to a
+  // vector (see the callback overload).
+  // @param delimiter The delimiter.
+  // @param pieces Receives the pieces.
+  // @return OK, or ALLOCATION_ERROR if a piece could not be appended.
+  template <memory::Allocator A, GrowthPolicy G>
+  VectorStatus split(const StringView delimiter,
+                     Vector<StringView, A, G>& pieces) const;
+
+  // @brief Compares the characters of two views.
+  // @param other The view to compare with.
+  // @return true if both have the same characters.
+  bool operator==(const StringView other) const;
+
+  // @brief Returns the first character.
+  // @return A pointer to the first character (nullptr for an empty view).
+  const char* getData() const;
+
+  // @brief Returns the number of characters.
+  // @return The size of the view.
+  uint64 getSize() const;
+
+  // @brief Checks whether the view has no characters.
+  // @return true if the size is zero.
+  bool isEmpty() const;
+
+ private:
+  // @brief The first character.
+  const char* characters = nullptr;
+
+  // @brief The number of characters.
+  uint64 size = 0;
+};
+
+// @brief An owned, growable, NUL-terminated string. Up to INLINE_CAPACITY
+// characters are stored inside the object itself (small-string
+// optimization), so short keys never allocate; longer strings grow through
+// memory::allocate and memory::reallocate.
+class String {
+ public:
+  // @brief The number of characters stored without allocating.
+  static constexpr uint64 INLINE_CAPACITY = 23;
+
+  // @brief The largest capacity; the top byte of the capacity word is the
+  // heap tag.
+  static constexpr uint64 MAX_CAPACITY = (1ULL << 56) - 1;
+
+  // === Constructor & Deconstructor ===
+
+  // @brief Default constructor. Creates an empty string; no allocation
+  // takes place.
+  String();
+
+  // @brief Destructor. Frees the heap storage, if any.
+  ~String();
+
+  // === Disable copy semantics ===
+
+  // @brief Deleted copy constructor. Copies may allocate, so they are made
+  // explicitly with assign(), which reports failure.
+  String(const String&) = delete;
+
+  // @brief Deleted copy assignment operator. Use assign().
+  String& operator=(const String&) = delete;
+
+  // === Enable move semantics ===
+
+  // @brief Move constructor. Takes over the characters of another String,
+  // leaving it empty.
+  // @param other The String to move resources from.
+  String(String&& other) noexcept;
+
+  // @brief Move assignment operator. Releases the current characters, then
+  // takes over those of another String.
+  // @param other The String to move resources from.
+  // @return A reference to the current String object.
+  String& operator=(String&& other) noexcept;
+
+  // === Public Methods ===
+
+  // @brief Replaces the characters with a copy of text.
+  // @param text The new characters (may view this string).
+  // @return OK, or ALLOCATION_ERROR (the string is left untouched).
+  StringStatus assign(const StringView text);
+
+  // @brief Appends a copy of text.
+  // @param text The characters to append (may view this string).
+  // @return OK, or ALLOCATION_ERROR (the string is left untouched).
+  StringStatus append(const StringView text);
+
+  // @brief Appends one character.
+  // @param character The character.
+  // @return OK, or ALLOCATION_ERROR (the string is left untouched).
+  StringStatus append(const char character);
+
+  // @brief Makes room for at least count characters.
+  // @param count The number of characters.
+  // @return OK, or ALLOCATION_ERROR if the block cannot be allocated or
+  // count exceeds MAX_CAPACITY (the string is left untouched).
+  StringStatus reserve(const uint64 count);
+
+  // @brief Shortens the string, keeping its storage.
+  // @param new_size The new number of characters.
+  // @return OK, or OUT_OF_BOUNDS_ERROR if new_size is larger than the size.
+  StringStatus truncate(const uint64 new_size);
+
+  // @brief Removes every character, keeping the storage.
+  void clear();
+
+  // @brief Gets the character at a specified index.
+  // @param index The index of the character.
+  // @return A pointer to the character, or nullptr if index is out of bounds.
+  char* get(const uint64 index);
+
+  // @brief Compares the characters with those of a view.
+  // @param other The view to compare with.
+  // @return true if both have the same characters.
+  bool operator==(const StringView other) const;
+
+  // @brief Compares the characters of two strings.
+  // @param other The string to compare with.
+  // @return true if both have the same characters.
+  bool operator==(const String& other) const;
+
+  // === Getters ===
+
+  // @brief Returns a view over the characters. Invalidated by any change
+  // that grows the string.
+  // @return The view.
+  StringView getView() const;
+
+  // @brief Returns the characters, NUL-terminated.
+  // @return A pointer to the first character.
+  const char* getData() const;
+
+  // @brief Returns the number of characters.
+  // @return The size of the string.
+  uint64 getSize() const;
+
+  // @brief Returns the number of characters that fit without growing.
+  // @return The capacity of the string.
+  uint64 getCapacity() const;
+
+  // @brief Checks whether the string has no characters.
+  // @return true if the size is zero.
+  bool isEmpty() const;
+
+  // @brief Checks whether the characters live inside the object.
+  // @return true while the string has never outgrown INLINE_CAPACITY.
+  bool isInline() const;
+
+ private:
+  // @brief The heap representation. Its last byte overlaps the tag.
+  struct Heap {
+    char* characters;
+    uint64 size;
+    uint64 capacity;
+  };
+
+  // @brief The inline characters, or the heap representation. The last
+  // byte is the tag: INLINE_CAPACITY - size inline (so a full inline string
+  // is NUL-terminated by its tag), HEAP_TAG on the heap.
+  union {
+    char small[sizeof(Heap)];
+    Heap heap;
+  };
+
+  static_assert(sizeof(Heap) == INLINE_CAPACITY + 1,
+                "String expects a 24-byte heap representation");
+
+  // @brief The tag of heap strings; never a valid inline tag.
+  static constexpr byte HEAP_TAG = 0xFF;
+
+  // @brief The capacity word with its top byte in place of the tag.
+  // @param capacity The capacity.
+  // @return The encoded word.
+  static uint64 encode_capacity(const uint64 capacity);
+
+  // @brief Reads the capacity from an encoded word.
+  // @param word The encoded word.
+  // @return The capacity.
+  static uint64 decode_capacity(const uint64 word);
+
+  // @brief Returns the characters.
+  // @return A pointer to the first character.
+  char* characters();
+
+  // @brief Sets the size and writes the terminator.
+  // @param new_size The new number of characters (within the capacity).
+  void set_size(const uint64 new_size);
+
+  // @brief Frees the heap storage, if any, and becomes empty and inline.
+  void release();
+};
+
+// === Hash specializations ===
+
+// @brief Hashes views and strings alike, so a HashMap keyed by String can
+// be searched with a StringView.
+template <>
+struct Hash<StringView> {
+  uint64 operator()(const StringView key) const;
+  uint64 operator()(const String& key) const;
+};
+
+template <>
+struct Hash<String> : Hash<StringView> {};
+
+// === Implementation of StringView ===
+
+inline StringView::StringView(const char* text) : characters(text) {
+  while (text[this->size] != '\0') {
+    this->size++;
+  }
+}
+
+inline StringView::StringView(const char* text, const uint64 length)
+    : characters(text), size(length) {}
+
+inline const char* StringView::get(const uint64 index) const {
+  // Check for an out-of-bounds access
+  if (index >= this->size) {
+    return nullptr;
+  }
+  return &this->characters[index];
+}
+
+inline StringView StringView::subview(const uint64 offset,
+                                      const uint64 count) const {
+  // Clamp the view to the end of this one
+  if (offset >= this->size) {
+    return StringView();
+  }
+  const uint64 available = this->size - offset;
+  return StringView(this->characters + offset,
+                    count < available ? count : available);
+}
+
+inline uint64 StringView::find(const StringView pattern,
+                               const uint64 from) const {
+  if (from > this->size) {
+    return NOT_FOUND;
+  }
+  const void* match =
+      memory::find(this->characters + from, this->size - from,
+                   pattern.characters, pattern.size);
+  if (match == nullptr) {
+    return NOT_FOUND;
+  }
+  return static_cast<uint64>(static_cast<const char*>(match) -
+                             this->characters);
+}
+
+inline uint64 StringView::find(const char character,
+                               const uint64 from) const {
+  return this->find(StringView(&character, 1), from);
+}
+
+inline bool StringView::starts_with(const StringView prefix) const {
+  return prefix.size <= this->size &&
+         memory::compare(this->characters, prefix.characters, prefix.size);
+}
+
+inline bool StringView::ends_with(const StringView suffix) const {
+  return suffix.size <= this->size &&
+         memory::compare(this->characters + this->size - suffix.size,
+                         suffix.characters, suffix.size);
+}
+
+template <typename F>
+inline uint64 StringView::split(const StringView delimiter,
+                                const F& function) const {
+  if (delimiter.isEmpty()) {
+    function(*this);
+    return 1;
+  }
+
+  // Each search resumes right after the previous delimiter
+  uint64 count = 0;
+  uint64 start = 0;
+  for (;;) {
+    const uint64 match = this->find(delimiter, start);
+    if (match == NOT_FOUND) {
+      function(StringView(this->characters + start, this->size - start));
+      return count + 1;
+    }
+    function(StringView(this->characters + start, match - start));
+    count++;
+    start = match + delimiter.size;
+  }
+}
+
+template <memory::Allocator A, GrowthPolicy G>
+inline VectorStatus StringView::split(const StringView delimiter,
+                                      Vector<StringView, A, G>& pieces) const {
+  VectorStatus status = VectorStatus::OK;
+  this->split(delimiter, [&](const StringView piece) {
+    if (status == VectorStatus::OK) {
+      status = pieces.push(piece);
+    }
+  });
+  return status;
+}
+
+inline bool StringView::operator==(const StringView other) const {
+  return this->size == other.size &&
+         memory::compare(this->characters, other.characters, this->size);
+}
+
+inline const char* StringView::getData() const { return this->characters; }
+
+inline uint64 StringView::getSize() const { return this->size; }
+
+inline bool StringView::isEmpty() const { return this->size == 0; }
+
+// === Implementation of String ===
+
+inline String::String() {
+  this->small[0] = '\0';
+  this->small[INLINE_CAPACITY] = static_cast<char>(INLINE_CAPACITY);
+}
+
+inline String::~String() { this->release(); }
+
+inline String::String(String&& other) noexcept {
+  // Both representations are plain bytes; take them over and leave 'other'
+  // empty and inline so its destructor frees nothing
+  ::memory::copy(this->small, other.small, sizeof(this->small));
+  other.small[0] = '\0';
+  other.small[INLINE_CAPACITY] = static_cast<char>(INLINE_CAPACITY);
+}
+
+inline String& String::operator=(String&& other) noexcept {
+  if (this != &other) {
+    this->release();
+    ::memory::copy(this->small, other.small, sizeof(this->small));
+    other.small[0] = '\0';
+    other.small[INLINE_CAPACITY] = static_cast<char>(INLINE_CAPACITY);
+  }
+  return *this;
+}
+
+inline StringStatus String::assign(const StringView text) {
+  // Grow first: text may view this string, which reserve keeps intact
+  const StringStatus status = this->reserve(text.getSize());
+  if (status != StringStatus::OK) {
+    return status;
+  }
+  ::memory::move(this->characters(), text.getData(), text.getSize());
+  this->set_size(text.getSize());
+  return StringStatus::OK;
+}
+
+inline StringStatus String::append(const StringView text) {
+  const uint64 old_size = this->getSize();
+  const uint64 new_size = old_size + text.getSize();
+  if (new_size > this->getCapacity()) {
+    // Double, so repeated appends stay amortized O(1); text may view this
+    // string, so remember where it starts relative to the old characters
+    const char* old_characters = this->getData();
+    const bool aliased = text.getData() >= old_characters &&
+                         text.getData() <= old_characters + old_size;
+    const uint64 offset =
+        aliased ? static_cast<uint64>(text.getData() - old_characters) : 0;
+    const uint64 capacity = this->getCapacity();
+    const uint64 doubled =
+        capacity > MAX_CAPACITY / 2 ? MAX_CAPACITY : capacity * 2;
+    const StringStatus status =
+        this->reserve(new_size > doubled ? new_size : doubled);
+    if (status != StringStatus::OK) {
+      return status;
+    }
+    const char* source = aliased ? this->getData() + offset : text.getData();
+    ::memory::move(this->characters() + old_size, source, text.getSize());
+  } else {
+    ::memory::move(this->characters() + old_size, text.getData(),
+                   text.getSize());
+  }
+  this->set_size(new_size);
+  return StringStatus::OK;
+}
+
+inline StringStatus String::append(const char character) {
+  return this->append(StringView(&character, 1));
+}
+
+inline StringStatus String::reserve(const uint64 count) {
+  if (count <= this->getCapacity()) {
+    return StringStatus::OK;
+  }
+  // Refuse capacities the encoded word cannot hold
+  if (count > MAX_CAPACITY) {
+    return StringStatus::ALLOCATION_ERROR;
+  }
+
+  // Heap strings grow in place when the allocator can; inline ones move out
+  const uint64 size = this->getSize();
+  if (this->isInline()) {
+    char* block = static_cast<char*>(::memory::allocate(count + 1));
+    if (block == nullptr) {
+      return StringStatus::ALLOCATION_ERROR;
+    }
+    ::memory::copy(block, this->small, size + 1);
+    this->heap.characters = block;
+  } else {
+    char* block = static_cast<char*>(
+        ::memory::reallocate(this->heap.characters, count + 1));
+    if (block == nullptr) {
+      return StringStatus::ALLOCATION_ERROR;
+    }
+    this->heap.characters = block;
+  }
+  this->heap.size = size;
+  this->heap.capacity = encode_capacity(count);
+  return StringStatus::OK;
+}
+
+inline StringStatus String::truncate(const uint64 new_size) {
+  if (new_size > this->getSize()) {
+    return StringStatus::OUT_OF_BOUNDS_ERROR;
+  }
+  this->set_size(new_size);
+  return StringStatus::OK;
+}
+
+inline void String::clear() { this->set_size(0); }
+
+inline char* String::get(const uint64 index) {
+  // Check for an out-of-bounds access
+  if (index >= this->getSize()) {
+    return nullptr;
+  }
+  return &this->characters()[index];
+}
+
+inline bool String::operator==(const StringView other) const {
+  return this->getView() == other;
+}
+
+inline bool String::operator==(const String& other) const {
+  return this->getView() == other.getView();
+}
+
+inline StringView String::getView() const {
+  return StringView(this->getData(), this->getSize());
+}
+
+inline const char* String::getData() const {
+  return this->isInline() ? this->small : this->heap.characters;
+}
+
+inline uint64 String::getSize() const {
+  if (this->isInline()) {
+    return INLINE_CAPACITY - static_cast<byte>(this->small[INLINE_CAPACITY]);
+  }
+  return this->heap.size;
+}
+
+inline uint64 String::getCapacity() const {
+  return this->isInline() ? INLINE_CAPACITY
+                          : decode_capacity(this->heap.capacity);
+}
+
+inline bool String::isEmpty() const { return this->getSize() == 0; }
+
+inline bool String::isInline() const {
+  return static_cast<byte>(this->small[INLINE_CAPACITY]) != HEAP_TAG;
+}
+
+inline uint64 String::encode_capacity(const uint64 capacity) {
+  // The tag is the last byte of the capacity word: its top byte on
+  // little-endian targets, its bottom byte on big-endian ones
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return (capacity << 8) | HEAP_TAG;
+#else
+  return capacity | (static_cast<uint64>(HEAP_TAG) << 56);
+#endif
+}
+
+inline uint64 String::decode_capacity(const uint64 word) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return word >> 8;
+#else
+  return word & ((1ULL << 56) - 1);
+#endif
+}
+
+inline char* String::characters() {
+  return this->isInline() ? this->small : this->heap.characters;
+}
+
+inline void String::set_size(const uint64 new_size) {
+  if (this->isInline()) {
+    this->small[new_size] = '\0';
+    this->small[INLINE_CAPACITY] =
+        static_cast<char>(INLINE_CAPACITY - new_size);
+  } else {
+    this->heap.characters[new_size] = '\0';
+    this->heap.size = new_size;
+  }
+}
+
+inline void String::release() {
+  if (!this->isInline()) {
+    ::memory::deallocate(this->heap.characters);
+  }
+  this->small[0] = '\0';
+  this->small[INLINE_CAPACITY] = static_cast<char>(INLINE_CAPACITY);
+}
+
+// === Implementation of Hash<StringView> ===
+
+inline uint64 Hash<StringView>::operator()(const StringView key) const {
+  return hash::bytes(key.getData(), key.getSize());
+}
+
+inline uint64 Hash<StringView>::operator()(const String& key) const {
+  return hash::bytes(key.getData(), key.getSize());
+}
+
+// === Trait specializations ===
+
+// @brief A String holds either its characters or a pointer to a heap block
+// it owns, never a pointer into itself, so it can be relocated bitwise.
+template <>
+struct isTriviallyRelocatable<String> {
+  static constexpr bool value = true;
+};
@@ -13,7 +13,7 @@
 #define ARCHITECTURE_ARM
 #define ARCHITECTURE_NAME "ARM"
 
-#elif defined(__aARCHITECTURE_H64__)
+#elif defined(__aarch64__) || defined(_M_ARM64)
 #define ARCHITECTURE_ARM64
 #define ARCHITECTURE_NAME "ARM64"
 
@@ -97,4 +97,28 @@
 #define COMPILER_VERSION "0.0.0"
 #endif
 
+// ============================================================================
+//  Code Generation Attributes
+// ============================================================================
+
+// Compiles a single function for an instruction set extension (e.g. "avx2")
+// without raising the baseline of the whole translation unit
+#if defined(COMPILER_GCC) || defined(COMPILER_CLANG)
+#define COMPILER_TARGET(isa) __attribute__((target(isa)))
+#else
+#define COMPILER_TARGET(isa)
+#endif
+
+// Stops the optimizer from turning hand-written copy/fill loops back into
+// calls to memcpy/memset, which do not exist in freestanding builds
+#if defined(COMPILER_CLANG)
+#define COMPILER_NO_LIBC_PATTERNS \
+  __attribute__((no_builtin("memcpy", "memmove", "memset")))
+#elif defined(COMPILER_GCC)
+#define COMPILER_NO_LIBC_PATTERNS \
+  __attribute__((optimize("no-tree-loop-distribute-patterns")))
+#else
+#define COMPILER_NO_LIBC_PATTERNS
+#endif
+
 #endif
@@ -37,7 +37,7 @@ typedef double float64;
 #define INT32_MIN -2147483648
 #define INT32_MAX 2147483647
 
-#define INT64_MIN -9223372036854775807LL
+#define INT64_MIN (-INT64_MAX - 1)
 #define INT64_MAX 9223372036854775807LL
 
 #define FLOAT32_MIN 1.175494e-38F
@@ -7,6 +7,7 @@
 #include <stddef.h>  // Per nullptr
 
 #include "memory.hpp"
+#include "numbers.hpp"
 
 // @brief The status codes for operations within the Vector class.
 enum class VectorStatus : int8 {
@@ -18,10 +19,66 @@ enum class VectorStatus : int8 {
       -3,  // Aggiunto per l'errore di inizializzazione nel costruttore
 };
 
+// @brief Capacity growth strategies for Vector. A policy is a type exposing a
+// static next(capacity, required, element_size) returning the new capacity in
+// elements, which must be at least required.
+namespace growth {
+
+// @brief Doubles the capacity (starting from 1). Fewest reallocations, up to
+// 2x memory overhead.
+struct Double {
+  // @brief Computes the next capacity.
+  // @param capacity The current capacity in elements.
+  // @param required The minimum capacity needed in elements.
+  // @param element_size The size in bytes of one element.
+  // @return The new capacity in elements.
+  static uint64 next(uint64 capacity, uint64 required, uint64 element_size);
+};
+
+// @brief Grows the capacity by 1.5x (starting from 4). Lower peak memory and
+// lets freed blocks be reused by the allocator, at the cost of more
+// reallocations.
+struct OneAndHalf {
+  // @brief Computes the next capacity.
+  // @param capacity The current capacity in elements.
+  // @param required The minimum capacity needed in elements.
+  // @param element_size The size in bytes of one element.
+  // @return The new capacity in elements.
+  static uint64 next(uint64 capacity, uint64 required, uint64 element_size);
+};
+
+// @brief Doubles small buffers, then grows large buffers by 1.5x rounded up
+// to whole pages so no partially used page is ever reallocated.
+// @param PageSize The page size in bytes (power of two).
+// @param Threshold The buffer size in bytes from which growth is
+// page-granular.
+template <uint64 PageSize = 4096, uint64 Threshold = 64 * 1024>
+struct PageGranular {
+  // @brief Computes the next capacity.
+  // @param capacity The current capacity in elements.
+  // @param required The minimum capacity needed in elements.
+  // @param element_size The size in bytes of one element.
+  // @return The new capacity in elements.
+  static uint64 next(uint64 capacity, uint64 required, uint64 element_size);
+};
+
+}  // namespace growth
+
+// @brief Requirements for a Vector growth policy.
+// @param G The policy type to check.
+template <typename G>
+concept GrowthPolicy = requires(uint64 n) {
+  static_cast<uint64>(G::next(n, n, n));
+};
+
 // @brief A contiguous growable array type that manages its own memory for
 // storing elements.
 // @param T The type of elements stored in the vector.
-template <typename T>
+// @param A The allocator the storage is obtained from (defaults to the global
+// memory:: functions; see memory::ArenaAllocator and memory::PoolAllocator).
+// @param G The growth policy used when the storage is full (see growth::).
+template <typename T, memory::Allocator A = memory::HeapAllocator,
+          GrowthPolicy G = growth::Double>
 class Vector {
  public:
   // === Constructor & Deconstructor ===
@@ -35,6 +92,13 @@ class Vector {
   // isInitialized().
   Vector(const uint64 initial_capacity);
 
+  // @brief Convenience constructor that attempts to initialize the Vector with
+  // storage obtained from a specific allocator.
+  // @param initial_capacity The starting number of elements the vector can
+  // hold.
+  // @param storage_allocator The allocator used for every (re)allocation.
+  Vector(const uint64 initial_capacity, A storage_allocator);
+
   // @brief Destructor. Frees the memory allocated for the vector's items.
   ~Vector();
 
@@ -61,29 +125,51 @@ class Vector {
 
   // === Public Methods ===
 
-  // @brief Appends an element to the end of the vector. Triggers a reallocation
-  // if capacity is reached.
+  // @brief Appends a copy of an element to the end of the vector. Triggers a
+  // reallocation if capacity is reached.
   // @param element The element to be added.
   // @return A VectorStatus object indicating success (OK) or failure
   // (ALLOCATION_ERROR if resize fails).
-  VectorStatus push(T element);
+  VectorStatus push(const T& element);
+
+  // @brief Appends an element to the end of the vector by moving it into the
+  // storage. Triggers a reallocation if capacity is reached.
+  // @param element The element to be moved in.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (ALLOCATION_ERROR if resize fails).
+  VectorStatus push(T&& element);
+
+  // @brief Constructs an element in place at the end of the vector.
+  // @param args The arguments forwarded to the constructor of T.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (UNINITIALIZED_ERROR or ALLOCATION_ERROR).
+  template <typename... Args>
+  VectorStatus emplace(Args&&... args);
 
-  // @brief Removes the last element of the vector and copies it into
+  // @brief Removes the last element of the vector and moves it into
   // 'out_element'.
   // @param out_element A reference where the popped element will be stored.
   // @return A VectorStatus object indicating success (OK) or failure
   // (EMPTY_VECTOR_ERROR).
   VectorStatus pop(T& out_element);
 
-  // @brief Inserts an element at a specified index, shifting subsequent
-  // elements.
+  // @brief Inserts a copy of an element at a specified index, shifting
+  // subsequent elements.
   // @param index The position where the element should be inserted.
   // @param element The element to be inserted.
   // @return A VectorStatus object indicating success (OK) or failure
   // (OUT_OF_BOUNDS_ERROR or ALLOCATION_ERROR).
-  VectorStatus insert(uint64 index, T element);
+  VectorStatus insert(uint64 index, const T& element);
+
+  // @brief Moves an element into a specified index, shifting subsequent
+  // elements.
+  // @param index The position where the element should be inserted.
+  // @param element The element to be moved in.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (OUT_OF_BOUNDS_ERROR or ALLOCATION_ERROR).
+  VectorStatus insert(uint64 index, T&& element);
 
-  // @brief Removes the element at a specified index and copies it into
+  // @brief Removes the element at a specified index and moves it into
   // 'out_element', shifting subsequent elements back.
   // @param index The position of the element to remove.
   // @param out_element A reference where the removed element will be stored.
@@ -91,18 +177,88 @@ class Vector {
   // failure (OUT_OF_BOUNDS_ERROR).
   VectorStatus remove(uint64 index, T& out_element);
 
+  // @brief Ensures the vector can hold at least min_capacity elements without
+  // reallocating. Performs at most one reallocation.
+  // @param min_capacity The number of elements the storage must hold.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (UNINITIALIZED_ERROR or ALLOCATION_ERROR).
+  VectorStatus reserve(uint64 min_capacity);
+
+  // @brief Changes the number of elements. New elements are
+  // value-initialized; surplus elements are destroyed.
+  // @param new_size The number of elements the vector must hold.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (UNINITIALIZED_ERROR or ALLOCATION_ERROR).
+  VectorStatus resize(uint64 new_size);
+
+  // @brief Changes the number of elements, filling new slots with copies of
+  // value; surplus elements are destroyed.
+  // @param new_size The number of elements the vector must hold.
+  // @param value The value new elements are copied from.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (UNINITIALIZED_ERROR or ALLOCATION_ERROR).
+  VectorStatus resize(uint64 new_size, const T& value);
+
+  // @brief Appends copies of count contiguous elements with at most one
+  // reallocation and, for trivially copyable types, one memory::copy.
+  // @param elements Pointer to the first element to copy. Must not point into
+  // this vector.
+  // @param count The number of elements to append.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (UNINITIALIZED_ERROR or ALLOCATION_ERROR).
+  VectorStatus append(const T* elements, uint64 count);
+
+  // @brief Inserts copies of count contiguous elements at index, shifting the
+  // tail once for the whole batch.
+  // @param index The position of the first inserted element.
+  // @param elements Pointer to the first element to copy. Must not point into
+  // this vector.
+  // @param count The number of elements to insert.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (UNINITIALIZED_ERROR, OUT_OF_BOUNDS_ERROR or ALLOCATION_ERROR).
+  VectorStatus insert_range(uint64 index, const T* elements, uint64 count);
+
+  // @brief Removes count elements starting at index, shifting the tail once.
+  // @param index The position of the first element to remove.
+  // @param count The number of elements to remove.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (OUT_OF_BOUNDS_ERROR).
+  VectorStatus erase_range(uint64 index, uint64 count);
+
+  // @brief Destroys every element while keeping the allocated capacity.
+  void clear();
+
+  // @brief Reduces the capacity to the current size, returning the surplus
+  // memory to the allocator. Frees the storage entirely when empty.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (ALLOCATION_ERROR, in which case the vector is left unchanged).
+  VectorStatus shrink_to_fit();
+
   // @brief Gets the element at a specified index.
   // @param index The index of the element to retrieve.
   // @return A pointer to the element on success, or nullptr on failure
   // (OUT_OF_BOUNDS_ERROR).
   T* get(uint64 index) const;
 
-  // @brief Sets the element at a specified index to a new value.
+  // @brief Sets the element at a specified index to a copy of a new value.
+  // @param index The index of the element to modify.
+  // @param element The new value for the element.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (OUT_OF_BOUNDS_ERROR).
+  VectorStatus set(uint64 index, const T& element);
+
+  // @brief Sets the element at a specified index by moving a new value in.
   // @param index The index of the element to modify.
   // @param element The new value for the element.
   // @return A VectorStatus object indicating success (OK) or failure
   // (OUT_OF_BOUNDS_ERROR).
-  VectorStatus set(uint64 index, T element);
+  VectorStatus set(uint64 index, T&& element);
+
+  // @brief Returns the contiguous element storage, for algorithms that work
+  // on raw ranges (see algorithms.hpp). Invalidated by any reallocation.
+  // @return A pointer to the first element, or nullptr if nothing is
+  // allocated.
+  T* getData() const;
 
   // @brief Returns the current number of elements in the vector.
   // @return The size of the vector.
@@ -130,18 +286,96 @@ class Vector {
   // @brief Indicates whether the vector has been correctly initialized.
   bool initialized = false;
 
+  // @brief The allocator every (re)allocation goes through.
+  [[no_unique_address]] A allocator{};
+
   // @brief Creates and initializes a new Vector with a given capacity.
   // @param initial_capacity The starting number of elements the vector can
   // hold.
   // @return A VectorStatus object indicating success (OK), or an error status
   // on failure (ALLOCATION_ERROR).
   VectorStatus initialize_items(uint64 initial_capacity);
+
+  // @brief Moves the elements into a block of new_capacity elements. Trivially
+  // relocatable types go through a single reallocate; other types are
+  // move-constructed into a fresh block and destroyed in the old one.
+  // @param new_capacity The number of elements the new block must hold.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (ALLOCATION_ERROR).
+  VectorStatus relocate_items(uint64 new_capacity);
+
+  // @brief Grows the storage so that count more elements fit, following the
+  // growth policy so repeated calls stay amortized O(1).
+  // @param count The number of elements about to be added.
+  // @return A VectorStatus object indicating success (OK) or failure
+  // (ALLOCATION_ERROR).
+  VectorStatus grow_for(uint64 count);
+
+  // @brief Opens a hole of count elements at index by shifting the tail
+  // right. The slots of the hole are left uninitialized. Capacity must allow
+  // count more elements.
+  // @param index The position of the hole.
+  // @param count The width of the hole.
+  void open_gap(uint64 index, uint64 count);
+
+  // @brief Closes count (already destroyed) slots at index by shifting the
+  // tail left. The last count slots are left uninitialized.
+  // @param index The position of the first closed slot.
+  // @param count The number of closed slots.
+  void close_gap(uint64 index, uint64 count);
+
+  // @brief Copy-constructs count elements into uninitialized storage, with a
+  // single memory::copy for trivially copyable types.
+  // @param dest Pointer to the uninitialized destination slots.
+  // @param elements Pointer to the elements to copy.
+  // @param count The number of elements to copy.
+  static void copy_construct(T* dest, const T* elements, uint64 count);
+
+  // @brief Destroys every element, keeping the storage.
+  void destroy_items();
 };
 
+// === Implementation of growth policies ===
+
+inline uint64 growth::Double::next(uint64 capacity, uint64 required,
+                                   uint64 element_size) {
+  (void)element_size;
+
+  // Double the current capacity (or set to 1 if starting from 0), jumping
+  // straight to the required size for large batches
+  const uint64 doubled = capacity > 0 ? capacity * 2 : 1;
+  return doubled < required ? required : doubled;
+}
+
+inline uint64 growth::OneAndHalf::next(uint64 capacity, uint64 required,
+                                       uint64 element_size) {
+  (void)element_size;
+
+  // Grow by half the current capacity (or start at 4)
+  const uint64 grown = capacity > 0 ? capacity + (capacity + 1) / 2 : 4;
+  return grown < required ? required : grown;
+}
+
+template <uint64 PageSize, uint64 Threshold>
+uint64 growth::PageGranular<PageSize, Threshold>::next(uint64 capacity,
+                                                       uint64 required,
+                                                       uint64 element_size) {
+  // Small buffers simply double
+  const uint64 doubled = Double::next(capacity, required, element_size);
+  if (doubled * element_size < Threshold) {
+    return doubled;
+  }
+
+  // Large buffers grow by 1.5x, rounded up to whole pages
+  const uint64 grown = OneAndHalf::next(capacity, required, element_size);
+  const uint64 bytes = memory::align_up(grown * element_size, PageSize);
+  return bytes / element_size;
+}
+
 // === Implementation of Vector<T> ===
 
-template <typename T>
-VectorStatus Vector<T>::initialize_items(uint64 initial_capacity) {
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::initialize_items(uint64 initial_capacity) {
   if (initial_capacity == 0) {
     // Handle zero capacity initialization
     this->items = nullptr;
@@ -151,8 +385,13 @@ VectorStatus Vector<T>::initialize_items(uint64 initial_capacity) {
     return VectorStatus::OK;
   }
 
-  // Allocate memory for the initial capacity
-  this->items = static_cast<T*>(memory::allocate(initial_capacity * sizeof(T)));
+  // Allocate memory for the initial capacity, unless its byte size overflows
+  if (initial_capacity > UINT64_MAX / sizeof(T)) {
+    this->initialized = false;
+    return VectorStatus::ALLOCATION_ERROR;
+  }
+  this->items = static_cast<T*>(
+      this->allocator.allocate(initial_capacity * sizeof(T)));
   if (this->items == nullptr) {
     // Handle allocation failure and return an error
     this->initialized = false;
@@ -168,17 +407,25 @@ VectorStatus Vector<T>::initialize_items(uint64 initial_capacity) {
   return VectorStatus::OK;
 }
 
-template <typename T>
-Vector<T>::Vector(const uint64 initial_capacity) {
+template <typename T, memory::Allocator A, GrowthPolicy G>
+Vector<T, A, G>::Vector(const uint64 initial_capacity) {
   // Perform initialization directly
   this->initialize_items(initial_capacity);
   // The 'initialized' flag is set within initialize_items
 }
 
-template <typename T>
-Vector<T>::~Vector() {
-  // Deallocate the memory block pointed to by items
-  memory::deallocate(this->items);
+template <typename T, memory::Allocator A, GrowthPolicy G>
+Vector<T, A, G>::Vector(const uint64 initial_capacity, A storage_allocator)
+    : allocator(storage_allocator) {
+  // Perform initialization with the provided allocator
+  this->initialize_items(initial_capacity);
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+Vector<T, A, G>::~Vector() {
+  // Destroy the elements and return the memory block to the allocator
+  this->destroy_items();
+  this->allocator.deallocate(this->items, this->capacity * sizeof(T));
 
   // Reset member variables to a safe, default state
   this->items = nullptr;
@@ -186,12 +433,13 @@ Vector<T>::~Vector() {
   this->capacity = 0;
 }
 
-template <typename T>
-Vector<T>::Vector(Vector&& other) noexcept {
+template <typename T, memory::Allocator A, GrowthPolicy G>
+Vector<T, A, G>::Vector(Vector&& other) noexcept : allocator(other.allocator) {
   // Transfer ownership of internal resources from 'other' to 'this'
   this->items = other.items;
   this->size = other.size;
   this->capacity = other.capacity;
+  this->initialized = other.initialized;
 
   // Nullify 'other's pointers and counters to ensure its destructor doesn't
   // free the memory
@@ -201,14 +449,16 @@ Vector<T>::Vector(Vector&& other) noexcept {
   other.initialized = false;
 }
 
-template <typename T>
-Vector<T>& Vector<T>::operator=(Vector&& other) noexcept {
+template <typename T, memory::Allocator A, GrowthPolicy G>
+Vector<T, A, G>& Vector<T, A, G>::operator=(Vector&& other) noexcept {
   // Self-assignment check
   if (this != &other) {
     // Free current resources before acquiring new ones
-    memory::deallocate(this->items);
+    this->destroy_items();
+    this->allocator.deallocate(this->items, this->capacity * sizeof(T));
 
     // Transfer ownership of internal resources from 'other' to 'this'
+    this->allocator = other.allocator;
     this->items = other.items;
     this->size = other.size;
     this->capacity = other.capacity;
@@ -223,53 +473,229 @@ Vector<T>& Vector<T>::operator=(Vector&& other) noexcept {
   return *this;
 }
 
-template <typename T>
-VectorStatus Vector<T>::push(T element) {
-  // Handle uninitialized vector
-  if (!this->initialized) {
-    return VectorStatus::UNINITIALIZED_ERROR;
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::relocate_items(uint64 new_capacity) {
+  // Time the relocation (a no-op unless RECREATIONS_TRACE is set)
+  os::system::trace::Zone zone("Vector::relocate");
+  // Refuse capacities whose byte size overflows; the vector is untouched
+  if (new_capacity > UINT64_MAX / sizeof(T)) {
+    return VectorStatus::ALLOCATION_ERROR;
   }
-
-  // Check if current size equals capacity, indicating a need for reallocation
-  if (this->size == this->capacity) {
-    // Double the current capacity (or set to 1 if starting from 0)
-    uint64 new_capacity = this->capacity > 0 ? this->capacity * 2 : 1;
-
-    // Attempt to reallocate memory with the new capacity
+  if constexpr (isTriviallyRelocatable<T>::value) {
+    // Bitwise relocation: let the allocator grow the block in place or copy it
     T* new_items = static_cast<T*>(
-        memory::reallocate(this->items, new_capacity * sizeof(T)));
-
-    // Handle reallocation failure
+        this->allocator.reallocate(this->items, this->capacity * sizeof(T),
+                                   new_capacity * sizeof(T)));
     if (new_items == nullptr) {
       return VectorStatus::ALLOCATION_ERROR;
     }
+    this->items = new_items;
+  } else {
+    // Allocate a fresh block for the elements
+    T* new_items =
+        static_cast<T*>(this->allocator.allocate(new_capacity * sizeof(T)));
+    if (new_items == nullptr) {
+      return VectorStatus::ALLOCATION_ERROR;
+    }
+
+    // Move-construct every element into the new block and destroy the source
+    for (uint64 i = 0; i < this->size; i++) {
+      memory::construct(&new_items[i],
+                        memory::pass_ownership(this->items[i]));
+      memory::destroy(&this->items[i]);
+    }
 
-    // Update the items pointer and capacity to the new memory block
+    // Release the old block
+    this->allocator.deallocate(this->items, this->capacity * sizeof(T));
     this->items = new_items;
-    this->capacity = new_capacity;
+  }
+
+  // Report the reallocation (a no-op unless RECREATIONS_MEMORY_STATS is set)
+  memory::stats::count_container_reallocation(new_capacity * sizeof(T));
+  this->capacity = new_capacity;
+  return VectorStatus::OK;
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::grow_for(uint64 count) {
+  // Refuse batches whose total size wraps
+  if (count > UINT64_MAX - this->size) {
+    return VectorStatus::ALLOCATION_ERROR;
+  }
+
+  // Nothing to do while there is room for the new elements
+  const uint64 required = this->size + count;
+  if (required <= this->capacity) {
+    return VectorStatus::OK;
+  }
+
+  // Ask the growth policy for the new capacity; a policy whose arithmetic
+  // wrapped falls back to the exact requirement
+  const uint64 grown = G::next(this->capacity, required, sizeof(T));
+  return this->relocate_items(grown < required ? required : grown);
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+void Vector<T, A, G>::open_gap(uint64 index, uint64 count) {
+  // Calculate how many elements need to be shifted
+  const uint64 elements_to_shift = this->size - index;
+  if (elements_to_shift == 0 || count == 0) {
+    return;
+  }
+
+  if constexpr (isTriviallyRelocatable<T>::value) {
+    // Move memory block to create space for the new elements at 'index'
+    memory::move(&(this->items[index + count]),  // Destination
+                 &(this->items[index]),          // Source
+                 elements_to_shift * sizeof(T));
+  } else {
+    // Shift back to front: slots past the old end are uninitialized and get
+    // move-constructed, the others are move-assigned
+    for (uint64 i = this->size; i > index; i--) {
+      const uint64 dest = i - 1 + count;
+      if (dest >= this->size) {
+        memory::construct(&this->items[dest],
+                          memory::pass_ownership(this->items[i - 1]));
+      } else {
+        this->items[dest] = memory::pass_ownership(this->items[i - 1]);
+      }
+    }
+
+    // Leave the hole uninitialized for the caller
+    const uint64 hole_end =
+        index + count < this->size ? index + count : this->size;
+    for (uint64 i = index; i < hole_end; i++) {
+      memory::destroy(&this->items[i]);
+    }
+  }
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+void Vector<T, A, G>::close_gap(uint64 index, uint64 count) {
+  // Calculate how many elements need to be shifted back
+  const uint64 elements_to_shift = this->size - index - count;
+  if (elements_to_shift == 0 || count == 0) {
+    return;
+  }
+
+  if constexpr (isTriviallyRelocatable<T>::value) {
+    // Move subsequent elements left (overwriting the closed slots)
+    memory::move(&(this->items[index]),          // Destination
+                 &(this->items[index + count]),  // Source
+                 elements_to_shift * sizeof(T));
+  } else {
+    // Shift front to back: closed slots get move-constructed, live ones get
+    // move-assigned
+    for (uint64 i = index + count; i < this->size; i++) {
+      const uint64 dest = i - count;
+      if (dest < index + count) {
+        memory::construct(&this->items[dest],
+                          memory::pass_ownership(this->items[i]));
+      } else {
+        this->items[dest] = memory::pass_ownership(this->items[i]);
+      }
+    }
+
+    // Destroy the moved-from elements left behind at the end
+    const uint64 tail_start = this->size - count > index + count
+                                  ? this->size - count
+                                  : index + count;
+    for (uint64 i = tail_start; i < this->size; i++) {
+      memory::destroy(&this->items[i]);
+    }
+  }
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+void Vector<T, A, G>::copy_construct(T* dest, const T* elements, uint64 count) {
+  if constexpr (isTriviallyCopyable<T>::value) {
+    // Copy the whole batch at once
+    if (count > 0) {
+      memory::copy(dest, elements, count * sizeof(T));
+    }
+  } else {
+    // Copy-construct element by element
+    for (uint64 i = 0; i < count; i++) {
+      memory::construct(&dest[i], elements[i]);
+    }
+  }
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+void Vector<T, A, G>::destroy_items() {
+  // Run the destructor of every live element
+  for (uint64 i = 0; i < this->size; i++) {
+    memory::destroy(&this->items[i]);
+  }
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::push(const T& element) {
+  return this->emplace(element);
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::push(T&& element) {
+  return this->emplace(memory::pass_ownership(element));
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+template <typename... Args>
+VectorStatus Vector<T, A, G>::emplace(Args&&... args) {
+  // Handle uninitialized vector
+  if (!this->initialized) {
+    return VectorStatus::UNINITIALIZED_ERROR;
+  }
+
+  // Fast path: construct directly into the spare slot
+  if (this->size < this->capacity) {
+    memory::construct(&this->items[this->size],
+                      static_cast<Args&&>(args)...);
+    this->size++;
+    return VectorStatus::OK;
+  }
+
+  // Growth path: the arguments may refer to elements of this vector, so build
+  // the value before the storage moves
+  T element(static_cast<Args&&>(args)...);
+  const VectorStatus status = this->grow_for(1);
+  if (status != VectorStatus::OK) {
+    return status;
   }
 
   // Insert the new element at the end and increment the size
-  this->items[this->size++] = element;
+  memory::construct(&this->items[this->size],
+                    memory::pass_ownership(element));
+  this->size++;
   return VectorStatus::OK;
 }
 
-template <typename T>
-VectorStatus Vector<T>::pop(T& out_element) {
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::pop(T& out_element) {
   // Check for an empty vector
   if (this->size == 0) {
     return VectorStatus::EMPTY_VECTOR_ERROR;
   }
 
-  // Decrement size and retrieve the element (copy to output reference)
-  out_element = this->items[--this->size];
+  // Decrement size, move the element out and destroy the vacated slot
+  this->size--;
+  out_element = memory::pass_ownership(this->items[this->size]);
+  memory::destroy(&this->items[this->size]);
 
   // Return success
   return VectorStatus::OK;
 }
 
-template <typename T>
-VectorStatus Vector<T>::insert(uint64 index, T element) {
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::insert(uint64 index, const T& element) {
+  // Copy first: the element may live inside this vector and move while
+  // shifting
+  T copy(element);
+  return this->insert(index, memory::pass_ownership(copy));
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::insert(uint64 index, T&& element) {
   // Check if the index is valid for insertion (up to and including current
   // size)
   if (index > this->size) {
@@ -277,32 +703,14 @@ VectorStatus Vector<T>::insert(uint64 index, T element) {
   }
 
   // Check capacity and reallocate if necessary
-  if (this->size == this->capacity) {
-    uint64 new_capacity = this->capacity > 0 ? this->capacity * 2 : 1;
-    T* new_items = static_cast<T*>(
-        memory::reallocate(this->items, new_capacity * sizeof(T)));
-    if (new_items == nullptr) {
-      return VectorStatus::ALLOCATION_ERROR;
-    }
-
-    this->items = new_items;
-    this->capacity = new_capacity;
+  const VectorStatus status = this->grow_for(1);
+  if (status != VectorStatus::OK) {
+    return status;
   }
 
-  // If index is the current size, elements don't need to be shifted (handled
-  // implicitly below)
-
-  // Calculate how many elements need to be shifted
-  const uint64 elements_to_shift = this->size - index;
-  if (elements_to_shift > 0) {
-    // Move memory block to create space for the new element at 'index'
-    memory::move(&(this->items[index + 1]),  // Destination (one step right)
-                 &(this->items[index]),      // Source
-                 elements_to_shift * sizeof(T));
-  }
-
-  // Insert the new element at the specified index
-  this->items[index] = element;
+  // Shift the tail right and construct the new element in the hole
+  this->open_gap(index, 1);
+  memory::construct(&this->items[index], memory::pass_ownership(element));
 
   // Increment the size counter
   this->size++;
@@ -310,26 +718,19 @@ VectorStatus Vector<T>::insert(uint64 index, T element) {
   return VectorStatus::OK;
 }
 
-template <typename T>
-VectorStatus Vector<T>::remove(uint64 index, T& out_element) {
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::remove(uint64 index, T& out_element) {
   // Check if the index is within the valid range (0 to size - 1)
   if (index >= this->size) {
     return VectorStatus::OUT_OF_BOUNDS_ERROR;
   }
 
-  // Store the element to be removed before shifting
-  out_element = this->items[index];
-
-  // Calculate how many elements need to be shifted back
-  const uint64 elements_to_shift = this->size - index - 1;
+  // Move the element out and destroy its slot before shifting
+  out_element = memory::pass_ownership(this->items[index]);
+  memory::destroy(&this->items[index]);
 
-  if (elements_to_shift > 0) {
-    // Move subsequent elements one position to the left (overwriting the
-    // element at 'index')
-    memory::move(&(this->items[index]),      // Destination
-                 &(this->items[index + 1]),  // Source (one step right)
-                 elements_to_shift * sizeof(T));
-  }
+  // Shift subsequent elements back over the vacated slot
+  this->close_gap(index, 1);
 
   // Decrement the size counter
   this->size--;
@@ -338,8 +739,173 @@ VectorStatus Vector<T>::remove(uint64 index, T& out_element) {
   return VectorStatus::OK;
 }
 
-template <typename T>
-T* Vector<T>::get(uint64 index) const {
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::reserve(uint64 min_capacity) {
+  // Handle uninitialized vector
+  if (!this->initialized) {
+    return VectorStatus::UNINITIALIZED_ERROR;
+  }
+
+  // Reallocate exactly once, only if the storage is too small
+  if (min_capacity <= this->capacity) {
+    return VectorStatus::OK;
+  }
+  return this->relocate_items(min_capacity);
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::resize(uint64 new_size) {
+  // Handle uninitialized vector
+  if (!this->initialized) {
+    return VectorStatus::UNINITIALIZED_ERROR;
+  }
+
+  // Shrink: destroy the surplus elements
+  if (new_size <= this->size) {
+    for (uint64 i = new_size; i < this->size; i++) {
+      memory::destroy(&this->items[i]);
+    }
+    this->size = new_size;
+    return VectorStatus::OK;
+  }
+
+  // Grow: reserve once, then value-initialize the new slots
+  const VectorStatus status = this->reserve(new_size);
+  if (status != VectorStatus::OK) {
+    return status;
+  }
+  if constexpr (isTriviallyConstructible<T>::value) {
+    const byte zero = 0;
+    memory::set(&this->items[this->size], &zero,
+                (new_size - this->size) * sizeof(T));
+  } else {
+    for (uint64 i = this->size; i < new_size; i++) {
+      memory::construct(&this->items[i]);
+    }
+  }
+  this->size = new_size;
+  return VectorStatus::OK;
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::resize(uint64 new_size, const T& value) {
+  // Handle uninitialized vector
+  if (!this->initialized) {
+    return VectorStatus::UNINITIALIZED_ERROR;
+  }
+
+  // Shrink: destroy the surplus elements
+  if (new_size <= this->size) {
+    for (uint64 i = new_size; i < this->size; i++) {
+      memory::destroy(&this->items[i]);
+    }
+    this->size = new_size;
+    return VectorStatus::OK;
+  }
+
+  // Grow: copy the value first (it may live inside this vector), reserve
+  // once, then fill the new slots
+  T fill(value);
+  const VectorStatus status = this->reserve(new_size);
+  if (status != VectorStatus::OK) {
+    return status;
+  }
+  for (uint64 i = this->size; i < new_size; i++) {
+    memory::construct(&this->items[i], fill);
+  }
+  this->size = new_size;
+  return VectorStatus::OK;
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::append(const T* elements, uint64 count) {
+  // Handle uninitialized vector
+  if (!this->initialized) {
+    return VectorStatus::UNINITIALIZED_ERROR;
+  }
+
+  // Make room for the whole batch with a single reallocation
+  const VectorStatus status = this->grow_for(count);
+  if (status != VectorStatus::OK) {
+    return status;
+  }
+
+  // Copy the batch past the end and bump the size
+  copy_construct(&this->items[this->size], elements, count);
+  this->size += count;
+  return VectorStatus::OK;
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::insert_range(uint64 index, const T* elements,
+                                        uint64 count) {
+  // Handle uninitialized vector
+  if (!this->initialized) {
+    return VectorStatus::UNINITIALIZED_ERROR;
+  }
+
+  // Check if the index is valid for insertion
+  if (index > this->size) {
+    return VectorStatus::OUT_OF_BOUNDS_ERROR;
+  }
+
+  // Make room for the whole batch with a single reallocation
+  const VectorStatus status = this->grow_for(count);
+  if (status != VectorStatus::OK) {
+    return status;
+  }
+
+  // Shift the tail once and copy the batch into the hole
+  this->open_gap(index, count);
+  copy_construct(&this->items[index], elements, count);
+  this->size += count;
+  return VectorStatus::OK;
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::erase_range(uint64 index, uint64 count) {
+  // Check that the whole range lies inside the vector
+  if (index > this->size || count > this->size - index) {
+    return VectorStatus::OUT_OF_BOUNDS_ERROR;
+  }
+
+  // Destroy the erased elements, then shift the tail over them once
+  for (uint64 i = index; i < index + count; i++) {
+    memory::destroy(&this->items[i]);
+  }
+  this->close_gap(index, count);
+  this->size -= count;
+  return VectorStatus::OK;
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+void Vector<T, A, G>::clear() {
+  // Destroy the elements but keep the storage for reuse
+  this->destroy_items();
+  this->size = 0;
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::shrink_to_fit() {
+  // Nothing to release when the storage is already tight
+  if (this->capacity == this->size) {
+    return VectorStatus::OK;
+  }
+
+  // An empty vector gives its whole block back
+  if (this->size == 0) {
+    this->allocator.deallocate(this->items, this->capacity * sizeof(T));
+    this->items = nullptr;
+    this->capacity = 0;
+    return VectorStatus::OK;
+  }
+
+  // Otherwise move the elements into a block of exactly size elements
+  return this->relocate_items(this->size);
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+T* Vector<T, A, G>::get(uint64 index) const {
   // Check for an out-of-bounds access
   if (index >= this->size) {
     // Return nullptr on failure
@@ -350,32 +916,109 @@ T* Vector<T>::get(uint64 index) const {
   return &(this->items[index]);
 }
 
-template <typename T>
-VectorStatus Vector<T>::set(uint64 index, T element) {
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::set(uint64 index, const T& element) {
   // Check for an out-of-bounds access
   if (index >= this->size) {
     return VectorStatus::OUT_OF_BOUNDS_ERROR;
   }
 
-  // Assign the new element value
+  // Copy-assign the new element value
   this->items[index] = element;
   return VectorStatus::OK;
 }
 
-template <typename T>
-uint64 Vector<T>::getSize() const {
+template <typename T, memory::Allocator A, GrowthPolicy G>
+VectorStatus Vector<T, A, G>::set(uint64 index, T&& element) {
+  // Check for an out-of-bounds access
+  if (index >= this->size) {
+    return VectorStatus::OUT_OF_BOUNDS_ERROR;
+  }
+
+  // Move-assign the new element value
+  this->items[index] = memory::pass_ownership(element);
+  return VectorStatus::OK;
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+T* Vector<T, A, G>::getData() const {
+  // Return the storage pointer
+  return this->items;
+}
+
+template <typename T, memory::Allocator A, GrowthPolicy G>
+uint64 Vector<T, A, G>::getSize() const {
   // Return the stored size count
   return this->size;
 }
 
-template <typename T>
-uint64 Vector<T>::getCapacity() const {
+template <typename T, memory::Allocator A, GrowthPolicy G>
+uint64 Vector<T, A, G>::getCapacity() const {
   // Return the stored capacity count
   return this->capacity;
 }
 
-template <typename T>
-bool Vector<T>::isInitialized() const {
+template <typename T, memory::Allocator A, GrowthPolicy G>
+bool Vector<T, A, G>::isInitialized() const {
   // Return the initialization status
   return this->initialized;
-}
\ No newline at end of file
+}
+
+// === Saturating arithmetic over vectors (Declaration) ===
+
+namespace numbers {
+
+// @brief Adds others[i] to values[i] for every i, clamping each sum (see
+// numbers::saturating_add over ranges).
+// @param values The accumulators, updated in place.
+// @param others The amounts to add.
+// @return OK, or OUT_OF_BOUNDS_ERROR if the sizes differ.
+template <Integer T, memory::Allocator A, GrowthPolicy G, memory::Allocator B,
+          GrowthPolicy H>
+VectorStatus saturating_add(Vector<T, A, G>& values,
+                            const Vector<T, B, H>& others);
+
+// @brief Subtracts others[i] from values[i] for every i, clamping each
+// difference.
+// @param values The accumulators, updated in place.
+// @param others The amounts to subtract.
+// @return OK, or OUT_OF_BOUNDS_ERROR if the sizes differ.
+template <Integer T, memory::Allocator A, GrowthPolicy G, memory::Allocator B,
+          GrowthPolicy H>
+VectorStatus saturating_sub(Vector<T, A, G>& values,
+                            const Vector<T, B, H>& others);
+
+}  // namespace numbers
+
+// === Implementation of saturating arithmetic over vectors ===
+
+template <Integer T, memory::Allocator A, GrowthPolicy G, memory::Allocator B,
+          GrowthPolicy H>
+VectorStatus numbers::saturating_add(Vector<T, A, G>& values,
+                                     const Vector<T, B, H>& others) {
+  if (values.getSize() != others.getSize()) {
+    return VectorStatus::OUT_OF_BOUNDS_ERROR;
+  }
+  saturating_add(values.getData(), others.getData(), values.getSize());
+  return VectorStatus::OK;
+}
+
+template <Integer T, memory::Allocator A, GrowthPolicy G, memory::Allocator B,
+          GrowthPolicy H>
+VectorStatus numbers::saturating_sub(Vector<T, A, G>& values,
+                                     const Vector<T, B, H>& others) {
+  if (values.getSize() != others.getSize()) {
+    return VectorStatus::OUT_OF_BOUNDS_ERROR;
+  }
+  saturating_sub(values.getData(), others.getData(), values.getSize());
+  return VectorStatus::OK;
+}
+
+// === Trait specializations ===
+
+// @brief A Vector only holds a pointer to its heap block and counters, so it
+// can be relocated bitwise when nested inside another container.
+template <typename T, memory::Allocator A, GrowthPolicy G>
+struct isTriviallyRelocatable<Vector<T, A, G>> {
+  static constexpr bool value = isTriviallyRelocatable<A>::value;
+};